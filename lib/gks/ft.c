@@ -2,6 +2,7 @@
 
 #include <stdio.h>
 #include <stdlib.h>
+#include <string.h>
 #include <math.h>
 #if defined(_WIN32)
 #define STRSAFE_NO_DEPRECATE
@@ -135,6 +136,230 @@ static int *opcodes = NULL;
 
 static long pen_x = 0;
 
+/* Glyph cache
+ *
+ * Decomposed outlines (in font units), kerning pairs, rendered bitmaps and glyph metrics are kept in a hash table with
+ * a least recently used eviction policy. The key is made of the face, the glyph (or glyph pair), the size and the
+ * transformation. Entries stay valid as long as the faces are loaded, i.e. until gks_ft_terminate() is called. */
+
+#define FT_CACHE_BUCKETS 4096
+#define FT_CACHE_DEFAULT_SIZE 4096
+#define FT_CACHE_MAX_BYTES (32 * 1024 * 1024)
+
+#define FT_CACHE_KERNING_UNSCALED 0
+#define FT_CACHE_KERNING_UNFITTED 1
+#define FT_CACHE_KERNING_API 2
+#define FT_CACHE_METRICS_API 0
+#define FT_CACHE_CAPHEIGHT 1
+
+typedef struct
+{
+  int kind;
+  void *face;
+  FT_UInt code[2];
+  double size[2];
+  FT_Matrix transform;
+  int flags;
+} ft_cache_key_t;
+
+typedef struct ft_cache_entry_t
+{
+  ft_cache_key_t key;
+  unsigned int hash;
+  struct ft_cache_entry_t *chain;      /* next entry in the same bucket */
+  struct ft_cache_entry_t *prev, *next; /* LRU list, most recently used first */
+  size_t nbytes;
+  FT_UInt glyph_index;
+  FT_Bool fixed_width;
+  FT_Glyph_Metrics metrics;
+  FT_Vector advance;
+  int num_points, num_opcodes;
+  double *points; /* x, y pairs */
+  int *opcodes;
+  int left, top, rows, width;
+  unsigned char *buffer; /* rows * width bytes */
+  int found;
+  double values[9];
+} ft_cache_entry_t;
+
+static ft_cache_entry_t *ft_cache_table[FT_CACHE_BUCKETS];
+static ft_cache_entry_t *ft_cache_head = NULL, *ft_cache_tail = NULL;
+static int ft_cache_capacity = -1, ft_cache_entries = 0;
+static size_t ft_cache_bytes = 0;
+static long ft_cache_hits[GKS_K_FT_CACHE_KINDS], ft_cache_misses[GKS_K_FT_CACHE_KINDS];
+/* an entry which is still used by the caller while other entries are added (it is not evicted either) */
+static ft_cache_entry_t *ft_cache_pinned = NULL;
+
+static void ft_cache_init_key(ft_cache_key_t *key, int kind, void *face, FT_UInt code1, FT_UInt code2)
+{
+  memset(key, 0, sizeof(ft_cache_key_t));
+  key->kind = kind;
+  key->face = face;
+  key->code[0] = code1;
+  key->code[1] = code2;
+  key->transform.xx = key->transform.yy = 0x10000L;
+}
+
+static unsigned int ft_cache_hash(const ft_cache_key_t *key)
+{
+  unsigned long values[10];
+  unsigned int hash = 2166136261U;
+  int i;
+
+  values[0] = (unsigned long)key->kind | ((unsigned long)key->flags << 8);
+  values[1] = (unsigned long)(size_t)key->face;
+  values[2] = key->code[0];
+  values[3] = key->code[1];
+  values[4] = (unsigned long)(long)(key->size[0] * 64);
+  values[5] = (unsigned long)(long)(key->size[1] * 64);
+  values[6] = (unsigned long)key->transform.xx;
+  values[7] = (unsigned long)key->transform.xy;
+  values[8] = (unsigned long)key->transform.yx;
+  values[9] = (unsigned long)key->transform.yy;
+  for (i = 0; i < 10; i++)
+    {
+      hash = (hash ^ (unsigned int)(values[i] ^ ((values[i] >> 16) >> 16))) * 16777619U;
+    }
+  return hash;
+}
+
+static int ft_cache_equal(const ft_cache_key_t *a, const ft_cache_key_t *b)
+{
+  return a->kind == b->kind && a->face == b->face && a->code[0] == b->code[0] && a->code[1] == b->code[1] &&
+         a->size[0] == b->size[0] && a->size[1] == b->size[1] && a->transform.xx == b->transform.xx &&
+         a->transform.xy == b->transform.xy && a->transform.yx == b->transform.yx &&
+         a->transform.yy == b->transform.yy && a->flags == b->flags;
+}
+
+static void ft_cache_unlink(ft_cache_entry_t *entry)
+{
+  if (entry->prev)
+    entry->prev->next = entry->next;
+  else
+    ft_cache_head = entry->next;
+  if (entry->next)
+    entry->next->prev = entry->prev;
+  else
+    ft_cache_tail = entry->prev;
+  entry->prev = entry->next = NULL;
+}
+
+static void ft_cache_link(ft_cache_entry_t *entry)
+{
+  entry->prev = NULL;
+  entry->next = ft_cache_head;
+  if (ft_cache_head) ft_cache_head->prev = entry;
+  ft_cache_head = entry;
+  if (!ft_cache_tail) ft_cache_tail = entry;
+}
+
+static void ft_cache_remove(ft_cache_entry_t *entry)
+{
+  ft_cache_entry_t **p = &ft_cache_table[entry->hash % FT_CACHE_BUCKETS];
+
+  while (*p != entry) p = &(*p)->chain;
+  *p = entry->chain;
+  ft_cache_unlink(entry);
+
+  ft_cache_entries -= 1;
+  ft_cache_bytes -= entry->nbytes;
+  if (entry->points) gks_free(entry->points);
+  if (entry->opcodes) gks_free(entry->opcodes);
+  if (entry->buffer) gks_free(entry->buffer);
+  gks_free(entry);
+}
+
+static void ft_cache_clear(void)
+{
+  while (ft_cache_tail) ft_cache_remove(ft_cache_tail);
+}
+
+static ft_cache_entry_t *ft_cache_lookup(const ft_cache_key_t *key)
+{
+  ft_cache_entry_t *entry;
+  const char *env;
+
+  if (ft_cache_capacity < 0)
+    {
+      ft_cache_capacity = FT_CACHE_DEFAULT_SIZE;
+      if ((env = gks_getenv("GKS_FT_CACHE_SIZE")) != NULL)
+        {
+          ft_cache_capacity = atoi(env);
+          if (ft_cache_capacity < 0) ft_cache_capacity = 0;
+        }
+    }
+
+  if (ft_cache_capacity > 0)
+    {
+      for (entry = ft_cache_table[ft_cache_hash(key) % FT_CACHE_BUCKETS]; entry != NULL; entry = entry->chain)
+        {
+          if (ft_cache_equal(&entry->key, key))
+            {
+              if (entry != ft_cache_head)
+                {
+                  ft_cache_unlink(entry);
+                  ft_cache_link(entry);
+                }
+              ft_cache_hits[key->kind]++;
+              return entry;
+            }
+        }
+    }
+  ft_cache_misses[key->kind]++;
+  return NULL;
+}
+
+static ft_cache_entry_t *ft_cache_new(const ft_cache_key_t *key)
+{
+  ft_cache_entry_t *entry = (ft_cache_entry_t *)gks_malloc(sizeof(ft_cache_entry_t));
+
+  entry->key = *key;
+  entry->hash = ft_cache_hash(key);
+  return entry;
+}
+
+/* Insert a filled in entry. The new entry itself is never evicted, so that it can be used by the caller until the next
+ * cache operation, even if caching is disabled. Entries from earlier operations may be evicted, unless they are pinned
+ * with `ft_cache_pinned`. */
+static void ft_cache_add(ft_cache_entry_t *entry, size_t nbytes)
+{
+  ft_cache_entry_t **bucket = &ft_cache_table[entry->hash % FT_CACHE_BUCKETS];
+  ft_cache_entry_t *victim;
+
+  entry->nbytes = sizeof(ft_cache_entry_t) + nbytes;
+  entry->chain = *bucket;
+  *bucket = entry;
+  ft_cache_link(entry);
+  ft_cache_entries += 1;
+  ft_cache_bytes += entry->nbytes;
+
+  while (ft_cache_entries > ft_cache_capacity || ft_cache_bytes > FT_CACHE_MAX_BYTES)
+    {
+      victim = (ft_cache_tail == ft_cache_pinned) ? ft_cache_tail->prev : ft_cache_tail;
+      if (victim == NULL || victim == entry) break;
+      ft_cache_remove(victim);
+    }
+}
+
+void gks_ft_inq_cache_stats(long *hits, long *misses, int *entries, long *nbytes)
+{
+  int i;
+
+  for (i = 0; i < GKS_K_FT_CACHE_KINDS; i++)
+    {
+      if (hits) hits[i] = ft_cache_hits[i];
+      if (misses) misses[i] = ft_cache_misses[i];
+    }
+  if (entries) *entries = ft_cache_entries;
+  if (nbytes) *nbytes = (long)ft_cache_bytes;
+}
+
+void gks_ft_reset_cache_stats(void)
+{
+  memset(ft_cache_hits, 0, sizeof(ft_cache_hits));
+  memset(ft_cache_misses, 0, sizeof(ft_cache_misses));
+}
+
 #if defined(_WIN32)
 typedef wchar_t ft_path_char_t;
 #else
@@ -205,7 +430,7 @@ static const ft_path_char_t *user_font_directories[] = {
 };
 
 static FT_Error set_glyph(FT_Face face, FT_UInt codepoint, FT_UInt *previous, FT_Vector *pen, FT_Bool vertical,
-                          FT_Matrix *rotation, FT_Vector *bearing, FT_Int halign, FT_GlyphSlot *glyph_slot_ptr);
+                          FT_Matrix *rotation, FT_Vector *bearing, FT_Int halign, ft_cache_entry_t **glyph_ptr);
 static void gks_ft_init_fallback_faces(void);
 static void utf_to_unicode(FT_Bytes str, FT_UInt *unicode_string, FT_UInt *length);
 static FT_Long ft_min(FT_Long a, FT_Long b);
@@ -490,84 +715,142 @@ DLLEXPORT void gks_ft_inq_bearing_x_direction(int *direction)
   *direction = gks_ft_bearing_x_direction;
 }
 
-/* load a glyph into the slot and compute bearing */
+static void get_scaled_kerning(FT_Face face, FT_UInt left_glyph_index, FT_UInt right_glyph_index, FT_Vector *delta)
+{
+  ft_cache_key_t key;
+  ft_cache_entry_t *entry;
+
+  ft_cache_init_key(&key, GKS_K_FT_CACHE_KERNING, face, left_glyph_index, right_glyph_index);
+  key.size[0] = face->size->metrics.x_scale;
+  key.size[1] = face->size->metrics.y_scale;
+  key.flags = FT_CACHE_KERNING_UNFITTED;
+  if ((entry = ft_cache_lookup(&key)) == NULL)
+    {
+      entry = ft_cache_new(&key);
+      FT_Get_Kerning(face, left_glyph_index, right_glyph_index, FT_KERNING_UNFITTED, &entry->advance);
+      ft_cache_add(entry, 0);
+    }
+  *delta = entry->advance;
+}
+
+/* load a rendered glyph (from the cache or into the slot) and compute bearing */
 static FT_Error set_glyph(FT_Face face, FT_UInt codepoint, FT_UInt *previous, FT_Vector *pen, FT_Bool vertical,
-                          FT_Matrix *rotation, FT_Vector *bearing, FT_Int halign, FT_GlyphSlot *glyph_slot_ptr)
+                          FT_Matrix *rotation, FT_Vector *bearing, FT_Int halign, ft_cache_entry_t **glyph_ptr)
 {
   FT_Error error;
   FT_UInt glyph_index;
-
-  glyph_index = FT_Get_Char_Index(face, codepoint);
+  FT_GlyphSlot slot;
+  ft_cache_key_t key;
+  ft_cache_entry_t *glyph;
+  int j;
+
+  ft_cache_init_key(&key, GKS_K_FT_CACHE_BITMAP, face, codepoint, 0);
+  key.size[0] = face->size->metrics.x_scale;
+  key.size[1] = face->size->metrics.y_scale;
+  key.transform = *rotation;
+  key.flags = vertical;
+  glyph = ft_cache_lookup(&key);
+
+  glyph_index = glyph ? glyph->glyph_index : FT_Get_Char_Index(face, codepoint);
   if (FT_HAS_KERNING(face) && !FT_IS_FIXED_WIDTH(face) && *previous && !vertical && glyph_index)
     {
       FT_Vector delta;
-      FT_Get_Kerning(face, *previous, glyph_index, FT_KERNING_UNFITTED, &delta);
+      /* adding the kerning entry must not evict the cached glyph */
+      ft_cache_pinned = glyph;
+      get_scaled_kerning(face, *previous, glyph_index, &delta);
+      ft_cache_pinned = NULL;
       FT_Vector_Transform(&delta, rotation);
       pen->x += delta.x;
       pen->y += delta.y;
     }
   *previous = glyph_index;
 
-  if (!glyph_index)
+  if (!glyph)
     {
-      unsigned int i;
-      for (i = 0; i < NUM_FALLBACK_FACES; i++)
+      glyph = ft_cache_new(&key);
+      glyph->glyph_index = glyph_index;
+
+      if (!glyph_index)
         {
-          if (!fallback_font_faces[i])
+          unsigned int i;
+          for (i = 0; i < NUM_FALLBACK_FACES; i++)
             {
-              continue;
-            }
-          glyph_index = FT_Get_Char_Index(fallback_font_faces[i], codepoint);
-          if (glyph_index != 0)
-            {
-              face = fallback_font_faces[i];
-              break;
+              if (!fallback_font_faces[i])
+                {
+                  continue;
+                }
+              glyph_index = FT_Get_Char_Index(fallback_font_faces[i], codepoint);
+              if (glyph_index != 0)
+                {
+                  face = fallback_font_faces[i];
+                  break;
+                }
             }
         }
-    }
 
-  if (!glyph_index)
-    {
-      gks_perror("glyph missing from current font: %d", codepoint);
-    }
-  error = FT_Load_Glyph(face, glyph_index, vertical ? FT_LOAD_VERTICAL_LAYOUT : FT_LOAD_DEFAULT);
-  if (error)
-    {
-      gks_perror("glyph could not be loaded: %d", codepoint);
-      return 1;
-    }
-  *glyph_slot_ptr = face->glyph;
+      if (!glyph_index)
+        {
+          gks_perror("glyph missing from current font: %d", codepoint);
+        }
+      error = FT_Load_Glyph(face, glyph_index, vertical ? FT_LOAD_VERTICAL_LAYOUT : FT_LOAD_DEFAULT);
+      if (error)
+        {
+          gks_perror("glyph could not be loaded: %d", codepoint);
+          gks_free(glyph);
+          return 1;
+        }
 
-  error = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
-  if (error)
-    {
-      gks_perror("glyph could not be rendered: %c", codepoint);
-      return 1;
+      error = FT_Render_Glyph(face->glyph, FT_RENDER_MODE_NORMAL);
+      if (error)
+        {
+          gks_perror("glyph could not be rendered: %c", codepoint);
+          gks_free(glyph);
+          return 1;
+        }
+
+      slot = face->glyph;
+      glyph->fixed_width = FT_IS_FIXED_WIDTH(face);
+      glyph->metrics = slot->metrics;
+      glyph->advance = slot->advance;
+      glyph->left = slot->bitmap_left;
+      glyph->top = slot->bitmap_top;
+      glyph->rows = slot->bitmap.rows;
+      glyph->width = slot->bitmap.width;
+      if (glyph->rows * glyph->width > 0)
+        {
+          glyph->buffer = (unsigned char *)gks_malloc(glyph->rows * glyph->width);
+          for (j = 0; j < glyph->rows; j++)
+            {
+              memcpy(glyph->buffer + j * glyph->width, slot->bitmap.buffer + j * slot->bitmap.pitch, glyph->width);
+            }
+        }
+      ft_cache_add(glyph, glyph->rows * glyph->width);
     }
+  *glyph_ptr = glyph;
 
-  bearing->x = FT_IS_FIXED_WIDTH(face) ? 0 : face->glyph->metrics.horiBearingX;
+  bearing->x = glyph->fixed_width ? 0 : glyph->metrics.horiBearingX;
   bearing->y = 0;
   if (vertical)
     {
       if (halign == GKS_K_TEXT_HALIGN_RIGHT)
         {
-          bearing->x += face->glyph->metrics.width;
+          bearing->x += glyph->metrics.width;
         }
       else if (halign == GKS_K_TEXT_HALIGN_CENTER)
         {
-          bearing->x += face->glyph->metrics.width / 2;
+          bearing->x += glyph->metrics.width / 2;
         }
       if (bearing->x != 0) FT_Vector_Transform(bearing, rotation);
-      bearing->x = 64 * face->glyph->bitmap_left - bearing->x;
-      bearing->y = 64 * face->glyph->bitmap_top - bearing->y;
+      bearing->x = 64 * glyph->left - bearing->x;
+      bearing->y = 64 * glyph->top - bearing->y;
     }
   else
     {
       if (bearing->x != 0) FT_Vector_Transform(bearing, rotation);
       pen->x += gks_ft_bearing_x_direction * bearing->x;
       pen->y -= bearing->y;
-      bearing->x = 64 * face->glyph->bitmap_left;
-      bearing->y = 64 * face->glyph->bitmap_top;
+      bearing->x = 64 * glyph->left;
+      bearing->y = 64 * glyph->top;
     }
   return 0;
 }
@@ -673,6 +956,7 @@ void gks_ft_terminate(void)
 {
   if (init)
     {
+      ft_cache_clear();
       ft_close_all_fonts();
       FT_Done_FreeType(library);
     }
@@ -967,7 +1251,7 @@ void *gks_ft_get_face(int textfont)
 }
 
 
-int gks_ft_get_metrics(int font, double fontsize, unsigned int codepoint, unsigned int dpi, double *width,
+static int get_metrics(int font, double fontsize, unsigned int codepoint, unsigned int dpi, double *width,
                        double *height, double *depth, double *advance, double *bearing, double *xmin, double *xmax,
                        double *ymin, double *ymax)
 {
@@ -1063,8 +1347,8 @@ int gks_ft_get_metrics(int font, double fontsize, unsigned int codepoint, unsign
   return 0;
 }
 
-double gks_ft_get_kerning(int font, double fontsize, unsigned int dpi, unsigned int first_codepoint,
-                          unsigned int second_codepoint)
+static double get_scaled_kerning_pair(int font, double fontsize, unsigned int dpi, unsigned int first_codepoint,
+                                      unsigned int second_codepoint)
 {
   FT_Face face;
   FT_Error error;
@@ -1116,11 +1400,70 @@ double gks_ft_get_kerning(int font, double fontsize, unsigned int dpi, unsigned
 }
 
 
+int gks_ft_get_metrics(int font, double fontsize, unsigned int codepoint, unsigned int dpi, double *width,
+                       double *height, double *depth, double *advance, double *bearing, double *xmin, double *xmax,
+                       double *ymin, double *ymax)
+{
+  ft_cache_key_t key;
+  ft_cache_entry_t *entry;
+  double *values;
+
+  gks_ft_init();
+
+  ft_cache_init_key(&key, GKS_K_FT_CACHE_METRICS, gks_ft_get_face(font), codepoint, 0);
+  key.size[0] = fontsize;
+  key.size[1] = dpi;
+  key.flags = FT_CACHE_METRICS_API;
+  if ((entry = ft_cache_lookup(&key)) == NULL)
+    {
+      entry = ft_cache_new(&key);
+      values = entry->values;
+      entry->found = get_metrics(font, fontsize, codepoint, dpi, values, values + 1, values + 2, values + 3, values + 4,
+                                 values + 5, values + 6, values + 7, values + 8);
+      ft_cache_add(entry, 0);
+    }
+  if (!entry->found) return 0;
+
+  values = entry->values;
+  if (width) *width = values[0];
+  if (height) *height = values[1];
+  if (depth) *depth = values[2];
+  if (advance) *advance = values[3];
+  if (bearing) *bearing = values[4];
+  if (xmin) *xmin = values[5];
+  if (xmax) *xmax = values[6];
+  if (ymin) *ymin = values[7];
+  if (ymax) *ymax = values[8];
+  return 1;
+}
+
+double gks_ft_get_kerning(int font, double fontsize, unsigned int dpi, unsigned int first_codepoint,
+                          unsigned int second_codepoint)
+{
+  ft_cache_key_t key;
+  ft_cache_entry_t *entry;
+
+  gks_ft_init();
+
+  ft_cache_init_key(&key, GKS_K_FT_CACHE_KERNING, gks_ft_get_face(font), first_codepoint, second_codepoint);
+  key.size[0] = fontsize;
+  key.size[1] = dpi;
+  key.flags = FT_CACHE_KERNING_API;
+  if ((entry = ft_cache_lookup(&key)) == NULL)
+    {
+      entry = ft_cache_new(&key);
+      entry->values[0] = get_scaled_kerning_pair(font, fontsize, dpi, first_codepoint, second_codepoint);
+      ft_cache_add(entry, 0);
+    }
+  return entry->values[0];
+}
+
+
 unsigned char *gks_ft_get_bitmap(int *x, int *y, int *width, int *height, gks_state_list_t *gkss, const char *text,
                                  int length)
 {
   FT_Face face;                /* font face */
-  FT_GlyphSlot glyph_slot;     /* glyph slot (might be in a fallback face) */
+  ft_cache_entry_t *glyph;     /* rendered glyph (might be from a fallback face) */
   FT_Vector pen;               /* glyph position */
   FT_BBox bb;                  /* bounding box */
   FT_Vector bearing;           /* individual glyph translation */
@@ -1136,7 +1479,6 @@ unsigned char *gks_ft_get_bitmap(int *x, int *y, int *width, int *height, gks_st
   FT_UInt num_glyphs;          /* number of glyphs */
   FT_Vector anchor;
   FT_Vector up;
-  FT_Bitmap ftbitmap;
   FT_UInt codepoint;
   int textfont, dx, dy, value, pos_x, pos_y;
   unsigned int i, j, k;
@@ -1221,6 +1563,8 @@ unsigned char *gks_ft_get_bitmap(int *x, int *y, int *width, int *height, gks_st
     }
   else
     {
+      rotation.xx = rotation.yy = 0x10000L;
+      rotation.xy = rotation.yx = 0;
       FT_Set_Transform(face, NULL, NULL);
       for (i = 0; i < NUM_FALLBACK_FACES; i++)
         {
@@ -1278,23 +1622,23 @@ unsigned char *gks_ft_get_bitmap(int *x, int *y, int *width, int *height, gks_st
     {
       codepoint = unicode_string[i];
 
-      error = set_glyph(face, codepoint, &previous, &pen, vertical, &rotation, &bearing, halign, &glyph_slot);
+      error = set_glyph(face, codepoint, &previous, &pen, vertical, &rotation, &bearing, halign, &glyph);
       if (error) continue;
 
       bb.xMin = ft_min(bb.xMin, pen.x + bearing.x);
-      bb.xMax = ft_max(bb.xMax, pen.x + bearing.x + 64 * glyph_slot->bitmap.width);
-      bb.yMin = ft_min(bb.yMin, pen.y + bearing.y - 64 * glyph_slot->bitmap.rows);
+      bb.xMax = ft_max(bb.xMax, pen.x + bearing.x + 64 * glyph->width);
+      bb.yMin = ft_min(bb.yMin, pen.y + bearing.y - 64 * glyph->rows);
       bb.yMax = ft_max(bb.yMax, pen.y + bearing.y);
 
       if (direction == GKS_K_TEXT_PATH_DOWN)
         {
-          pen.x -= glyph_slot->advance.x + spacing.x;
-          pen.y -= glyph_slot->advance.y + spacing.y;
+          pen.x -= glyph->advance.x + spacing.x;
+          pen.y -= glyph->advance.y + spacing.y;
         }
       else
         {
-          pen.x += glyph_slot->advance.x + spacing.x;
-          pen.y += glyph_slot->advance.y + spacing.y;
+          pen.x += glyph->advance.x + spacing.x;
+          pen.y += glyph->advance.y + spacing.y;
         }
     }
 
@@ -1369,20 +1713,19 @@ unsigned char *gks_ft_get_bitmap(int *x, int *y, int *width, int *height, gks_st
       codepoint = unicode_string[i];
 
       bearing.x = bearing.y = 0;
-      error = set_glyph(face, codepoint, &previous, &pen, vertical, &rotation, &bearing, halign, &glyph_slot);
+      error = set_glyph(face, codepoint, &previous, &pen, vertical, &rotation, &bearing, halign, &glyph);
       if (error) continue;
 
       pos_x = (pen.x + bearing.x - bb.xMin) / 64;
       pos_y = (-pen.y - bearing.y + bb.yMax) / 64;
-      ftbitmap = glyph_slot->bitmap;
-      for (j = 0; j < (unsigned int)ftbitmap.rows; j++)
+      for (j = 0; j < (unsigned int)glyph->rows; j++)
         {
-          for (k = 0; k < (unsigned int)ftbitmap.width; k++)
+          for (k = 0; k < (unsigned int)glyph->width; k++)
             {
               dx = k + pos_x;
               dy = j + pos_y;
               value = mono_bitmap[dy * *width + dx];
-              value += ftbitmap.buffer[j * ftbitmap.pitch + k];
+              value += glyph->buffer[j * glyph->width + k];
               if (value > 255)
                 {
                   value = 255;
@@ -1393,13 +1736,13 @@ unsigned char *gks_ft_get_bitmap(int *x, int *y, int *width, int *height, gks_st
 
       if (direction == GKS_K_TEXT_PATH_DOWN)
         {
-          pen.x -= glyph_slot->advance.x + spacing.x;
-          pen.y -= glyph_slot->advance.y + spacing.y;
+          pen.x -= glyph->advance.x + spacing.x;
+          pen.y -= glyph->advance.y + spacing.y;
         }
       else
         {
-          pen.x += glyph_slot->advance.x + spacing.x;
-          pen.y += glyph_slot->advance.y + spacing.y;
+          pen.x += glyph->advance.x + spacing.x;
+          pen.y += glyph->advance.y + spacing.y;
         }
     }
   gks_free(unicode_string);
@@ -1510,13 +1853,20 @@ static int cubic_to(const FT_Vector *control1, const FT_Vector *control2, const
   return 0;
 }
 
-static void get_outline(FT_Face face, FT_UInt charcode, FT_Bool first, FT_Bool last)
+/* load the outline of a glyph in font units (from the cache or by decomposing the glyph) */
+static ft_cache_entry_t *load_outline(FT_Face face, FT_UInt charcode)
 {
   FT_Outline_Funcs callbacks;
-  FT_GlyphSlot slot;
-  FT_Glyph_Metrics metrics;
-  FT_Outline outline;
   FT_Error error;
+  ft_cache_key_t key;
+  ft_cache_entry_t *glyph;
+  long saved_pen_x = pen_x;
+  int j;
+
+  ft_cache_init_key(&key, GKS_K_FT_CACHE_OUTLINE, face, charcode, 0);
+  if ((glyph = ft_cache_lookup(&key)) != NULL) return glyph;
+
+  load_glyph(face, charcode);
 
   callbacks.move_to = move_to;
   callbacks.line_to = line_to;
@@ -1526,14 +1876,54 @@ static void get_outline(FT_Face face, FT_UInt charcode, FT_Bool first, FT_Bool l
   callbacks.shift = 0;
   callbacks.delta = 0;
 
-  slot = face->glyph;
-  outline = slot->outline;
-  metrics = slot->metrics;
+  pen_x = 0;
+  npoints = 0;
+  num_opcodes = 0;
+  error = FT_Outline_Decompose(&face->glyph->outline, &callbacks, NULL);
+  if (error) gks_perror("could not extract the outline");
+  pen_x = saved_pen_x;
+
+  glyph = ft_cache_new(&key);
+  glyph->metrics = face->glyph->metrics;
+  glyph->num_points = npoints;
+  glyph->num_opcodes = num_opcodes;
+  if (npoints > 0)
+    {
+      glyph->points = (double *)gks_malloc(2 * npoints * sizeof(double));
+      glyph->opcodes = (int *)gks_malloc(num_opcodes * sizeof(int));
+      for (j = 0; j < (int)npoints; j++)
+        {
+          glyph->points[2 * j] = xpoint[j];
+          glyph->points[2 * j + 1] = ypoint[j];
+        }
+      memcpy(glyph->opcodes, opcodes, num_opcodes * sizeof(int));
+    }
+  ft_cache_add(glyph, npoints * 2 * sizeof(double) + num_opcodes * sizeof(int));
+
+  npoints = 0;
+  num_opcodes = 0;
+
+  return glyph;
+}
+
+static void get_outline(ft_cache_entry_t *glyph, FT_UInt charcode, FT_Bool first, FT_Bool last)
+{
+  FT_Glyph_Metrics metrics = glyph->metrics;
+  int j;
 
   if (first) pen_x -= metrics.horiBearingX;
 
-  error = FT_Outline_Decompose(&outline, &callbacks, NULL);
-  if (error) gks_perror("could not extract the outline");
+  if (npoints + glyph->num_points + 2 >= maxpoints) reallocate(npoints + glyph->num_points + 2);
+  for (j = 0; j < glyph->num_points; j++)
+    {
+      xpoint[npoints] = glyph->points[2 * j] + pen_x;
+      ypoint[npoints] = glyph->points[2 * j + 1];
+      npoints += 1;
+    }
+  for (j = 0; j < glyph->num_opcodes; j++)
+    {
+      opcodes[num_opcodes++] = glyph->opcodes[j];
+    }
 
   if (num_opcodes > 0)
     {
@@ -1558,6 +1948,12 @@ static long get_kerning(FT_Face face, FT_UInt left_glyph, FT_UInt right_glyph)
   FT_UInt left_glyph_index, right_glyph_index;
   FT_Vector delta;
   FT_Error error;
+  ft_cache_key_t key;
+  ft_cache_entry_t *entry;
+
+  ft_cache_init_key(&key, GKS_K_FT_CACHE_KERNING, face, left_glyph, right_glyph);
+  key.flags = FT_CACHE_KERNING_UNSCALED;
+  if ((entry = ft_cache_lookup(&key)) != NULL) return entry->advance.x;
 
   left_glyph_index = FT_Get_Char_Index(face, left_glyph);
   right_glyph_index = FT_Get_Char_Index(face, right_glyph);
@@ -1568,6 +1964,10 @@ static long get_kerning(FT_Face face, FT_UInt left_glyph, FT_UInt right_glyph)
       delta.x = 0;
     }
 
+  entry = ft_cache_new(&key);
+  entry->advance.x = delta.x;
+  ft_cache_add(entry, 0);
+
   return delta.x;
 }
 
@@ -1577,9 +1977,15 @@ static double get_capheight(FT_Face face)
   FT_BBox bbox;
   FT_Error error;
   long capheight;
+  ft_cache_key_t key;
+  ft_cache_entry_t *entry;
 
   if (!init) gks_ft_init();
 
+  ft_cache_init_key(&key, GKS_K_FT_CACHE_METRICS, face, 0, 0);
+  key.flags = FT_CACHE_CAPHEIGHT;
+  if ((entry = ft_cache_lookup(&key)) != NULL) return entry->values[0];
+
   pclt = FT_Get_Sfnt_Table(face, ft_sfnt_pclt);
   if (pclt == NULL)
     {
@@ -1598,6 +2004,10 @@ static double get_capheight(FT_Face face)
   else
     capheight = pclt->CapHeight;
 
+  entry = ft_cache_new(&key);
+  entry->values[0] = capheight;
+  ft_cache_add(entry, 0);
+
   return capheight;
 }
 
@@ -1610,6 +2020,7 @@ static void process_glyphs(FT_Face face, double x, double y, char *text, double
   double xj, yj, cos_f, sin_f, shear_x, shear_y;
   double chh, height, theta;
   int alh;
+  ft_cache_entry_t *glyph;
 
   if (!init) gks_ft_init();
 
@@ -1628,12 +2039,12 @@ static void process_glyphs(FT_Face face, double x, double y, char *text, double
 
   for (i = 0; i < length; i++)
     {
-      load_glyph(face, unicode_string[i]);
-
+      /* the kerning is looked up first, adding it to the cache could evict the outline */
       if (i > 0 && FT_HAS_KERNING(face) && !FT_IS_FIXED_WIDTH(face))
         pen_x += get_kerning(face, unicode_string[i - 1], unicode_string[i]);
 
-      get_outline(face, unicode_string[i], i == 0, i == length - 1);
+      glyph = load_outline(face, unicode_string[i]);
+      get_outline(glyph, unicode_string[i], i == 0, i == length - 1);
 
       if (npoints > 0 && bBoxX == NULL && bBoxY == NULL)
         {
@@ -1763,6 +2174,7 @@ static void process_glyphs3d(FT_Face face, double x, double y, double z, char *t
   unsigned int i, j;
   double xj, yj, zj, cos_f, sin_f, shear_x, shear_y;
   double chh, height, theta;
+  ft_cache_entry_t *glyph;
 
   if (!init) gks_ft_init();
 
@@ -1780,12 +2192,12 @@ static void process_glyphs3d(FT_Face face, double x, double y, double z, char *t
 
   for (i = 0; i < length; i++)
     {
-      load_glyph(face, unicode_string[i]);
-
+      /* the kerning is looked up first, adding it to the cache could evict the outline */
       if (i > 0 && FT_HAS_KERNING(face) && !FT_IS_FIXED_WIDTH(face))
         pen_x += get_kerning(face, unicode_string[i - 1], unicode_string[i]);
 
-      get_outline(face, unicode_string[i], i == 0, i == length - 1);
+      glyph = load_outline(face, unicode_string[i]);
+      get_outline(glyph, unicode_string[i], i == 0, i == length - 1);
 
       if (npoints > 0 && bBoxX == NULL && bBoxY == NULL)
         {
@@ -1991,6 +2403,21 @@ int *gks_ft_render(int *x, int *y, int *width, int *height, gks_state_list_t *gk
 
 void gks_ft_terminate(void) {}
 
+void gks_ft_inq_cache_stats(long *hits, long *misses, int *entries, long *nbytes)
+{
+  int i;
+
+  for (i = 0; i < GKS_K_FT_CACHE_KINDS; i++)
+    {
+      if (hits) hits[i] = 0;
+      if (misses) misses[i] = 0;
+    }
+  if (entries) *entries = 0;
+  if (nbytes) *nbytes = 0;
+}
+
+void gks_ft_reset_cache_stats(void) {}
+
 void gks_ft_text(double x, double y, char *text, gks_state_list_t *gkss,
                  void (*gdp)(int, double *, double *, int, int, int *))
 {
@@ -126,6 +126,232 @@ static double *x = NULL, *y = NULL;
 
 static int max_points = 0;
 
+#ifndef EMSCRIPTEN
+
+static void gks_drv_null(int fctid, int dx, int dy, int dimx, int *i_arr, int len_f_arr_1, double *f_arr_1,
+                         int len_f_arr_2, double *f_arr_2, int len_c_arr, char *c_arr, void **ptr)
+{
+}
+
+static void gks_drv_unknown(int fctid, int dx, int dy, int dimx, int *i_arr, int len_f_arr_1, double *f_arr_1,
+                            int len_f_arr_2, double *f_arr_2, int len_c_arr, char *c_arr, void **ptr)
+{
+  printf("GKS: %s\n", gks_function_name(fctid));
+}
+
+#endif
+
+static gks_driver_t gks_ws_driver(int wtype)
+{
+#ifndef EMSCRIPTEN
+  switch (wtype)
+    {
+    case 2:
+      return gks_drv_mo;
+
+    case 3:
+      return gks_drv_mi;
+
+    case 5:
+      return gks_drv_wiss;
+
+    case 41:
+      return gks_drv_win;
+
+    case 61:
+    case 62:
+    case 63:
+    case 64:
+      return gks_drv_ps;
+
+    case 100:
+      return gks_drv_null;
+
+    case 101:
+    case 102:
+      return gks_drv_pdf;
+
+    case 210:
+    case 211:
+    case 212:
+    case 213:
+    case 214:
+    case 215:
+    case 216:
+    case 217:
+    case 218:
+      return gks_x11_plugin;
+
+    case 410:
+    case 411:
+    case 412:
+    case 413:
+      return gks_drv_socket;
+
+    case 415:
+      return gks_zmq_plugin;
+
+    case 301:
+      return gks_drv_plugin;
+
+    case 320:
+    case 321:
+    case 322:
+    case 323:
+      return gks_gs_plugin;
+
+    case 371:
+      return gks_gtk_plugin;
+
+    case 380:
+      return gks_wx_plugin;
+
+    case 381:
+      return gks_qt_plugin;
+
+    case 382:
+      return gks_svg_plugin;
+
+    case 390:
+      return gks_wmf_plugin;
+
+    case 400:
+      return gks_quartz_plugin;
+
+    case 420:
+      return gks_gl_plugin;
+
+    case 140:
+    case 141:
+    case 142:
+    case 143:
+    case 144:
+    case 145:
+    case 146:
+    case 150:
+    case 151:
+      return gks_cairo_plugin;
+
+    case 120:
+    case 121:
+    case 130:
+    case 131:
+    case 160:
+    case 161:
+    case 162:
+      return gks_video_plugin;
+
+    case 170:
+    case 171:
+    case 172:
+    case 173:
+      return gks_agg_plugin;
+
+    case 314:
+      return gks_pgf_plugin;
+
+    default:
+      return gks_drv_unknown;
+    }
+#else
+  return gks_drv_js;
+#endif
+}
+
+/*
+ * Attributes which are cached per workstation. A setting is only passed to the
+ * driver if it differs from the last value sent to that workstation, so that
+ * repeated attribute calls in tight drawing loops don't reach the drivers.
+ */
+
+static int gks_attribute_slot(int fctid)
+{
+  switch (fctid)
+    {
+    case SET_PLINE_INDEX:
+    case SET_PLINE_LINETYPE:
+    case SET_PLINE_LINEWIDTH:
+    case SET_PLINE_COLOR_INDEX:
+    case SET_PMARK_INDEX:
+    case SET_PMARK_TYPE:
+    case SET_PMARK_SIZE:
+    case SET_PMARK_COLOR_INDEX:
+    case SET_TEXT_INDEX:
+    case SET_TEXT_FONTPREC:
+    case SET_TEXT_EXPFAC:
+    case SET_TEXT_SPACING:
+    case SET_TEXT_COLOR_INDEX:
+    case SET_TEXT_HEIGHT:
+    case SET_TEXT_UPVEC:
+    case SET_TEXT_PATH:
+    case SET_TEXT_ALIGN:
+    case SET_FILL_INDEX:
+    case SET_FILL_INT_STYLE:
+    case SET_FILL_STYLE_INDEX:
+    case SET_FILL_COLOR_INDEX:
+      return fctid - SET_PLINE_INDEX;
+    case SET_WINDOW:
+      return 21;
+    case SET_VIEWPORT:
+      return 22;
+    case SELECT_XFORM:
+      return 23;
+    case SET_CLIPPING:
+      return 24;
+    case SET_RESAMPLE_METHOD:
+      return 25;
+    case SET_TEXT_SLANT:
+      return 26;
+    case SET_SHADOW:
+      return 27;
+    case SET_TRANSPARENCY:
+      return 28;
+    case SET_BORDER_WIDTH:
+      return 29;
+    case SET_BORDER_COLOR_INDEX:
+      return 30;
+    default:
+      return -1;
+    }
+}
+
+static int gks_redundant_attribute(ws_list_t *ws, int fctid, int n, int *i_arr, int len_f_arr_1, double *f_arr_1,
+                                   int len_f_arr_2, double *f_arr_2)
+{
+  double *cached;
+  int slot, i, changed;
+
+  /* segment storage must record every attribute change */
+  if (ws->wtype == 5) return 0;
+
+  slot = gks_attribute_slot(fctid);
+  if (slot < 0 || n + len_f_arr_1 + len_f_arr_2 > MAX_ATTRIBUTE_VALUES) return 0;
+
+  cached = ws->attributes[slot];
+  changed = (ws->attributes_set & (1U << slot)) == 0;
+  for (i = 0; i < n; i++, cached++)
+    if (changed || *cached != i_arr[i])
+      {
+        *cached = i_arr[i];
+        changed = 1;
+      }
+  for (i = 0; i < len_f_arr_1; i++, cached++)
+    if (changed || *cached != f_arr_1[i])
+      {
+        *cached = f_arr_1[i];
+        changed = 1;
+      }
+  for (i = 0; i < len_f_arr_2; i++, cached++)
+    if (changed || *cached != f_arr_2[i])
+      {
+        *cached = f_arr_2[i];
+        changed = 1;
+      }
+  ws->attributes_set |= 1U << slot;
+
+  return !changed;
+}
+
 static void gks_ddlk(int fctid, int dx, int dy, int dimx, int *i_arr, int len_f_arr_1, double *f_arr_1, int len_f_arr_2,
                      double *f_arr_2, int len_c_arr, char *c_arr, void **ptr)
 {
@@ -178,173 +404,145 @@ static void gks_ddlk(int fctid, int dx, int dy, int dimx, int *i_arr, int len_f_
                   continue;
                 }
             }
+          if (fctid == CLEAR_WS)
+            ws->attributes_set = 0; /* drivers may start a new page with default settings */
+          else if (!have_id && gks_redundant_attribute(ws, fctid, dx * dy, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2,
+                                                       f_arr_2))
+            {
+              list = list->next;
+              continue;
+            }
           ptr = &ws->ptr;
 
 #ifndef EMSCRIPTEN
           if (s->debug)
             fprintf(stdout, "[DEBUG:GKS] dispatch %s function to %s driver (wtype: %d)\n", gks_function_name(fctid),
                     ws->name, ws->wtype);
-
-          switch (ws->wtype)
-            {
-            case 2:
-              gks_drv_mo(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr, ptr);
-              break;
-
-            case 3:
-              gks_drv_mi(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr, ptr);
-              break;
-
-            case 5:
-              gks_drv_wiss(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                           ptr);
-              break;
-
-            case 41:
-              gks_drv_win(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                          ptr);
-              break;
-
-            case 61:
-            case 62:
-            case 63:
-            case 64:
-              gks_drv_ps(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr, ptr);
-              break;
-
-            case 100:
-              break;
-
-            case 101:
-            case 102:
-              gks_drv_pdf(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                          ptr);
-              break;
-
-            case 210:
-            case 211:
-            case 212:
-            case 213:
-            case 214:
-            case 215:
-            case 216:
-            case 217:
-            case 218:
-              gks_x11_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                             ptr);
-              break;
-
-            case 410:
-            case 411:
-            case 412:
-            case 413:
-              gks_drv_socket(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                             ptr);
-              break;
-
-            case 415:
-              gks_zmq_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                             ptr);
-              break;
-
-            case 301:
-              gks_drv_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                             ptr);
-              break;
-
-            case 320:
-            case 321:
-            case 322:
-            case 323:
-              gks_gs_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                            ptr);
-              break;
-
-            case 371:
-              gks_gtk_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                             ptr);
-              break;
-
-            case 380:
-              gks_wx_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                            ptr);
-              break;
-
-            case 381:
-              gks_qt_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                            ptr);
-              break;
-
-            case 382:
-              gks_svg_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                             ptr);
-              break;
-
-            case 390:
-              gks_wmf_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                             ptr);
-              break;
-
-            case 400:
-              gks_quartz_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr,
-                                c_arr, ptr);
-              break;
-
-            case 420:
-              gks_gl_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                            ptr);
-              break;
-
-            case 140:
-            case 141:
-            case 142:
-            case 143:
-            case 144:
-            case 145:
-            case 146:
-            case 150:
-            case 151:
-              gks_cairo_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                               ptr);
-              break;
-
-            case 120:
-            case 121:
-            case 130:
-            case 131:
-            case 160:
-            case 161:
-            case 162:
-              gks_video_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                               ptr);
-              break;
-
-            case 170:
-            case 171:
-            case 172:
-            case 173:
-              gks_agg_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                             ptr);
-              break;
-
-            case 314:
-              gks_pgf_plugin(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr,
-                             ptr);
-              break;
-
-            default:
-              printf("GKS: %s\n", gks_function_name(fctid));
-              break;
-            }
-#else
-          gks_drv_js(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr, ptr);
 #endif
+          ws->driver(fctid, dx, dy, dimx, i_arr, len_f_arr_1, f_arr_1, len_f_arr_2, f_arr_2, len_c_arr, c_arr, ptr);
         }
       list = list->next;
     }
   api = 1;
 }
 
+static void gks_send_int_attribute(int fctid, int n, int *values)
+{
+  int i;
+
+  for (i = 0; i < n; i++) i_arr[i] = values[i];
+
+  /* call the device driver link routine */
+  gks_ddlk(fctid, n, 1, n, i_arr, 0, f_arr_1, 0, f_arr_2, 0, c_arr, NULL);
+}
+
+static void gks_send_double_attribute(int fctid, int n1, double *values1, int n2, double *values2)
+{
+  int i;
+
+  for (i = 0; i < n1; i++) f_arr_1[i] = values1[i];
+  for (i = 0; i < n2; i++) f_arr_2[i] = values2[i];
+
+  /* call the device driver link routine */
+  gks_ddlk(fctid, 0, 0, 0, i_arr, n1, f_arr_1, n2, f_arr_2, 0, c_arr, NULL);
+}
+
+static void gks_send_rect_attribute(int fctid, int tnr, double *rect)
+{
+  i_arr[0] = tnr;
+  f_arr_1[0] = rect[0];
+  f_arr_1[1] = rect[1];
+  f_arr_2[0] = rect[2];
+  f_arr_2[1] = rect[3];
+
+  /* call the device driver link routine */
+  gks_ddlk(fctid, 1, 1, 1, i_arr, 2, f_arr_1, 2, f_arr_2, 0, c_arr, NULL);
+}
+
+/*
+ * Replace the GKS state by the given state list (e.g. the state at segment
+ * creation) and pass every changed attribute to the drivers. Drivers which
+ * keep their own copy of the attributes (display lists, the Qt and socket
+ * drivers) would otherwise miss the restored values, because the attribute
+ * routines skip values which equal the current state. The caller selects the
+ * receiving workstations through `id`.
+ */
+
+void gks_restore_state(gks_state_list_t *sl)
+{
+  gks_state_list_t prev;
+  int tnr, i, values[2];
+  double shadow[3];
+
+  if (sl == s) return;
+
+  memmove(&prev, s, sizeof(gks_state_list_t));
+  memmove(s, sl, sizeof(gks_state_list_t));
+
+  if ((s->txprec == GKS_K_TEXT_PRECISION_STROKE || s->txprec == GKS_K_TEXT_PRECISION_CHAR) && fontfile == 0)
+    fontfile = gks_open_font();
+
+  if (s->lindex != prev.lindex) gks_send_int_attribute(SET_PLINE_INDEX, 1, &s->lindex);
+  if (s->ltype != prev.ltype) gks_send_int_attribute(SET_PLINE_LINETYPE, 1, &s->ltype);
+  if (s->lwidth != prev.lwidth) gks_send_double_attribute(SET_PLINE_LINEWIDTH, 1, &s->lwidth, 0, NULL);
+  if (s->plcoli != prev.plcoli) gks_send_int_attribute(SET_PLINE_COLOR_INDEX, 1, &s->plcoli);
+  if (s->mindex != prev.mindex) gks_send_int_attribute(SET_PMARK_INDEX, 1, &s->mindex);
+  if (s->mtype != prev.mtype) gks_send_int_attribute(SET_PMARK_TYPE, 1, &s->mtype);
+  if (s->mszsc != prev.mszsc) gks_send_double_attribute(SET_PMARK_SIZE, 1, &s->mszsc, 0, NULL);
+  if (s->pmcoli != prev.pmcoli) gks_send_int_attribute(SET_PMARK_COLOR_INDEX, 1, &s->pmcoli);
+  if (s->tindex != prev.tindex) gks_send_int_attribute(SET_TEXT_INDEX, 1, &s->tindex);
+  if (s->txfont != prev.txfont || s->txprec != prev.txprec)
+    {
+      values[0] = s->txfont;
+      values[1] = s->txprec;
+      gks_send_int_attribute(SET_TEXT_FONTPREC, 2, values);
+    }
+  if (s->chxp != prev.chxp) gks_send_double_attribute(SET_TEXT_EXPFAC, 1, &s->chxp, 0, NULL);
+  if (s->chsp != prev.chsp) gks_send_double_attribute(SET_TEXT_SPACING, 1, &s->chsp, 0, NULL);
+  if (s->txcoli != prev.txcoli) gks_send_int_attribute(SET_TEXT_COLOR_INDEX, 1, &s->txcoli);
+  if (s->chh != prev.chh) gks_send_double_attribute(SET_TEXT_HEIGHT, 1, &s->chh, 0, NULL);
+  if (s->chup[0] != prev.chup[0] || s->chup[1] != prev.chup[1])
+    gks_send_double_attribute(SET_TEXT_UPVEC, 1, &s->chup[0], 1, &s->chup[1]);
+  if (s->txp != prev.txp) gks_send_int_attribute(SET_TEXT_PATH, 1, &s->txp);
+  if (s->txal[0] != prev.txal[0] || s->txal[1] != prev.txal[1]) gks_send_int_attribute(SET_TEXT_ALIGN, 2, s->txal);
+  if (s->findex != prev.findex) gks_send_int_attribute(SET_FILL_INDEX, 1, &s->findex);
+  if (s->ints != prev.ints) gks_send_int_attribute(SET_FILL_INT_STYLE, 1, &s->ints);
+  if (s->styli != prev.styli) gks_send_int_attribute(SET_FILL_STYLE_INDEX, 1, &s->styli);
+  if (s->facoli != prev.facoli) gks_send_int_attribute(SET_FILL_COLOR_INDEX, 1, &s->facoli);
+
+  for (i = 0; i < 13; i++)
+    if (s->asf[i] != prev.asf[i]) break;
+  if (i < 13) gks_send_int_attribute(SET_ASF, 13, s->asf);
+
+  for (tnr = 1; tnr < MAX_TNR; tnr++)
+    {
+      if (memcmp(s->window[tnr], prev.window[tnr], sizeof(s->window[tnr])) != 0)
+        gks_send_rect_attribute(SET_WINDOW, tnr, s->window[tnr]);
+      if (memcmp(s->viewport[tnr], prev.viewport[tnr], sizeof(s->viewport[tnr])) != 0)
+        gks_send_rect_attribute(SET_VIEWPORT, tnr, s->viewport[tnr]);
+    }
+  if (s->cntnr != prev.cntnr) gks_send_int_attribute(SELECT_XFORM, 1, &s->cntnr);
+  if (s->clip != prev.clip) gks_send_int_attribute(SET_CLIPPING, 1, &s->clip);
+  if (s->clip_tnr != prev.clip_tnr) gks_send_int_attribute(SELECT_CLIP_XFORM, 1, &s->clip_tnr);
+
+  if (s->resample_method != prev.resample_method)
+    {
+      values[0] = (int)s->resample_method;
+      gks_send_int_attribute(SET_RESAMPLE_METHOD, 1, values);
+    }
+  if (s->txslant != prev.txslant) gks_send_double_attribute(SET_TEXT_SLANT, 1, &s->txslant, 0, NULL);
+  if (s->shoff[0] != prev.shoff[0] || s->shoff[1] != prev.shoff[1] || s->blur != prev.blur)
+    {
+      shadow[0] = s->shoff[0];
+      shadow[1] = s->shoff[1];
+      shadow[2] = s->blur;
+      gks_send_double_attribute(SET_SHADOW, 3, shadow, 0, NULL);
+    }
+  if (s->alpha != prev.alpha) gks_send_double_attribute(SET_TRANSPARENCY, 1, &s->alpha, 0, NULL);
+  if (s->bwidth != prev.bwidth) gks_send_double_attribute(SET_BORDER_WIDTH, 1, &s->bwidth, 0, NULL);
+  if (s->bcoli != prev.bcoli) gks_send_int_attribute(SET_BORDER_COLOR_INDEX, 1, &s->bcoli);
+}
+
 static int gks_parse_encoding(const char *encoding)
 {
   unsigned int i, j;
@@ -694,6 +892,7 @@ void gks_open_ws(int wkid, char *path, int wtype)
                         ws->path = gks_strdup(path);
 
                       ws->wtype = wtype;
+                      ws->driver = gks_ws_driver(wtype);
                       ws->conid = 0;
                       ws->name = descr->name;
 
@@ -1036,19 +1235,19 @@ void gks_redraw_seg_on_ws(int wkid)
             {
               if (gks_list_find(active_ws, wkid) != NULL)
                 {
-                  /* save GKS state, restore segment state */
-                  memmove(&sl, s, sizeof(gks_state_list_t));
-                  memmove(s, seg_state, sizeof(gks_state_list_t));
-
                   id = wkid;
 
+                  /* save GKS state, restore segment state (on the selected workstation) */
+                  memmove(&sl, s, sizeof(gks_state_list_t));
+                  gks_restore_state(seg_state);
+
                   /* call the WISS dispatch routine */
                   gks_wiss_dispatch(REDRAW_SEG_ON_WS, wkid, 0);
 
-                  id = 0;
-
                   /* restore GKS state */
-                  memmove(s, &sl, sizeof(gks_state_list_t));
+                  gks_restore_state(&sl);
+
+                  id = 0;
                 }
               else
                 /* specified workstation is not active */
@@ -2147,7 +2346,7 @@ void gks_create_seg(int segn)
       state = GKS_K_SGOP;
 
       /* save segment state */
-      seg_state = (gks_state_list_t *)gks_malloc(sizeof(gks_state_list_t));
+      if (seg_state == NULL) seg_state = (gks_state_list_t *)gks_malloc(sizeof(gks_state_list_t));
       memmove(seg_state, s, sizeof(gks_state_list_t));
     }
   else
@@ -2197,19 +2396,19 @@ void gks_assoc_seg_with_ws(int wkid, int segn)
             {
               if (gks_list_find(active_ws, wkid) != NULL)
                 {
-                  /* save GKS state, restore segment state */
-                  memmove(&sl, s, sizeof(gks_state_list_t));
-                  memmove(s, seg_state, sizeof(gks_state_list_t));
-
                   id = wkid;
 
+                  /* save GKS state, restore segment state (on the selected workstation) */
+                  memmove(&sl, s, sizeof(gks_state_list_t));
+                  gks_restore_state(seg_state);
+
                   /* call the WISS dispatch routine */
                   gks_wiss_dispatch(ASSOC_SEG_WITH_WS, wkid, segn);
 
-                  id = 0;
-
                   /* restore GKS state */
-                  memmove(s, &sl, sizeof(gks_state_list_t));
+                  gks_restore_state(&sl);
+
+                  id = 0;
                 }
               else
                 /* specified workstation is not active */
@@ -2241,19 +2440,19 @@ void gks_copy_seg_to_ws(int wkid, int segn)
             {
               if (gks_list_find(active_ws, wkid) != NULL)
                 {
-                  /* save GKS state, restore segment state */
-                  memmove(&sl, s, sizeof(gks_state_list_t));
-                  memmove(s, seg_state, sizeof(gks_state_list_t));
-
                   id = wkid;
 
+                  /* save GKS state, restore segment state (on the selected workstation) */
+                  memmove(&sl, s, sizeof(gks_state_list_t));
+                  gks_restore_state(seg_state);
+
                   /* call the WISS dispatch routine */
                   gks_wiss_dispatch(COPY_SEG_TO_WS, wkid, segn);
 
-                  id = 0;
-
                   /* restore GKS state */
-                  memmove(s, &sl, sizeof(gks_state_list_t));
+                  gks_restore_state(&sl);
+
+                  id = 0;
                 }
               else
                 /* specified workstation is not active */
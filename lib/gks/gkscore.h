@@ -179,6 +179,12 @@ typedef struct gks_list
   void *ptr;
 } gks_list_t;
 
+#define MAX_CACHED_ATTRIBUTES 32
+#define MAX_ATTRIBUTE_VALUES 5
+
+typedef void (*gks_driver_t)(int fctid, int dx, int dy, int dimx, int *i_arr, int len_f_arr_1, double *f_arr_1,
+                             int len_f_arr_2, double *f_arr_2, int len_c_arr, char *c_arr, void **ptr);
+
 typedef struct
 {
   int wkid;
@@ -188,6 +194,9 @@ typedef struct
   void *ptr;
   double vp[4];
   char *name;
+  gks_driver_t driver;
+  unsigned int attributes_set;
+  double attributes[MAX_CACHED_ATTRIBUTES][MAX_ATTRIBUTE_VALUES];
 } ws_list_t;
 
 typedef struct
@@ -233,6 +242,25 @@ typedef struct
   int status;
 } gks_locator_t;
 
+/* device coordinates of a point array; the buffers are reused and only grow */
+typedef struct
+{
+  double *x, *y;
+  int size;
+} gks_dc_points_t;
+
+/* header of the shared memory ring buffer used to pass display lists to a local gksqt */
+typedef struct
+{
+  unsigned int magic;
+  unsigned int size;          /* capacity of the data area following the header */
+  volatile unsigned int head; /* number of bytes written by the client */
+  volatile unsigned int tail; /* number of bytes consumed by the viewer */
+  char reserved[48];
+} gks_shm_ring_t;
+
+#define GKS_SHM_RING_MAGIC 0x52534b47
+
 int gks_open_font(void);
 void gks_lookup_font(int fd, int version, int font, int chr, stroke_data_t *buffer);
 void gks_close_font(int fd);
@@ -269,6 +297,10 @@ void gks_set_xform_matrix(double tran[3][2]);
 void gks_seg_xform(double *x, double *y);
 void gks_WC_to_NDC(int tnr, double *x, double *y);
 void gks_NDC_to_WC(int tnr, double *x, double *y);
+void gks_WC_to_DC(int n, double *px, double *py, int tnr, double a, double b, double c, double d, double *x,
+                  double *y);
+void gks_points_to_DC(gks_dc_points_t *dc, int n, double *px, double *py, int tnr, double a, double b, double c,
+                      double d);
 void gks_set_dev_xform(gks_state_list_t *s, double *window, double *viewport);
 void gks_inq_dev_xform(double *window, double *viewport);
 void gks_set_chr_xform(void);
@@ -277,6 +309,7 @@ void gks_get_dash(int ltype, double scale, char *dash);
 void gks_get_dash_list(int ltype, double scale, int list[10]);
 void gks_move(double x, double y, void (*move)(double x, double y));
 void gks_dash(double x, double y, void (*move)(double x, double y), void (*draw)(double x, double y));
+int gks_clip_runs(int n, double *x, double *y, double *clrt, int *runs);
 void gks_emul_polyline(int n, double *px, double *py, int ltype, int tnr, void (*move)(double x, double y),
                        void (*draw)(double x, double y));
 void gks_emul_polymarker(int n, double *px, double *py, void (*marker)(double x, double y, int mtype));
@@ -305,6 +338,7 @@ DLLEXPORT int gks_dl_read_item(char *dl, gks_state_list_t **gkss,
                                void (*fn)(int fctid, int dx, int dy, int dimx, int *ia, int lr1, double *r1, int lr2,
                                           double *r2, int lc, char *chars, void **ptr));
 void gks_wiss_dispatch(int fctid, int wkid, int segn);
+void gks_restore_state(gks_state_list_t *sl);
 int gks_debug(void);
 
 #ifndef EMSCRIPTEN
@@ -416,6 +450,15 @@ DLLEXPORT void gks_ft_set_bearing_x_direction(int);
 DLLEXPORT void gks_ft_inq_bearing_x_direction(int *);
 DLLEXPORT int gks_ft_load_user_font(char *font, int ignore_file_not_found);
 
+#define GKS_K_FT_CACHE_OUTLINE 0
+#define GKS_K_FT_CACHE_KERNING 1
+#define GKS_K_FT_CACHE_BITMAP 2
+#define GKS_K_FT_CACHE_METRICS 3
+#define GKS_K_FT_CACHE_KINDS 4
+
+DLLEXPORT void gks_ft_inq_cache_stats(long *hits, long *misses, int *entries, long *nbytes);
+DLLEXPORT void gks_ft_reset_cache_stats(void);
+
 DLLEXPORT void gks_set_encoding(int encoding);
 DLLEXPORT void gks_inq_encoding(int *encoding);
 
@@ -1,20 +1,56 @@
 
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200112L
+#endif
+
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
+#include <float.h>
 
 #if !defined(VMS) && !defined(_WIN32)
 #include <unistd.h>
+#include <sys/mman.h>
+#define HAVE_MMAP
 #endif
 
 #include <sys/types.h>
 #include <sys/stat.h>
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 #include "gkscore.h"
 #include "gks.h"
 
 #define SEGM_SIZE 262144 /* 256K */
 
+/*
+ * Version 2 metafiles start with a header (magic, version, flags) followed by
+ * chunks, one for each metafile update. A chunk consists of the size of the
+ * encoded items, the number of stored (possibly deflated) bytes and the data.
+ * Items are stored like in version 1 files, but text items are not padded and
+ * coordinate arrays can be stored as single precision deltas. The file ends
+ * with an index of the chunks which start a new page and a trailer containing
+ * the offset of that index.
+ */
+
+#define MF_MAGIC "GKSM"
+#define MF_INDEX_MAGIC "GKSI"
+#define MF_VERSION 2
+#define MF_HEADER_SIZE (4 + 3 * (int)sizeof(int))
+#define MF_TRAILER_SIZE (4 + (int)sizeof(int))
+
+#define MF_DEFLATE 1
+#define MF_SINGLE_PRECISION 2
+
+#define MF_DOUBLE_COORDS 0
+#define MF_DELTA_COORDS 1
+
+#define MF_INDEX_MARK -1
+
 #define COPY(s, n)                              \
   memmove(p->buffer + p->nbytes, (void *)s, n); \
   p->nbytes += n
@@ -22,6 +58,10 @@
   memset(p->buffer + p->nbytes, 0, n); \
   p->nbytes += n
 
+#define STORE(d, s, n) \
+  memcpy(d, s, n);      \
+  d += n
+
 #define RESOLVE(arg, type, nbytes) \
   arg = (type *)(s + sp);          \
   sp += nbytes
@@ -36,6 +76,9 @@ typedef struct ws_state_list_struct
   int empty;
   char *buffer;
   int size, nbytes, position;
+  int version, flags, offset;
+  int *pages, npages;
+  int mapped, length;
 } ws_state_list;
 
 static ws_state_list *p;
@@ -45,7 +88,7 @@ static int unused_variable = 0;
 
 static void reallocate(int len)
 {
-  while (p->nbytes + len > p->size) p->size += SEGM_SIZE;
+  while (p->nbytes + len > p->size) p->size *= 2;
 
   p->buffer = (char *)gks_realloc(p->buffer, p->size + 1);
   if (p->buffer == NULL)
@@ -247,6 +290,191 @@ static void write_item(int fctid, int dx, int dy, int dimx, int *i_arr, int len_
     }
 }
 
+static void write_bytes(int fd, char *buffer, int nbytes)
+{
+  int offset = 0, bufsiz, cc;
+
+  while (offset < nbytes)
+    {
+      bufsiz = (nbytes - offset <= BUFSIZ) ? nbytes - offset : BUFSIZ;
+      if ((cc = gks_write_file(fd, buffer + offset, bufsiz)) <= 0)
+        {
+          gks_perror("can't write GKSM metafile");
+          perror("write");
+          break;
+        }
+      offset += cc;
+    }
+  p->offset += offset;
+}
+
+static int is_delta_encodable(int n, double *x)
+{
+  int i;
+
+  if (n < 1) return 0;
+  for (i = 0; i < n; i++)
+    {
+      /* NaN and infinite values are stored as doubles */
+      if (!(x[i] - x[i] == 0)) return 0;
+      if (i > 0 && fabs(x[i] - x[i - 1]) > FLT_MAX / 2) return 0;
+    }
+
+  return 1;
+}
+
+static char *encode_coords(char *d, int n, double *x, int encoding)
+{
+  double xr;
+  float delta;
+  int i;
+
+  if (encoding == MF_DOUBLE_COORDS)
+    {
+      STORE(d, x, n * sizeof(double));
+      return d;
+    }
+
+  /* deltas are taken from the reconstructed values, so rounding errors don't accumulate */
+  xr = x[0];
+  STORE(d, &xr, sizeof(double));
+  for (i = 1; i < n; i++)
+    {
+      delta = (float)(x[i] - xr);
+      xr += delta;
+      STORE(d, &delta, sizeof(float));
+    }
+
+  return d;
+}
+
+static int encode_items(char *s, int nbytes, char *data)
+{
+  char *d = data, *item;
+  int sp = 0, len, fctid, n, ldr, slen, nchars, encoding;
+  double *x, *y;
+
+  while (sp < nbytes)
+    {
+      len = *(int *)(s + sp);
+      fctid = *(int *)(s + sp + sizeof(int));
+      item = d;
+
+      switch (fctid)
+        {
+        case 12: /* polyline */
+        case 13: /* polymarker */
+        case 15: /* fill area */
+        case 17: /* GDP */
+
+          n = *(int *)(s + sp + 2 * sizeof(int));
+          ldr = fctid == 17 ? 3 + *(int *)(s + sp + 4 * sizeof(int)) : 1;
+          x = (double *)(s + sp + (2 + ldr) * sizeof(int));
+          y = x + n;
+          encoding = (p->flags & MF_SINGLE_PRECISION) && is_delta_encodable(n, x) && is_delta_encodable(n, y)
+                         ? MF_DELTA_COORDS
+                         : MF_DOUBLE_COORDS;
+
+          d += sizeof(int);
+          STORE(d, &fctid, sizeof(int));
+          STORE(d, &encoding, sizeof(int));
+          STORE(d, s + sp + 2 * sizeof(int), ldr * sizeof(int));
+          d = encode_coords(d, n, x, encoding);
+          d = encode_coords(d, n, y, encoding);
+          break;
+
+        case 14: /* text */
+
+          slen = *(int *)(s + sp + 2 * sizeof(int) + 2 * sizeof(double));
+          nchars = slen < GKS_K_TEXT_MAX_SIZE ? slen : GKS_K_TEXT_MAX_SIZE;
+
+          d += sizeof(int);
+          STORE(d, s + sp + sizeof(int), sizeof(int) + 2 * sizeof(double) + sizeof(int));
+          STORE(d, s + sp + 3 * sizeof(int) + 2 * sizeof(double), nchars);
+          n = (sizeof(int) - nchars % sizeof(int)) % sizeof(int);
+          memset(d, 0, n);
+          d += n;
+          break;
+
+        default:
+
+          STORE(d, s + sp, len);
+        }
+
+      n = d - item;
+      memcpy(item, &n, sizeof(int));
+      sp += len;
+    }
+
+  return d - data;
+}
+
+static void write_chunk(int fd, char *buffer, int nbytes)
+{
+  char *data, *stored;
+  int chunk[2];
+#ifdef HAVE_ZLIB
+  uLongf size;
+#endif
+
+  data = (char *)gks_malloc(2 * nbytes + 16);
+  chunk[0] = chunk[1] = encode_items(buffer, nbytes, data);
+  stored = data;
+
+#ifdef HAVE_ZLIB
+  if (p->flags & MF_DEFLATE)
+    {
+      size = compressBound(chunk[0]);
+      stored = (char *)gks_malloc(size);
+      if (compress2((Bytef *)stored, &size, (Bytef *)data, chunk[0], Z_DEFAULT_COMPRESSION) == Z_OK &&
+          (int)size < chunk[0])
+        chunk[1] = size;
+      else
+        {
+          /* chunks which are stored uncompressed have equal sizes */
+          free(stored);
+          stored = data;
+        }
+    }
+#endif
+
+  if (p->position == 0)
+    {
+      p->pages = (int *)gks_realloc(p->pages, (p->npages + 1) * sizeof(int));
+      p->pages[p->npages++] = p->offset;
+    }
+
+  write_bytes(fd, (char *)chunk, 2 * sizeof(int));
+  write_bytes(fd, stored, chunk[1]);
+
+  if (stored != data) free(stored);
+  free(data);
+}
+
+static void write_header(int fd)
+{
+  char header[MF_HEADER_SIZE];
+  int version = MF_VERSION, reserved = 0;
+
+  memcpy(header, MF_MAGIC, 4);
+  memcpy(header + 4, &version, sizeof(int));
+  memcpy(header + 4 + sizeof(int), &p->flags, sizeof(int));
+  memcpy(header + 4 + 2 * sizeof(int), &reserved, sizeof(int));
+
+  write_bytes(fd, header, MF_HEADER_SIZE);
+}
+
+static void write_index(int fd)
+{
+  int mark = MF_INDEX_MARK, offset = p->offset;
+
+  write_bytes(fd, (char *)&mark, sizeof(int));
+  write_bytes(fd, (char *)&p->npages, sizeof(int));
+  write_bytes(fd, (char *)p->pages, p->npages * sizeof(int));
+  write_bytes(fd, (char *)&offset, sizeof(int));
+  write_bytes(fd, MF_INDEX_MAGIC, 4);
+}
+
 static void write_gksm(int stream)
 {
   int fd, nbytes;
@@ -264,19 +492,10 @@ static void write_gksm(int stream)
 
   if (fd >= 0)
     {
-      int offset = 0, bufsiz, cc;
-
-      while (offset < nbytes)
-        {
-          bufsiz = (nbytes - offset <= BUFSIZ) ? nbytes - offset : BUFSIZ;
-          if ((cc = gks_write_file(fd, buffer + offset, bufsiz)) <= 0)
-            {
-              gks_perror("can't write GKSM metafile");
-              perror("write");
-              break;
-            }
-          offset += cc;
-        }
+      if (p->version == MF_VERSION)
+        write_chunk(fd, buffer, nbytes);
+      else
+        write_bytes(fd, buffer, nbytes);
     }
 }
 
@@ -284,6 +503,7 @@ void gks_drv_mo(int fctid, int dx, int dy, int dimx, int *i_arr, int len_farr_1,
                 double *f_arr_2, int len_c_arr, char *c_arr, void **ptr)
 {
   int gksm = 2;
+  const char *env;
   p = (ws_state_list *)*ptr;
 
   switch (fctid)
@@ -300,6 +520,19 @@ void gks_drv_mo(int fctid, int dx, int dy, int dimx, int *i_arr, int len_farr_1,
       p->size = SEGM_SIZE;
       p->nbytes = p->position = 0;
 
+      env = gks_getenv("GKS_MF_FORMAT");
+      p->version = env != NULL && atoi(env) == MF_VERSION ? MF_VERSION : 1;
+      if (p->version == MF_VERSION)
+        {
+#ifdef HAVE_ZLIB
+          p->flags |= MF_DEFLATE;
+#endif
+          env = gks_getenv("GKS_MF_PRECISION");
+          if (env != NULL && strcmp(env, "single") == 0) p->flags |= MF_SINGLE_PRECISION;
+
+          if (p->conid >= 0) write_header(p->conid > 100 ? p->conid - 100 : p->conid);
+        }
+
       gkss = (gks_state_list_t *)*ptr;
 
       *ptr = (void *)p;
@@ -308,8 +541,10 @@ void gks_drv_mo(int fctid, int dx, int dy, int dimx, int *i_arr, int len_farr_1,
     case 3: /* close workstation */
 
       if (p->position < p->nbytes && !p->empty) write_gksm(p->conid);
+      if (p->version == MF_VERSION && p->conid >= 0) write_index(p->conid > 100 ? p->conid - 100 : p->conid);
 
       free(p->buffer);
+      if (p->pages != NULL) free(p->pages);
       free(p);
 
       p = NULL;
@@ -415,11 +650,25 @@ static char *readfile(int fd)
     {
 
       fstat(fd, &buf);
+#ifdef HAVE_MMAP
+      if (S_ISREG(buf.st_mode) && buf.st_size > 0)
+        {
+          s = (char *)mmap(NULL, buf.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+          if (s != MAP_FAILED)
+            {
+              p->mapped = 1;
+              p->length = buf.st_size;
+              return s;
+            }
+          s = NULL;
+        }
+#endif
       size = (buf.st_size > 0) ? buf.st_size : 1000000;
       s = (char *)gks_malloc(size + 2 * sizeof(int));
 
       if ((cc = read(fd, s, size)) != -1) s[cc] = '\0';
       memset(s + cc, 0, 2 * sizeof(int));
+      p->length = cc > 0 ? cc : 0;
     }
   else
     gks_perror("invalid file descriptor (%d)", fd);
@@ -427,6 +676,219 @@ static char *readfile(int fd)
   return s;
 }
 
+static void release(char *s)
+{
+#ifdef HAVE_MMAP
+  if (p->mapped)
+    {
+      munmap(s, p->length);
+      p->mapped = 0;
+      return;
+    }
+#endif
+  free(s);
+}
+
+static char *decode_coords(char *s, int n, double *x, int encoding)
+{
+  double xr;
+  float delta;
+  int i;
+
+  if (encoding == MF_DOUBLE_COORDS)
+    {
+      memcpy(x, s, n * sizeof(double));
+      return s + n * sizeof(double);
+    }
+
+  memcpy(&xr, s, sizeof(double));
+  s += sizeof(double);
+  x[0] = xr;
+  for (i = 1; i < n; i++)
+    {
+      memcpy(&delta, s, sizeof(float));
+      s += sizeof(float);
+      xr += delta;
+      x[i] = xr;
+    }
+
+  return s;
+}
+
+static int decode_items(char *s, int nbytes)
+{
+  int sp = 0, len, fctid, encoding, n, ldr, slen, nchars;
+  int header[5];
+  char *src;
+
+  while (sp < nbytes)
+    {
+      memcpy(header, s + sp, 2 * sizeof(int));
+      len = header[0];
+      fctid = header[1];
+      if (len < 2 * (int)sizeof(int) || sp + len > nbytes)
+        {
+          gks_perror("metafile is corrupted (len=%d, fctid=%d)", len, fctid);
+          return -1;
+        }
+      src = s + sp + 2 * sizeof(int);
+
+      switch (fctid)
+        {
+        case 12: /* polyline */
+        case 13: /* polymarker */
+        case 15: /* fill area */
+        case 17: /* GDP */
+
+          memcpy(&encoding, src, sizeof(int));
+          memcpy(&n, src + sizeof(int), sizeof(int));
+          if (fctid == 17)
+            {
+              memcpy(&ldr, src + 3 * sizeof(int), sizeof(int));
+              ldr += 3;
+            }
+          else
+            ldr = 1;
+          src += sizeof(int);
+
+          len = (2 + ldr) * sizeof(int) + 2 * n * sizeof(double);
+          if (p->nbytes + len > p->size) reallocate(len);
+
+          COPY(&len, sizeof(int));
+          COPY(&fctid, sizeof(int));
+          COPY(src, ldr * sizeof(int));
+          src += ldr * sizeof(int);
+          src = decode_coords(src, n, (double *)(p->buffer + p->nbytes), encoding);
+          p->nbytes += n * sizeof(double);
+          src = decode_coords(src, n, (double *)(p->buffer + p->nbytes), encoding);
+          p->nbytes += n * sizeof(double);
+          break;
+
+        case 14: /* text */
+
+          memcpy(&slen, src + 2 * sizeof(double), sizeof(int));
+          nchars = slen < GKS_K_TEXT_MAX_SIZE ? slen : GKS_K_TEXT_MAX_SIZE;
+
+          len = 3 * sizeof(int) + 2 * sizeof(double) + GKS_K_TEXT_MAX_SIZE;
+          if (p->nbytes + len > p->size) reallocate(len);
+
+          COPY(&len, sizeof(int));
+          COPY(&fctid, sizeof(int));
+          COPY(src, 2 * sizeof(double) + sizeof(int));
+          memset(p->buffer + p->nbytes, 0, GKS_K_TEXT_MAX_SIZE);
+          memcpy(p->buffer + p->nbytes, src + 2 * sizeof(double) + sizeof(int), nchars);
+          p->nbytes += GKS_K_TEXT_MAX_SIZE;
+          break;
+
+        default:
+
+          if (p->nbytes + len > p->size) reallocate(len);
+          COPY(s + sp, len);
+        }
+
+      memcpy(&len, s + sp, sizeof(int));
+      sp += len;
+    }
+
+  return 0;
+}
+
+/*
+ * Expand the chunks of a version 2 metafile into an item buffer, which can be
+ * interpreted like a version 1 metafile. If GKS_MF_PAGE is set, the page index
+ * is used to only decode the chunks of the given page.
+ */
+static void decode_metafile(void)
+{
+  char *s = p->buffer;
+  int length = p->length, version, index = 0, npages, page, start, end, sp, chunk[2];
+  const char *env;
+#ifdef HAVE_ZLIB
+  char *data;
+  uLongf size;
+#endif
+
+  memcpy(&version, s + 4, sizeof(int));
+  if (version != MF_VERSION)
+    {
+      gks_perror("unsupported metafile version (%d)", version);
+      release(s);
+      p->buffer = NULL;
+      return;
+    }
+
+  start = MF_HEADER_SIZE;
+  end = length;
+  if (length >= MF_HEADER_SIZE + MF_TRAILER_SIZE && memcmp(s + length - 4, MF_INDEX_MAGIC, 4) == 0)
+    {
+      memcpy(&index, s + length - MF_TRAILER_SIZE, sizeof(int));
+      if (index >= start && index < length) end = index;
+    }
+
+  env = gks_getenv("GKS_MF_PAGE");
+  if (env != NULL && end == index)
+    {
+      page = atoi(env);
+      memcpy(&npages, s + index + sizeof(int), sizeof(int));
+      if (page >= 1 && page <= npages)
+        {
+          memcpy(&start, s + index + (1 + page) * sizeof(int), sizeof(int));
+          if (page < npages) memcpy(&end, s + index + (2 + page) * sizeof(int), sizeof(int));
+        }
+      else
+        {
+          gks_perror("metafile page %d not found", page);
+          start = end;
+        }
+    }
+
+  p->buffer = (char *)gks_malloc(SEGM_SIZE + 1);
+  p->size = SEGM_SIZE;
+  p->nbytes = 0;
+
+  sp = start;
+  while (sp + 2 * (int)sizeof(int) <= end)
+    {
+      memcpy(chunk, s + sp, 2 * sizeof(int));
+      sp += 2 * sizeof(int);
+      if (chunk[0] == MF_INDEX_MARK) break;
+      if (chunk[0] < 0 || chunk[1] < 0 || sp + chunk[1] > end)
+        {
+          gks_perror("metafile is corrupted (chunk size=%d)", chunk[1]);
+          break;
+        }
+
+      if (chunk[1] != chunk[0])
+        {
+#ifdef HAVE_ZLIB
+          data = (char *)gks_malloc(chunk[0]);
+          size = chunk[0];
+          if (uncompress((Bytef *)data, &size, (Bytef *)s + sp, chunk[1]) != Z_OK || (int)size != chunk[0] ||
+              decode_items(data, chunk[0]) != 0)
+            {
+              gks_perror("can't decompress metafile data");
+              free(data);
+              break;
+            }
+          free(data);
+#else
+          gks_perror("compressed metafiles are not supported");
+          break;
+#endif
+        }
+      else if (decode_items(s + sp, chunk[0]) != 0)
+        break;
+
+      sp += chunk[1];
+    }
+
+  if (p->nbytes + 2 * (int)sizeof(int) > p->size) reallocate(2 * sizeof(int));
+  PAD(2 * sizeof(int));
+
+  release(s);
+  p->length = p->nbytes;
+}
+
 static void gksinit(gks_state_list_t *gkss)
 {
   int tnr;
@@ -788,12 +1250,15 @@ void gks_drv_mi(int fctid, int dx, int dy, int dimx, int *i_arr, int len_farr_1,
       p->buffer = (char *)readfile(p->conid);
       p->position = 0;
 
+      if (p->buffer != NULL && p->length >= MF_HEADER_SIZE && memcmp(p->buffer, MF_MAGIC, 4) == 0)
+        decode_metafile();
+
       *ptr = p;
       break;
 
     case 3: /* close workstation */
 
-      if (p->buffer != NULL) free(p->buffer);
+      if (p->buffer != NULL) release(p->buffer);
       free(p);
 
       p = NULL;
@@ -801,7 +1266,7 @@ void gks_drv_mi(int fctid, int dx, int dy, int dimx, int *i_arr, int len_farr_1,
 
     case 102: /* get item */
 
-      if (p->buffer != NULL)
+      if (p->buffer != NULL && p->position + 2 * (int)sizeof(int) <= p->length)
         {
           i_arr[0] = *(int *)(p->buffer + p->position + sizeof(int));
           i_arr[1] = *(int *)(p->buffer + p->position);
@@ -823,7 +1288,7 @@ void gks_drv_mi(int fctid, int dx, int dy, int dimx, int *i_arr, int len_farr_1,
       s = c_arr;
 
       len = *(int *)(p->buffer + p->position);
-      if (len < i_arr[2] * 80 - 2 * (int)sizeof(int))
+      if (len < i_arr[2] * 80 - 2 * (int)sizeof(int) && p->position + len <= p->length)
         {
           memmove(s, p->buffer + p->position, len);
           memset(s + len, 0, 2 * sizeof(int));
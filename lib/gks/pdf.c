@@ -961,25 +961,23 @@ static void draw(double x, double y)
     }
 }
 
+static gks_dc_points_t dc_points = {NULL, NULL, 0};
+
 static void line_routine(int n, double *px, double *py, int ltype, int tnr)
 {
   int i, j, m;
-  double x, y, xdev, ydev;
 
   m = ltype == DrawBorder ? n + 1 : n;
 
+  gks_points_to_DC(&dc_points, n, px, py, tnr, p->a, p->b, p->c, p->d);
   for (i = 0; i < m; i++)
     {
       j = i < n ? i : 0;
 
-      WC_to_NDC(px[j], py[j], tnr, x, y);
-      seg_xform(&x, &y);
-      NDC_to_DC(x, y, xdev, ydev);
-
       if (i == 0)
-        pdf_moveto(p, xdev, ydev);
+        pdf_moveto(p, dc_points.x[j], dc_points.y[j]);
       else
-        pdf_lineto(p, xdev, ydev);
+        pdf_lineto(p, dc_points.x[j], dc_points.y[j]);
     }
 
   p->stroke = 1;
@@ -1388,12 +1386,12 @@ static void text(double px, double py, int nchars, char *chars)
 static void fill_routine(int n, double *px, double *py, int tnr)
 {
   int i, nan_found = 0;
-  double x, y, xdev, ydev;
 
   gks_set_dev_xform(gkss, p->window, p->viewport);
 
   if (p->pattern) pdf_printf(p->content, "/Pattern cs/P%d scn\n", p->pattern);
 
+  gks_points_to_DC(&dc_points, n, px, py, tnr, p->a, p->b, p->c, p->d);
   for (i = 0; i < n; i++)
     {
       if (px[i] != px[i] && py[i] != py[i])
@@ -1401,18 +1399,15 @@ static void fill_routine(int n, double *px, double *py, int tnr)
           nan_found = 1;
           continue;
         }
-      WC_to_NDC(px[i], py[i], tnr, x, y);
-      seg_xform(&x, &y);
-      NDC_to_DC(x, y, xdev, ydev);
 
       if (i == 0 || nan_found)
         {
-          pdf_moveto(p, xdev, ydev);
+          pdf_moveto(p, dc_points.x[i], dc_points.y[i]);
           nan_found = 0;
         }
       else
         {
-          pdf_lineto(p, xdev, ydev);
+          pdf_lineto(p, dc_points.x[i], dc_points.y[i]);
         }
     }
 
@@ -1635,15 +1630,7 @@ static void cellarray(double xmin, double xmax, double ymin, double ymax, int dx
 
 static void to_DC(int n, double *x, double *y)
 {
-  int i;
-  double xn, yn;
-
-  for (i = 0; i < n; i++)
-    {
-      WC_to_NDC(x[i], y[i], gkss->cntnr, xn, yn);
-      seg_xform(&xn, &yn);
-      NDC_to_DC(xn, yn, x[i], y[i]);
-    }
+  gks_WC_to_DC(n, x, y, gkss->cntnr, p->a, p->b, p->c, p->d, x, y);
 }
 
 static void arc(double x, double y, double w, double h, double a1, double a2)
@@ -64,12 +64,18 @@ void gks_aggplugin(int fctid, int dx, int dy, int dimx, int *i_arr, int len_f_ar
 #include <agg_image_accessors.h>
 #include <agg_span_pattern_rgba.h>
 
+#include <atomic>
+#include <deque>
+#include <thread>
+#include <vector>
+
 #include <png.h>
 #include <jpeglib.h>
 
 #define PATTERNS 120
 #define HATCH_STYLE 108
 #define MAXPATHLEN 1024
+#define DEFAULT_TILE_SIZE 256
 
 typedef agg::pixfmt_alpha_blend_rgba<agg::blender_rgba<agg::rgba8, agg::order_bgra>, agg::rendering_buffer> pix_fmt_t;
 typedef agg::renderer_base<pix_fmt_t> renderer_base_t;
@@ -79,7 +85,58 @@ typedef agg::renderer_scanline_aa_solid<renderer_base_t> renderer_aa_t;
 typedef agg::path_storage path_t;
 typedef agg::conv_curve<agg::path_storage> conv_curve_t;
 typedef agg::conv_stroke<agg::conv_curve<agg::path_storage>> conv_stroke_t;
-typedef agg::conv_dash<agg::conv_curve<agg::path_storage>> conv_dash_t;
+
+/* Vertex source reading a const path, so that several tiles can iterate the same recorded path concurrently */
+class path_reader_t
+{
+public:
+  explicit path_reader_t(const path_t &path) : path(path) {}
+
+  void rewind(unsigned int) { index = 0; }
+
+  unsigned int vertex(double *x, double *y)
+  {
+    if (index >= path.total_vertices())
+      {
+        return agg::path_cmd_stop;
+      }
+    return path.vertex(index++, x, y);
+  }
+
+private:
+  const path_t &path;
+  unsigned int index{};
+};
+
+enum render_op_type_t
+{
+  RENDER_OP_FILL,
+  RENDER_OP_STROKE,
+  RENDER_OP_DASHED_STROKE,
+  RENDER_OP_PATTERN,
+  RENDER_OP_PIXELS
+};
+
+/*
+ * A single rasterization step together with the renderer state it depends on. Operations are either rendered
+ * immediately or, in tiled mode, recorded into the page's display list and rendered per tile in `write_page`.
+ */
+struct render_op_t
+{
+  render_op_type_t type{};
+  path_t path;
+  agg::rgba8 color;
+  agg::filling_rule_e filling_rule{agg::fill_non_zero};
+  agg::rect_i clip;
+  agg::rect_i bbox;
+  double width{};
+  agg::line_cap_e line_cap{agg::butt_cap};
+  agg::line_join_e line_join{agg::miter_join};
+  std::vector<double> dashes;
+  int pattern[33]{};
+  int x{}, y{}, w{}, h{};
+  std::vector<agg::rgba8> pixels;
+};
 
 struct ws_state_list
 {
@@ -107,11 +164,14 @@ struct ws_state_list
   unsigned char *image_buffer{};
   rasterizer_t rasterizer{1 << 14};
   scanline_p8_t scanline;
-  renderer_aa_t renderer_aa;
   path_t path;
   conv_curve_t curve{path};
   conv_stroke_t stroke{curve};
   agg::rgba8 fill_col, stroke_col;
+  agg::filling_rule_e filling_rule{agg::fill_non_zero};
+
+  int threads{1}, tile_size{DEFAULT_TILE_SIZE};
+  std::deque<render_op_t> display_list;
 };
 
 static gks_state_list_t *gkss;
@@ -285,6 +345,223 @@ static void init_colors()
     }
 }
 
+static void render_op(const render_op_t &op, const path_t &path, renderer_base_t &renderer, rasterizer_t &rasterizer,
+                      scanline_p8_t &scanline)
+{
+  path_reader_t reader(path);
+  agg::conv_curve<path_reader_t> curve(reader);
+  renderer_aa_t renderer_aa(renderer);
+
+  rasterizer.reset();
+  rasterizer.filling_rule(op.filling_rule);
+  renderer_aa.color(op.color);
+
+  switch (op.type)
+    {
+    case RENDER_OP_FILL:
+      rasterizer.add_path(curve);
+      agg::render_scanlines(rasterizer, scanline, renderer_aa);
+      break;
+
+    case RENDER_OP_STROKE:
+      {
+        agg::conv_stroke<agg::conv_curve<path_reader_t>> stroke(curve);
+        stroke.width(op.width);
+        stroke.line_cap(op.line_cap);
+        stroke.line_join(op.line_join);
+        rasterizer.add_path(stroke);
+        agg::render_scanlines(rasterizer, scanline, renderer_aa);
+      }
+      break;
+
+    case RENDER_OP_DASHED_STROKE:
+      {
+        agg::conv_dash<agg::conv_curve<path_reader_t>> dashes(curve);
+        for (size_t i = 0; i + 1 < op.dashes.size(); i += 2)
+          {
+            dashes.add_dash(op.dashes[i], op.dashes[i + 1]);
+          }
+        agg::conv_stroke<agg::conv_dash<agg::conv_curve<path_reader_t>>> stroke(dashes);
+        stroke.width(op.width);
+        rasterizer.add_path(stroke);
+        agg::render_scanlines(rasterizer, scanline, renderer_aa);
+      }
+      break;
+
+    case RENDER_OP_PATTERN:
+      {
+        typedef agg::wrap_mode_repeat wrap_x_type;
+        typedef agg::wrap_mode_repeat wrap_y_type;
+        typedef agg::image_accessor_wrap<agg::pixfmt_rgba32, wrap_x_type, wrap_y_type> img_source_type;
+        typedef agg::span_pattern_rgba<img_source_type> span_gen_type;
+
+        int size = op.pattern[0];
+        std::vector<agg::int8u> pattern(8 * size * pix_fmt_t::pix_width);
+        agg::rendering_buffer pattern_rbuf(pattern.data(), 8, size, 8 * pix_fmt_t::pix_width);
+        agg::pixfmt_rgba32 img_pixf(pattern_rbuf);
+
+        for (int j = 1; j < size + 1; j++)
+          {
+            for (int i = 0; i < 8; i++)
+              {
+                if (!((1 << i) & op.pattern[j]))
+                  {
+                    img_pixf.copy_pixel(i, j - 1, op.color);
+                  }
+                else
+                  {
+                    img_pixf.copy_pixel(i, j - 1, agg::rgba(0, 0, 0, 0));
+                  }
+              }
+          }
+
+        agg::span_allocator<agg::rgba8> sa;
+        img_source_type img_src(img_pixf);
+        span_gen_type sg(img_src, 0, 0);
+
+        rasterizer.add_path(reader);
+        agg::render_scanlines_aa(rasterizer, scanline, renderer, sa, sg);
+      }
+      break;
+
+    case RENDER_OP_PIXELS:
+      {
+        const agg::rect_i &box = renderer.clip_box();
+        int i0 = max(box.x1 - op.x, 0), i1 = min(box.x2 - op.x, op.w - 1);
+        int j0 = max(box.y1 - op.y, 0), j1 = min(box.y2 - op.y, op.h - 1);
+
+        for (int j = j0; j <= j1; j++)
+          {
+            for (int i = i0; i <= i1; i++)
+              {
+                renderer.blend_pixel(op.x + i, op.y + j, op.pixels[j * op.w + i], agg::cover_full);
+              }
+          }
+      }
+      break;
+    }
+}
+
+static agg::rect_i path_bbox(const path_t &path, double margin)
+{
+  double x, y, x1 = 0, y1 = 0, x2 = -1, y2 = -1;
+  bool first = true;
+
+  for (unsigned int i = 0; i < path.total_vertices(); i++)
+    {
+      if (agg::is_vertex(path.vertex(i, &x, &y)))
+        {
+          if (first)
+            {
+              x1 = x2 = x;
+              y1 = y2 = y;
+              first = false;
+            }
+          else
+            {
+              x1 = min(x1, x);
+              y1 = min(y1, y);
+              x2 = max(x2, x);
+              y2 = max(y2, y);
+            }
+        }
+    }
+  if (first)
+    {
+      return agg::rect_i(1, 1, 0, 0);
+    }
+
+  return agg::rect_i((int)floor(x1 - margin), (int)floor(y1 - margin), (int)ceil(x2 + margin),
+                     (int)ceil(y2 + margin));
+}
+
+static void render(render_op_t &op, const path_t &path)
+{
+  op.clip = p->renderer.clip_box();
+
+  if (p->threads > 1)
+    {
+      if (op.type == RENDER_OP_PIXELS)
+        {
+          op.bbox = agg::rect_i(op.x, op.y, op.x + op.w - 1, op.y + op.h - 1);
+        }
+      else if (op.type == RENDER_OP_STROKE || op.type == RENDER_OP_DASHED_STROKE)
+        {
+          /* miter joins may extend up to twice the line width (default miter limit of 4) */
+          op.bbox = path_bbox(path, 2 * op.width + 2);
+        }
+      else
+        {
+          op.bbox = path_bbox(path, 2);
+        }
+      bool has_path = op.type != RENDER_OP_PIXELS;
+      p->display_list.push_back(std::move(op));
+      if (has_path)
+        {
+          p->display_list.back().path = path;
+        }
+    }
+  else
+    {
+      render_op(op, path, p->renderer, p->rasterizer, p->scanline);
+    }
+}
+
+static void render_display_list()
+{
+  int columns, rows, tiles, threads;
+  std::atomic<int> next_tile{0};
+  std::vector<std::thread> workers;
+
+  if (p->display_list.empty())
+    {
+      return;
+    }
+
+  columns = (p->width + p->tile_size - 1) / p->tile_size;
+  rows = (p->height + p->tile_size - 1) / p->tile_size;
+  tiles = columns * rows;
+
+  /* every tile replays the whole display list with its own rasterizer, scanline and clipping */
+  auto render_tiles = [&]() {
+    rasterizer_t rasterizer{1 << 14};
+    scanline_p8_t scanline;
+    renderer_base_t renderer(p->pix_fmt);
+    int tile;
+
+    while ((tile = next_tile++) < tiles)
+      {
+        int x = (tile % columns) * p->tile_size;
+        int y = (tile / columns) * p->tile_size;
+        agg::rect_i area(x, y, min(x + p->tile_size, p->width) - 1, min(y + p->tile_size, p->height) - 1);
+
+        for (const auto &op : p->display_list)
+          {
+            agg::rect_i clip = agg::intersect_rectangles(op.clip, area);
+            if (!clip.is_valid() || !agg::intersect_rectangles(clip, op.bbox).is_valid())
+              {
+                continue;
+              }
+            renderer.clip_box(clip.x1, clip.y1, clip.x2, clip.y2);
+            render_op(op, op.path, renderer, rasterizer, scanline);
+          }
+      }
+  };
+
+  threads = min(p->threads, tiles);
+  for (int i = 1; i < threads; i++)
+    {
+      workers.emplace_back(render_tiles);
+    }
+  render_tiles();
+  for (auto &worker : workers)
+    {
+      worker.join();
+    }
+
+  p->display_list.clear();
+}
+
 static void open_page()
 {
   set_xform();
@@ -295,7 +572,6 @@ static void open_page()
   p->pix_fmt = pix_fmt_t(p->render_buffer);
   p->renderer = renderer_base_t(p->pix_fmt);
   p->renderer.clear(agg::rgba(0, 0, 0, 0));
-  p->renderer_aa = renderer_aa_t(p->renderer);
   p->stroke.line_cap(agg::butt_cap);
   p->stroke.line_join(agg::round_join);
   p->transparency = 1;
@@ -305,6 +581,8 @@ static void write_page()
 {
   char path[MAXPATHLEN];
 
+  render_display_list();
+
   p->current_page_written = 1;
   p->page_counter++;
 
@@ -467,48 +745,59 @@ static void write_page()
 
 static void close_page()
 {
+  p->display_list.clear();
   p->renderer.reset_clipping(true);
   delete[] p->image_buffer;
 }
 
 static void fill_path(agg::path_storage &path, bool winding_rule = false)
 {
+  render_op_t op;
+
   path.close_polygon();
-  p->rasterizer.reset();
-  p->rasterizer.add_path(p->curve);
-  p->renderer_aa.color(p->fill_col);
-  p->rasterizer.filling_rule(winding_rule ? agg::fill_non_zero : agg::fill_even_odd);
-  agg::render_scanlines(p->rasterizer, p->scanline, p->renderer_aa);
-  p->rasterizer.filling_rule(agg::fill_non_zero);
+  op.type = RENDER_OP_FILL;
+  op.color = p->fill_col;
+  op.filling_rule = winding_rule ? agg::fill_non_zero : agg::fill_even_odd;
+  render(op, path);
+  p->filling_rule = agg::fill_non_zero;
   p->path.remove_all();
 }
 
 static void stroke_path(agg::path_storage &path, bool close = true)
 {
+  render_op_t op;
+
   if (close)
     {
       path.close_polygon();
     }
-  p->rasterizer.reset();
-  p->rasterizer.add_path(p->stroke);
-  p->renderer_aa.color(p->stroke_col);
-  agg::render_scanlines(p->rasterizer, p->scanline, p->renderer_aa);
+  op.type = RENDER_OP_STROKE;
+  op.color = p->stroke_col;
+  op.filling_rule = p->filling_rule;
+  op.width = p->stroke.width();
+  op.line_cap = p->stroke.line_cap();
+  op.line_join = p->stroke.line_join();
+  render(op, path);
   p->path.remove_all();
 }
 
 static void fill_stroke_path(agg::path_storage &path, bool winding_rule = false)
 {
+  render_op_t fill_op, stroke_op;
+
   path.close_polygon();
-  p->rasterizer.reset();
-  p->rasterizer.add_path(p->curve);
-  p->renderer_aa.color(p->fill_col);
-  p->rasterizer.filling_rule(winding_rule ? agg::fill_non_zero : agg::fill_even_odd);
-  agg::render_scanlines(p->rasterizer, p->scanline, p->renderer_aa);
-  p->rasterizer.filling_rule(agg::fill_non_zero);
-  p->rasterizer.reset();
-  p->rasterizer.add_path(p->stroke);
-  p->renderer_aa.color(p->stroke_col);
-  agg::render_scanlines(p->rasterizer, p->scanline, p->renderer_aa);
+  fill_op.type = RENDER_OP_FILL;
+  fill_op.color = p->fill_col;
+  fill_op.filling_rule = winding_rule ? agg::fill_non_zero : agg::fill_even_odd;
+  render(fill_op, path);
+  p->filling_rule = agg::fill_non_zero;
+  stroke_op.type = RENDER_OP_STROKE;
+  stroke_op.color = p->stroke_col;
+  stroke_op.filling_rule = p->filling_rule;
+  stroke_op.width = p->stroke.width();
+  stroke_op.line_cap = p->stroke.line_cap();
+  stroke_op.line_join = p->stroke.line_join();
+  render(stroke_op, path);
   p->path.remove_all();
 }
 
@@ -519,14 +808,20 @@ static void text_routine(double x, double y, int nchars, char *chars)
   int height = p->height;
   int px, py;
   unsigned char *alpha_pixels;
-  unsigned char *bgra_pixels;
   double red, green, blue;
+  render_op_t op;
 
   NDC_to_DC(x, y, px, py);
   py = p->height - py;
 
   alpha_pixels = gks_ft_get_bitmap(&px, &py, &width, &height, gkss, chars, nchars);
-  bgra_pixels = new unsigned char[pix_fmt_t::pix_width * height * width];
+
+  op.type = RENDER_OP_PIXELS;
+  op.x = px;
+  op.y = p->height - py - height;
+  op.w = width;
+  op.h = height;
+  op.pixels.resize(width * height);
 
   gks_inq_rgb(p->color, &red, &green, &blue);
   for (i = 0; i < height; i++)
@@ -534,46 +829,42 @@ static void text_routine(double x, double y, int nchars, char *chars)
       for (j = 0; j < width; j++)
         {
           double alpha = alpha_pixels[i * width + j] / 255.0;
-          p->renderer.blend_pixel(px + j, p->height - py - height + i, agg::rgba(red, green, blue, alpha),
-                                  agg::cover_full);
+          op.pixels[i * width + j] = agg::rgba8(agg::rgba(red, green, blue, alpha));
         }
     }
-  delete[] bgra_pixels;
+  render(op, p->path);
   gks_free(alpha_pixels);
 }
 
+static gks_dc_points_t dc_points = {NULL, NULL, 0};
+
 static void line_routine(int n, double *px, double *py, int linetype, int tnr)
 {
-  double x, y, x0, y0, xi, yi;
   int gks_dashes[10], i;
 
-  WC_to_NDC(px[0], py[0], tnr, x, y);
-  seg_xform(x, y);
-  NDC_to_DC(x, y, x0, y0);
-  p->path.move_to(x0, y0);
+  gks_points_to_DC(&dc_points, n, px, py, tnr, p->a, p->b, p->c, p->d);
+  p->path.move_to(dc_points.x[0], dc_points.y[0]);
   for (i = 1; i < n; i++)
     {
-      WC_to_NDC(px[i], py[i], tnr, x, y);
-      seg_xform(x, y);
-      NDC_to_DC(x, y, xi, yi);
-      p->path.line_to(xi, yi);
+      p->path.line_to(dc_points.x[i], dc_points.y[i]);
     }
   p->stroke.width(p->linewidth);
   p->stroke_col = agg::rgba(p->rgb[p->color][0], p->rgb[p->color][1], p->rgb[p->color][2], p->transparency);
   if (linetype != GKS_K_LINETYPE_SOLID)
     {
-      conv_dash_t dashes(p->curve);
+      render_op_t op;
+
+      op.type = RENDER_OP_DASHED_STROKE;
+      op.color = p->stroke_col;
+      op.filling_rule = p->filling_rule;
+      op.width = p->linewidth;
       gks_get_dash_list(linetype, p->linewidth, gks_dashes);
       for (i = 0; i < gks_dashes[0]; i += 2)
         {
-          dashes.add_dash(gks_dashes[i + 1], gks_dashes[i + 2]);
+          op.dashes.push_back(gks_dashes[i + 1]);
+          op.dashes.push_back(gks_dashes[i + 2]);
         }
-      p->rasterizer.reset();
-      agg::conv_stroke<agg::conv_dash<agg::conv_curve<agg::path_storage>>> stroke(dashes);
-      stroke.width(p->linewidth);
-      p->rasterizer.add_path(stroke);
-      p->renderer_aa.color(p->stroke_col);
-      agg::render_scanlines(p->rasterizer, p->scanline, p->renderer_aa);
+      render(op, p->path);
       p->path.remove_all();
     }
   else
@@ -584,23 +875,15 @@ static void line_routine(int n, double *px, double *py, int linetype, int tnr)
 
 static void fill_routine(int n, double *px, double *py, int tnr)
 {
-  int i, j, k;
-  double x, y, ix, iy;
-  int fl_inter, fl_style, fl_color, size;
-  int gks_pattern[33];
-
-  WC_to_NDC(px[0], py[0], tnr, x, y);
-  seg_xform(x, y);
-  NDC_to_DC(x, y, ix, iy);
+  int i;
+  int fl_inter, fl_style, fl_color;
 
-  p->path.move_to(ix, iy);
+  gks_points_to_DC(&dc_points, n, px, py, tnr, p->a, p->b, p->c, p->d);
+  p->path.move_to(dc_points.x[0], dc_points.y[0]);
 
   int nan_found = 0;
   for (i = 1; i < n; i++)
     {
-      WC_to_NDC(px[i], py[i], tnr, x, y);
-      seg_xform(x, y);
-      NDC_to_DC(x, y, ix, iy);
       if (px[i] != px[i] || py[i] != py[i])
         {
           nan_found = 1;
@@ -609,11 +892,11 @@ static void fill_routine(int n, double *px, double *py, int tnr)
       if (nan_found)
         {
           nan_found = 0;
-          p->path.move_to(ix, iy);
+          p->path.move_to(dc_points.x[i], dc_points.y[i]);
         }
       else
         {
-          p->path.line_to(ix, iy);
+          p->path.line_to(dc_points.x[i], dc_points.y[i]);
         }
     }
 
@@ -631,45 +914,17 @@ static void fill_routine(int n, double *px, double *py, int tnr)
         {
           fl_style = 1;
         }
-      gks_inq_pattern_array(fl_style, gks_pattern);
-      size = gks_pattern[0];
 
-      typedef agg::wrap_mode_repeat wrap_x_type;
-      typedef agg::wrap_mode_repeat wrap_y_type;
-      typedef agg::image_accessor_wrap<agg::pixfmt_rgba32, wrap_x_type, wrap_y_type> img_source_type;
-      typedef agg::span_pattern_rgba<img_source_type> span_gen_type;
+      render_op_t op;
 
-      auto *m_pattern = new agg::int8u[8 * size * pix_fmt_t::pix_width];
-      agg::rendering_buffer m_pattern_rbuf(m_pattern, 8, size, 8 * pix_fmt_t::pix_width);
-      agg::pixfmt_rgba32 img_pixf(m_pattern_rbuf);
-
-      for (j = 1; j < size + 1; j++)
-        {
-          for (i = 0; i < 8; i++)
-            {
-              k = (1 << i) & gks_pattern[j];
-              if (!(k))
-                {
-                  img_pixf.copy_pixel(i, j - 1,
-                                      agg::rgba(p->rgb[fl_color][0] * p->transparency,
-                                                p->rgb[fl_color][1] * p->transparency,
-                                                p->rgb[fl_color][2] * p->transparency, p->transparency));
-                }
-              else
-                {
-                  img_pixf.copy_pixel(i, j - 1, agg::rgba(0, 0, 0, 0));
-                }
-            }
-        }
-
-      agg::span_allocator<agg::rgba8> sa;
-      img_source_type img_src(img_pixf);
-      span_gen_type sg(img_src, 0, 0);
+      op.type = RENDER_OP_PATTERN;
+      op.color = agg::rgba8(agg::rgba(p->rgb[fl_color][0] * p->transparency, p->rgb[fl_color][1] * p->transparency,
+                                      p->rgb[fl_color][2] * p->transparency, p->transparency));
+      op.filling_rule = p->filling_rule;
+      gks_inq_pattern_array(fl_style, op.pattern);
 
       p->path.close_polygon();
-      p->rasterizer.reset();
-      p->rasterizer.add_path(p->path);
-      agg::render_scanlines_aa(p->rasterizer, p->scanline, p->renderer, sa, sg);
+      render(op, p->path);
       p->path.remove_all();
       return;
     }
@@ -681,7 +936,7 @@ static void fill_routine(int n, double *px, double *py, int tnr)
     }
   else
     {
-      p->rasterizer.filling_rule(agg::fill_non_zero);
+      p->filling_rule = agg::fill_non_zero;
       p->stroke.width(p->linewidth);
       p->stroke.line_cap(agg::round_cap);
       p->stroke.line_join(agg::round_join);
@@ -901,9 +1156,9 @@ static void fillarea(int n, double *px, double *py)
   p->linewidth = gkss->bwidth * p->nominal_size;
   p->color = gkss->asf[12] ? gkss->facoli : 1;
 
-  p->rasterizer.filling_rule(agg::fill_even_odd);
+  p->filling_rule = agg::fill_even_odd;
   fill_routine(n, px, py, gkss->cntnr);
-  p->rasterizer.filling_rule(agg::fill_non_zero);
+  p->filling_rule = agg::fill_non_zero;
 }
 
 static void cellarray(double xmin, double xmax, double ymin, double ymax, int dx, int dy, int dimx, int *colia,
@@ -916,6 +1171,7 @@ static void cellarray(double xmin, double xmax, double ymin, double ymax, int dx
   int i, j, ix, iy, ind;
   int swapx, swapy;
   unsigned char *data;
+  render_op_t op;
 
   WC_to_NDC(xmin, ymax, gkss->cntnr, x1, y1);
   seg_xform(x1, y1);
@@ -934,6 +1190,13 @@ static void cellarray(double xmin, double xmax, double ymin, double ymax, int dx
   swapx = ix1 > ix2;
   swapy = iy1 < iy2;
 
+  op.type = RENDER_OP_PIXELS;
+  op.x = x;
+  op.y = y;
+  op.w = width;
+  op.h = height;
+  op.pixels.resize(width * height);
+
   if (true_color)
     {
       data = new unsigned char[width * height * pix_fmt_t::pix_width];
@@ -949,8 +1212,7 @@ static void cellarray(double xmin, double xmax, double ymin, double ymax, int dx
               blue = data[(j * width + i) * pix_fmt_t::pix_width + 2];
               alpha = (int)(data[(j * width + i) * pix_fmt_t::pix_width + 3] * p->transparency);
 
-              agg::rgba8 col = agg::rgba8(red, green, blue, alpha);
-              p->renderer.blend_pixel(x + i, y + j, col, agg::cover_full);
+              op.pixels[j * width + i] = agg::rgba8(red, green, blue, alpha);
             }
         }
       delete[] data;
@@ -979,24 +1241,16 @@ static void cellarray(double xmin, double xmax, double ymin, double ymax, int dx
               green = alpha * p->rgb[ind][1];
               blue = alpha * p->rgb[ind][2];
 
-              agg::rgba col = agg::rgba(red, green, blue, alpha);
-              p->renderer.blend_pixel(x + i, y + j, col, agg::cover_full);
+              op.pixels[j * width + i] = agg::rgba8(agg::rgba(red, green, blue, alpha));
             }
         }
     }
+  render(op, p->path);
 }
 
 static void to_DC(int n, double *x, double *y)
 {
-  int i;
-  double xn, yn;
-
-  for (i = 0; i < n; i++)
-    {
-      WC_to_NDC(x[i], y[i], gkss->cntnr, xn, yn);
-      seg_xform(xn, yn);
-      NDC_to_DC(xn, yn, x[i], y[i]);
-    }
+  gks_WC_to_DC(n, x, y, gkss->cntnr, p->a, p->b, p->c, p->d, x, y);
 }
 
 static void draw_path(int n, double *px, double *py, int nc, int *codes)
@@ -1351,6 +1605,7 @@ static void gdp(int n, double *px, double *py, int primid, int nc, int *codes)
 void gks_aggplugin(int fctid, int dx, int dy, int dimx, int *i_arr, int len_f_arr_1, double *f_arr_1, int len_f_arr_2,
                    double *f_arr_2, int len_c_arr, char *c_arr, void **ptr)
 {
+  const char *env;
   GKS_UNUSED(len_c_arr);
   GKS_UNUSED(len_f_arr_1);
   GKS_UNUSED(len_f_arr_2);
@@ -1453,6 +1708,24 @@ void gks_aggplugin(int fctid, int dx, int dy, int dimx, int *i_arr, int len_f_ar
           p->nominal_size = p->dpi / 100;
         }
 
+      if ((env = gks_getenv("GKS_AGG_THREADS")) != nullptr)
+        {
+          p->threads = atoi(env);
+          if (p->threads <= 0)
+            {
+              p->threads = (int)std::thread::hardware_concurrency();
+            }
+        }
+      if ((env = gks_getenv("GKS_AGG_TILE_SIZE")) != nullptr)
+        {
+          p->tile_size = atoi(env);
+          if (p->tile_size <= 0)
+            {
+              gks_perror("invalid tile size (%s)", env);
+              p->tile_size = DEFAULT_TILE_SIZE;
+            }
+        }
+
       init_colors();
       open_page();
 
@@ -1482,6 +1755,7 @@ void gks_aggplugin(int fctid, int dx, int dy, int dimx, int *i_arr, int len_f_ar
 
     case 6:
       /* clear workstation */
+      p->display_list.clear();
       p->renderer.reset_clipping(true);
       p->renderer.clear(agg::rgba(0, 0, 0, 0));
       break;
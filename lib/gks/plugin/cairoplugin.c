@@ -187,10 +187,11 @@ typedef struct ws_state_list_t
   Display *dpy;
   Window win;
   pthread_t thread;
-  pthread_mutex_t mutex;
   int run, done;
   Atom wmDeleteMessage;
   pthread_t master_thread;
+  gks_display_list_t dl;
+  int redraw_pending, resize_pending, resize_width, resize_height;
 #endif
   int npoints, max_points;
   int empty, current_page_written, page_counter;
@@ -199,12 +200,21 @@ typedef struct ws_state_list_t
   unsigned char *patterns;
   int pattern_counter, use_symbols;
   double dashes[10];
+  int *sixel_palette, sixel_colors;
+  short *sixel_lut;
+  unsigned char *sixel_seen, *sixel_prev;
+  int sixel_dirty, sixel_width, sixel_height;
 } ws_state_list;
 
 static ws_state_list *p;
 
 static int idle = 0;
 
+#ifndef NO_X11
+/* serializes the workstation calls with the event threads, which request redraws of their workstations */
+static pthread_mutex_t mutex = PTHREAD_MUTEX_INITIALIZER;
+#endif
+
 static int predef_prec[] = {0, 1, 2, 2, 2, 2};
 
 static int predef_ints[] = {0, 1, 3, 3, 3};
@@ -487,37 +497,28 @@ static void draw(double x, double y)
   p->npoints++;
 }
 
+static gks_dc_points_t dc_points = {NULL, NULL, 0};
+
 static void line_routine(int n, double *px, double *py, int linetype, int tnr)
 {
-  double x, y, x0, y0, xi, yi;
   int i;
   GKS_UNUSED(linetype);
 
-  WC_to_NDC(px[0], py[0], tnr, x, y);
-  seg_xform(&x, &y);
-  NDC_to_DC(x, y, x0, y0);
+  gks_points_to_DC(&dc_points, n, px, py, tnr, p->a, p->b, p->c, p->d);
 
   cairo_set_line_cap(p->cr, CAIRO_LINE_CAP_ROUND);
   cairo_set_line_join(p->cr, CAIRO_LINE_JOIN_ROUND);
   set_line_width(p->linewidth);
 
-  cairo_move_to(p->cr, x0, y0);
-
-  for (i = 1; i < n; i++)
-    {
-      WC_to_NDC(px[i], py[i], tnr, x, y);
-      seg_xform(&x, &y);
-      NDC_to_DC(x, y, xi, yi);
+  cairo_move_to(p->cr, dc_points.x[0], dc_points.y[0]);
 
-      cairo_line_to(p->cr, xi, yi);
-    }
+  for (i = 1; i < n; i++) cairo_line_to(p->cr, dc_points.x[i], dc_points.y[i]);
   cairo_stroke(p->cr);
 }
 
 static void fill_routine(int n, double *px, double *py, int tnr)
 {
   int i, j, k;
-  double x, y, ix, iy;
   int fl_inter, fl_style, fl_color, size;
   int gks_pattern[33];
   cairo_format_t format = CAIRO_FORMAT_ARGB32;
@@ -526,21 +527,13 @@ static void fill_routine(int n, double *px, double *py, int tnr)
   cairo_surface_t *image;
   cairo_matrix_t pattern_matrix;
 
-  WC_to_NDC(px[0], py[0], tnr, x, y);
-  seg_xform(&x, &y);
-  NDC_to_DC(x, y, ix, iy);
+  gks_points_to_DC(&dc_points, n, px, py, tnr, p->a, p->b, p->c, p->d);
 
   cairo_set_dash(p->cr, p->dashes, 0, 0);
 
-  cairo_move_to(p->cr, ix, iy);
+  cairo_move_to(p->cr, dc_points.x[0], dc_points.y[0]);
 
-  for (i = 1; i < n; i++)
-    {
-      WC_to_NDC(px[i], py[i], tnr, x, y);
-      seg_xform(&x, &y);
-      NDC_to_DC(x, y, ix, iy);
-      cairo_line_to(p->cr, ix, iy);
-    }
+  for (i = 1; i < n; i++) cairo_line_to(p->cr, dc_points.x[i], dc_points.y[i]);
 
   cairo_close_path(p->cr);
 
@@ -835,56 +828,221 @@ static void set_clipping(int index)
 static void lock(void)
 {
 #ifndef NO_X11
-  if (p->wtype == 141) pthread_mutex_lock(&p->mutex);
+  pthread_mutex_lock(&mutex);
 #endif
 }
 
 static void unlock(void)
 {
 #ifndef NO_X11
-  if (p->wtype == 141) pthread_mutex_unlock(&p->mutex);
+  pthread_mutex_unlock(&mutex);
 #endif
 }
 
 #ifndef NO_X11
 
+static void fit_to_window(int width, int height)
+{
+  double ratio = (p->window[1] - p->window[0]) / (p->window[3] - p->window[2]);
+
+  if (width > height * ratio)
+    width = nint(height * ratio);
+  else
+    height = nint(width / ratio);
+
+  p->width = width;
+  p->height = height;
+  if (gkss->resize_behaviour == GKS_K_RESIZE) p->nominal_size = min(p->width, p->height) / 500.0;
+
+  set_xform();
+  init_norm_xform();
+}
+
+static void select_xform(int tnr);
+static void set_transparency(double alpha);
+void set_window(int tnr, double xmin, double xmax, double ymin, double ymax);
+static void set_viewport(int tnr, double xmin, double xmax, double ymin, double ymax);
+static void gdp(int n, double *px, double *py, int primid, int nc, int *codes);
+
+static void replay_function(int fctid, int dx, int dy, int dimx, int *ia, int lr1, double *r1, int lr2, double *r2,
+                            int lc, char *chars, void **ptr)
+{
+  GKS_UNUSED(lr1);
+  GKS_UNUSED(lr2);
+  GKS_UNUSED(lc);
+  GKS_UNUSED(ptr);
+
+  switch (fctid)
+    {
+    case 2:
+      /* the state list has been restored from the display list */
+      init_norm_xform();
+      set_clip_rect(gkss->cntnr);
+      break;
+
+    case 12:
+      polyline(ia[0], r1, r2);
+      break;
+
+    case 13:
+      polymarker(ia[0], r1, r2);
+      break;
+
+    case 14:
+      text(r1[0], r2[0], strlen(chars), chars);
+      break;
+
+    case 15:
+      fillarea(ia[0], r1, r2);
+      break;
+
+    case 16:
+    case DRAW_IMAGE:
+      cellarray(r1[0], r1[1], r2[0], r2[1], dx, dy, dimx, ia, fctid == DRAW_IMAGE);
+      break;
+
+    case 17:
+      gdp(ia[0], r1, r2, ia[1], ia[2], ia + 3);
+      break;
+
+    case 48:
+      set_color_rep(ia[1], r1[0], r1[1], r1[2]);
+      break;
+
+    case 49:
+      set_window(ia[0], r1[0], r1[1], r2[0], r2[1]);
+      break;
+
+    case 50:
+      set_viewport(ia[0], r1[0], r1[1], r2[0], r2[1]);
+      break;
+
+    case 52:
+      select_xform(ia[0]);
+      break;
+
+    case 53:
+      set_clipping(ia[0]);
+      break;
+
+    case 54:
+      p->window[0] = r1[0];
+      p->window[1] = r1[1];
+      p->window[2] = r2[0];
+      p->window[3] = r2[1];
+
+      set_xform();
+      init_norm_xform();
+      break;
+
+    case 203:
+      set_transparency(r1[0]);
+      break;
+
+    default:
+      /* the window size is kept, everything else does not change the window contents */
+      break;
+    }
+}
+
+/*
+ * Redraw the window contents from the recorded display list. The primitives are interpreted with a private copy of
+ * the state list by calling the draw routines directly, so the display list is not modified. The drawing routines use
+ * the process-wide transformations and caches of the GKS core, so this only runs on the application thread; the
+ * normalization transformations of the application are restored afterwards.
+ */
+static void replay(void)
+{
+  gks_state_list_t *saved_gkss = gkss, state;
+  char *s = p->dl.buffer;
+  int sp = 0, *len, tnr;
+
+  if (s == NULL) return;
+
+  memcpy(&state, gkss, sizeof(gks_state_list_t));
+  gkss = &state;
+
+  cairo_save(p->cr);
+  cairo_reset_clip(p->cr);
+  cairo_set_operator(p->cr, CAIRO_OPERATOR_CLEAR);
+  cairo_paint(p->cr);
+  cairo_restore(p->cr);
+
+  len = (int *)s;
+  while (*len)
+    {
+      sp += sizeof(int);
+      sp += gks_dl_read_item(s + sp, &gkss, replay_function);
+      len = (int *)(s + sp);
+    }
+
+  cairo_surface_flush(p->surface);
+  XFlush(p->dpy);
+
+  gkss = saved_gkss;
+  for (tnr = 0; tnr < MAX_TNR; tnr++) gks_set_norm_xform(tnr, gkss->window[tnr], gkss->viewport[tnr]);
+  init_norm_xform();
+  set_clip_rect(gkss->cntnr);
+}
+
+static void redraw_window(int replay_contents)
+{
+  /* Handle the resize and expose events which were received by the event thread since the last workstation call */
+  if (p->resize_pending)
+    {
+      fit_to_window(p->resize_width, p->resize_height);
+      p->resize_pending = 0;
+    }
+  p->redraw_pending = 0;
+  if (replay_contents) replay();
+}
+
 static void *event_loop(void *arg)
 {
-  ws_state_list *p = (ws_state_list *)arg;
+  ws_state_list *ws = (ws_state_list *)arg;
   XEvent event;
 
-  p->run = 1;
-  while (p->run)
+  ws->run = 1;
+  while (ws->run)
     {
       usleep(10000);
 
-      if (idle && p->run)
+      if (idle && ws->run)
         {
-          if (pthread_mutex_trylock(&p->mutex) == 0)
+          if (pthread_mutex_trylock(&mutex) == 0)
             {
-              while (XPending(p->dpy))
+              /* the window is redrawn by the next workstation call of the application */
+              while (XPending(ws->dpy))
                 {
-                  XNextEvent(p->dpy, &event);
+                  XNextEvent(ws->dpy, &event);
                   if (event.type == ClientMessage)
                     {
-                      if ((Atom)event.xclient.data.l[0] == p->wmDeleteMessage)
+                      if ((Atom)event.xclient.data.l[0] == ws->wmDeleteMessage)
                         {
 #ifdef SIGUSR1
-                          pthread_kill(p->master_thread, SIGUSR1);
+                          pthread_kill(ws->master_thread, SIGUSR1);
 #endif
-                          p->run = 0;
+                          ws->run = 0;
                         }
                     }
                   else if (event.type == ConfigureNotify)
                     {
-                      cairo_xlib_surface_set_size(p->surface, event.xconfigure.width, event.xconfigure.height);
+                      cairo_xlib_surface_set_size(ws->surface, event.xconfigure.width, event.xconfigure.height);
+                      ws->resize_width = event.xconfigure.width;
+                      ws->resize_height = event.xconfigure.height;
+                      ws->resize_pending = 1;
+                      ws->redraw_pending = 1;
+                    }
+                  else if (event.type == Expose && event.xexpose.count == 0)
+                    {
+                      ws->redraw_pending = 1;
                     }
                 }
-              pthread_mutex_unlock(&p->mutex);
+              pthread_mutex_unlock(&mutex);
             }
         }
     }
-  p->done = 1;
+  ws->done = 1;
 
   pthread_exit(0);
 }
@@ -912,7 +1070,6 @@ static void create_window(void)
   XSelectInput(p->dpy, p->win, StructureNotifyMask | ExposureMask);
   XMapWindow(p->dpy, p->win);
 
-  pthread_mutex_init(&p->mutex, NULL);
   pthread_attr_init(&attr);
   pthread_attr_setdetachstate(&attr, PTHREAD_CREATE_DETACHED);
   if (pthread_create(&p->thread, &attr, event_loop, (void *)p)) perror("pthread_create");
@@ -1200,136 +1357,228 @@ static oct_node node_fold(oct_node p)
   return q;
 }
 
-static int color_replace(oct_node root, unsigned char *pix)
+#define N_COLORS 256
+
+#define LUT_SIZE 32768
+
+#define LUT_INDEX(pix) ((((pix)[0] & 0xf8) << 7) | (((pix)[1] & 0xf8) << 2) | ((pix)[2] >> 3))
+
+static void quantize(int width, int height, unsigned char *data)
 {
-  unsigned char i, bit;
+  unsigned char *pix = data, *last = NULL;
+  oct_node root, got, leaf = NULL;
+  int i, j;
+  node_heap heap = {0, 0, NULL};
+  double c;
 
-  for (bit = 1 << 7; bit; bit >>= 1)
+  root = node_new(0, 0, NULL);
+  for (i = 0; i < width * height; i++, pix += 4)
     {
-      i = !!(pix[1] & bit) * 4 + !!(pix[0] & bit) * 2 + !!(pix[2] & bit);
-      if (!root->kids[i]) break;
-      root = root->kids[i];
+      if (last != NULL && pix[0] == last[0] && pix[1] == last[1] && pix[2] == last[2])
+        {
+          /* runs of equal pixels are very common in plots, so skip the tree descent */
+          leaf->r += pix[0];
+          leaf->g += pix[1];
+          leaf->b += pix[2];
+          leaf->count++;
+        }
+      else
+        {
+          leaf = node_insert(root, pix);
+          if (leaf->count == 1) heap_add(&heap, leaf);
+          last = pix;
+        }
     }
 
-  pix[0] = root->r;
-  pix[1] = root->g;
-  pix[2] = root->b;
+  /* the leaf counts have changed since they were added, so restore the heap order */
+  for (i = (heap.n - 1) / 2; i >= 1; i--) down_heap(&heap, heap.buf[i]);
+
+  while (heap.n > N_COLORS + 1) heap_add(&heap, node_fold(pop_heap(&heap)));
+
+  p->sixel_colors = heap.n - 1;
+  for (i = 1, j = 0; i < heap.n; i++)
+    {
+      got = heap.buf[i];
+      c = got->count;
+      p->sixel_palette[j++] = (int)(got->r / c + 0.5) & 0xff;
+      p->sixel_palette[j++] = (int)(got->g / c + 0.5) & 0xff;
+      p->sixel_palette[j++] = (int)(got->b / c + 0.5) & 0xff;
+    }
 
-  return root->heap_idx;
+  node_free();
+  free(heap.buf);
 }
 
-#define N_COLORS 256
+static int nearest_color(unsigned char *pix)
+{
+  int i, dr, dg, db, d, dmin = 3 * 256 * 256, color = 0;
+
+  for (i = 0; i < p->sixel_colors; i++)
+    {
+      dr = p->sixel_palette[3 * i] - pix[0];
+      dg = p->sixel_palette[3 * i + 1] - pix[1];
+      db = p->sixel_palette[3 * i + 2] - pix[2];
+      d = dr * dr + dg * dg + db * db;
+      if (d < dmin)
+        {
+          dmin = d;
+          color = i;
+        }
+    }
+
+  return color;
+}
 
-#define WRITE_SIXEL_DATA                                     \
-  if (cache == -1)                                           \
-    c = 0x3f;                                                \
-  else                                                       \
-    {                                                        \
-      c = 0x3f + n;                                          \
-      if (slots[cache] == 0)                                 \
-        {                                                    \
-          r = palette[cache * 3 - 3] * 100 / 256;            \
-          g = palette[cache * 3 - 2] * 100 / 256;            \
-          b = palette[cache * 3 - 1] * 100 / 256;            \
-          slots[cache] = 1;                                  \
-          fprintf(stream, "#%d;2;%d;%d;%d", cache, r, g, b); \
-        }                                                    \
-      fprintf(stream, "#%d", cache);                         \
-    }                                                        \
-  if (count < 3)                                             \
-    for (i = 0; i < count; i++) fprintf(stream, "%c", c);    \
-  else                                                       \
+static void write_sixel_run(FILE *stream, int c, int count)
+{
+  if (count > 3)
     fprintf(stream, "!%d%c", count, c);
+  else
+    while (count--) putc(c, stream);
+}
 
-static void write_sixels(char *path, int width, int height, int *palette, int *data)
+/*
+ * Write the indexed image as sixel bands of six pixel rows. Each band is written as one run-length encoded line
+ * per color used in that band. If a previous frame is given, bands which did not change are skipped, relying on
+ * the terminal to keep the transparent (P2=1) pixels.
+ */
+static void write_sixels(char *path, int width, int height, int *data, unsigned char *pixels, unsigned char *prev)
 {
-  int i, slots[257];
   FILE *stream;
-  int n, x, y, p, cache, count, c, color;
-  int r, g, b;
-
-  for (i = 0; i <= 256; i++) slots[i] = 0;
+  unsigned char *bits, *row, *mark;
+  int *used, n_used;
+  int i, j, x, y, rows, color, count, c;
 
   stream = fopen(path, "w");
+  if (stream == NULL)
+    {
+      gks_perror("can't open sixel file");
+      return;
+    }
 
   fprintf(stream, "%c%s", 0x1b, "P");
   fprintf(stream, "%d;%d;%dq\"1;1;%d;%d", 7, 1, 75, width, height);
 
-  n = 1;
-  for (y = 0; y < height; y++)
+  for (i = 0; i < p->sixel_colors; i++)
+    fprintf(stream, "#%d;2;%d;%d;%d", i, (p->sixel_palette[3 * i] * 100 + 127) / 255,
+            (p->sixel_palette[3 * i + 1] * 100 + 127) / 255, (p->sixel_palette[3 * i + 2] * 100 + 127) / 255);
+
+  bits = (unsigned char *)gks_malloc(N_COLORS * width);
+  mark = (unsigned char *)gks_malloc(N_COLORS);
+  used = (int *)gks_malloc(N_COLORS * sizeof(int));
+
+  for (y = 0; y < height; y += 6)
     {
-      p = y * width;
-      cache = data[p];
-      count = 1;
-      c = -1;
-      for (x = 0; x < width; x++)
+      if (y > 0) putc('-', stream);
+
+      rows = min(6, height - y);
+      if (prev != NULL && memcmp(pixels + y * width * 4, prev + y * width * 4, rows * width * 4) == 0) continue;
+
+      n_used = 0;
+      for (j = 0; j < rows; j++)
+        for (x = 0; x < width; x++)
+          {
+            color = data[(y + j) * width + x];
+            if (!mark[color])
+              {
+                mark[color] = 1;
+                used[n_used++] = color;
+              }
+            bits[color * width + x] |= 1 << j;
+          }
+
+      for (i = 0; i < n_used; i++)
         {
-          color = data[p + x];
-          if (color == cache)
-            count += 1;
-          else
+          color = used[i];
+          row = bits + color * width;
+
+          fprintf(stream, "#%d", color);
+          c = row[0];
+          count = 1;
+          for (x = 1; x < width; x++)
             {
-              WRITE_SIXEL_DATA;
-              count = 1;
-              cache = color;
+              if (row[x] == c)
+                count++;
+              else
+                {
+                  write_sixel_run(stream, 0x3f + c, count);
+                  c = row[x];
+                  count = 1;
+                }
             }
-        }
-      if (c != -1 && count > 1)
-        {
-          WRITE_SIXEL_DATA;
-        }
-      if (n == 32)
-        {
-          n = 1;
-          fprintf(stream, "-");
-        }
-      else
-        {
-          n <<= 1;
-          fprintf(stream, "$");
+          if (c != 0) write_sixel_run(stream, 0x3f + c, count);
+          if (i < n_used - 1) putc('$', stream);
+
+          memset(row, 0, width);
+          mark[color] = 0;
         }
     }
   fprintf(stream, "%c\\", 0x1b);
   fclose(stream);
+
+  free(used);
+  free(mark);
+  free(bits);
 }
 
+/*
+ * Quantize the page and write it as sixel file. The palette and the color lookup table are kept between pages and
+ * reused as long as the new page doesn't contain colors which were not present when the palette was computed.
+ */
 static void write_to_six(char *path, int width, int height, unsigned char *data)
 {
-  unsigned char *pix = data;
-  oct_node root, got;
-  int i, j;
-  node_heap heap = {0, 0, NULL};
-  double c;
-  int r, g, b, *palette, *ca;
+  unsigned char *pix, *seen, *prev = NULL;
+  int i, k, reuse, *ca;
 
-  root = node_new(0, 0, NULL);
-  for (i = 0; i < width * height; i++, pix += 4) heap_add(&heap, node_insert(root, pix));
+  if (p->sixel_palette == NULL)
+    {
+      p->sixel_palette = (int *)gks_malloc(N_COLORS * 3 * sizeof(int));
+      p->sixel_lut = (short *)gks_malloc(LUT_SIZE * sizeof(short));
+      p->sixel_seen = (unsigned char *)gks_malloc(LUT_SIZE / 8);
+    }
 
-  while (heap.n > N_COLORS + 1) heap_add(&heap, node_fold(pop_heap(&heap)));
+  seen = (unsigned char *)gks_malloc(LUT_SIZE / 8);
+  for (i = 0, pix = data; i < width * height; i++, pix += 4)
+    {
+      k = LUT_INDEX(pix);
+      seen[k >> 3] |= 1 << (k & 7);
+    }
 
-  palette = (int *)gks_malloc(heap.n * 3 * sizeof(int));
-  for (i = 1, j = 0; i < heap.n; i++)
+  reuse = p->sixel_colors > 0;
+  for (i = 0; reuse && i < LUT_SIZE / 8; i++)
+    if (seen[i] & ~p->sixel_seen[i]) reuse = 0;
+
+  if (!reuse)
     {
-      got = heap.buf[i];
-      c = got->count;
-      got->r = got->r / c + 0.5;
-      got->g = got->g / c + 0.5;
-      got->b = got->b / c + 0.5;
-      r = (int)got->r & 0xff;
-      g = (int)got->g & 0xff;
-      b = (int)got->b & 0xff;
-      palette[j++] = r;
-      palette[j++] = g;
-      palette[j++] = b;
+      quantize(width, height, data);
+      memcpy(p->sixel_seen, seen, LUT_SIZE / 8);
+      for (i = 0; i < LUT_SIZE; i++) p->sixel_lut[i] = -1;
     }
+  free(seen);
 
   ca = (int *)gks_malloc(width * height * sizeof(int));
-  for (i = 0, pix = data; i < width * height; i++, pix += 4) ca[i] = color_replace(root, pix);
+  for (i = 0, pix = data; i < width * height; i++, pix += 4)
+    {
+      k = LUT_INDEX(pix);
+      if (p->sixel_lut[k] < 0) p->sixel_lut[k] = nearest_color(pix);
+      ca[i] = p->sixel_lut[k];
+    }
+
+  if (p->sixel_dirty)
+    {
+      if (p->sixel_prev != NULL && p->sixel_width == width && p->sixel_height == height) prev = p->sixel_prev;
+    }
 
-  write_sixels(path, width, height, palette, ca);
+  write_sixels(path, width, height, ca, data, prev);
+  free(ca);
 
-  node_free();
-  free(heap.buf);
+  if (p->sixel_dirty)
+    {
+      p->sixel_prev = (unsigned char *)gks_realloc(p->sixel_prev, width * height * 4);
+      memcpy(p->sixel_prev, data, width * height * 4);
+      p->sixel_width = width;
+      p->sixel_height = height;
+    }
 }
 
 static void write_page(void)
@@ -1779,15 +2028,7 @@ static void set_viewport(int tnr, double xmin, double xmax, double ymin, double
 
 static void to_DC(int n, double *x, double *y)
 {
-  int i;
-  double xn, yn;
-
-  for (i = 0; i < n; i++)
-    {
-      WC_to_NDC(x[i], y[i], gkss->cntnr, xn, yn);
-      seg_xform(&xn, &yn);
-      NDC_to_DC(xn, yn, x[i], y[i]);
-    }
+  gks_WC_to_DC(n, x, y, gkss->cntnr, p->a, p->b, p->c, p->d, x, y);
 }
 
 static void draw_path(int n, double *px, double *py, int nc, int *codes)
@@ -2211,10 +2452,16 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
   GKS_UNUSED(lr2);
   GKS_UNUSED(lc);
 
+  lock();
   p = (ws_state_list *)*ptr;
 
   idle = 0;
 
+#ifndef NO_X11
+  /* the contents are not replayed if the workstation is closed or cleared anyway */
+  if (fctid != 2 && p->wtype == 141 && p->redraw_pending) redraw_window(fctid != 3 && fctid != 6);
+#endif
+
   switch (fctid)
     {
     case 2:
@@ -2356,6 +2603,7 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
       p->current_page_written = 1;
       p->page_counter = 0;
       p->scroll = gks_getenv("GKS_SCROLL_ITERM") != NULL;
+      p->sixel_dirty = gks_getenv("GKS_SIXEL_DIRTY") != NULL;
 
       p->transparency = 1.0;
       p->linewidth = p->nominal_size;
@@ -2386,8 +2634,19 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
             }
 
           close_page();
+#ifndef NO_X11
+          if (p->wtype == 141)
+            gks_dl_write_item(&p->dl, fctid, dx, dy, dimx, ia, lr1, r1, lr2, r2, lc, chars, gkss);
+#endif
           free(p->patterns);
           free(p->points);
+          if (p->sixel_palette != NULL)
+            {
+              free(p->sixel_palette);
+              free(p->sixel_lut);
+              free(p->sixel_seen);
+            }
+          if (p->sixel_prev != NULL) free(p->sixel_prev);
           free(p);
         }
       break;
@@ -2404,7 +2663,6 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
 
     case 6:
       /* clear workstation */
-      lock();
       cairo_save(p->cr);
       cairo_reset_clip(p->cr);
       cairo_set_operator(p->cr, CAIRO_OPERATOR_CLEAR);
@@ -2412,14 +2670,12 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
       cairo_restore(p->cr);
       p->empty = 1;
       p->current_page_written = 0;
-      unlock();
       break;
 
     case 8:
       /* update workstation */
       if (ia[1] & GKS_K_WRITE_PAGE_FLAG)
         {
-          lock();
           if (!p->empty)
             {
               write_page();
@@ -2428,7 +2684,6 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
             {
               write_empty_page();
             }
-          unlock();
         }
       break;
 
@@ -2436,11 +2691,9 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
       /* polyline */
       if (p->state == GKS_K_WS_ACTIVE)
         {
-          lock();
           polyline(ia[0], r1, r2);
           p->empty = 0;
           p->current_page_written = 0;
-          unlock();
         }
       break;
 
@@ -2448,11 +2701,9 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
       /* polymarker */
       if (p->state == GKS_K_WS_ACTIVE)
         {
-          lock();
           polymarker(ia[0], r1, r2);
           p->empty = 0;
           p->current_page_written = 0;
-          unlock();
         }
       break;
 
@@ -2460,11 +2711,9 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
       /* text */
       if (p->state == GKS_K_WS_ACTIVE)
         {
-          lock();
           text(r1[0], r2[0], strlen(chars), chars);
           p->empty = 0;
           p->current_page_written = 0;
-          unlock();
         }
       break;
 
@@ -2472,11 +2721,9 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
       /* fill area */
       if (p->state == GKS_K_WS_ACTIVE)
         {
-          lock();
           fillarea(ia[0], r1, r2);
           p->empty = 0;
           p->current_page_written = 0;
-          unlock();
         }
       break;
 
@@ -2487,11 +2734,9 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
         {
           int true_color = fctid == DRAW_IMAGE;
 
-          lock();
           cellarray(r1[0], r1[1], r2[0], r2[1], dx, dy, dimx, ia, true_color);
           p->empty = 0;
           p->current_page_written = 0;
-          unlock();
         }
       break;
 
@@ -2508,43 +2753,32 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
       /* set color representation */
       if (p->state == GKS_K_WS_ACTIVE)
         {
-          lock();
           set_color_rep(ia[1], r1[0], r1[1], r1[2]);
-          unlock();
         }
       break;
 
     case 49:
       /* set window */
-      lock();
       set_window(ia[0], r1[0], r1[1], r2[0], r2[1]);
-      unlock();
       break;
 
     case 50:
       /* set viewport */
-      lock();
       set_viewport(ia[0], r1[0], r1[1], r2[0], r2[1]);
-      unlock();
       break;
 
     case 52:
       /* select normalization transformation */
-      lock();
       select_xform(ia[0]);
-      unlock();
       break;
 
     case 53:
       /* set clipping inidicator */
-      lock();
       set_clipping(ia[0]);
-      unlock();
       break;
 
     case 54:
       /* set workstation window */
-      lock();
       p->window[0] = r1[0];
       p->window[1] = r1[1];
       p->window[2] = r2[0];
@@ -2552,12 +2786,10 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
 
       set_xform();
       init_norm_xform();
-      unlock();
       break;
 
     case 55:
       /* set workstation viewport */
-      lock();
       if (p->viewport[0] != 0 || p->viewport[1] != r1[1] - r1[0] || p->viewport[2] != 0 ||
           p->viewport[3] != r2[1] - r2[0])
         {
@@ -2582,20 +2814,24 @@ void gks_cairoplugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doub
           init_norm_xform();
           set_clip_rect(gkss->cntnr);
         }
-      unlock();
       break;
 
     case 203:
       /* set transparency */
-      lock();
       set_transparency(r1[0]);
-      unlock();
       break;
 
     default:;
     }
 
+#ifndef NO_X11
+  /* keep a display list of the window contents so that it can be redrawn on expose and resize events */
+  if (fctid != 3 && p->wtype == 141)
+    gks_dl_write_item(&p->dl, fctid, dx, dy, dimx, ia, lr1, r1, lr2, r2, lc, chars, gkss);
+#endif
+
   idle = 1;
+  unlock();
 }
 
 #else
@@ -595,17 +595,18 @@ static void stroke(void)
       (y) = SVG_MAX;          \
   }
 
+static gks_dc_points_t dc_points = {NULL, NULL, 0};
+
 static void line_routine(int n, double *px, double *py, int linetype, int tnr)
 {
-  double x, y;
   int i, len;
   double x0, y0, xi, yi, xim1, yim1;
   int dash_list[10];
   char s[100], buf[20];
 
-  WC_to_NDC(px[0], py[0], tnr, x, y);
-  seg_xform(&x, &y);
-  NDC_to_DC(x, y, x0, y0);
+  gks_points_to_DC(&dc_points, n, px, py, tnr, p->a, p->b, p->c, p->d);
+  x0 = dc_points.x[0];
+  y0 = dc_points.y[0];
 
   svg_printf(p->stream,
              "<polyline clip-path=\"url(#clip%02d%d)\" style=\""
@@ -633,9 +634,8 @@ static void line_routine(int n, double *px, double *py, int linetype, int tnr)
 
   for (i = 1; i < n; i++)
     {
-      WC_to_NDC(px[i], py[i], tnr, x, y);
-      seg_xform(&x, &y);
-      NDC_to_DC(x, y, xi, yi);
+      xi = dc_points.x[i];
+      yi = dc_points.y[i];
       fix_coordinates(xi, yi);
 
       if (i == 1 || xi != xim1 || yi != yim1)
@@ -652,7 +652,6 @@ static void line_routine(int n, double *px, double *py, int linetype, int tnr)
 static void fill_routine(int n, double *px, double *py, int tnr)
 {
   int i, j, nan_found = 0;
-  double x, y, ix, iy;
   char *s, line[80];
   size_t slen;
 
@@ -728,6 +727,7 @@ static void fill_routine(int n, double *px, double *py, int tnr)
     }
 
   svg_printf(p->stream, "<path clip-path=\"url(#clip%02d%d)\" d=\"", path_id, p->rect_index);
+  gks_points_to_DC(&dc_points, n, px, py, tnr, p->a, p->b, p->c, p->d);
   for (i = 0; i < n; i++)
     {
       if (px[i] != px[i] && py[i] != py[i])
@@ -735,18 +735,15 @@ static void fill_routine(int n, double *px, double *py, int tnr)
           nan_found = 1;
           continue;
         }
-      WC_to_NDC(px[i], py[i], tnr, x, y);
-      seg_xform(&x, &y);
-      NDC_to_DC(x, y, ix, iy);
 
       if (i == 0 || nan_found)
         {
-          svg_printf(p->stream, "M%g %g ", ix, iy);
+          svg_printf(p->stream, "M%g %g ", dc_points.x[i], dc_points.y[i]);
           nan_found = 0;
         }
       else
         {
-          svg_printf(p->stream, "L%g %g ", ix, iy);
+          svg_printf(p->stream, "L%g %g ", dc_points.x[i], dc_points.y[i]);
         }
     }
   if (p->pattern)
@@ -1077,15 +1074,7 @@ static void cellarray(double xmin, double xmax, double ymin, double ymax, int dx
 
 static void to_DC(int n, double *x, double *y)
 {
-  int i;
-  double xn, yn;
-
-  for (i = 0; i < n; i++)
-    {
-      WC_to_NDC(x[i], y[i], gkss->cntnr, xn, yn);
-      seg_xform(&xn, &yn);
-      NDC_to_DC(xn, yn, x[i], y[i]);
-    }
+  gks_WC_to_DC(n, x, y, gkss->cntnr, p->a, p->b, p->c, p->d, x, y);
 }
 
 static void draw_path(int n, double *px, double *py, int nc, int *codes)
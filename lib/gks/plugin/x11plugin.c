@@ -131,6 +131,11 @@ DLLEXPORT void gks_x11plugin(int fctid, int dx, int dy, int dimx, int *i_arr, in
   yd = sint(p->c * (yn) + p->d + 0.5); \
   update_bbox(xd, yd)
 
+#define DC_to_pixel(xd, yd, ix, iy) \
+  ix = sint((xd) + 0.5);            \
+  iy = sint((yd) + 0.5);            \
+  update_bbox(ix, iy)
+
 #define DC_to_NDC(xd, yd, xn, yn) \
   xn = ((xd)-p->b) / p->a;        \
   yn = ((yd)-p->d) / p->c;
@@ -271,6 +276,12 @@ static int predef_styli[] = {1, 1, 1, 2, 3};
 static XPoint *points = NULL;
 static int max_points = MAX_POINTS;
 
+static XPoint *dots = NULL;
+static XSegment *segments = NULL;
+static XRectangle *rectangles = NULL;
+static int num_dots = 0, num_segments = 0, num_rectangles = 0;
+static int max_dots = 0, max_segments = 0, max_rectangles = 0;
+
 typedef enum
 {
   TypeNone,
@@ -291,6 +302,11 @@ typedef struct
   short x1, y1, x2, y2;
 } Segment;
 
+typedef struct
+{
+  int x1, y1, x2, y2;
+} Area;
+
 typedef struct ws_state_list_struct
 {
   pthread_t thread;
@@ -362,6 +378,11 @@ typedef struct ws_state_list_struct
   Bool xshm;
   Pixmap *frame;
   int nframes;
+  Bool damage_tracking, batch_markers, update_stats;
+  Area damage, extent;
+  int damage_pad;
+  unsigned long last_request;
+  double repainted;
 } ws_state_list;
 
 typedef struct
@@ -555,6 +576,56 @@ static void update_bbox(int x, int y)
       if (y < p->bb->y1) p->bb->y1 = y;
       if (y > p->bb->y2) p->bb->y2 = y;
     }
+  if (p->damage_tracking)
+    {
+      if (x < p->damage.x1) p->damage.x1 = x;
+      if (x > p->damage.x2) p->damage.x2 = x;
+
+      if (y < p->damage.y1) p->damage.y1 = y;
+      if (y > p->damage.y2) p->damage.y2 = y;
+    }
+}
+
+
+static void reset_area(Area *area)
+{
+  area->x1 = area->y1 = 0x7fffffff;
+  area->x2 = area->y2 = -0x7fffffff;
+}
+
+
+static void merge_area(Area *area, Area *other)
+{
+  area->x1 = min(area->x1, other->x1);
+  area->y1 = min(area->y1, other->y1);
+  area->x2 = max(area->x2, other->x2);
+  area->y2 = max(area->y2, other->y2);
+}
+
+
+static void full_damage(void)
+{
+  p->damage.x1 = p->damage.y1 = 0;
+  p->damage.x2 = p->width;
+  p->damage.y2 = p->height;
+}
+
+
+static Bool damaged_rectangle(Area *area, int *x, int *y, int *w, int *h)
+
+/*
+ *  Enlarge the area by the widest line drawn and clip it to the window
+ */
+
+{
+  int pad = p->damage_pad / 2 + 2;
+
+  *x = max(area->x1 - pad, 0);
+  *y = max(area->y1 - pad, 0);
+  *w = min(area->x2 + pad + 1, p->width) - *x;
+  *h = min(area->y2 + pad + 1, p->height) - *y;
+
+  return *w > 0 && *h > 0;
 }
 
 
@@ -994,6 +1065,9 @@ static void configure_viewport(XConfigureEvent *event)
       free_shared_memory();
       create_shared_memory();
 #endif
+      reset_area(&p->extent);
+      full_damage();
+
       p->viewport[0] = 0;
       p->viewport[1] = p->width * p->resolution;
       p->viewport[2] = 0;
@@ -1468,6 +1542,8 @@ static void configure_event(XConfigureEvent *event)
 #endif
       setup_xform(p->window, p->viewport);
       set_clipping(True);
+      reset_area(&p->extent);
+      full_damage();
       return;
     }
   else
@@ -1492,6 +1568,69 @@ static void handle_expose_event(ws_state_list *p)
 }
 
 
+static void copy_damage(void)
+
+/*
+ *  Copy the areas drawn since the last update from the pixmap to the window
+ */
+
+{
+  int x, y, w, h;
+  Area copied;
+
+  if (damaged_rectangle(&p->damage, &x, &y, &w, &h))
+    {
+      if (p->pixmap)
+        {
+          set_clipping(False);
+          XCopyArea(p->dpy, p->pixmap, p->win, p->gc, x, y, w, h, x, y);
+          set_clipping(True);
+          XSync(p->dpy, False);
+          p->repainted += (double)w * h;
+        }
+      copied.x1 = x;
+      copied.y1 = y;
+      copied.x2 = x + w - 1;
+      copied.y2 = y + h - 1;
+      merge_area(&p->extent, &copied);
+    }
+  reset_area(&p->damage);
+  p->damage_pad = p->lwidth;
+}
+
+
+static void clear_damage(void)
+
+/*
+ *  Clear only the areas drawn since the last clear, the rest of the pixmap
+ *  and the window is still blank
+ */
+
+{
+  Area area = p->extent;
+  int x, y, w, h;
+
+  merge_area(&area, &p->damage);
+  if (damaged_rectangle(&area, &x, &y, &w, &h))
+    {
+      if (p->pixmap) XFillRectangle(p->dpy, p->pixmap, p->clear, x, y, w, h);
+      if (p->drawable) XFillRectangle(p->dpy, p->drawable, p->clear, x, y, w, h);
+      if (!p->double_buf) XClearArea(p->dpy, p->win, x, y, w, h, False);
+      p->repainted += (double)w * h;
+
+      /* the cleared area has to be copied to the window by the next update */
+      if (p->double_buf)
+        {
+          p->damage = area;
+          reset_area(&p->extent);
+          return;
+        }
+    }
+  reset_area(&p->damage);
+  reset_area(&p->extent);
+}
+
+
 static void wait_for_expose(void)
 {
   XEvent event;
@@ -1563,6 +1702,95 @@ static void init_norm_xform(void)
 }
 
 
+static void flush_markers(void)
+
+/*
+ *  Send the batched marker primitives with a single request per drawable
+ */
+
+{
+  if (num_dots > 0)
+    {
+      if (p->pixmap) XDrawPoints(p->dpy, p->pixmap, p->gc, dots, num_dots, CoordModeOrigin);
+      if (p->selection) XDrawPoints(p->dpy, p->drawable, p->gc, dots, num_dots, CoordModeOrigin);
+      if (!p->double_buf) XDrawPoints(p->dpy, p->win, p->gc, dots, num_dots, CoordModeOrigin);
+      num_dots = 0;
+    }
+  if (num_segments > 0)
+    {
+      if (p->pixmap) XDrawSegments(p->dpy, p->pixmap, p->gc, segments, num_segments);
+      if (p->selection) XDrawSegments(p->dpy, p->drawable, p->gc, segments, num_segments);
+      if (!p->double_buf) XDrawSegments(p->dpy, p->win, p->gc, segments, num_segments);
+      num_segments = 0;
+    }
+  if (num_rectangles > 0)
+    {
+      if (p->pixmap) XFillRectangles(p->dpy, p->pixmap, p->gc, rectangles, num_rectangles);
+      if (p->selection) XFillRectangles(p->dpy, p->drawable, p->gc, rectangles, num_rectangles);
+      if (!p->double_buf) XFillRectangles(p->dpy, p->win, p->gc, rectangles, num_rectangles);
+      num_rectangles = 0;
+    }
+}
+
+
+static void batch_dot(int x, int y)
+{
+  if (num_dots == max_dots)
+    {
+      max_dots += MAX_POINTS;
+      dots = (XPoint *)gks_realloc(dots, max_dots * sizeof(XPoint));
+    }
+  dots[num_dots].x = x;
+  dots[num_dots].y = y;
+  num_dots++;
+}
+
+
+static void batch_segment(XPoint *line)
+{
+  if (num_segments == max_segments)
+    {
+      max_segments += MAX_POINTS;
+      segments = (XSegment *)gks_realloc(segments, max_segments * sizeof(XSegment));
+    }
+  segments[num_segments].x1 = line[0].x;
+  segments[num_segments].y1 = line[0].y;
+  segments[num_segments].x2 = line[1].x;
+  segments[num_segments].y2 = line[1].y;
+  num_segments++;
+}
+
+
+static Bool batch_rectangle(XPoint *polygon, int n)
+
+/*
+ *  Batch a closed polygon if it is an axis-aligned rectangle, which covers
+ *  the same pixels with XFillRectangle as with XFillPolygon
+ */
+
+{
+  XPoint *q = polygon;
+
+  if (n != 5 || q[4].x != q[0].x || q[4].y != q[0].y) return False;
+  if (!(q[0].x == q[1].x && q[1].y == q[2].y && q[2].x == q[3].x && q[3].y == q[0].y) &&
+      !(q[0].y == q[1].y && q[1].x == q[2].x && q[2].y == q[3].y && q[3].x == q[0].x))
+    return False;
+
+  if (num_rectangles == max_rectangles)
+    {
+      max_rectangles += MAX_POINTS;
+      rectangles = (XRectangle *)gks_realloc(rectangles, max_rectangles * sizeof(XRectangle));
+    }
+  rectangles[num_rectangles].x = min(q[0].x, q[2].x);
+  rectangles[num_rectangles].y = min(q[0].y, q[2].y);
+  rectangles[num_rectangles].width = abs(q[2].x - q[0].x);
+  rectangles[num_rectangles].height = abs(q[2].y - q[0].y);
+  num_rectangles++;
+
+  return True;
+}
+
+
 static void draw_marker(double xn, double yn, int mtype, double mscale)
 {
   int r, d, x, y, i;
@@ -1592,10 +1820,19 @@ static void draw_marker(double xn, double yn, int mtype, double mscale)
   do
     {
       op = marker[mtype][pc];
+
+      /* keep the drawing order if the marker isn't batched */
+      if (op != 1 && op != 2 && op != 4) flush_markers();
+
       switch (op)
         {
 
         case 1: /* point */
+          if (p->batch_markers)
+            {
+              batch_dot(x, y);
+              break;
+            }
           if (p->pixmap) XDrawPoint(p->dpy, p->pixmap, p->gc, x, y);
           if (p->selection) XDrawPoint(p->dpy, p->drawable, p->gc, x, y);
           if (!p->double_buf) XDrawPoint(p->dpy, p->win, p->gc, x, y);
@@ -1610,6 +1847,12 @@ static void draw_marker(double xn, double yn, int mtype, double mscale)
               points[i].x = nint(x - xr);
               points[i].y = nint(y + yr);
             }
+          if (p->batch_markers)
+            {
+              batch_segment(points);
+              pc += 4;
+              break;
+            }
           if (p->pixmap) XDrawLines(p->dpy, p->pixmap, p->gc, points, 2, CoordModeOrigin);
           if (p->selection) XDrawLines(p->dpy, p->drawable, p->gc, points, 2, CoordModeOrigin);
           if (!p->double_buf) XDrawLines(p->dpy, p->win, p->gc, points, 2, CoordModeOrigin);
@@ -1640,6 +1883,15 @@ static void draw_marker(double xn, double yn, int mtype, double mscale)
               points[i].x = nint(x - xr);
               points[i].y = nint(y + yr);
             }
+          if (p->batch_markers)
+            {
+              if (batch_rectangle(points, marker[mtype][pc + 1]))
+                {
+                  pc += 1 + 2 * marker[mtype][pc + 1];
+                  break;
+                }
+              flush_markers();
+            }
           if (p->pixmap)
             XFillPolygon(p->dpy, p->pixmap, p->gc, points, marker[mtype][pc + 1], Complex, CoordModeOrigin);
           if (p->selection)
@@ -1691,10 +1943,12 @@ static void draw_marker(double xn, double yn, int mtype, double mscale)
 }
 
 
+static gks_dc_points_t dc_points = {NULL, NULL, 0};
+
+
 static void draw_points(int n, double *px, double *py, int tnr)
 {
   int i;
-  double xn, yn;
 
   if (n > max_points)
     {
@@ -1702,11 +1956,10 @@ static void draw_points(int n, double *px, double *py, int tnr)
       max_points = n;
     }
 
+  gks_points_to_DC(&dc_points, n, px, py, tnr, p->a, p->b, p->c, p->d);
   for (i = 0; i < n; i++)
     {
-      WC_to_NDC(px[i], py[i], tnr, xn, yn);
-      seg_xform(&xn, &yn);
-      NDC_to_DC(xn, yn, points[i].x, points[i].y);
+      DC_to_pixel(dc_points.x[i], dc_points.y[i], points[i].x, points[i].y);
     }
 
   if (p->pixmap) XDrawPoints(p->dpy, p->pixmap, p->gc, points, n, CoordModeOrigin);
@@ -1744,6 +1997,7 @@ static void marker_routine(int n, double *px, double *py, int tnr, int mtype, do
 
           if (draw) draw_marker(x, y, mtype, mscale);
         }
+      flush_markers();
       set_clipping(True);
     }
   else
@@ -1764,6 +2018,8 @@ static void set_line_attr(int linetype, double linewidth)
   else
     width = 0;
 
+  if ((int)width > p->damage_pad) p->damage_pad = width;
+
   if (linetype != p->ltype || width != p->lwidth)
     {
       if (linetype != GKS_K_LINETYPE_SOLID)
@@ -1858,7 +2114,6 @@ static void clip_line(int *x0, int *x1, int *y0, int *y1, Bool *visible, Bool *c
 
 static void line_routine(int n, double *px, double *py, int linetype, int tnr)
 {
-  double x1, y1;
   int i, j, npoints, m;
   int ix0, iy0, ix1, iy1, x, y;
   Bool visible, clip;
@@ -1869,9 +2124,8 @@ static void line_routine(int n, double *px, double *py, int linetype, int tnr)
       max_points = n;
     }
 
-  WC_to_NDC(px[0], py[0], tnr, x1, y1);
-  seg_xform(&x1, &y1);
-  NDC_to_DC(x1, y1, ix1, iy1);
+  gks_points_to_DC(&dc_points, n, px, py, tnr, p->a, p->b, p->c, p->d);
+  DC_to_pixel(dc_points.x[0], dc_points.y[0], ix1, iy1);
 
   npoints = 0;
   m = linetype ? n : n + 1;
@@ -1883,9 +2137,7 @@ static void line_routine(int n, double *px, double *py, int linetype, int tnr)
       ix0 = ix1;
       iy0 = iy1;
 
-      WC_to_NDC(px[i], py[i], tnr, x1, y1);
-      seg_xform(&x1, &y1);
-      NDC_to_DC(x1, y1, ix1, iy1);
+      DC_to_pixel(dc_points.x[i], dc_points.y[i], ix1, iy1);
 
       x = ix1;
       y = iy1;
@@ -1972,7 +2224,6 @@ static void polymarker(int n, double *px, double *py)
 
 static void fill_routine(int n, double *px, double *py, int tnr)
 {
-  double x, y;
   int i, npoints;
 
   if (n > max_points)
@@ -1982,11 +2233,10 @@ static void fill_routine(int n, double *px, double *py, int tnr)
     }
 
   npoints = n;
+  gks_points_to_DC(&dc_points, n, px, py, tnr, p->a, p->b, p->c, p->d);
   for (i = 0; i < n; i++)
     {
-      WC_to_NDC(px[i], py[i], tnr, x, y);
-      seg_xform(&x, &y);
-      NDC_to_DC(x, y, points[i].x, points[i].y);
+      DC_to_pixel(dc_points.x[i], dc_points.y[i], points[i].x, points[i].y);
     }
 
   if (npoints > 1)
@@ -4028,6 +4278,9 @@ void gks_x11plugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, double
       p->packed_ca = gks_getenv("GKS_PACKED_CELL_ARRAY") ? True : False;
       p->double_buf = gks_getenv("GKS_DOUBLE_BUF") ? True : False;
       p->shape = gks_getenv("GKS_CONVEX_SHAPE") ? Convex : Complex;
+      p->damage_tracking = gks_getenv("GKS_DAMAGE_TRACKING") ? True : False;
+      p->batch_markers = gks_getenv("GKS_BATCH_MARKERS") ? True : False;
+      p->update_stats = gks_getenv("GKS_UPDATE_STATS") ? True : False;
       p->widget = (Widget)NULL;
       p->conid = ia[1];
       p->wstype = ia[2];
@@ -4150,6 +4403,11 @@ void gks_x11plugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, double
       p->bounding_box.x2 = p->bounding_box.y2 = -32767;
       p->drawable = 0;
 
+      reset_area(&p->damage);
+      reset_area(&p->extent);
+      p->damage_pad = 0;
+      p->repainted = 0;
+
       p->type = TypeLocal;
       p->px = Undefined;
       p->py = Undefined;
@@ -4173,6 +4431,8 @@ void gks_x11plugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, double
       init_norm_xform();
       set_clipping(True);
 
+      p->last_request = NextRequest(p->dpy);
+
       if (p->new_win)
         {
           pthread_mutex_init(&p->mutex, NULL);
@@ -4277,9 +4537,15 @@ void gks_x11plugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, double
             }
         }
 
-      if (p->pixmap) XFillRectangle(p->dpy, p->pixmap, p->clear, 0, 0, p->width, p->height);
-      if (p->drawable) XFillRectangle(p->dpy, p->drawable, p->clear, 0, 0, p->width, p->height);
-      if (!p->double_buf) XClearWindow(p->dpy, p->win);
+      if (p->damage_tracking && !p->frame)
+        clear_damage();
+      else
+        {
+          if (p->pixmap) XFillRectangle(p->dpy, p->pixmap, p->clear, 0, 0, p->width, p->height);
+          if (p->drawable) XFillRectangle(p->dpy, p->drawable, p->clear, 0, 0, p->width, p->height);
+          if (!p->double_buf) XClearWindow(p->dpy, p->win);
+          p->repainted += (double)p->width * p->height;
+        }
 
       p->empty = True;
 
@@ -4292,10 +4558,27 @@ void gks_x11plugin(int fctid, int dx, int dy, int dimx, int *ia, int lr1, double
        *  Update workstation
        */
       lock();
-      if (p->double_buf && (ia[1] & GKS_K_PERFORM_FLAG)) handle_expose_event(p);
+      if (p->double_buf && (ia[1] & GKS_K_PERFORM_FLAG))
+        {
+          if (p->damage_tracking)
+            copy_damage();
+          else
+            {
+              handle_expose_event(p);
+              p->repainted += (double)p->width * p->height;
+            }
+        }
 
       update();
 
+      if (p->update_stats)
+        {
+          fprintf(stderr, "GKS: %.0f pixels repainted, %lu X requests\n", p->repainted,
+                  NextRequest(p->dpy) - p->last_request);
+          p->repainted = 0;
+          p->last_request = NextRequest(p->dpy);
+        }
+
       if (p->state == GKS_K_WS_ACTIVE)
         {
           if (p->error)
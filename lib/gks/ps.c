@@ -23,6 +23,10 @@
 #include "gks.h"
 #include "gkscore.h"
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 #ifndef MIN
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
 #endif
@@ -132,9 +136,7 @@ typedef struct ws_state_list_t
   int len, size, column, saved_len, saved_column;
   char *buffer;
 
-  unsigned char ascii85_buffer[10];
-  char a85line[100];
-  long a85offset;
+  int level;
 
   double window[4], viewpt[4];
 
@@ -242,197 +244,187 @@ static void packb(const char *buff)
     }
 }
 
-static char *Ascii85Tuple(unsigned char *data)
+static void Ascii85Encode(const unsigned char *data, size_t length)
 {
-  static char tuple[6];
-  long i, x;
-  unsigned long code, quantum;
+  char line[80];
+  int column = 0, k;
+  size_t i, n;
+  unsigned char last[4];
+  unsigned long code;
 
-  code = ((((unsigned long)data[0] << 8) | (unsigned long)data[1]) << 16) | ((unsigned long)data[2] << 8) |
-         (unsigned long)data[3];
-  if (code == 0L)
-    {
-      tuple[0] = 'z';
-      tuple[1] = '\0';
-      return (tuple);
-    }
-  quantum = 85UL * 85UL * 85UL * 85UL;
-  for (i = 0; i < 4; i++)
+  for (i = 0; i + 4 <= length; i += 4)
     {
-      x = (long)(code / quantum);
-      code -= quantum * x;
-      tuple[i] = (char)(x + (int)'!');
-      quantum /= 85L;
+      code = ((unsigned long)data[i] << 24) | ((unsigned long)data[i + 1] << 16) | ((unsigned long)data[i + 2] << 8) |
+             (unsigned long)data[i + 3];
+      if (code == 0)
+        line[column++] = 'z';
+      else
+        {
+          for (k = 4; k >= 0; k--)
+            {
+              line[column + k] = (char)(code % 85 + '!');
+              code /= 85;
+            }
+          column += 5;
+        }
+      if (column >= 70)
+        {
+          line[column] = '\0';
+          packb(line);
+          column = 0;
+        }
     }
-  tuple[4] = (char)((code % 85L) + (int)'!');
-  tuple[5] = '\0';
-  return (tuple);
-}
-
-static void Ascii85Initialize(void)
-{
-  p->a85offset = 0L;
-  p->a85line[0] = '\0';
-}
-
-static void Ascii85Flush(void)
-{
-  char *tuple;
 
-  packb(p->a85line);
-  if (p->a85offset > 0)
+  /* a final partial group of n bytes is written as n + 1 characters */
+  n = length - i;
+  if (n > 0)
     {
-      p->ascii85_buffer[p->a85offset] = '\0';
-      p->ascii85_buffer[p->a85offset + 1] = '\0';
-      p->ascii85_buffer[p->a85offset + 2] = '\0';
-      tuple = Ascii85Tuple(p->ascii85_buffer);
-      packb(*tuple == 'z' ? (char *)"!!!!" : tuple);
-    }
-  packb("~>");
-}
-
-static void Ascii85Encode(unsigned char code)
-{
-  long n, i = 0;
-  char *q;
-  unsigned char *c;
-  char b[100];
-
-  p->ascii85_buffer[p->a85offset] = code;
-  p->a85offset++;
-  if (p->a85offset < 4) return;
-  c = p->ascii85_buffer;
-  for (n = p->a85offset; n >= 4; n -= 4)
-    {
-      for (q = Ascii85Tuple(c); *q; q++) b[i++] = *q;
-      c += 8;
+      memset(last, 0, 4);
+      memcpy(last, data + i, n);
+      code = ((unsigned long)last[0] << 24) | ((unsigned long)last[1] << 16) | ((unsigned long)last[2] << 8) |
+             (unsigned long)last[3];
+      for (k = 4; k >= 0; k--)
+        {
+          if (k <= (int)n) line[column + k] = (char)(code % 85 + '!');
+          code /= 85;
+        }
+      column += (int)n + 1;
     }
-  p->a85offset = n;
-  c -= 4;
-  b[i] = '\0';
-  strcat(p->a85line, b);
-  if (strlen(p->a85line) >= 75)
+  if (column > 0)
     {
-      packb(p->a85line);
-      p->a85line[0] = '\0';
+      line[column] = '\0';
+      packb(line);
     }
-  for (n = 0; n < 4; n++) p->ascii85_buffer[n] = (*c++);
+  packb("~>");
 }
 
-static unsigned int LZWEncodeImage(unsigned int number_pixels, unsigned char *pixels)
+static unsigned char *LZWEncodeImage(size_t number_pixels, const unsigned char *pixels, size_t *length)
 {
-#define LZWClr 256UL /* Clear Table Marker */
-#define LZWEod 257UL /* End of Data marker */
-#define OutputCode(code)                                    \
-  {                                                         \
-    accumulator += code << (32 - code_width - number_bits); \
-    number_bits += code_width;                              \
-    while (number_bits >= 8)                                \
-      {                                                     \
-        Ascii85Encode((unsigned char)(accumulator >> 24));  \
-        accumulator = accumulator << 8;                     \
-        number_bits -= 8;                                   \
-      }                                                     \
+#define LZWClr 256L /* Clear Table Marker */
+#define LZWEod 257L /* End of Data marker */
+#define LZWHashSize 5003 /* prime, 80% occupancy for 4096 codes */
+#define LZWHashShift 4
+#define OutputCode(code)                                                     \
+  {                                                                          \
+    accumulator |= (unsigned long)(code) << (32 - code_width - number_bits); \
+    number_bits += code_width;                                               \
+    while (number_bits >= 8)                                                 \
+      {                                                                      \
+        data[nbytes++] = (unsigned char)(accumulator >> 24);                 \
+        accumulator = (accumulator << 8) & 0xffffffffUL;                     \
+        number_bits -= 8;                                                    \
+      }                                                                      \
   }
 
-  typedef struct _TableType
-  {
-    long prefix, suffix, next;
-  } TableType;
-
-  long index;
-  long i;
-  TableType *table;
-  unsigned long accumulator, number_bits, code_width, last_code, next_index;
-
   /*
-   * Allocate string table.
+   * The string table is kept as an open addressing hash table of
+   * (prefix, suffix) keys, probed the same way as in gks_compress.
    */
+  long htab[LZWHashSize];
+  unsigned short codetab[LZWHashSize];
 
-  table = (TableType *)malloc((1 << 12) * sizeof(*table));
-  if (table == (TableType *)NULL) return (0);
+  unsigned char *data;
+  size_t nbytes = 0, i;
+  unsigned long accumulator = 0;
+  int number_bits = 0, code_width = 9, h, disp;
+  long fcode, ent, next_index, c;
+
+  data = (unsigned char *)malloc(number_pixels + number_pixels / 2 + number_pixels / 1024 + 64);
+  if (data == NULL) return NULL;
 
-  /*
-   * Initialize variables.
-   */
-  accumulator = 0;
-  code_width = 9;
-  number_bits = 0;
-  last_code = 0;
-  Ascii85Initialize();
   OutputCode(LZWClr);
-  for (index = 0; index < 256; index++)
-    {
-      table[index].prefix = (-1);
-      table[index].suffix = (short)index;
-      table[index].next = (-1);
-    }
+  for (h = 0; h < LZWHashSize; h++) htab[h] = -1;
   next_index = LZWEod + 1;
-  code_width = 9;
-  last_code = (unsigned long)pixels[0];
-  for (i = 1; i < (long)number_pixels; i++)
+
+  ent = number_pixels > 0 ? (long)pixels[0] : 0;
+  for (i = 1; i < number_pixels; i++)
     {
+      c = (long)pixels[i];
+      fcode = (c << 12) + ent;
+      h = (int)((c << LZWHashShift) ^ ent);
+      if (htab[h] == fcode)
+        {
+          ent = codetab[h];
+          continue;
+        }
+      if (htab[h] >= 0)
+        {
+          disp = h == 0 ? 1 : LZWHashSize - h;
+          do
+            {
+              h -= disp;
+              if (h < 0) h += LZWHashSize;
+            }
+          while (htab[h] != fcode && htab[h] >= 0);
+          if (htab[h] == fcode)
+            {
+              ent = codetab[h];
+              continue;
+            }
+        }
+
       /*
-       * Find string.
+       * Add string.
        */
-      index = (long)last_code;
-      while (index != -1)
-        if ((table[index].prefix != (long)last_code) || (table[index].suffix != (long)pixels[i]))
-          index = table[index].next;
-        else
-          {
-            last_code = (unsigned long)index;
-            break;
-          }
-      if (last_code != (unsigned long)index)
+      OutputCode(ent);
+      htab[h] = fcode;
+      codetab[h] = (unsigned short)next_index++;
+
+      /*
+       * Did we just move up to next bit width?
+       */
+      if ((next_index >> code_width) != 0)
         {
-          /*
-           * Add string.
-           */
-          OutputCode(last_code);
-          table[next_index].prefix = (long)last_code;
-          table[next_index].suffix = (short)pixels[i];
-          table[next_index].next = table[last_code].next;
-          table[last_code].next = (long)next_index;
-          next_index++;
-          /*
-           * Did we just move up to next bit width?
-           */
-          if ((next_index >> code_width) != 0)
+          code_width++;
+          if (code_width > 12)
             {
-              code_width++;
-              if (code_width > 12)
-                {
-                  /*
-                   * Did we overflow the max bit width?
-                   */
-                  code_width--;
-                  OutputCode(LZWClr);
-                  for (index = 0; index < 256; index++)
-                    {
-                      table[index].prefix = (-1);
-                      table[index].suffix = index;
-                      table[index].next = (-1);
-                    }
-                  next_index = LZWEod + 1;
-                  code_width = 9;
-                }
+              /*
+               * Did we overflow the max bit width?
+               */
+              code_width--;
+              OutputCode(LZWClr);
+              for (h = 0; h < LZWHashSize; h++) htab[h] = -1;
+              next_index = LZWEod + 1;
+              code_width = 9;
             }
-          last_code = (unsigned long)pixels[i];
         }
+      ent = c;
     }
   /*
    * Flush tables.
    */
-  OutputCode(last_code);
+  if (number_pixels > 0) OutputCode(ent);
   OutputCode(LZWEod);
-  if (number_bits != 0) Ascii85Encode((unsigned char)(accumulator >> 24));
+  if (number_bits != 0) data[nbytes++] = (unsigned char)(accumulator >> 24);
+
+  *length = nbytes;
+
+  return data;
+
+#undef OutputCode
+}
 
-  Ascii85Flush();
-  free(table);
+#ifdef HAVE_ZLIB
+static unsigned char *FlateEncodeImage(size_t number_pixels, const unsigned char *pixels, size_t *length)
+{
+  unsigned char *data;
+  uLongf size;
+
+  size = compressBound((uLong)number_pixels);
+  data = (unsigned char *)malloc(size);
+  if (data == NULL) return NULL;
+
+  if (compress2(data, &size, pixels, (uLong)number_pixels, Z_BEST_SPEED) != Z_OK)
+    {
+      gks_perror("compression failed");
+      free(data);
+      return NULL;
+    }
+  *length = size;
 
-  return (0);
+  return data;
 }
+#endif
 
 static void set_xform(double *wn, double *vp)
 {
@@ -698,6 +690,7 @@ static void ps_header(void)
   writefile("%%+Copyright @ 1993-2007, J.Heinen\n");
   snprintf(buffer, 200, "%%%%Pages: %d\n", p->pages);
   writefile(buffer);
+  if (p->level >= 3) writefile("%%LanguageLevel: 3\n");
 }
 
 static void set_color(int color, int wtype)
@@ -876,6 +869,29 @@ static void get_magstep(double *magstep, int *dpi)
   *dpi = 75;
 }
 
+static int get_level(void)
+{
+  char *env;
+  int level = 2;
+
+#ifdef HAVE_ZLIB
+  if ((env = (char *)gks_getenv("GKS_PS_LEVEL")) != NULL)
+    {
+      level = atoi(env);
+      if (level < 2 || level > 3)
+        {
+          gks_perror("invalid PostScript language level (%s)", env);
+          level = 2;
+        }
+    }
+#else
+  env = NULL;
+  GKS_UNUSED(env);
+#endif
+
+  return level;
+}
+
 static void ps_init(int *pages)
 {
   int dpi, landscape;
@@ -1276,7 +1292,8 @@ static void cell_array(double xmin, double xmax, double ymin, double ymax, int d
                        int wtype, int true_color)
 {
   char buffer[100];
-  unsigned char *buf, *bufP;
+  unsigned char *buf, *bufP, *data;
+  size_t length;
   double x1, x2, y1, y2;
   int w, h, x, y;
 
@@ -1304,7 +1321,10 @@ static void cell_array(double xmin, double xmax, double ymin, double ymax, int d
   set_clip(gkss->viewport[gkss->clip == GKS_K_CLIP ? tnr : 0]);
 
   packb("/RawData currentfile /ASCII85Decode filter def");
-  packb("/Data RawData << >> /LZWDecode filter def");
+  if (p->level >= 3)
+    packb("/Data RawData << >> /FlateDecode filter def");
+  else
+    packb("/Data RawData << >> /LZWDecode filter def");
 
   snprintf(buffer, 100, "%d %d translate", x, y);
   packb(buffer);
@@ -1353,9 +1373,20 @@ static void cell_array(double xmin, double xmax, double ymin, double ymax, int d
             rgb2color(ci, &bufP, wtype);
         }
     }
-  LZWEncodeImage(len, buf);
+#ifdef HAVE_ZLIB
+  if (p->level >= 3)
+    data = FlateEncodeImage(len, buf, &length);
+  else
+#endif
+    data = LZWEncodeImage(len, buf, &length);
   free(buf);
 
+  if (data != NULL)
+    {
+      Ascii85Encode(data, length);
+      free(data);
+    }
+
   packb("grestore");
 }
 
@@ -1419,9 +1450,10 @@ static void text_routine(double *x, double *y, int nchars, char *chars)
   gks_free(latin1_str);
 }
 
+static gks_dc_points_t dc_points = {NULL, NULL, 0};
+
 static void fill_routine(int n, double *px, double *py, int tnr)
 {
-  double x, y;
   char buffer[50];
   int i, jx, jy, rx, ry, nan_found = 0;
 
@@ -1429,8 +1461,9 @@ static void fill_routine(int n, double *px, double *py, int tnr)
 
   set_clip(gkss->viewport[gkss->clip == GKS_K_CLIP ? tnr : 0]);
 
-  WC_to_NDC(px[0], py[0], tnr, x, y);
-  NDC_to_DC(x, y, p->ix, p->iy);
+  gks_points_to_DC(&dc_points, n, px, py, tnr, p->a, p->b, p->c, p->d);
+  p->ix = dc_points.x[0];
+  p->iy = dc_points.y[0];
 
   snprintf(buffer, 50, "np %d %d m", p->ix, p->iy);
   packb(buffer);
@@ -1440,8 +1473,8 @@ static void fill_routine(int n, double *px, double *py, int tnr)
     {
       jx = p->ix;
       jy = p->iy;
-      WC_to_NDC(px[i], py[i], tnr, x, y);
-      NDC_to_DC(x, y, p->ix, p->iy);
+      p->ix = dc_points.x[i];
+      p->iy = dc_points.y[i];
 
       if (i == 1 || p->ix != jx || p->iy != jy)
         {
@@ -1501,15 +1534,7 @@ static void line_routine(int n, double *px, double *py, int ltype, int tnr)
 
 static void to_DC(int n, double *x, double *y)
 {
-  int i;
-  double xn, yn;
-
-  for (i = 0; i < n; i++)
-    {
-      WC_to_NDC(x[i], y[i], gkss->cntnr, xn, yn);
-      seg_xform(&xn, &yn);
-      NDC_to_DC(xn, yn, x[i], y[i]);
-    }
+  gks_WC_to_DC(n, x, y, gkss->cntnr, p->a, p->b, p->c, p->d, x, y);
 }
 
 static void draw_path(int n, double *px, double *py, int nc, int *codes)
@@ -1916,6 +1941,8 @@ void gks_drv_ps(int fctid, int dx, int dy, int dimx, int *ia, int lr1, double *r
       p->size = SIZE_INCREMENT;
       p->buffer = (char *)calloc(1, p->size);
 
+      p->level = get_level();
+
       init_norm_xform();
       set_connection(ia[1], ia[2]);
       set_colortable();
@@ -11,6 +11,17 @@
 #include <QDesktopWidget>
 #endif
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#ifndef _WIN32
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#include <unistd.h>
+#endif
+
 #include "gkscore.h"
 
 #include "gksserver.h"
@@ -37,7 +48,8 @@ inline QRect &operator-=(QRect &rect, const QMargins &margins)
 
 
 GKSConnection::GKSConnection(QTcpSocket *socket)
-    : socket(socket), widget(NULL), dl(NULL), dl_size(0), socket_function(SocketFunction::unknown)
+    : socket(socket), widget(NULL), dl(NULL), dl_size(0), delta_header_read(false), shm(NULL), shm_size(0),
+      socket_function(SocketFunction::unknown)
 {
   ++index;
   connect(socket, SIGNAL(readyRead()), this, SLOT(readClient()));
@@ -59,6 +71,12 @@ GKSConnection::GKSConnection(QTcpSocket *socket)
 
 GKSConnection::~GKSConnection()
 {
+#ifndef _WIN32
+  if (shm != NULL)
+    {
+      munmap(shm, shm_size);
+    }
+#endif
   socket->close();
   delete socket;
   if (widget != NULL)
@@ -104,6 +122,104 @@ void GKSConnection::readClient()
           dl_size = 0;
           socket_function = SocketFunction::unknown;
           break;
+        case SocketFunction::draw_delta:
+          /* header: offset in the retained display list, size of the data and number of transferred bytes (the fourth
+           * element of `delta_header` is only used by `draw_shm`) */
+          if (!delta_header_read)
+            {
+              if (socket->bytesAvailable() < (long)(3 * sizeof(int))) return;
+              socket->read((char *)delta_header, 3 * sizeof(int));
+              delta_header_read = true;
+            }
+          if (socket->bytesAvailable() < delta_header[2]) return;
+          {
+            char *delta_data = new char[delta_header[1] > 0 ? delta_header[1] : 1];
+            bool valid = true;
+            if (delta_header[2] != delta_header[1])
+              {
+                char *compressed = new char[delta_header[2]];
+                socket->read(compressed, delta_header[2]);
+#ifdef HAVE_ZLIB
+                uLongf size = delta_header[1];
+                valid = uncompress((Bytef *)delta_data, &size, (Bytef *)compressed, delta_header[2]) == Z_OK &&
+                        (int)size == delta_header[1];
+#else
+                valid = false;
+#endif
+                delete[] compressed;
+              }
+            else
+              {
+                socket->read(delta_data, delta_header[1]);
+              }
+            if (valid)
+              {
+                if (widget == NULL)
+                  {
+                    newWidget();
+                  }
+                emit(delta(delta_header[0], delta_data, delta_header[1]));
+              }
+            else
+              {
+                qWarning("GKSserver: Failed to decompress display list data");
+              }
+            delete[] delta_data;
+          }
+          delta_header_read = false;
+          socket_function = SocketFunction::unknown;
+          break;
+        case SocketFunction::open_shm:
+          /* the client sends the length of the shared memory object name followed by the name */
+          if (!delta_header_read)
+            {
+              if (socket->bytesAvailable() < (long)sizeof(int)) return;
+              socket->read((char *)delta_header, sizeof(int));
+              delta_header_read = true;
+            }
+          if (socket->bytesAvailable() < delta_header[0]) return;
+          {
+            std::string name(delta_header[0], '\0');
+            socket->read(&name[0], delta_header[0]);
+            char reply[1]{static_cast<char>(openSharedMemory(name.c_str()) ? SocketFunction::open_shm
+                                                                            : SocketFunction::unknown)};
+            socket->write(reply, sizeof(reply));
+            socket->flush();
+          }
+          delta_header_read = false;
+          socket_function = SocketFunction::unknown;
+          break;
+        case SocketFunction::draw_shm:
+          /* header: offset in the retained display list, size of the data, position in the ring and new tail */
+          if (socket->bytesAvailable() < (long)sizeof(delta_header)) return;
+          socket->read((char *)delta_header, sizeof(delta_header));
+          if (shm != NULL)
+            {
+              gks_shm_ring_t *ring = static_cast<gks_shm_ring_t *>(shm);
+              unsigned int ring_size = (unsigned int)(shm_size - sizeof(gks_shm_ring_t));
+              unsigned int size = delta_header[1], pos = delta_header[2], tail = delta_header[3];
+              /* The ring is writable by the client, so the frame must lie within the mapped ring and the new tail
+               * must not pass the head (`head` and `tail` are running byte counters) */
+              if (delta_header[1] < 0 || delta_header[2] < 0 || size > ring_size || pos > ring_size - size ||
+                  tail - ring->tail > ring->head - ring->tail || ring->head - tail > ring_size)
+                {
+                  qWarning("GKSserver: Invalid shared memory frame");
+                  socket_function = SocketFunction::unknown;
+                  break;
+                }
+              if (widget == NULL)
+                {
+                  newWidget();
+                }
+              /* the frame is copied from the ring into the retained display list, then its space is released */
+              emit(delta(delta_header[0], reinterpret_cast<char *>(ring + 1) + delta_header[2], delta_header[1]));
+#ifdef __GNUC__
+              __sync_synchronize();
+#endif
+              ring->tail = delta_header[3];
+            }
+          socket_function = SocketFunction::unknown;
+          break;
         case SocketFunction::is_alive:
           {
             char reply[1]{static_cast<char>(SocketFunction::is_alive)};
@@ -112,6 +228,18 @@ void GKSConnection::readClient()
             socket_function = SocketFunction::unknown;
           }
           break;
+        case SocketFunction::inq_features:
+          {
+            /* only sent by clients which know this request, so the connection information above stays unchanged */
+            int reply[2]{sizeof(reply), SocketFeature::draw_delta};
+#ifndef _WIN32
+            reply[1] |= SocketFeature::shm;
+#endif
+            socket->write(reinterpret_cast<const char *>(reply), sizeof(reply));
+            socket->flush();
+            socket_function = SocketFunction::unknown;
+          }
+          break;
         case SocketFunction::close_window:
           if (widget != NULL)
             {
@@ -184,6 +312,46 @@ void GKSConnection::readClient()
     }
 }
 
+bool GKSConnection::openSharedMemory(const char *name)
+{
+#ifndef _WIN32
+  int fd = shm_open(name, O_RDWR, 0);
+  struct stat buf;
+  void *mem;
+
+  if (fd < 0)
+    {
+      return false;
+    }
+  if (fstat(fd, &buf) != 0 || buf.st_size < (off_t)sizeof(gks_shm_ring_t))
+    {
+      ::close(fd);
+      return false;
+    }
+  mem = mmap(NULL, buf.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  ::close(fd);
+  if (mem == MAP_FAILED)
+    {
+      return false;
+    }
+  gks_shm_ring_t *ring = static_cast<gks_shm_ring_t *>(mem);
+  if (ring->magic != GKS_SHM_RING_MAGIC || sizeof(gks_shm_ring_t) + ring->size != (size_t)buf.st_size)
+    {
+      munmap(mem, buf.st_size);
+      return false;
+    }
+  if (shm != NULL)
+    {
+      munmap(shm, shm_size);
+    }
+  shm = mem;
+  shm_size = buf.st_size;
+  return true;
+#else
+  return false;
+#endif
+}
+
 void GKSConnection::destroyedWidget()
 {
   widget = NULL;
@@ -245,6 +413,9 @@ void GKSConnection::newWidget()
                  valid_position_area.top());
   widget->move(widget_position);
   connect(this, SIGNAL(data(char *)), widget, SLOT(interpret(char *)));
+  /* the delta data is only valid during the call (e.g. a frame in the shared memory ring), so it must be direct */
+  connect(this, SIGNAL(delta(int, const char *, int)), widget, SLOT(interpret_delta(int, const char *, int)),
+          Qt::DirectConnection);
 
   widget->setAttribute(Qt::WA_QuitOnClose, false);
   widget->setAttribute(Qt::WA_DeleteOnClose);
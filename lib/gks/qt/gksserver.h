@@ -20,7 +20,21 @@ struct SocketFunction
     close_window = 4,
     is_running = 5,
     inq_ws_state = 6,
-    sample_locator = 7
+    sample_locator = 7,
+    draw_delta = 8,
+    open_shm = 9,
+    draw_shm = 10,
+    inq_features = 11
+  };
+};
+
+
+struct SocketFeature
+{
+  enum Enum
+  {
+    draw_delta = 1,
+    shm = 2
   };
 };
 
@@ -33,6 +47,7 @@ public:
   GKSConnection(QTcpSocket *socket);
   virtual ~GKSConnection();
   void newWidget();
+  bool openSharedMemory(const char *name);
 
 public slots:
   void readClient();
@@ -42,6 +57,7 @@ public slots:
 
 signals:
   void data(char *);
+  void delta(int offset, const char *data, int nbytes);
   void close(GKSConnection &connection);
   void requestApplicationShutdown(GKSConnection &connection);
 
@@ -53,6 +69,10 @@ private:
   GKSWidget *widget;
   char *dl;
   unsigned int dl_size;
+  int delta_header[4];
+  bool delta_header_read;
+  void *shm;
+  size_t shm_size;
   SocketFunction::Enum socket_function;
 };
 
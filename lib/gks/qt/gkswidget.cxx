@@ -72,7 +72,8 @@ static void resize_pixmap(int width, int height)
 }
 
 GKSWidget::GKSWidget(QWidget *parent)
-    : QWidget(parent), is_mapped(false), resize_requested_by_application(false), dl(NULL)
+    : QWidget(parent), is_mapped(false), resize_requested_by_application(false), dl(NULL), dl_size(0), dl_capacity(0),
+      painted(0)
 {
   widget_state_list = new ws_state_list;
   p = widget_state_list;
@@ -127,8 +128,17 @@ void GKSWidget::paintEvent(QPaintEvent *)
     {
       QPainter painter(this);
       p = widget_state_list;
-      p->pm->fill(Qt::white);
-      interp(dl);
+      if (painted == 0 || p->memory_plugin_wstype)
+        {
+          p->pm->fill(Qt::white);
+          interp(dl);
+        }
+      else if (painted < dl_size)
+        {
+          /* the pixmap still shows the beginning of the display list, only render the new items */
+          interp(dl + painted);
+        }
+      painted = dl_size;
       painter.drawPixmap(0, 0, *(p->pm));
       if (p->memory_plugin_wstype)
         {
@@ -157,6 +167,7 @@ void GKSWidget::resizeEvent(QResizeEvent *event)
   p->mheight = (double)height() / p->device_dpi_y * 0.0254;
   p->nominal_size = min(width(), height()) / 500.0;
   resize_pixmap(nint(width()), nint(height()));
+  painted = 0;
   // Ignore the initial resize event (in this case `width()` and `height()` of the oldSize are `-1`))
   if ((event->oldSize().width() > 0 && event->oldSize().height() > 0) && !resize_requested_by_application)
     {
@@ -165,10 +176,10 @@ void GKSWidget::resizeEvent(QResizeEvent *event)
   resize_requested_by_application = false;
 }
 
-void GKSWidget::set_window_size_from_dl()
+void GKSWidget::set_window_size_from_dl(int start)
 {
   p = widget_state_list;
-  int sp = 0, *len, *f;
+  int sp = start, *len, *f;
   double *vp;
   len = (int *)(dl + sp);
   while (*len)
@@ -205,10 +216,22 @@ void GKSWidget::set_window_size_from_dl()
 
 void GKSWidget::interpret(char *dl)
 {
+  int *len;
+
   p = widget_state_list;
   delete[] this->dl;
   this->dl = dl;
 
+  dl_size = 0;
+  len = (int *)dl;
+  while (*len)
+    {
+      dl_size += *len;
+      len = (int *)(dl + dl_size);
+    }
+  dl_capacity = dl_size + sizeof(int);
+  painted = 0;
+
   if (!p->prevent_resize_by_dl)
     {
       set_window_size_from_dl();
@@ -223,6 +246,52 @@ void GKSWidget::interpret(char *dl)
   repaint();
 }
 
+void GKSWidget::interpret_delta(int offset, const char *data, int nbytes)
+{
+  /* `data` is owned by the caller (it may point into the shared memory ring) and is copied into the retained list */
+  p = widget_state_list;
+
+  if (offset < 0 || offset > dl_size || nbytes < 0)
+    {
+      qWarning("GKSWidget: Display list update does not match the retained display list");
+      return;
+    }
+
+  if (offset + nbytes + (int)sizeof(int) > dl_capacity)
+    {
+      int capacity = dl_capacity > 0 ? dl_capacity : 65536;
+      char *buffer;
+
+      while (offset + nbytes + (int)sizeof(int) > capacity) capacity *= 2;
+      buffer = new char[capacity];
+      if (dl != NULL) memcpy(buffer, dl, offset);
+      delete[] dl;
+      dl = buffer;
+      dl_capacity = capacity;
+    }
+  memcpy(dl + offset, data, nbytes);
+  dl_size = offset + nbytes;
+  // The data buffer must be terminated by a zero integer -> `sizeof(int)` zero bytes
+  memset(dl + dl_size, 0, sizeof(int));
+  if (offset < painted)
+    {
+      painted = 0;
+    }
+
+  if (!p->prevent_resize_by_dl)
+    {
+      set_window_size_from_dl(offset);
+    }
+  if (!is_mapped)
+    {
+      is_mapped = true;
+      create_pixmap(p);
+      show();
+    }
+
+  repaint();
+}
+
 void GKSWidget::inqdspsize(double *mwidth, double *mheight, int *width, int *height)
 {
   /* forward call to internally included copy of qtplugin_impl.cxx */
@@ -24,6 +24,7 @@ public:
 
 public slots:
   void interpret(char *dl);
+  void interpret_delta(int offset, const char *data, int nbytes);
 
 signals:
   void rendererChanged(QString renderer_string);
@@ -31,12 +32,13 @@ signals:
 protected:
   void paintEvent(QPaintEvent *event);
   void resizeEvent(QResizeEvent *event);
-  void set_window_size_from_dl();
+  void set_window_size_from_dl(int start = 0);
 
 private:
   bool is_mapped;
   bool resize_requested_by_application;
   char *dl;
+  int dl_size, dl_capacity, painted;
   static QSize frame_decoration_size_;
   QString renderer_string;
   ws_state_list_t *widget_state_list;
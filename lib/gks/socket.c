@@ -13,12 +13,17 @@
 #include <arpa/inet.h>
 #include <sys/socket.h>
 #include <netinet/in.h>
+#include <netinet/tcp.h>
 #include <netdb.h>
 #include <sys/time.h>
 #include <pthread.h>
 #include <unistd.h>
 #include <signal.h>
 #include <sys/errno.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <fcntl.h>
+#define HAVE_SHM
 #else
 #define __STRSAFE__NO_INLINE
 #define STRSAFE_NO_DEPRECATE
@@ -29,6 +34,10 @@
 #include <strsafe.h>
 #endif
 
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
 #include "gks.h"
 #include "gkscore.h"
 
@@ -41,6 +50,21 @@
 #define SOCKET_FUNCTION_IS_RUNNING 5
 #define SOCKET_FUNCTION_INQ_WS_STATE 6
 #define SOCKET_FUNCTION_SAMPLE_LOCATOR 7
+#define SOCKET_FUNCTION_DRAW_DELTA 8
+#define SOCKET_FUNCTION_OPEN_SHM 9
+#define SOCKET_FUNCTION_DRAW_SHM 10
+#define SOCKET_FUNCTION_INQ_FEATURES 11
+
+#define SOCKET_FEATURE_DRAW_DELTA 1
+#define SOCKET_FEATURE_SHM 2
+
+#define SHM_RING_SIZE 16777216 /* 16M */
+
+#ifdef __GNUC__
+#define memory_barrier() __sync_synchronize()
+#else
+#define memory_barrier()
+#endif
 
 
 #ifndef MAXPATHLEN
@@ -55,12 +79,27 @@ typedef struct
   int wstype;
   gks_display_list_t dl;
   double aspect_ratio;
+  int features, sent, compress;
+  gks_shm_ring_t *shm;
 } ws_state_list;
 
+typedef struct
+{
+  int nbytes;
+  double mwidth;
+  double mheight;
+  int width;
+  int height;
+  char name[6];
+} workstation_information_t;
+
 static gks_state_list_t *gkss;
 
 static int is_running = 0;
 
+/* set if the running gksqt was started by this process (or its wrapper), so it belongs to this version of GKS */
+static int started_server = 0;
+
 #ifdef _WIN32
 
 #define CMD_LINE_LEN (32767 + 10)
@@ -229,6 +268,10 @@ static int connect_socket(int quiet)
 #ifdef SO_REUSEADDR
   setsockopt(s, SOL_SOCKET, SO_REUSEADDR, (char *)&opt, sizeof(opt));
 #endif
+#ifdef TCP_NODELAY
+  /* requests are small and often followed by other requests without a reply in between */
+  setsockopt(s, IPPROTO_TCP, TCP_NODELAY, (char *)&opt, sizeof(opt));
+#endif
 
   if (connect(s, res->ai_addr, res->ai_addrlen) < 0)
     {
@@ -278,6 +321,8 @@ static int open_socket(int wstype)
         }
 #else
       command = gks_getenv("GKS_QT");
+      /* the GR.jl wrapper script starts the gksqt of the same installation */
+      if (command != NULL && *command == '\0') started_server = 1;
       if (command == NULL)
         {
           env = gks_getenv("GRDIR");
@@ -304,7 +349,8 @@ static int open_socket(int wstype)
                  because in this case gksqt is started by the GR.jl wrapper script */
               if (*command)
                 {
-                  if (start((void *)command) != 0) gks_perror("could not auto-start GKS Qt application");
+                  started_server = start((void *)command) == 0;
+                  if (!started_server) gks_perror("could not auto-start GKS Qt application");
                 }
             }
           sleep_ms = retry_count <= n_initial_times ? initial_sleep_time_ms[retry_count - 1] : max_sleep_time_ms;
@@ -402,6 +448,202 @@ static int close_socket(int s)
   return 0;
 }
 
+static int read_workstation_information(int s, workstation_information_t *workstation_information)
+{
+  int nbytes;
+  char *buf;
+
+  memset(workstation_information, 0, sizeof(workstation_information_t));
+  if (read_socket(s, (char *)&nbytes, sizeof(int), 0) != sizeof(int) || nbytes < (int)sizeof(int))
+    {
+      return 0;
+    }
+  if (nbytes == sizeof(workstation_information_t))
+    {
+      workstation_information->nbytes = nbytes;
+      return read_socket(s, (char *)workstation_information + sizeof(int), nbytes - (int)sizeof(int), 0) ==
+             nbytes - (int)sizeof(int);
+    }
+  /* unknown format, skip it */
+  buf = gks_malloc(nbytes - (int)sizeof(int) + 1);
+  read_socket(s, buf, nbytes - (int)sizeof(int), 0);
+  gks_free(buf);
+  return 0;
+}
+
+static int inq_features(int s)
+{
+  /* Ask gksqt for the supported protocol extensions. Older versions of gksqt do not recover from unknown requests, so
+   * only a gksqt which was started by this process (or its wrapper) is asked; all other ones get the full display list
+   * on every update. */
+  char request_type = SOCKET_FUNCTION_INQ_FEATURES;
+  int reply[2];
+
+  if (!started_server)
+    {
+      return 0;
+    }
+  if (send_socket(s, &request_type, 1, 0) <= 0 || read_socket(s, (char *)reply, sizeof(reply), 0) != sizeof(reply) ||
+      reply[0] != sizeof(reply))
+    {
+      return 0;
+    }
+
+  return reply[1];
+}
+
+/*
+ * Send the part of the display list which was added since the last update. The receiver truncates its copy of the
+ * display list to the given offset and appends the data, so an offset of zero replaces the whole list.
+ */
+static void send_delta(ws_state_list *wss)
+{
+  char request_type = SOCKET_FUNCTION_DRAW_DELTA;
+  int header[3];
+  char *data;
+#ifdef HAVE_ZLIB
+  uLongf size;
+#endif
+
+  if (wss->sent > wss->dl.nbytes) wss->sent = 0;
+
+  header[0] = wss->sent;
+  header[1] = header[2] = wss->dl.nbytes - wss->sent;
+  data = wss->dl.buffer + wss->sent;
+
+#ifdef HAVE_ZLIB
+  if (wss->compress && header[1] > 0)
+    {
+      size = compressBound(header[1]);
+      data = gks_malloc(size);
+      if (compress2((Bytef *)data, &size, (Bytef *)wss->dl.buffer + wss->sent, header[1], Z_BEST_SPEED) == Z_OK &&
+          (int)size < header[1])
+        {
+          /* uncompressed data is sent with equal sizes */
+          header[2] = size;
+        }
+      else
+        {
+          gks_free(data);
+          data = wss->dl.buffer + wss->sent;
+        }
+    }
+#endif
+
+  if (send_socket(wss->s, &request_type, 1, 0) > 0 && send_socket(wss->s, (char *)header, sizeof(header), 0) > 0 &&
+      send_socket(wss->s, data, header[2], 0) >= 0)
+    {
+      wss->sent = wss->dl.nbytes;
+    }
+  else
+    {
+      wss->sent = 0;
+    }
+
+  if (data != wss->dl.buffer + header[0]) gks_free(data);
+}
+
+#ifdef HAVE_SHM
+
+static void close_shm(ws_state_list *wss)
+{
+  if (wss->shm != NULL)
+    {
+      munmap(wss->shm, sizeof(gks_shm_ring_t) + wss->shm->size);
+      wss->shm = NULL;
+    }
+}
+
+/*
+ * Create a shared memory ring buffer and ask gksqt to map it. The segment is unlinked as soon as the viewer has
+ * answered, so it doesn't outlive the two processes. If anything fails, display lists are sent through the socket.
+ */
+static void open_shm(ws_state_list *wss)
+{
+  static int counter = 0;
+  char name[64], request_type = SOCKET_FUNCTION_OPEN_SHM, reply = 0;
+  int fd, len;
+  void *mem;
+
+  sprintf(name, "/gks-%d-%d", (int)getpid(), ++counter);
+  fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+  if (fd < 0) return;
+
+  if (ftruncate(fd, sizeof(gks_shm_ring_t) + SHM_RING_SIZE) != 0 ||
+      (mem = mmap(NULL, sizeof(gks_shm_ring_t) + SHM_RING_SIZE, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0)) ==
+          MAP_FAILED)
+    {
+      close(fd);
+      shm_unlink(name);
+      return;
+    }
+  close(fd);
+
+  wss->shm = (gks_shm_ring_t *)mem;
+  wss->shm->magic = GKS_SHM_RING_MAGIC;
+  wss->shm->size = SHM_RING_SIZE;
+  wss->shm->head = wss->shm->tail = 0;
+
+  len = strlen(name);
+  if (send_socket(wss->s, &request_type, 1, 0) <= 0 || send_socket(wss->s, (char *)&len, sizeof(int), 0) <= 0 ||
+      send_socket(wss->s, name, len, 0) <= 0 || read_socket(wss->s, &reply, 1, 0) != 1 ||
+      reply != SOCKET_FUNCTION_OPEN_SHM)
+    {
+      close_shm(wss);
+    }
+  shm_unlink(name);
+}
+
+/*
+ * Copy the display list delta into the ring buffer and notify gksqt through the socket. Returns 0 if the data
+ * has to be sent through the socket instead, which is also the case if the viewer has not consumed enough of the
+ * previous frames yet (the application never waits for the viewer).
+ */
+static int send_shm(ws_state_list *wss)
+{
+  gks_shm_ring_t *ring = wss->shm;
+  char request[1 + 4 * sizeof(int)];
+  unsigned int n, pos, skip;
+  int header[4];
+
+  if (wss->sent > wss->dl.nbytes) wss->sent = 0;
+  n = wss->dl.nbytes - wss->sent;
+  if (n > ring->size) return 0;
+
+  /* frames are stored contiguously, so the rest of the ring is skipped if the frame doesn't fit */
+  pos = ring->head % ring->size;
+  skip = pos + n > ring->size ? ring->size - pos : 0;
+
+  memory_barrier();
+  if (ring->size - (ring->head - ring->tail) < skip + n) return 0;
+
+  pos = (pos + skip) % ring->size;
+  memcpy((char *)(ring + 1) + pos, wss->dl.buffer + wss->sent, n);
+  memory_barrier();
+  ring->head += skip + n;
+
+  header[0] = wss->sent;
+  header[1] = n;
+  header[2] = pos;
+  header[3] = ring->head;
+
+  /* send the notification with a single call, small consecutive writes would be delayed by Nagle's algorithm */
+  request[0] = SOCKET_FUNCTION_DRAW_SHM;
+  memcpy(request + 1, header, sizeof(header));
+  if (send_socket(wss->s, request, sizeof(request), 0) > 0)
+    {
+      wss->sent = wss->dl.nbytes;
+    }
+  else
+    {
+      wss->sent = 0;
+    }
+
+  return 1;
+}
+
+#endif
+
 static void check_socket_connection(ws_state_list *wss)
 {
   if (wss->s != -1 && wss->wstype >= 411 && wss->wstype <= 413)
@@ -418,16 +660,21 @@ static void check_socket_connection(ws_state_list *wss)
     {
       close_socket(wss->s);
       wss->s = open_socket(wss->wstype);
+      /* the new connection doesn't know any parts of the display list */
+      wss->sent = 0;
       if (wss->s != -1 && wss->wstype >= 411 && wss->wstype <= 413)
         {
-          /* workstation information was already read during OPEN_WS */
-          int nbytes;
-          if (read_socket(wss->s, (char *)&nbytes, sizeof(int), 0) == sizeof(int))
+          /* workstation information was already read during OPEN_WS, only the features may have changed */
+          workstation_information_t workstation_information;
+          wss->features = 0;
+          if (read_workstation_information(wss->s, &workstation_information))
             {
-              char *buf = gks_malloc(nbytes - (int)sizeof(int));
-              read_socket(wss->s, buf, nbytes - (int)sizeof(int), 0);
-              gks_free(buf);
+              wss->features = inq_features(wss->s);
             }
+#ifdef HAVE_SHM
+          close_shm(wss);
+          if ((wss->features & SOCKET_FEATURE_SHM) && gks_getenv("GKS_SOCKET_SHM") != NULL) open_shm(wss);
+#endif
         }
     }
 }
@@ -463,27 +710,22 @@ void gks_drv_socket(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doubl
           if (wss->wstype >= 411 && wss->wstype <= 413)
             {
               /* get workstation information */
-              int nbytes;
-              struct
-              {
-                int nbytes;
-                double mwidth;
-                double mheight;
-                int width;
-                int height;
-                char name[6];
-              } workstation_information = {sizeof(workstation_information), 0, 0, 0, 0, ""};
-              if (read_socket(wss->s, (char *)&nbytes, sizeof(int), 0) == sizeof(int) &&
-                  nbytes == workstation_information.nbytes)
+              workstation_information_t workstation_information;
+              if (read_workstation_information(wss->s, &workstation_information))
                 {
-                  read_socket(wss->s, (char *)&workstation_information + sizeof(int), nbytes - (int)sizeof(int), 0);
                   ia[0] = workstation_information.width;
                   ia[1] = workstation_information.height;
                   r1[0] = workstation_information.mwidth;
                   r2[0] = workstation_information.mheight;
+                  wss->features = inq_features(wss->s);
                 }
             }
           wss->aspect_ratio = 1.0;
+          wss->sent = 0;
+          wss->compress = gks_getenv("GKS_SOCKET_COMPRESSION") != NULL;
+#ifdef HAVE_SHM
+          if ((wss->features & SOCKET_FEATURE_SHM) && gks_getenv("GKS_SOCKET_SHM") != NULL) open_shm(wss);
+#endif
           /*
            * TODO: Send `CREATE_WINDOW` on open workstation or implicit window creation?
            * request_type = SOCKET_FUNCTION_CREATE_WINDOW;
@@ -499,6 +741,9 @@ void gks_drv_socket(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doubl
           send_socket(wss->s, &request_type, 1, 0);
         }
       close_socket(wss->s);
+#ifdef HAVE_SHM
+      close_shm(wss);
+#endif
       if (wss->dl.buffer)
         {
           free(wss->dl.buffer);
@@ -511,6 +756,14 @@ void gks_drv_socket(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doubl
       if (ia[1] & GKS_K_PERFORM_FLAG)
         {
           check_socket_connection(wss);
+          if (wss->wstype >= 411 && wss->wstype <= 413 && (wss->features & SOCKET_FEATURE_DRAW_DELTA))
+            {
+#ifdef HAVE_SHM
+              if (wss->shm != NULL && send_shm(wss)) break;
+#endif
+              send_delta(wss);
+              break;
+            }
           request_type = SOCKET_FUNCTION_DRAW;
           if (wss->wstype >= 411 && wss->wstype <= 413)
             {
@@ -597,5 +850,7 @@ void gks_drv_socket(int fctid, int dx, int dy, int dimx, int *ia, int lr1, doubl
   if (wss != NULL)
     {
       gks_dl_write_item(&wss->dl, fctid, dx, dy, dimx, ia, lr1, r1, lr2, r2, lc, chars, gkss);
+      /* clearing the workstation rewrites the display list from the start */
+      if (fctid == 6) wss->sent = 0;
     }
 }
@@ -0,0 +1,81 @@
+/*
+ * Call throughput benchmark for the GKS driver dispatch.
+ *
+ * Simulates a polyline-heavy workload (e.g. a line plot with many short
+ * segments) in which every segment is preceded by the same attribute calls,
+ * like it is common for code generated by higher level plotting layers. The
+ * loop is run on the dummy workstation (pure dispatch overhead), the GKS
+ * metafile driver (every call which reaches the driver is recorded) and the
+ * PostScript driver, and the number of GKS calls per second is reported.
+ *
+ *   dispatch [segments [prefix]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "gks.h"
+
+#define CALLS_PER_SEGMENT 6
+
+static void run(const char *name, int wtype, const char *prefix, const char *extension, int segments)
+{
+  double x[4], y[4], seconds;
+  int i, j;
+  clock_t start;
+  char output[256];
+  long size = 0;
+  FILE *fp;
+
+  if (extension != NULL) sprintf(output, "%.240s.%s", prefix, extension);
+
+  gks_open_gks(6);
+  gks_open_ws(1, extension != NULL ? output : NULL, wtype);
+  gks_activate_ws(1);
+
+  start = clock();
+  for (i = 0; i < segments; i++)
+    {
+      for (j = 0; j < 4; j++)
+        {
+          x[j] = (double)((i + j) % 1000) / 1000;
+          y[j] = 0.5 + 0.4 * ((i * 7 + j * 13) % 100) / 100;
+        }
+      gks_set_pline_linetype(GKS_K_LINETYPE_SOLID);
+      gks_set_pline_linewidth(1.0);
+      gks_set_pline_color_index(1 + i / 10000 % 8);
+      gks_set_transparency(1.0);
+      gks_select_xform(1);
+      gks_polyline(4, x, y);
+    }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+
+  gks_deactivate_ws(1);
+  gks_close_ws(1);
+  gks_close_gks();
+
+  if (extension != NULL && (fp = fopen(output, "rb")) != NULL)
+    {
+      fseek(fp, 0, SEEK_END);
+      size = ftell(fp);
+      fclose(fp);
+    }
+  printf("%-10s %d polylines: %.3f s, %.2f million calls/s, %ld KiB output\n", name, segments, seconds,
+         (double)segments * CALLS_PER_SEGMENT / seconds / 1e6, size / 1024);
+}
+
+int main(int argc, char *argv[])
+{
+  int segments = 1000000;
+  const char *prefix = "dispatch";
+
+  if (argc > 1) segments = atoi(argv[1]);
+  if (argc > 2) prefix = argv[2];
+
+  run("dummy", 100, prefix, NULL, segments);
+  run("metafile", 2, prefix, "mf", segments);
+  run("postscript", 62, prefix, "ps", segments);
+
+  return 0;
+}
@@ -0,0 +1,73 @@
+/*
+ * Throughput benchmark for the image encoders of the PostScript driver.
+ *
+ * Renders a number of large cell arrays (heatmap-like data) to an EPS file
+ * and reports the time spent per page and the encoded input bytes per second.
+ * Set GKS_PS_LEVEL=3 to benchmark the FlateDecode image streams instead of
+ * the default LZWDecode ones.
+ *
+ *   ps_cellarray [size [pages [output]]]
+ */
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "gks.h"
+
+static void fill_heatmap(int *colia, int n, int frame)
+{
+  int i, j;
+
+  for (j = 0; j < n; j++)
+    for (i = 0; i < n; i++)
+      colia[j * n + i] = 8 + ((i / 4 + j / 7 + frame) * (i % 13 + 1) + (i ^ j)) % 72;
+}
+
+int main(int argc, char *argv[])
+{
+  int n = 2000, pages = 4, page;
+  char *output = "ps_cellarray.eps";
+  int *colia;
+  clock_t start, total = 0;
+  double seconds, mbytes;
+
+  if (argc > 1) n = atoi(argv[1]);
+  if (argc > 2) pages = atoi(argv[2]);
+  if (argc > 3) output = argv[3];
+
+  colia = (int *)malloc(n * n * sizeof(int));
+  if (colia == NULL)
+    {
+      fprintf(stderr, "out of memory\n");
+      return 1;
+    }
+
+  gks_open_gks(6);
+  gks_open_ws(1, output, 62);
+  gks_activate_ws(1);
+
+  for (page = 0; page < pages; page++)
+    {
+      fill_heatmap(colia, n, page);
+      if (page > 0) gks_clear_ws(1, GKS_K_CLEAR_ALWAYS);
+      start = clock();
+      gks_cellarray(0.1, 0.9, 0.9, 0.1, n, n, 1, 1, n, n, colia);
+      total += clock() - start;
+    }
+
+  start = clock();
+  gks_deactivate_ws(1);
+  gks_close_ws(1);
+  gks_close_gks();
+  total += clock() - start;
+
+  seconds = (double)total / CLOCKS_PER_SEC;
+  mbytes = (double)n * n * 3 * pages / (1024.0 * 1024.0);
+  printf("%d pages of %dx%d cells: %.3f s, %.3f s/page, %.1f MiB/s\n", pages, n, n, seconds, seconds / pages,
+         seconds > 0 ? mbytes / seconds : 0.0);
+
+  free(colia);
+
+  return 0;
+}
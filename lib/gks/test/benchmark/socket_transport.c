@@ -0,0 +1,229 @@
+/*
+ * Latency and throughput benchmark for the transports of the gksqt socket driver.
+ *
+ * A minimal gksqt replacement is forked which consumes display lists sent either
+ * through the TCP socket or through the shared memory ring buffer. For each
+ * transport, a number of frames containing a single large polyline is drawn.
+ * After each update, the viewport size is inquired, so the measured time
+ * includes the round trip until the viewer has received the frame.
+ *
+ *   socket_transport [points [frames]]
+ */
+
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <signal.h>
+#include <sys/mman.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "gks.h"
+#include "gkscore.h"
+
+#define PORT 8410
+
+static int read_all(int s, void *buf, int n)
+{
+  int nread = 0, cc;
+
+  while (nread < n)
+    {
+      if ((cc = read(s, (char *)buf + nread, n - nread)) <= 0) return 0;
+      nread += cc;
+    }
+  return 1;
+}
+
+static void serve(int listener)
+{
+  struct
+  {
+    int nbytes;
+    double mwidth;
+    double mheight;
+    int width;
+    int height;
+    char name[6];
+  } workstation_information = {sizeof(workstation_information), 0.3, 0.2, 1920, 1080, "gksqt"};
+  int features[2] = {sizeof(features), 3};
+  gks_ws_state_t state = {500, 500, 1.0};
+  gks_shm_ring_t *ring = NULL;
+  char function, name[64], reply[1 + sizeof(gks_ws_state_t)], *data = NULL;
+  int s, header[4], len, size = 0, fd;
+  struct stat buf;
+
+  while ((s = accept(listener, NULL, NULL)) >= 0)
+    {
+      if (write(s, &workstation_information, sizeof(workstation_information)) < 0) break;
+      while (read_all(s, &function, 1))
+        {
+          switch (function)
+            {
+            case 3: /* is alive */
+              if (write(s, &function, 1) < 0) return;
+              break;
+
+            case 4: /* close window */
+              break;
+
+            case 6: /* inquire workstation state */
+              reply[0] = function;
+              memcpy(reply + 1, &state, sizeof(state));
+              if (write(s, reply, sizeof(reply)) < 0) return;
+              break;
+
+            case 8: /* draw delta */
+              read_all(s, header, 3 * sizeof(int));
+              if (header[0] + header[2] > size)
+                {
+                  size = header[0] + header[2];
+                  data = (char *)realloc(data, size);
+                }
+              read_all(s, data + header[0], header[2]);
+              break;
+
+            case 9: /* open shared memory */
+              read_all(s, &len, sizeof(int));
+              read_all(s, name, len);
+              name[len] = '\0';
+              function = 0;
+              if ((fd = shm_open(name, O_RDWR, 0)) >= 0)
+                {
+                  fstat(fd, &buf);
+                  ring = (gks_shm_ring_t *)mmap(NULL, buf.st_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+                  close(fd);
+                  if (ring != MAP_FAILED) function = 9;
+                }
+              if (write(s, &function, 1) < 0) return;
+              break;
+
+            case 10: /* draw from shared memory */
+              read_all(s, header, 4 * sizeof(int));
+              if (header[0] + header[1] > size)
+                {
+                  size = header[0] + header[1];
+                  data = (char *)realloc(data, size);
+                }
+              memcpy(data + header[0], (char *)(ring + 1) + header[2], header[1]);
+              ring->tail = header[3];
+              break;
+
+            case 11: /* inquire features */
+              if (write(s, features, sizeof(features)) < 0) return;
+              break;
+
+            default:
+              fprintf(stderr, "unknown socket function %d\n", function);
+              return;
+            }
+        }
+      close(s);
+    }
+}
+
+static double now(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static void run(const char *transport, int n, int frames, double *x, double *y)
+{
+  int frame, errind, width, height;
+  double ratio, start, elapsed, min_latency = 1e9, mbytes;
+
+  gks_open_gks(6);
+  gks_open_ws(1, NULL, 411);
+  gks_activate_ws(1);
+
+  start = now();
+  for (frame = 0; frame < frames; frame++)
+    {
+      elapsed = now();
+      gks_clear_ws(1, GKS_K_CLEAR_ALWAYS);
+      y[frame % n] += 0.01;
+      gks_polyline(n, x, y);
+      gks_update_ws(1, GKS_K_PERFORM_FLAG);
+      gks_inq_vp_size(1, &errind, &width, &height, &ratio);
+      elapsed = now() - elapsed;
+      if (elapsed < min_latency) min_latency = elapsed;
+    }
+  elapsed = now() - start;
+
+  gks_deactivate_ws(1);
+  gks_close_ws(1);
+  gks_close_gks();
+
+  mbytes = (double)n * 2 * sizeof(double) * frames / (1024.0 * 1024.0);
+  printf("%-6s %d frames of %d points: %.3f s, %.2f ms/frame (min %.2f ms), %.1f MiB/s\n", transport, frames, n,
+         elapsed, elapsed / frames * 1000, min_latency * 1000, mbytes / elapsed);
+}
+
+int main(int argc, char *argv[])
+{
+  int n = 250000, frames = 50, i, listener, opt = 1;
+  double *x, *y;
+  struct sockaddr_in addr;
+  pid_t pid;
+
+  if (argc > 1) n = atoi(argv[1]);
+  if (argc > 2) frames = atoi(argv[2]);
+
+  listener = socket(AF_INET, SOCK_STREAM, 0);
+  setsockopt(listener, SOL_SOCKET, SO_REUSEADDR, (char *)&opt, sizeof(opt));
+  memset(&addr, 0, sizeof(addr));
+  addr.sin_family = AF_INET;
+  addr.sin_port = htons(PORT);
+  addr.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  if (bind(listener, (struct sockaddr *)&addr, sizeof(addr)) != 0 || listen(listener, 1) != 0)
+    {
+      perror("can't listen on the gksqt port");
+      return 1;
+    }
+
+  if ((pid = fork()) == 0)
+    {
+      serve(listener);
+      exit(0);
+    }
+  close(listener);
+
+  x = (double *)malloc(n * sizeof(double));
+  y = (double *)malloc(n * sizeof(double));
+  for (i = 0; i < n; i++)
+    {
+      x[i] = (double)i / n;
+      y[i] = 0.5 + 0.4 * sin(i * 0.001);
+    }
+
+  /* don't start the real gksqt, the (empty) command also tells the driver that the server knows all requests */
+  setenv("GKS_QT", "", 1);
+
+  unsetenv("GKS_SOCKET_SHM");
+  run("socket", n, frames, x, y);
+  setenv("GKS_SOCKET_SHM", "1", 1);
+  run("shm", n, frames, x, y);
+
+  kill(pid, SIGTERM);
+  waitpid(pid, NULL, 0);
+
+  free(x);
+  free(y);
+
+  return 0;
+}
@@ -21,6 +21,16 @@
 #include <crt_externs.h>
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2
+#endif
+
+#if !defined(_WIN32) && !defined(NO_THREADS)
+#include <pthread.h>
+#define HAVE_THREADS
+#endif
+
 #include "gks.h"
 #include "gkscore.h"
 
@@ -739,6 +749,97 @@ static void gks_seg_xform_rel(double *x, double *y)
   *x = xx;
 }
 
+/*
+ * Apply the normalization transformation tnr, the segment transformation and
+ * (unless dev is NULL) the device transformation xd = dev[0] * xn + dev[1],
+ * yd = dev[2] * yn + dev[3] to whole coordinate arrays. The result is bitwise
+ * identical to the per-point WC_to_NDC, seg_xform and NDC_to_DC macros used
+ * by the drivers. The output arrays may be the same as the input arrays.
+ */
+
+static void xform_points(int n, double *px, double *py, int tnr, double *dev, double *x, double *y)
+{
+  double a = gkss->a[tnr], b = gkss->b[tnr], c = gkss->c[tnr], d = gkss->d[tnr];
+  double m00 = gkss->mat[0][0], m01 = gkss->mat[0][1], m10 = gkss->mat[1][0], m11 = gkss->mat[1][1];
+  double m20 = gkss->mat[2][0], m21 = gkss->mat[2][1];
+  double xn, yn, xs;
+  int i = 0;
+#ifdef HAVE_SSE2
+  __m128d va = _mm_set1_pd(a), vb = _mm_set1_pd(b), vc = _mm_set1_pd(c), vd = _mm_set1_pd(d);
+  __m128d v00 = _mm_set1_pd(m00), v01 = _mm_set1_pd(m01), v10 = _mm_set1_pd(m10), v11 = _mm_set1_pd(m11);
+  __m128d v20 = _mm_set1_pd(m20), v21 = _mm_set1_pd(m21), ve, vf, vg, vh;
+  __m128d vx, vy, vxs;
+
+  if (dev != NULL)
+    {
+      ve = _mm_set1_pd(dev[0]);
+      vf = _mm_set1_pd(dev[1]);
+      vg = _mm_set1_pd(dev[2]);
+      vh = _mm_set1_pd(dev[3]);
+    }
+  else
+    ve = vf = vg = vh = _mm_setzero_pd();
+
+  for (; i + 1 < n; i += 2)
+    {
+      vx = _mm_add_pd(_mm_mul_pd(va, _mm_loadu_pd(px + i)), vb);
+      vy = _mm_add_pd(_mm_mul_pd(vc, _mm_loadu_pd(py + i)), vd);
+      vxs = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, v00), _mm_mul_pd(vy, v01)), v20);
+      vy = _mm_add_pd(_mm_add_pd(_mm_mul_pd(vx, v10), _mm_mul_pd(vy, v11)), v21);
+      if (dev != NULL)
+        {
+          vxs = _mm_add_pd(_mm_mul_pd(ve, vxs), vf);
+          vy = _mm_add_pd(_mm_mul_pd(vg, vy), vh);
+        }
+      _mm_storeu_pd(x + i, vxs);
+      _mm_storeu_pd(y + i, vy);
+    }
+#endif
+  for (; i < n; i++)
+    {
+      xn = a * px[i] + b;
+      yn = c * py[i] + d;
+      xs = xn * m00 + yn * m01 + m20;
+      yn = xn * m10 + yn * m11 + m21;
+      if (dev != NULL)
+        {
+          x[i] = dev[0] * xs + dev[1];
+          y[i] = dev[2] * yn + dev[3];
+        }
+      else
+        {
+          x[i] = xs;
+          y[i] = yn;
+        }
+    }
+}
+
+void gks_WC_to_DC(int n, double *px, double *py, int tnr, double a, double b, double c, double d, double *x,
+                  double *y)
+{
+  double dev[4];
+
+  dev[0] = a;
+  dev[1] = b;
+  dev[2] = c;
+  dev[3] = d;
+  xform_points(n, px, py, tnr, dev, x, y);
+}
+
+void gks_points_to_DC(gks_dc_points_t *dc, int n, double *px, double *py, int tnr, double a, double b, double c,
+                      double d)
+{
+  /* Transform `n` points into the buffers of `dc`, which are enlarged if needed. Drivers keep their own `dc`, so
+   * workstations which are driven by different threads do not share the buffers. */
+  if (n > dc->size)
+    {
+      dc->x = (double *)gks_realloc(dc->x, n * sizeof(double));
+      dc->y = (double *)gks_realloc(dc->y, n * sizeof(double));
+      dc->size = n;
+    }
+  gks_WC_to_DC(n, px, py, tnr, a, b, c, d, dc->x, dc->y);
+}
+
 void gks_set_dev_xform(gks_state_list_t *s, double *window, double *viewport)
 {
   int i;
@@ -978,13 +1079,52 @@ static int clip_code(double x, double y)
   return code;
 }
 
-static int clip_line(double *x0, double *y0, double *x1, double *y1)
+static void outcodes(int n, double *x, double *y, double *clrt, int *codes)
 {
-  int c, c0, c1;
-  double x = 0, y = 0;
+  double xmin = clrt[0], xmax = clrt[1], ymin = clrt[2], ymax = clrt[3];
+  int i = 0;
+#ifdef HAVE_SSE2
+  __m128d vxmin = _mm_set1_pd(xmin), vxmax = _mm_set1_pd(xmax);
+  __m128d vymin = _mm_set1_pd(ymin), vymax = _mm_set1_pd(ymax);
+  __m128d vx, vy;
+  int left, right, bottom, top;
+
+  for (; i + 1 < n; i += 2)
+    {
+      vx = _mm_loadu_pd(x + i);
+      vy = _mm_loadu_pd(y + i);
+      left = _mm_movemask_pd(_mm_cmplt_pd(vx, vxmin));
+      right = _mm_movemask_pd(_mm_cmpgt_pd(vx, vxmax)) & ~left;
+      bottom = _mm_movemask_pd(_mm_cmplt_pd(vy, vymin));
+      top = _mm_movemask_pd(_mm_cmpgt_pd(vy, vymax)) & ~bottom;
+      codes[i] = (left & 1) * LEFT | (right & 1) * RIGHT | (bottom & 1) * BOTTOM | (top & 1) * TOP;
+      codes[i + 1] = (left >> 1) * LEFT | (right >> 1) * RIGHT | (bottom >> 1) * BOTTOM | (top >> 1) * TOP;
+    }
+#endif
+  for (; i < n; i++)
+    {
+      int left = x[i] < xmin, bottom = y[i] < ymin;
 
-  c0 = clip_code(*x0, *y0);
-  c1 = clip_code(*x1, *y1);
+      codes[i] = (left ? LEFT : 0) | (!left && x[i] > xmax ? RIGHT : 0) | (bottom ? BOTTOM : 0) |
+                 (!bottom && y[i] > ymax ? TOP : 0);
+    }
+}
+
+static void clip_codes(int n, double *x, double *y, int *codes)
+{
+  double clrt[4];
+
+  clrt[0] = cxl;
+  clrt[1] = cxr;
+  clrt[2] = cyb;
+  clrt[3] = cyt;
+  outcodes(n, x, y, clrt, codes);
+}
+
+static int clip_line(double *x0, double *y0, int c0, double *x1, double *y1, int c1)
+{
+  int c;
+  double x = 0, y = 0;
 
   while (c0 | c1)
     {
@@ -1028,50 +1168,280 @@ static int clip_line(double *x0, double *y0, double *x1, double *y1)
   return 1;
 }
 
-void gks_emul_polyline(int n, double *px, double *py, int ltype, int tnr, void (*move)(double x, double y),
-                       void (*draw)(double x, double y))
+#define XFORM_BATCH 256
+
+#define CLIP_RUNS_MIN 1024
+#define CLIP_PARALLEL_MIN (1 << 20)
+#define MAX_CLIP_THREADS 8
+
+typedef struct
 {
-  double x0, y0, x, y, x1, y1;
-  int clip = 1, visible;
-  int i, j, m;
+  int first, last, nruns;
+  double *x, *y, *clrt;
+  int *runs;
+} clip_runs_t;
+
+/*
+ * Find the runs of consecutive segments of the points first..last which are
+ * not trivially rejected by the clipping rectangle, i.e. whose end points
+ * don't lie on the same outer side of it.
+ */
+
+static void visible_runs(clip_runs_t *t)
+{
+  int codes[XFORM_BATCH], prev = 0, start = -1, i, j, k;
 
-  dtype = ltype;
-  seglen = 0;
-  newseg = 1;
-  idash = 0;
+  t->nruns = 0;
+  for (i = t->first; i <= t->last; i += k)
+    {
+      k = MIN(t->last - i + 1, XFORM_BATCH);
+      outcodes(k, t->x + i, t->y + i, t->clrt, codes);
 
-  gks_get_dash_list(ltype, gkss->lwidth, dash_list);
+      for (j = 0; j < k; j++)
+        {
+          if (i + j > t->first)
+            {
+              if (prev & codes[j])
+                {
+                  if (start >= 0)
+                    {
+                      t->runs[2 * t->nruns] = start;
+                      t->runs[2 * t->nruns + 1] = i + j - 1;
+                      t->nruns++;
+                      start = -1;
+                    }
+                }
+              else if (start < 0)
+                start = i + j - 1;
+            }
+          prev = codes[j];
+        }
+    }
+  if (start >= 0)
+    {
+      t->runs[2 * t->nruns] = start;
+      t->runs[2 * t->nruns + 1] = t->last;
+      t->nruns++;
+    }
+}
 
-  WC_to_NDC(px[0], py[0], tnr, x0, y0);
-  gks_seg_xform(&x0, &y0);
+#ifdef HAVE_THREADS
 
-  m = ltype == 0 ? n + 1 : n;
+static void *clip_runs_worker(void *arg)
+{
+  visible_runs((clip_runs_t *)arg);
+  return NULL;
+}
 
-  for (i = 1; i < m; i++)
+#endif
+
+/*
+ * Split the polyline x, y into the runs which may be visible in the clipping
+ * rectangle clrt (xmin, xmax, ymin, ymax). Segments whose end points are both
+ * beyond the same edge are dropped, all other segments are kept unchanged, so
+ * the exact clipping is still left to the caller. The first and last point
+ * index of each run are stored in runs, which must provide space for n
+ * integers, and the number of runs is returned. Large polylines are processed
+ * by several threads.
+ */
+
+int gks_clip_runs(int n, double *x, double *y, double *clrt, int *runs)
+{
+  clip_runs_t t[MAX_CLIP_THREADS];
+  int nthreads = 1, nruns = 0, i, j;
+#ifdef HAVE_THREADS
+  pthread_t threads[MAX_CLIP_THREADS];
+  int started[MAX_CLIP_THREADS];
+#endif
+
+  if (n < 2) return 0;
+
+#ifdef HAVE_THREADS
+  if (n >= CLIP_PARALLEL_MIN)
+    {
+      nthreads = (int)sysconf(_SC_NPROCESSORS_ONLN);
+      nthreads = MAX(1, MIN(nthreads, MAX_CLIP_THREADS));
+    }
+#endif
+
+  if (nthreads == 1)
+    {
+      t[0].first = 0;
+      t[0].last = n - 1;
+      t[0].x = x;
+      t[0].y = y;
+      t[0].clrt = clrt;
+      t[0].runs = runs;
+      visible_runs(t);
+      return t[0].nruns;
+    }
+
+  /* adjacent chunks share one point, so that no segment gets lost */
+  for (i = 0; i < nthreads; i++)
     {
-      j = i < n ? i : 0;
+      t[i].first = (int)((double)i * (n - 1) / nthreads);
+      t[i].last = (int)((double)(i + 1) * (n - 1) / nthreads);
+      t[i].x = x;
+      t[i].y = y;
+      t[i].clrt = clrt;
+      t[i].runs = i == 0 ? runs : (int *)gks_malloc((t[i].last - t[i].first + 2) * sizeof(int));
+    }
+
+#ifdef HAVE_THREADS
+  for (i = 1; i < nthreads; i++)
+    started[i] = pthread_create(threads + i, NULL, clip_runs_worker, t + i) == 0;
+  visible_runs(t);
+  for (i = 1; i < nthreads; i++)
+    {
+      if (started[i])
+        pthread_join(threads[i], NULL);
+      else
+        visible_runs(t + i);
+    }
+#endif
+
+  /* concatenate the runs and join those which continue across a chunk border */
+  nruns = t[0].nruns;
+  for (i = 1; i < nthreads; i++)
+    {
+      for (j = 0; j < t[i].nruns; j++)
+        {
+          if (j == 0 && nruns > 0 && runs[2 * nruns - 1] == t[i].first && t[i].runs[0] == t[i].first)
+            runs[2 * nruns - 1] = t[i].runs[1];
+          else
+            {
+              runs[2 * nruns] = t[i].runs[2 * j];
+              runs[2 * nruns + 1] = t[i].runs[2 * j + 1];
+              nruns++;
+            }
+        }
+      gks_free(t[i].runs);
+    }
+
+  return nruns;
+}
+
+static void emul_polyline(int n, double *px, double *py, int closed, int tnr, void (*move)(double x, double y),
+                          void (*draw)(double x, double y))
+{
+  double xn[XFORM_BATCH], yn[XFORM_BATCH], x0, y0, x1, y1;
+  int codes[XFORM_BATCH], c0;
+  int clip = 1, visible;
+  int i, j, k, m;
+
+  xform_points(1, px, py, tnr, NULL, &x0, &y0);
+  clip_codes(1, &x0, &y0, &c0);
 
-      WC_to_NDC(px[j], py[j], tnr, x1, y1);
-      gks_seg_xform(&x1, &y1);
+  m = closed ? n + 1 : n;
 
-      x = x1;
-      y = y1;
-      visible = clip_line(&x0, &y0, &x1, &y1);
+  /* transform and classify the points in batches, the closing point of a
+   * border is the first point again */
+  for (i = 1; i < m; i += k)
+    {
+      if (i < n)
+        {
+          k = MIN(n - i, XFORM_BATCH);
+          xform_points(k, px + i, py + i, tnr, NULL, xn, yn);
+        }
+      else
+        {
+          k = 1;
+          xform_points(1, px, py, tnr, NULL, xn, yn);
+        }
+      clip_codes(k, xn, yn, codes);
 
-      if (visible)
+      for (j = 0; j < k; j++)
         {
-          if (clip)
+          x1 = xn[j];
+          y1 = yn[j];
+          visible = clip_line(&x0, &y0, c0, &x1, &y1, codes[j]);
+
+          if (visible)
             {
-              move(x0, y0);
-              clip = 0;
+              if (clip)
+                {
+                  move(x0, y0);
+                  clip = 0;
+                }
+              draw(x1, y1);
             }
-          draw(x1, y1);
+
+          if (xn[j] != x1 || yn[j] != y1 || !visible) clip = 1;
+          x0 = xn[j];
+          y0 = yn[j];
+          c0 = codes[j];
         }
+    }
+}
+
+/*
+ * Compute the clipping rectangle in world coordinates of the normalization
+ * transformation tnr. It is slightly enlarged, so that rounding can never
+ * reject a segment which is visible in normalized device coordinates.
+ * Returns 0 if a segment transformation is in effect.
+ */
+
+static int wc_clip_rect(int tnr, double *clrt)
+{
+  double dx, dy;
 
-      if (x != x1 || y != y1 || !visible) clip = 1;
-      x0 = x;
-      y0 = y;
+  if (gkss->mat[0][0] != 1 || gkss->mat[0][1] != 0 || gkss->mat[1][0] != 0 || gkss->mat[1][1] != 1 ||
+      gkss->mat[2][0] != 0 || gkss->mat[2][1] != 0)
+    return 0;
+
+  clrt[0] = (cxl - gkss->b[tnr]) / gkss->a[tnr];
+  clrt[1] = (cxr - gkss->b[tnr]) / gkss->a[tnr];
+  clrt[2] = (cyb - gkss->d[tnr]) / gkss->c[tnr];
+  clrt[3] = (cyt - gkss->d[tnr]) / gkss->c[tnr];
+  if (clrt[0] > clrt[1])
+    {
+      dx = clrt[0];
+      clrt[0] = clrt[1];
+      clrt[1] = dx;
+    }
+  if (clrt[2] > clrt[3])
+    {
+      dy = clrt[2];
+      clrt[2] = clrt[3];
+      clrt[3] = dy;
     }
+
+  dx = 1e-6 * (clrt[1] - clrt[0]) + 1e-12 * (fabs(clrt[0]) + fabs(clrt[1]));
+  dy = 1e-6 * (clrt[3] - clrt[2]) + 1e-12 * (fabs(clrt[2]) + fabs(clrt[3]));
+  clrt[0] -= dx;
+  clrt[1] += dx;
+  clrt[2] -= dy;
+  clrt[3] += dy;
+
+  return 1;
+}
+
+void gks_emul_polyline(int n, double *px, double *py, int ltype, int tnr, void (*move)(double x, double y),
+                       void (*draw)(double x, double y))
+{
+  double clrt[4];
+  int *runs, nruns, i;
+
+  dtype = ltype;
+  seglen = 0;
+  newseg = 1;
+  idash = 0;
+
+  gks_get_dash_list(ltype, gkss->lwidth, dash_list);
+
+  /* skip the parts of long polylines which are entirely outside of the
+   * clipping rectangle before they are transformed, the dash pattern is
+   * continued as if they had been clipped segment by segment */
+  if (ltype != 0 && n >= CLIP_RUNS_MIN && wc_clip_rect(tnr, clrt))
+    {
+      runs = (int *)gks_malloc(n * sizeof(int));
+      nruns = gks_clip_runs(n, px, py, clrt, runs);
+      for (i = 0; i < nruns; i++)
+        emul_polyline(runs[2 * i + 1] - runs[2 * i] + 1, px + runs[2 * i], py + runs[2 * i], 0, tnr, move, draw);
+      gks_free(runs);
+    }
+  else
+    emul_polyline(n, px, py, ltype == 0, tnr, move, draw);
 }
 
 void gks_emul_polymarker(int n, double *px, double *py, void (*marker)(double x, double y, int mtype))
@@ -1370,141 +1740,118 @@ static void minmax(int n, double *a, double *amin, double *amax)
     }
 }
 
-static void calc_intersect(double x1, double y1, double x2, double y2, double x3, double y3, double x4, double y4,
-                           double *xi, double *yi, int *flag)
+typedef struct
 {
-  int inf1, inf2;
-  double a1 = 0, a2 = 0;
+  int first, last; /* range of scanlines crossing the edge */
+  double u, dudv;  /* intersection with the current scanline and its increment */
+} fill_edge_t;
 
-  inf1 = fabs(x1 - x2) <= FEPS;
-  if (!inf1) a1 = (y2 - y1) / (x2 - x1);
-
-  inf2 = fabs(x3 - x4) <= FEPS;
-  if (!inf2) a2 = (y4 - y3) / (x4 - x3);
+static int compare_edges(const void *a, const void *b)
+{
+  return ((const fill_edge_t *)a)->first - ((const fill_edge_t *)b)->first;
+}
 
-  if (inf1)
-    {
-      if (inf2)
-        *flag = 0;
-      else
-        {
-          *xi = x1;
-          *yi = y3 + a2 * (*xi - x3);
-          *flag = 1;
-        }
-    }
-  else
+static void fill(int n, double *px, double *py, int tnr, double x0, double xinc, double dx, double xend, double y0,
+                 double yinc, double dy, double yend,
+                 void (*polyline)(int n, double *px, double *py, int ltype, int tnr))
+{
+  fill_edge_t *edges, **active, *e;
+  double det, x, y, u1, v1, u2, v2, sx[2], sy[2];
+  int i, j, ne, na, next, l, ascending;
+
+  /* Scanline l is the line (x0 + l * xinc, y0 + l * yinc) + u * (dx, dy). The
+   * polygon is transformed into these (u, v) coordinates, so that each edge
+   * crosses the scanlines ceil(v_min) ... ceil(v_max) - 1 and its intersection
+   * can be stepped incrementally from one scanline to the next. */
+  det = xinc * dy - yinc * dx;
+  if (n < 3 || det == 0) return;
+
+  edges = (fill_edge_t *)gks_malloc(n * sizeof(fill_edge_t));
+  active = (fill_edge_t **)gks_malloc(n * sizeof(fill_edge_t *));
+
+  WC_to_NDC(px[n - 1], py[n - 1], tnr, x, y);
+  u1 = (xinc * (y - y0) - yinc * (x - x0)) / det;
+  v1 = ((x - x0) * dy - (y - y0) * dx) / det;
+  ne = 0;
+  for (i = 0; i < n; i++)
     {
-      if (inf2)
-        {
-          *xi = x3;
-          *yi = y1 + a1 * (*xi - x1);
-          *flag = 1;
-        }
-      else
+      WC_to_NDC(px[i], py[i], tnr, x, y);
+      u2 = (xinc * (y - y0) - yinc * (x - x0)) / det;
+      v2 = ((x - x0) * dy - (y - y0) * dx) / det;
+      if (v1 != v2)
         {
-          *flag = fabs(a1 - a2) > FEPS;
-          if (*flag)
+          e = edges + ne;
+          e->dudv = (u2 - u1) / (v2 - v1);
+          if (v1 < v2)
+            {
+              e->first = (int)ceil(v1);
+              e->last = (int)ceil(v2) - 1;
+              e->u = u1 + (e->first - v1) * e->dudv;
+            }
+          else
             {
-              *xi = (y1 - y3 - a1 * x1 + a2 * x3) / (a2 - a1);
-              *yi = y1 + a1 * (*xi - x1);
+              e->first = (int)ceil(v2);
+              e->last = (int)ceil(v1) - 1;
+              e->u = u2 + (e->first - v2) * e->dudv;
             }
+          if (e->first <= e->last) ne++;
         }
+      u1 = u2;
+      v1 = v2;
     }
-}
+  qsort(edges, ne, sizeof(fill_edge_t), compare_edges);
 
-static void sort(int n, double *x, double *y, int inc)
-{
-  int i, j;
-  int flag;
-  double tmp;
+  na = next = 0;
+  l = 1;
+  while (next < ne || na > 0)
+    {
+      if (na == 0 && edges[next].first > l) l = edges[next].first;
+      if (x0 + l * xinc > xend || y0 + l * yinc > yend) break;
 
-  for (i = 0; i < n; i++)
-    for (j = i + 1; j < n; j++)
-      {
-        flag = inc == 0 ? x[j] < x[i] : x[j] > x[i];
-        if (flag)
+      /* update the active edge table */
+      for (i = j = 0; i < na; i++)
+        if (active[i]->last >= l)
           {
-            tmp = x[i];
-            x[i] = x[j];
-            x[j] = tmp;
-            tmp = y[i];
-            y[i] = y[j];
-            y[j] = tmp;
+            active[i]->u += active[i]->dudv;
+            active[j++] = active[i];
           }
-      }
-}
-
-static void fill(int n, double *px, double *py, int tnr, double x0, double xinc, double dx, double xend, double y0,
-                 double yinc, double dy, double yend,
-                 void (*polyline)(int n, double *px, double *py, int ltype, int tnr))
-{
-  double x1, x2, x3, x4, xi, epsx;
-  double y1, y2, y3, y4, yi, epsy;
-  int i, im1, l, ni, flag, inc;
-  double sx[128], sy[128];
-
-  xi = yi = 0.0;
-  epsx = fabs((xend - x0) * 1.0E-5);
-  epsy = fabs((yend - y0) * 1.0E-5);
-
-  l = 0;
-  for (;;)
-    {
-      l++;
-      x1 = x0 + l * xinc;
-      y1 = y0 + l * yinc;
-      if (x1 > xend || y1 > yend) return;
-      x2 = x1 + dx;
-      y2 = y1 + dy;
-
-      /* calculate all intersections of the line given by the points
-       * (x1, y1), (x2, y2) with the polygon's vertices */
-      ni = 0;
-      for (i = 0; i < n; i++)
+      na = j;
+      while (next < ne && edges[next].first <= l)
         {
-          im1 = i == 0 ? n - 1 : i - 1;
-
-          x3 = px[im1];
-          y3 = py[im1];
-          WC_to_NDC(x3, y3, tnr, x3, y3);
-          x4 = px[i];
-          y4 = py[i];
-          WC_to_NDC(x4, y4, tnr, x4, y4);
-
-          calc_intersect(x1, y1, x2, y2, x3, y3, x4, y4, &xi, &yi, &flag);
-          if (flag)
+          e = edges + next++;
+          if (e->last >= l)
             {
-              double xmin, xmax, ymin, ymax;
-
-              xmin = MIN(x3, x4);
-              xmax = MAX(x3, x4);
-              ymin = MIN(y3, y4);
-              ymax = MAX(y3, y4);
-
-              /* be sure that point not outside the polygon */
-              if (xi >= xmin - epsx && xi <= xmax + epsx && yi >= ymin - epsy && yi <= ymax + epsy)
-                {
-                  sx[ni] = xi;
-                  sy[ni] = yi;
-                  ni++;
-                }
+              e->u += (l - e->first) * e->dudv;
+              active[na++] = e;
             }
         }
 
-      if (ni > 0)
+      /* the order of the intersections changes only where edges cross */
+      for (i = 1; i < na; i++)
         {
-          /* set sort mode */
-          inc = l % 2;
-          if (fabs(xinc) <= FEPS) /* sort on X coordinates */
-            sort(ni, sx, sy, inc);
-          else
-            /* sort on Y coordinates */
-            sort(ni, sy, sx, inc);
+          e = active[i];
+          for (j = i; j > 0 && active[j - 1]->u > e->u; j--) active[j] = active[j - 1];
+          active[j] = e;
+        }
 
-          for (i = 0; i < ni - 1; i += 2) polyline(2, sx + i, sy + i, GKS_K_LINETYPE_SOLID, 0);
+      /* draw the spans in alternating directions (on X coordinates unless the
+       * scanlines are moving horizontally) */
+      ascending = (l % 2 == 0) == ((fabs(xinc) <= FEPS ? dx : dy) >= 0);
+      for (i = 0; i < na - 1; i += 2)
+        {
+          for (j = 0; j < 2; j++)
+            {
+              e = ascending ? active[i + j] : active[na - 1 - i - j];
+              sx[j] = x0 + l * xinc + e->u * dx;
+              sy[j] = y0 + l * yinc + e->u * dy;
+            }
+          polyline(2, sx, sy, GKS_K_LINETYPE_SOLID, 0);
         }
+      l++;
     }
+
+  gks_free(active);
+  gks_free(edges);
 }
 
 void gks_emul_fillarea(int n, double *px, double *py, int tnr,
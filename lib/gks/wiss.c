@@ -43,14 +43,18 @@ static int unused_variable = 0;
 
 static void reallocate(int len)
 {
+  int size = p->size;
+
   while (p->nbytes + len > p->size) p->size += SEGM_SIZE;
 
-  p->buffer = (char *)gks_realloc(p->buffer, p->size + 1);
+  /* the segment storage is terminated by a zero length */
+  p->buffer = (char *)gks_realloc(p->buffer, p->size + sizeof(int));
   if (p->buffer == NULL)
     {
       gks_perror("memory allocation failed");
       exit(1);
     }
+  memset(p->buffer + size, 0, p->size + sizeof(int) - size);
 }
 
 #if 0
@@ -279,7 +283,7 @@ static void write_item(int sgnum, int fctid, int dx, int dy, int dimx, int *i_ar
 static void delete_seg(char *str, int segn)
 {
   char *s, *d;
-  int sp = 0, *len, *sgnum, dp = 0, saved_sp;
+  int sp = 0, *len, *sgnum, dp = 0, saved_sp, item_len;
 
   s = d = str;
 
@@ -291,12 +295,14 @@ static void delete_seg(char *str, int segn)
       RESOLVE(sgnum, int, sizeof(int));
       sp = saved_sp;
 
+      /* the item may overlap its new position, so its length must be read before it is moved */
+      item_len = *len;
       if (*sgnum != 0 && segn != *sgnum)
         {
-          if (sp > dp) memmove(d + dp, s + sp, *len);
-          dp += *len;
+          if (sp > dp) memmove(d + dp, s + sp, item_len);
+          dp += item_len;
         }
-      sp += *len;
+      sp += item_len;
 
       saved_sp = sp;
       RESOLVE(len, int, sizeof(int));
@@ -327,7 +333,7 @@ void gks_drv_wiss(int fctid, int dx, int dy, int dimx, int *i_arr, int len_farr_
       p->segn = 0;
       p->empty = 1;
 
-      p->buffer = (char *)gks_malloc(SEGM_SIZE);
+      p->buffer = (char *)gks_malloc(SEGM_SIZE + sizeof(int));
       p->size = SEGM_SIZE;
       p->nbytes = 0;
 
@@ -432,6 +438,18 @@ void gks_drv_wiss(int fctid, int dx, int dy, int dimx, int *i_arr, int len_farr_
     case 56: /* create segment */
 
       p->segn = i_arr[0];
+      if (p->state == GKS_K_WS_ACTIVE)
+        {
+          /* store the GKS state at segment creation, so the segment can be replayed on its own */
+          int len = 3 * sizeof(int) + sizeof(gks_state_list_t), fctid = 2;
+
+          if (p->nbytes + len > p->size) reallocate(len);
+
+          COPY(&len, sizeof(int));
+          COPY(&p->segn, sizeof(int));
+          COPY(&fctid, sizeof(int));
+          COPY(gkss, sizeof(gks_state_list_t));
+        }
       break;
 
     case 57: /* close segment */
@@ -449,7 +467,7 @@ void gks_drv_wiss(int fctid, int dx, int dy, int dimx, int *i_arr, int len_farr_
 static void interp(char *str, int segn)
 {
   char *s;
-  gks_state_list_t *gkss = NULL;
+  gks_state_list_t *seg_state = NULL;
   int sp = 0, *len, *sgnum, *fctid, sx = 1, sy = 1;
   int *i_arr = NULL, *dx = NULL, *dy = NULL, *dimx = NULL, *len_c_arr = NULL;
   int *n = NULL, *primid = NULL, *ldr = NULL;
@@ -468,12 +486,20 @@ static void interp(char *str, int segn)
       RESOLVE(sgnum, int, sizeof(int));
       RESOLVE(fctid, int, sizeof(int));
 
+      if (segn != 0 && *sgnum != segn)
+        {
+          /* skip items of other segments without decoding them */
+          sp = saved_sp + *len;
+          saved_sp = sp;
+          RESOLVE(len, int, sizeof(int));
+          continue;
+        }
+
       switch (*fctid)
         {
         case 2:
 
-          RESOLVE(gkss, gks_state_list_t, sizeof(gks_state_list_t));
-          unused_variable = gkss->ltype;
+          RESOLVE(seg_state, gks_state_list_t, sizeof(gks_state_list_t));
           break;
 
         case 12: /* polyline */
@@ -602,6 +628,10 @@ static void interp(char *str, int segn)
         {
           switch (*fctid)
             {
+            case 2:
+              /* restore the state of the segment creation (the caller restores the GKS state afterwards) */
+              if (*sgnum != 0) gks_restore_state(seg_state);
+              break;
             case 12:
               gks_polyline(i_arr[0], f_arr_1, f_arr_2);
               break;
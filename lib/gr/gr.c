@@ -23,6 +23,12 @@ typedef __int64 int64_t;
 
 #if !defined(VMS) && !defined(_WIN32)
 #include <unistd.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <dirent.h>
+#include <time.h>
+#include <utime.h>
+#include <sys/stat.h>
 #endif
 
 #ifndef NO_THREADS
@@ -340,6 +346,8 @@ static unsigned int rgb[MAX_COLOR], used[MAX_COLOR];
 
 #define POINT_INC 2048
 
+#define CLIP_RUNS_MIN 1024
+
 /* Path definitions */
 #define STOP 0
 #define MOVETO 1
@@ -1853,6 +1861,50 @@ static void primitive(char *name, int n, double *x, double *y)
   gr_writestream("/>\n");
 }
 
+/*
+ * Pass a NaN free polyline in linear world coordinates to GKS. Long solid
+ * polylines are split into the runs which may be visible in the clipping
+ * rectangle, so that zoomed-in views of large data sets don't hand all the
+ * invisible points down to the workstations. The rectangle is enlarged by 10%
+ * to keep line joins and caps near the edges intact.
+ */
+
+static void clipped_polyline(int n, double *x, double *y)
+{
+  int state, errind, clsw, clip_tnr, ltype, tnr, nruns, i, *runs;
+  double clrt[4], wn[4], vp[4], dx, dy;
+
+  if (n >= CLIP_RUNS_MIN)
+    {
+      gks_inq_operating_state(&state);
+      gks_inq_clip(&errind, &clsw, clrt);
+      gks_inq_clip_xform(&errind, &clip_tnr);
+      gks_inq_pline_linetype(&errind, &ltype);
+
+      if (state != GKS_K_SGOP && clsw == GKS_K_CLIP && clip_tnr == 0 && ltype == GKS_K_LINETYPE_SOLID)
+        {
+          gks_inq_current_xformno(&errind, &tnr);
+          gks_inq_xform(tnr, &errind, wn, vp);
+
+          dx = 0.1 * (wn[1] - wn[0]);
+          dy = 0.1 * (wn[3] - wn[2]);
+          wn[0] -= dx;
+          wn[1] += dx;
+          wn[2] -= dy;
+          wn[3] += dy;
+
+          runs = (int *)xmalloc(n * sizeof(int));
+          nruns = gks_clip_runs(n, x, y, wn, runs);
+          for (i = 0; i < nruns; i++)
+            gks_polyline(runs[2 * i + 1] - runs[2 * i] + 1, x + runs[2 * i], y + runs[2 * i]);
+          free(runs);
+          return;
+        }
+    }
+
+  gks_polyline(n, x, y);
+}
+
 static void polyline(int n, double *x, double *y)
 {
   int i, npoints;
@@ -1866,7 +1918,7 @@ static void polyline(int n, double *x, double *y)
       ypoint[npoints] = y_lin(y[i]);
       if (is_nan(xpoint[npoints]) || is_nan(ypoint[npoints]))
         {
-          if (npoints >= 2) gks_polyline(npoints, xpoint, ypoint);
+          if (npoints >= 2) clipped_polyline(npoints, xpoint, ypoint);
 
           npoints = 0;
         }
@@ -1874,7 +1926,7 @@ static void polyline(int n, double *x, double *y)
         npoints++;
     }
 
-  if (npoints != 0) gks_polyline(npoints, xpoint, ypoint);
+  if (npoints != 0) clipped_polyline(npoints, xpoint, ypoint);
 }
 
 /*!
@@ -6058,8 +6110,9 @@ void gr_polyline3d(int n, double *px, double *py, double *pz)
   double clrt[4], wn[4], vp[4];
   int modern_projection_type;
 
-  double x, y, z, x0, y0, z0, x1, y1, z1;
+  double x, y, z, x0, y0, z0, x1, y1, z1, box[4];
   int clip = 1, visible = 1;
+  int m, r, nruns, *runs, single_run[2];
 
   check_autoinit;
 
@@ -6115,40 +6168,67 @@ void gr_polyline3d(int n, double *px, double *py, double *pz)
       visible = 1;
     }
 
-  x0 = px[0];
-  y0 = py[0];
-  z0 = pz[0];
+  for (m = 1; m < n; m++)
+    if (is_nan(px[m]) || is_nan(py[m]) || is_nan(pz[m])) break;
 
-  for (i = 1; i < n; i++)
+  /* segments which are beyond the same x or y face of the clipping box are
+   * dropped in bulk, the remaining runs are clipped segment by segment */
+  if (clsw == GKS_K_CLIP && m >= CLIP_RUNS_MIN)
+    {
+      box[0] = cxl;
+      box[1] = cxr;
+      box[2] = cyf;
+      box[3] = cyb;
+      runs = (int *)xmalloc(m * sizeof(int));
+      nruns = gks_clip_runs(m, px, py, box, runs);
+    }
+  else
     {
-      x1 = px[i];
-      y1 = py[i];
-      z1 = pz[i];
-      if (is_nan(x1) || is_nan(y1) || is_nan(z1)) break;
+      runs = single_run;
+      runs[0] = 0;
+      runs[1] = m - 1;
+      nruns = 1;
+    }
 
-      x = x1;
-      y = y1;
-      z = z1;
-      if (clsw == GKS_K_CLIP)
-        {
-          clip3d(&x0, &x1, &y0, &y1, &z0, &z1, &visible);
-        }
-      if (visible)
+  for (r = 0; r < nruns; r++)
+    {
+      x0 = px[runs[2 * r]];
+      y0 = py[runs[2 * r]];
+      z0 = pz[runs[2 * r]];
+      clip = 1;
+
+      for (i = runs[2 * r] + 1; i <= runs[2 * r + 1]; i++)
         {
-          if (clip)
+          x1 = px[i];
+          y1 = py[i];
+          z1 = pz[i];
+
+          x = x1;
+          y = y1;
+          z = z1;
+          if (clsw == GKS_K_CLIP)
             {
-              start_pline3d(x0, y0, z0);
-              clip = 0;
+              clip3d(&x0, &x1, &y0, &y1, &z0, &z1, &visible);
+            }
+          if (visible)
+            {
+              if (clip)
+                {
+                  start_pline3d(x0, y0, z0);
+                  clip = 0;
+                }
+              pline3d(x1, y1, z1);
             }
-          pline3d(x1, y1, z1);
-        }
 
-      clip = !visible || x != x1 || y != y1 || z != z1;
-      x0 = x;
-      y0 = y;
-      z0 = z;
+          clip = !visible || x != x1 || y != y1 || z != z1;
+          x0 = x;
+          y0 = y;
+          z0 = z;
+        }
     }
 
+  if (runs != single_run) free(runs);
+
   end_pline();
 
   if (flag_stream)
@@ -11168,115 +11248,364 @@ void gr_endgraphics(void)
     }
 }
 
-static void latex2image(char *string, int pointSize, double *rgb, int *width, int *height, int **data)
+/*
+ * LaTeX images are cached in two tiers: decoded images of recently used formulas are kept in memory, and the PNG
+ * files produced by latex and dvipng are kept in a cache directory (GR_LATEX_CACHE_DIR, the temporary directory by
+ * default). The size of the cache directory is limited to GR_LATEX_CACHE_SIZE megabytes; the least recently used
+ * images are removed first. A lock file ensures that only one process runs latex for a given formula.
+ */
+
+#define LATEX_IMAGE_CACHE_SIZE 128
+#define LATEX_IMAGE_CACHE_BYTES (64 * 1024 * 1024)
+#define LATEX_DISK_CACHE_SIZE 256 /* MB */
+#define LATEX_LOCK_TIMEOUT 60     /* seconds */
+
+typedef struct
 {
-  static char *temp = NULL;
-  int color;
-  char s[FILENAME_MAX], path[FILENAME_MAX], cache[33];
-  char *null, cmd[2 * FILENAME_MAX + 200];
-  static char *preamble = NULL;
-  char tex[FILENAME_MAX], dvi[FILENAME_MAX], png[FILENAME_MAX];
-  FILE *stream;
-  int math, ret;
-#ifdef _WIN32
-  wchar_t w_path[MAX_PATH];
+  char key[33];
+  int width, height;
+  int *data;
+  unsigned long last_use;
+} latex_image_t;
+
+static latex_image_t latex_images[LATEX_IMAGE_CACHE_SIZE];
+static size_t latex_image_bytes = 0;
+static unsigned long latex_image_clock = 0;
+
+static int lookup_latex_image(const char *key, int *width, int *height, int **data)
+{
+  int i;
+
+  for (i = 0; i < LATEX_IMAGE_CACHE_SIZE; i++)
+    {
+      if (latex_images[i].data != NULL && strcmp(latex_images[i].key, key) == 0)
+        {
+          latex_images[i].last_use = ++latex_image_clock;
+          *width = latex_images[i].width;
+          *height = latex_images[i].height;
+          *data = (int *)xmalloc(*width * *height * sizeof(int));
+          memcpy(*data, latex_images[i].data, *width * *height * sizeof(int));
+          return 1;
+        }
+    }
+  return 0;
+}
+
+static void store_latex_image(const char *key, int width, int height, const int *data)
+{
+  size_t size = (size_t)width * height * sizeof(int);
+  latex_image_t *image;
+  int i;
+
+  if (size > LATEX_IMAGE_CACHE_BYTES) return;
+
+  for (;;)
+    {
+      image = NULL;
+      for (i = 0; i < LATEX_IMAGE_CACHE_SIZE; i++)
+        {
+          if (latex_images[i].data == NULL)
+            {
+              if (latex_image_bytes + size <= LATEX_IMAGE_CACHE_BYTES)
+                {
+                  image = latex_images + i;
+                  break;
+                }
+            }
+          else if (image == NULL || latex_images[i].last_use < image->last_use)
+            {
+              image = latex_images + i;
+            }
+        }
+      if (image->data == NULL) break;
+
+      latex_image_bytes -= (size_t)image->width * image->height * sizeof(int);
+      free(image->data);
+      image->data = NULL;
+    }
+
+  strcpy(image->key, key);
+  image->width = width;
+  image->height = height;
+  image->data = (int *)xmalloc(size);
+  memcpy(image->data, data, size);
+  image->last_use = ++latex_image_clock;
+  latex_image_bytes += size;
+}
+
+#if !defined(VMS) && !defined(_WIN32)
+
+static void sleep_ms(long ms)
+{
+  struct timespec ts;
+
+  ts.tv_sec = ms / 1000;
+  ts.tv_nsec = (ms % 1000) * 1000000L;
+  nanosleep(&ts, NULL);
+}
+
+/*
+ * Acquire the lock for rendering a cache image. Returns 1 if the lock has been acquired, 0 if the image has been
+ * created by another process in the meantime, or -1 if locking is not possible (the image is rendered anyway).
+ */
+static int lock_latex_image(const char *lock, const char *path)
+{
+  struct stat buf;
+  int fd;
+
+  while ((fd = open(lock, O_WRONLY | O_CREAT | O_EXCL, 0644)) < 0)
+    {
+      if (errno != EEXIST) return -1;
+      if (access(path, R_OK) == 0) return 0;
+      if (stat(lock, &buf) == 0 && time(NULL) - buf.st_mtime > LATEX_LOCK_TIMEOUT)
+        {
+          /* stale lock of a process which has been terminated */
+          remove(lock);
+          continue;
+        }
+      sleep_ms(50);
+    }
+  close(fd);
+  return 1;
+}
+
+typedef struct
+{
+  char *name;
+  off_t size;
+  time_t mtime;
+} cache_file_t;
+
+static int compare_cache_files(const void *a, const void *b)
+{
+  const cache_file_t *fa = (const cache_file_t *)a, *fb = (const cache_file_t *)b;
+
+  return fa->mtime < fb->mtime ? -1 : (fa->mtime > fb->mtime ? 1 : 0);
+}
+
+static void prune_latex_cache(const char *dir, const char *keep)
+{
+  DIR *d;
+  struct dirent *entry;
+  struct stat buf;
+  char path[FILENAME_MAX], *env;
+  cache_file_t *files = NULL;
+  int num_files = 0, max_files = 0, i;
+  double total = 0, limit = LATEX_DISK_CACHE_SIZE;
+  size_t len;
+
+  if ((env = (char *)gks_getenv("GR_LATEX_CACHE_SIZE")) != NULL) limit = atof(env);
+  if (limit <= 0) return;
+  limit *= 1024 * 1024;
+
+  if ((d = opendir(dir)) == NULL) return;
+  while ((entry = readdir(d)) != NULL)
+    {
+      len = strlen(entry->d_name);
+      if (strncmp(entry->d_name, "gr-cache-", 9) != 0 || len < 13 || strcmp(entry->d_name + len - 4, ".png") != 0)
+        continue;
+      snprintf(path, FILENAME_MAX, "%s%s%s", dir, DIRDELIM, entry->d_name);
+      if (strcmp(path, keep) == 0 || stat(path, &buf) != 0) continue;
+      if (num_files == max_files)
+        {
+          max_files = max_files ? 2 * max_files : 64;
+          files = (cache_file_t *)xrealloc(files, max_files * sizeof(cache_file_t));
+        }
+      files[num_files].name = gks_strdup(path);
+      files[num_files].size = buf.st_size;
+      files[num_files].mtime = buf.st_mtime;
+      total += buf.st_size;
+      num_files++;
+    }
+  closedir(d);
+
+  if (total > limit)
+    {
+      qsort(files, num_files, sizeof(cache_file_t), compare_cache_files);
+      for (i = 0; i < num_files && total > limit; i++)
+        {
+          if (remove(files[i].name) == 0) total -= files[i].size;
+        }
+    }
+  for (i = 0; i < num_files; i++) gks_free(files[i].name);
+  free(files);
+}
+
 #endif
 
-  color = ((int)(rgb[0] * 255)) + ((int)(rgb[1] * 255) << 8) + ((int)(rgb[2] * 255) << 16) + (255 << 24);
-  snprintf(s, FILENAME_MAX, "%d%x%s", pointSize, color, string);
-  md5(s, cache, FILENAME_MAX);
-  if (temp == NULL)
+static const char *latex_cache_dir(void)
+{
+  static const char *dir = NULL;
+
+  if (dir == NULL)
     {
+      dir = gks_getenv("GR_LATEX_CACHE_DIR");
+      if (dir != NULL && *dir != '\0')
+        {
+#if !defined(VMS) && !defined(_WIN32)
+          mkdir(dir, 0755);
+#endif
+        }
+      else
+        {
 #ifdef _WIN32
-      temp = (char *)gks_getenv("TEMP");
+          dir = gks_getenv("TEMP");
 #else
-      temp = mkdtemp("gr-temp");
+          dir = NULL;
 #endif
-      if (temp == NULL) temp = TMPDIR;
+          if (dir == NULL) dir = TMPDIR;
+        }
     }
-  snprintf(path, FILENAME_MAX, "%s%sgr-cache-%s.png", temp, DIRDELIM, cache);
+  return dir;
+}
 
+static void run_latex(char *string, int pointSize, double *rgb, const char *temp, const char *job, const char *path)
+{
+  char *null, cmd[2 * FILENAME_MAX + 200];
+  static char *preamble = NULL;
+  char tex[FILENAME_MAX], dvi[FILENAME_MAX], png[FILENAME_MAX], aux[FILENAME_MAX], log[FILENAME_MAX];
+  FILE *stream;
+  int math, ret;
 #ifdef _WIN32
-  MultiByteToWideChar(CP_UTF8, 0, path, strlen(path) + 1, w_path, MAX_PATH);
-  if (_waccess(w_path, R_OK) != 0)
-#else
-  if (access(path, R_OK) != 0)
+  wchar_t w_path[MAX_PATH];
 #endif
-    {
-      math = strstr(string, "\\(") == NULL;
-      snprintf(tex, FILENAME_MAX, "%s%s%s.tex", temp, DIRDELIM, cache);
-      snprintf(dvi, FILENAME_MAX, "%s%s%s.dvi", temp, DIRDELIM, cache);
-      snprintf(png, FILENAME_MAX, "%s%s%s.png", temp, DIRDELIM, cache);
+
+  math = strstr(string, "\\(") == NULL;
+  snprintf(tex, FILENAME_MAX, "%s%s%s.tex", temp, DIRDELIM, job);
+  snprintf(dvi, FILENAME_MAX, "%s%s%s.dvi", temp, DIRDELIM, job);
+  snprintf(png, FILENAME_MAX, "%s%s%s.png", temp, DIRDELIM, job);
+  snprintf(aux, FILENAME_MAX, "%s%s%s.aux", temp, DIRDELIM, job);
+  snprintf(log, FILENAME_MAX, "%s%s%s.log", temp, DIRDELIM, job);
 #ifdef _WIN32
-      null = "NUL";
-      MultiByteToWideChar(CP_UTF8, 0, tex, strlen(tex) + 1, w_path, MAX_PATH);
-      stream = _wfopen(w_path, L"w");
+  null = "NUL";
+  MultiByteToWideChar(CP_UTF8, 0, tex, strlen(tex) + 1, w_path, MAX_PATH);
+  stream = _wfopen(w_path, L"w");
 #else
-      null = "/dev/null";
-      stream = fopen(tex, "w");
+  null = "/dev/null";
+  stream = fopen(tex, "w");
 #endif
-      if (preamble == NULL)
-        {
-          preamble = (char *)gks_getenv("GR_LATEX_PREAMBLE");
-        }
-      if (preamble != NULL)
+  if (stream == NULL)
+    {
+      fprintf(stderr, "latex: can't create %s\n", tex);
+      return;
+    }
+  if (preamble == NULL)
+    {
+      preamble = (char *)gks_getenv("GR_LATEX_PREAMBLE");
+    }
+  if (preamble != NULL)
+    {
+      if (strcmp(preamble, "AMS") == 0)
         {
-          if (strcmp(preamble, "AMS") == 0)
-            {
-              preamble = "\
+          preamble = "\
 \\documentclass{article}\n\
 \\pagestyle{empty}\n\
 \\usepackage{amssymb}\n\
 \\usepackage{amsmath}\n\
 \\usepackage[dvips]{color}\n\
 \\begin{document}\n";
-            }
         }
-      else
-        {
-          preamble = "\
+    }
+  else
+    {
+      preamble = "\
 \\documentclass{article}\n\
 \\pagestyle{empty}\n\
 \\usepackage[dvips]{color}\n\
 \\begin{document}\n";
-        }
-      fprintf(stream, "%s", preamble);
-      if (math) fprintf(stream, "\\[\n");
-      fprintf(stream, "\\color[rgb]{%.3f,%.3f,%.3f} {\n", rgb[0], rgb[1], rgb[2]);
-      fwrite(string, strlen(string), 1, stream);
-      fprintf(stream, "}\n");
-      if (math) fprintf(stream, "\\]\n");
-      fprintf(stream, "\\end{document}");
-      fclose(stream);
-
-      snprintf(cmd, 2 * FILENAME_MAX + 200, "latex -interaction=batchmode -halt-on-error -output-directory=%s %s >%s",
-               temp, tex, null);
-      ret = system(cmd);
+    }
+  fprintf(stream, "%s", preamble);
+  if (math) fprintf(stream, "\\[\n");
+  fprintf(stream, "\\color[rgb]{%.3f,%.3f,%.3f} {\n", rgb[0], rgb[1], rgb[2]);
+  fwrite(string, strlen(string), 1, stream);
+  fprintf(stream, "}\n");
+  if (math) fprintf(stream, "\\]\n");
+  fprintf(stream, "\\end{document}");
+  fclose(stream);
+
+  snprintf(cmd, 2 * FILENAME_MAX + 200, "latex -interaction=batchmode -halt-on-error -output-directory=%s %s >%s", temp,
+           tex, null);
+  ret = system(cmd);
 
 #ifdef _WIN32
-      MultiByteToWideChar(CP_UTF8, 0, dvi, strlen(dvi) + 1, w_path, MAX_PATH);
-      if (ret == 0 && _waccess(w_path, R_OK) == 0)
+  MultiByteToWideChar(CP_UTF8, 0, dvi, strlen(dvi) + 1, w_path, MAX_PATH);
+  if (ret == 0 && _waccess(w_path, R_OK) == 0)
 #else
-      if (ret == 0 && access(dvi, R_OK) == 0)
+  if (ret == 0 && access(dvi, R_OK) == 0)
 #endif
+    {
+      snprintf(cmd, 2 * FILENAME_MAX + 200, "dvipng -bg transparent -q -T tight -x %d %s -o %s >%s", pointSize * 100,
+               dvi, png, null);
+      ret = system(cmd);
+      if (ret == 0)
         {
-          snprintf(cmd, 2 * FILENAME_MAX + 200, "dvipng -bg transparent -q -T tight -x %d %s -o %s >%s",
-                   pointSize * 100, dvi, png, null);
-          ret = system(cmd);
-          if (ret == 0)
+          /* the image appears atomically for concurrent readers */
+          rename(png, path);
+          if (remove(tex) != 0 || remove(dvi) != 0)
             {
-              rename(png, path);
-              if (remove(tex) != 0 || remove(dvi) != 0)
-                {
-                  fprintf(stderr, "error deleting temprorary files\n");
-                }
+              fprintf(stderr, "error deleting temprorary files\n");
             }
-          else
-            fprintf(stderr, "dvipng: PNG conversion failed\n");
+          remove(aux);
+          remove(log);
         }
       else
-        fprintf(stderr, "latex: failed to create a dvi file\n");
+        fprintf(stderr, "dvipng: PNG conversion failed\n");
+    }
+  else
+    fprintf(stderr, "latex: failed to create a dvi file\n");
+}
+
+static void latex2image(char *string, int pointSize, double *rgb, int *width, int *height, int **data)
+{
+  const char *temp;
+  int color;
+  char s[FILENAME_MAX], path[FILENAME_MAX], cache[33];
+#ifdef _WIN32
+  wchar_t w_path[MAX_PATH];
+#elif !defined(VMS)
+  char lock[FILENAME_MAX], job[FILENAME_MAX];
+  int locked;
+#endif
+
+  color = ((int)(rgb[0] * 255)) + ((int)(rgb[1] * 255) << 8) + ((int)(rgb[2] * 255) << 16) + (255 << 24);
+  snprintf(s, FILENAME_MAX, "%d%x%s", pointSize, color, string);
+  md5(s, cache, FILENAME_MAX);
+
+  if (lookup_latex_image(cache, width, height, data)) return;
+
+  temp = latex_cache_dir();
+  snprintf(path, FILENAME_MAX, "%s%sgr-cache-%s.png", temp, DIRDELIM, cache);
+
+#ifdef _WIN32
+  MultiByteToWideChar(CP_UTF8, 0, path, strlen(path) + 1, w_path, MAX_PATH);
+  if (_waccess(w_path, R_OK) != 0)
+    {
+      run_latex(string, pointSize, rgb, temp, cache, path);
+    }
+#elif !defined(VMS)
+  if (access(path, R_OK) != 0)
+    {
+      snprintf(lock, FILENAME_MAX, "%s%sgr-cache-%s.lock", temp, DIRDELIM, cache);
+      locked = lock_latex_image(lock, path);
+      if (locked != 0 && access(path, R_OK) != 0)
+        {
+          snprintf(job, FILENAME_MAX, "%s-%d", cache, (int)getpid());
+          run_latex(string, pointSize, rgb, temp, job, path);
+          prune_latex_cache(temp, path);
+        }
+      if (locked == 1) remove(lock);
     }
+  else
+    {
+      /* mark the image as recently used */
+      utime(path, NULL);
+    }
+#else
+  if (access(path, R_OK) != 0)
+    {
+      run_latex(string, pointSize, rgb, temp, cache, path);
+    }
+#endif
 
 #ifdef _WIN32
   MultiByteToWideChar(CP_UTF8, 0, path, strlen(path) + 1, w_path, MAX_PATH);
@@ -11285,7 +11614,10 @@ static void latex2image(char *string, int pointSize, double *rgb, int *width, in
   if (access(path, R_OK) == 0)
 #endif
     {
-      gr_readimage(path, width, height, data);
+      if (gr_readimage(path, width, height, data) == 0 && *data != NULL)
+        {
+          store_latex_image(cache, *width, *height, *data);
+        }
     }
 }
 
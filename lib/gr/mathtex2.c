@@ -759,6 +759,7 @@ static const unsigned int symbol_codepoints[] = {
 #include <stdlib.h>
 #include <ctype.h>
 #include <math.h>
+#include <time.h>
 #include <assert.h>
 
 #include "gr.h"
@@ -3521,22 +3522,119 @@ static void get_results(size_t bm_node_index, double *width, double *height, dou
 }
 
 
+/*
+ * Layout cache
+ *
+ * The box model of a formula only depends on the formula itself and the font size, so the packed box model nodes are
+ * kept for the most recently used formulas. Inquiring the extent of a formula and drawing it afterwards (or drawing it
+ * again on a redraw) then only needs to ship out the cached box model.
+ */
+
+#define LAYOUT_CACHE_SIZE 64
+
+typedef struct LayoutCacheEntry_
+{
+  char *formula;
+  double font_size;
+  int font;
+  unsigned long last_use;
+  BoxModelNode *nodes;
+  size_t num_nodes;
+  size_t result_index;
+  double canvas_width;
+  double canvas_height;
+  double canvas_depth;
+} LayoutCacheEntry;
+
+static LayoutCacheEntry layout_cache[LAYOUT_CACHE_SIZE];
+static unsigned long layout_cache_clock = 0;
+
+/* debug counters, reported on stderr if GR_DEBUG is set */
+static unsigned long num_layouts = 0;
+static unsigned long num_layout_cache_hits = 0;
+static double parse_time = 0;
+static double layout_time = 0;
+static double render_time = 0;
+
+static int restore_box_model(const char *formula, int font)
+{
+  LayoutCacheEntry *entry;
+  int i;
+
+  for (i = 0; i < LAYOUT_CACHE_SIZE; i++)
+    {
+      entry = layout_cache + i;
+      if (entry->formula && entry->font_size == font_size && entry->font == font && strcmp(entry->formula, formula) == 0)
+        {
+          free_box_model_node_buffer();
+          box_model_node_memory_ = (BoxModelNode *)gks_malloc(entry->num_nodes * sizeof(BoxModelNode));
+          memcpy(box_model_node_memory_, entry->nodes, entry->num_nodes * sizeof(BoxModelNode));
+          box_model_node_memory_size_ = entry->num_nodes;
+          box_model_node_next_index_ = entry->num_nodes;
+          result_box_model_node_index = entry->result_index;
+          canvas_width = entry->canvas_width;
+          canvas_height = entry->canvas_height;
+          canvas_depth = entry->canvas_depth;
+          entry->last_use = ++layout_cache_clock;
+          num_layout_cache_hits++;
+          return 1;
+        }
+    }
+  return 0;
+}
+
+static void store_box_model(const char *formula, int font)
+{
+  LayoutCacheEntry *entry = layout_cache;
+  int i;
+
+  for (i = 1; i < LAYOUT_CACHE_SIZE && entry->formula; i++)
+    {
+      if (!layout_cache[i].formula || layout_cache[i].last_use < entry->last_use)
+        {
+          entry = layout_cache + i;
+        }
+    }
+  if (entry->formula)
+    {
+      gks_free(entry->formula);
+      gks_free(entry->nodes);
+    }
+  entry->formula = gks_strdup(formula);
+  entry->font_size = font_size;
+  entry->font = font;
+  entry->last_use = ++layout_cache_clock;
+  entry->num_nodes = box_model_node_next_index_;
+  entry->nodes = (BoxModelNode *)gks_malloc(entry->num_nodes * sizeof(BoxModelNode));
+  memcpy(entry->nodes, box_model_node_memory_, entry->num_nodes * sizeof(BoxModelNode));
+  entry->result_index = result_box_model_node_index;
+  entry->canvas_width = canvas_width;
+  entry->canvas_height = canvas_height;
+  entry->canvas_depth = canvas_depth;
+}
+
 static void mathtex_to_box_model(const char *mathtex, double *width, double *height, double *depth)
 {
   BoxModelNode *result_node;
+  clock_t start;
   state = OUTSIDE_SYMBOL;
   symbol_start = NULL;
   ignore_whitespace = 0;
   input = mathtex;
   cursor = input;
+  num_layouts++;
+  start = clock();
   yyparse();
+  parse_time += (double)(clock() - start) / CLOCKS_PER_SEC;
   if (has_parser_error)
     {
       return;
     }
+  start = clock();
   result_box_model_node_index = convert_to_box_model(result_parser_node_index, 0);
   kern_hlist(result_box_model_node_index);
   pack_hlist(result_box_model_node_index, 0.0, 1);
+  layout_time += (double)(clock() - start) / CLOCKS_PER_SEC;
   result_node = get_box_model_node(result_box_model_node_index);
   assert(get_box_model_node(result_box_model_node_index)->type == BT_HLIST);
   canvas_height = result_node->u.hlist.height + result_node->u.hlist.depth;
@@ -3929,14 +4027,23 @@ void mathtex2(double x, double y, const char *formula, int inquire, double *tbx,
   transformation[4] = 0;
   transformation[5] = 0;
   font_size = 16.0 * previous_char_height / 0.027 * window_height / 500;
-  mathtex_to_box_model(formula, NULL, NULL, NULL);
+  if (!restore_box_model(formula, font))
+    {
+      mathtex_to_box_model(formula, NULL, NULL, NULL);
+      if (!has_parser_error)
+        {
+          store_box_model(formula, font);
+        }
+    }
   if (!has_parser_error)
     {
       double x_offset = 0;
       double y_offset = 0;
       if (!inquire)
         {
+          clock_t start = clock();
           render_box_model(x, y, horizontal_alignment, vertical_alignment);
+          render_time += (double)(clock() - start) / CLOCKS_PER_SEC;
         }
       else
         {
@@ -4000,6 +4107,12 @@ void mathtex2(double x, double y, const char *formula, int inquire, double *tbx,
   gks_set_viewport(1, previous_viewport_xmin, previous_viewport_xmax, previous_viewport_ymin, previous_viewport_ymax);
   gks_select_xform(previous_tnr);
 
+  if (gr_debug())
+    {
+      fprintf(stderr, "mathtex2: %lu layouts, %lu cache hits, parse %.3f s, layout %.3f s, render %.3f s\n",
+              num_layouts, num_layout_cache_hits, parse_time, layout_time, render_time);
+    }
+
   if (inquire && previous_tnr != 0)
     {
       int i;
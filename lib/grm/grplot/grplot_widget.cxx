@@ -811,11 +811,20 @@ void GRPlotWidget::received(grm_args_t_wrapper args)
     {
       window()->show();
     }
+  grm_switch(1);
+  int append = 0;
+  if (grm_args_values(args.get_wrapper(), "append", "i", &append) && append)
+    {
+      /* Appended points are stored in the plot, so the message must not be merged again (e.g. on resize) */
+      grm_merge(args.get_wrapper());
+      grm_args_delete(args.get_wrapper());
+      redraw();
+      return;
+    }
   if (args_)
     {
       grm_args_delete(args_);
     }
-  grm_switch(1);
   args_ = args.get_wrapper();
   grm_merge(args_);
 
@@ -40,6 +40,8 @@ typedef struct _grm_args_t grm_args_t;
 
 typedef grm_args_t *grm_args_ptr_t;
 
+typedef void (*grm_args_release_callback_t)(void *data, void *context);
+
 /* ------------------------- argument iterator ---------------------------------------------------------------------- */
 
 struct _args_iterator_private_t;
@@ -78,6 +80,8 @@ EXPORT void grm_args_delete(grm_args_t *args);
 EXPORT int grm_args_push(grm_args_t *args, const char *key, const char *value_format, ...);
 EXPORT int grm_args_push_buf(grm_args_t *args, const char *key, const char *value_format, const void *buffer,
                              int apply_padding);
+EXPORT int grm_args_push_ref(grm_args_t *args, const char *key, const char *value_format, unsigned int array_length,
+                             const void *data, grm_args_release_callback_t release, void *context);
 
 EXPORT int grm_args_contains(const grm_args_t *args, const char *keyword);
 
@@ -34,6 +34,9 @@ static int argparse_static_variables_initialized = 0;
 static const char *const ARGS_VALID_FORMAT_SPECIFIERS = "niIdDcCsSaA";
 static const char *const ARGS_VALID_DATA_FORMAT_SPECIFIERS = "idcsa"; /* Each specifier is also valid in upper case */
 
+/* Source of container generations (see `args_mark_modified`); it is never reset, so generations are never reused */
+static unsigned long args_generation_counter = 0;
+
 
 /* ========================= functions ============================================================================== */
 
@@ -679,6 +682,49 @@ arg_t *args_create_args(const char *key, const char *value_format, const void *b
       return NULL;
     }
   arg->priv->reference_count = 1;
+  arg->priv->buffer = NULL;
+  arg->priv->has_stats = 0;
+
+  return arg;
+}
+
+arg_t *args_create_array_ref(const char *key, char format, size_t length, void *data, args_buffer_t *buffer)
+{
+  /* Create an argument which holds a single array (`nI`, `nD`) like `args_create_args` does, but reference `data`
+   * instead of copying it. A reference to `buffer` (which must contain `data`) is taken. */
+  arg_t *arg;
+  size_t *size_t_typed_buffer;
+
+  arg = malloc(sizeof(arg_t));
+  if (arg == NULL)
+    {
+      debug_print_malloc_error();
+      return NULL;
+    }
+  arg->key = gks_strdup(key);
+  arg->value_format = malloc(3);
+  arg->value_ptr = malloc(sizeof(size_t) + sizeof(void *));
+  arg->priv = malloc(sizeof(arg_private_t));
+  if (arg->key == NULL || arg->value_format == NULL || arg->value_ptr == NULL || arg->priv == NULL)
+    {
+      debug_print_malloc_error();
+      free((char *)arg->key);
+      free((char *)arg->value_format);
+      free(arg->value_ptr);
+      free(arg->priv);
+      free(arg);
+      return NULL;
+    }
+  ((char *)arg->value_format)[0] = 'n';
+  ((char *)arg->value_format)[1] = toupper(format);
+  ((char *)arg->value_format)[2] = '\0';
+  size_t_typed_buffer = arg->value_ptr;
+  *size_t_typed_buffer = length;
+  *(void **)(size_t_typed_buffer + 1) = data;
+  arg->priv->reference_count = 1;
+  arg->priv->buffer = buffer;
+  arg->priv->has_stats = 0;
+  ++(buffer->reference_count);
 
   return arg;
 }
@@ -944,12 +990,22 @@ int args_check_format_compatibility(const arg_t *arg, const char *compatible_for
 
 void args_decrease_arg_reference_count(args_node_t *args_node)
 {
-  if (--(args_node->arg->priv->reference_count) == 0)
+  arg_decrease_reference_count(args_node->arg);
+}
+
+void arg_decrease_reference_count(arg_t *arg)
+{
+  if (--(arg->priv->reference_count) == 0)
     {
-      args_value_iterator_t *value_it = arg_value_iter(args_node->arg);
+      args_value_iterator_t *value_it = arg_value_iter(arg);
       while (value_it->next(value_it) != NULL)
         {
           /* use a char pointer since chars have no memory alignment restrictions */
+          if (value_it->is_array && arg->priv->buffer != NULL)
+            {
+              /* the array data is owned by the shared buffer */
+              continue;
+            }
           if (value_it->is_array)
             {
               if (argparse_format_to_delete_callback[(int)value_it->format] != NULL)
@@ -971,11 +1027,15 @@ void args_decrease_arg_reference_count(args_node_t *args_node)
             }
         }
       args_value_iterator_delete(value_it);
-      free((char *)args_node->arg->key);
-      free((char *)args_node->arg->value_format);
-      free(args_node->arg->priv);
-      free(args_node->arg->value_ptr);
-      free(args_node->arg);
+      if (arg->priv->buffer != NULL)
+        {
+          args_buffer_release(arg->priv->buffer);
+        }
+      free((char *)arg->key);
+      free((char *)arg->value_format);
+      free(arg->priv);
+      free(arg->value_ptr);
+      free(arg);
     }
 }
 
@@ -1020,6 +1080,51 @@ void *copy_value(char format, void *value_ptr)
 }
 
 
+/* ------------------------- shared array buffer -------------------------------------------------------------------- */
+
+args_buffer_t *args_buffer_new(void *data, size_t size, grm_args_release_callback_t release, void *context)
+{
+  args_buffer_t *buffer;
+
+  buffer = malloc(sizeof(args_buffer_t));
+  if (buffer == NULL)
+    {
+      debug_print_malloc_error();
+      return NULL;
+    }
+  buffer->reference_count = 1;
+  buffer->data = data;
+  buffer->size = size;
+  buffer->release = release;
+  buffer->context = context;
+
+  return buffer;
+}
+
+void args_buffer_keep_data(void *data, void *context)
+{
+  /* release callback for caller-owned memory which is not released by GRM */
+  (void)data;
+  (void)context;
+}
+
+void args_buffer_release(args_buffer_t *buffer)
+{
+  if (--(buffer->reference_count) == 0)
+    {
+      if (buffer->release != NULL)
+        {
+          buffer->release(buffer->data, buffer->context);
+        }
+      else
+        {
+          free(buffer->data);
+        }
+      free(buffer);
+    }
+}
+
+
 /* ========================= methods ================================================================================ */
 
 /* ------------------------- argument ------------------------------------------------------------------------------- */
@@ -1034,10 +1139,13 @@ err_t arg_increase_array(arg_t *arg, size_t increment)
   size_t *current_size_ptr, new_size;
   void ***current_buffer_ptr, **new_buffer;
   int has_array_terminator;
+  err_t error;
 
   return_error_if(arg->value_format[0] != 'n', ERROR_ARGS_INCREASING_NON_ARRAY_VALUE);
   /* Currently, only one dimensional arrays can be increased */
   return_error_if(strlen(arg->value_format) != 2, ERROR_ARGS_INCREASING_MULTI_DIMENSIONAL_ARRAY);
+  error = arg_unshare_array(arg);
+  return_if_error;
 
   has_array_terminator = argparse_format_has_array_terminator[tolower(arg->value_format[1])];
 
@@ -1063,6 +1171,65 @@ err_t arg_increase_array(arg_t *arg, size_t increment)
   return ERROR_NONE;
 }
 
+err_t arg_unshare_array(arg_t *arg)
+{
+  /* Give the argument its own copy of a shared array, so it can be modified or reallocated. Callers modify the array
+   * afterwards, so its cached statistics are reset. */
+  size_t *size_t_typed_value_ptr, size;
+  void **data_ptr, *data;
+
+  arg->priv->has_stats = 0;
+  if (arg->priv->buffer == NULL)
+    {
+      return ERROR_NONE;
+    }
+  size_t_typed_value_ptr = arg->value_ptr;
+  data_ptr = (void **)(size_t_typed_value_ptr + 1);
+  size = *size_t_typed_value_ptr * argparse_format_to_size[tolower(arg->value_format[1])];
+  data = malloc(size > 0 ? size : 1);
+  if (data == NULL)
+    {
+      debug_print_malloc_error();
+      return ERROR_MALLOC;
+    }
+  if (size > 0)
+    {
+      memcpy(data, *data_ptr, size);
+    }
+  *data_ptr = data;
+  args_buffer_release(arg->priv->buffer);
+  arg->priv->buffer = NULL;
+
+  return ERROR_NONE;
+}
+
+int arg_is_caller_owned(const arg_t *arg)
+{
+  /* Return `1` if the array value of `arg` was pushed with `grm_args_push_ref` and is owned by the caller */
+  return arg->priv->buffer != NULL && arg->priv->buffer->release != NULL;
+}
+
+const array_stats_t *arg_array_stats(const arg_t *arg)
+{
+  /* Return the statistics of an `nD` argument or `NULL` for other formats. They are computed on the first call and
+   * kept until the array is modified, so repeated range computations on unchanged data are free. Caller-owned arrays
+   * can be modified in place unnoticed, so their statistics are computed on every call. */
+  size_t *size_t_typed_value_ptr;
+
+  if (strcmp(arg->value_format, "nD") != 0)
+    {
+      return NULL;
+    }
+  if (!arg->priv->has_stats)
+    {
+      size_t_typed_value_ptr = arg->value_ptr;
+      array_stats_compute(*(double **)(size_t_typed_value_ptr + 1), *size_t_typed_value_ptr, &arg->priv->stats);
+      arg->priv->has_stats = !arg_is_caller_owned(arg);
+    }
+
+  return &arg->priv->stats;
+}
+
 int(arg_first_value)(const arg_t *arg, const char *first_value_format, void *first_value, unsigned int *array_length)
 {
   char *transformed_first_value_format = NULL;
@@ -1297,6 +1464,9 @@ void args_init(grm_args_t *args)
   args->kwargs_head = NULL;
   args->kwargs_tail = NULL;
   args->count = 0;
+  args->index = NULL;
+  args->index_capacity = 0;
+  args_mark_modified(args);
 }
 
 void args_finalize(grm_args_t *args)
@@ -1329,18 +1499,7 @@ grm_args_t *args_flatcopy(const grm_args_t *copy_args)
           goto error_cleanup;
         }
       args_node->arg = copy_arg;
-      args_node->next = NULL;
-
-      if (args->kwargs_head == NULL)
-        {
-          args->kwargs_head = args_node;
-        }
-      else
-        {
-          args->kwargs_tail->next = args_node;
-        }
-      args->kwargs_tail = args_node;
-      ++(args->count);
+      args_append_node(args, args_node);
     }
   args_iterator_delete(it);
 
@@ -1440,18 +1599,7 @@ grm_args_t *args_copy_extended(const grm_args_t *copy_args, const char **keys_co
               goto error_cleanup;
             }
           args_node->arg = copy_arg;
-          args_node->next = NULL;
-
-          if (args->kwargs_head == NULL)
-            {
-              args->kwargs_head = args_node;
-            }
-          else
-            {
-              args->kwargs_tail->next = args_node;
-            }
-          args->kwargs_tail = args_node;
-          ++(args->count);
+          args_append_node(args, args_node);
         }
     }
   goto cleanup;
@@ -1505,6 +1653,7 @@ err_t args_push_common(grm_args_t *args, const char *key, const char *value_form
     {
       args_decrease_arg_reference_count(args_node);
       args_node->arg = arg;
+      args_mark_modified(args);
     }
   else
     {
@@ -1519,18 +1668,7 @@ err_t args_push_common(grm_args_t *args, const char *key, const char *value_form
           return ERROR_MALLOC;
         }
       args_node->arg = arg;
-      args_node->next = NULL;
-      if (args->kwargs_head == NULL)
-        {
-          args->kwargs_head = args_node;
-          args->kwargs_tail = args_node;
-        }
-      else
-        {
-          args->kwargs_tail->next = args_node;
-          args->kwargs_tail = args_node;
-        }
-      ++(args->count);
+      args_append_node(args, args_node);
     }
 
   return ERROR_NONE;
@@ -1543,60 +1681,45 @@ err_t args_push_vl(grm_args_t *args, const char *key, const char *value_format,
 
 err_t args_push_arg(grm_args_t *args, arg_t *arg)
 {
-  args_node_t *args_node = NULL, *previous_node_by_keyword = NULL;
-  err_t error = ERROR_NONE;
-
-  ++(arg->priv->reference_count);
-  args_node = malloc(sizeof(args_node_t));
-  error_cleanup_and_set_error_if(args_node == NULL, ERROR_MALLOC);
-  args_node->arg = arg;
-  args_node->next = NULL;
+  args_node_t *args_node;
 
-  if (args->kwargs_head == NULL)
+  if ((args_node = args_find_node(args, arg->key)) != NULL)
     {
-      args->kwargs_head = args_node;
-      args->kwargs_tail = args_node;
-      ++(args->count);
+      ++(arg->priv->reference_count);
+      args_decrease_arg_reference_count(args_node);
+      args_node->arg = arg;
+      args_mark_modified(args);
     }
-  else if (args_find_previous_node(args, arg->key, &previous_node_by_keyword))
+  else
     {
-      if (previous_node_by_keyword == NULL)
-        {
-          args_node->next = args->kwargs_head->next;
-          if (args->kwargs_head == args->kwargs_tail)
-            {
-              args->kwargs_tail = args_node;
-            }
-          args_decrease_arg_reference_count(args->kwargs_head);
-          free(args->kwargs_head);
-          args->kwargs_head = args_node;
-        }
-      else
+      args_node = malloc(sizeof(args_node_t));
+      if (args_node == NULL)
         {
-          args_node->next = previous_node_by_keyword->next->next;
-          args_decrease_arg_reference_count(previous_node_by_keyword->next);
-          free(previous_node_by_keyword->next);
-          previous_node_by_keyword->next = args_node;
-          if (args_node->next == NULL)
-            {
-              args->kwargs_tail = args_node;
-            }
+          debug_print_malloc_error();
+          return ERROR_MALLOC;
         }
-    }
-  else
-    {
-      args->kwargs_tail->next = args_node;
-      args->kwargs_tail = args_node;
-      ++(args->count);
+      ++(arg->priv->reference_count);
+      args_node->arg = arg;
+      args_append_node(args, args_node);
     }
 
   return ERROR_NONE;
+}
 
-error_cleanup:
-  if (args_node != NULL)
+err_t args_push_array_ref(grm_args_t *args, const char *key, char format, size_t length, void *data,
+                          args_buffer_t *buffer)
+{
+  arg_t *arg;
+  err_t error;
+
+  if ((arg = args_create_array_ref(key, format, length, data, buffer)) == NULL)
     {
-      free(args_node);
+      return ERROR_MALLOC;
     }
+  error = args_push_arg(args, arg);
+  /* on success, the container holds its own reference */
+  arg_decrease_reference_count(arg);
+
   return error;
 }
 
@@ -1724,10 +1847,44 @@ err_t args_setdefault_vl(grm_args_t *args, const char *key, const char *value_fo
   return args_setdefault_common(args, key, value_format, NULL, vl, 0);
 }
 
+void args_append_node(grm_args_t *args, args_node_t *args_node)
+{
+  args_node->next = NULL;
+  if (args->kwargs_head == NULL)
+    {
+      args->kwargs_head = args_node;
+    }
+  else
+    {
+      args->kwargs_tail->next = args_node;
+    }
+  args->kwargs_tail = args_node;
+  ++(args->count);
+  args_mark_modified(args);
+
+  if (args->index != NULL)
+    {
+      /* Keep the load factor at or below 1/2; if growing fails, the index is dropped and rebuilt on demand */
+      if (2 * args->count > args->index_capacity)
+        {
+          if (!args_index_build(args, 2 * args->index_capacity))
+            {
+              args_index_clear(args);
+            }
+        }
+      else
+        {
+          args_index_insert(args, args_node);
+        }
+    }
+}
+
 void args_clear(grm_args_t *args, const char **exclude_keys)
 {
   args_node_t *current_node, *next_node, *last_excluded_node;
 
+  args_index_clear(args);
+  args_mark_modified(args);
   current_node = args->kwargs_head;
   last_excluded_node = NULL;
   while (current_node != NULL)
@@ -1770,6 +1927,7 @@ err_t args_increase_array(grm_args_t *args, const char *key, size_t increment)
 
   arg = args_at(args, key);
   return_error_if(arg == NULL, ERROR_ARGS_INVALID_KEY);
+  args_mark_modified(args);
   return arg_increase_array(arg, increment);
 }
 
@@ -1827,6 +1985,31 @@ cleanup:
 args_node_t *args_find_node(const grm_args_t *args, const char *keyword)
 {
   args_node_t *current_node;
+  unsigned int mask, i;
+
+  if (args->index == NULL && args->count >= ARGS_INDEX_MIN_COUNT)
+    {
+      /* The index is a cache which does not change the logical state of the container, so it may be built for
+       * `const` containers, too. If memory is short, the list is searched linearly instead. */
+      unsigned int capacity = 2 * ARGS_INDEX_MIN_COUNT;
+      while (capacity < 2 * args->count)
+        {
+          capacity *= 2;
+        }
+      args_index_build((grm_args_t *)args, capacity);
+    }
+  if (args->index != NULL)
+    {
+      mask = args->index_capacity - 1;
+      for (i = args_hash_key(keyword) & mask; (current_node = args->index[i]) != NULL; i = (i + 1) & mask)
+        {
+          if (strcmp(current_node->arg->key, keyword) == 0)
+            {
+              return current_node;
+            }
+        }
+      return NULL;
+    }
 
   current_node = args->kwargs_head;
   while (current_node != NULL && strcmp(current_node->arg->key, keyword) != 0)
@@ -1857,11 +2040,219 @@ int args_find_previous_node(const grm_args_t *args, const char *keyword, args_no
   return 0;
 }
 
+unsigned int args_hash_key(const char *key)
+{
+  /* 32 bit FNV-1a */
+  unsigned long hash = 2166136261UL;
+
+  while (*key != '\0')
+    {
+      hash ^= (unsigned char)*key++;
+      hash = (hash * 16777619UL) & 0xffffffffUL;
+    }
+
+  return (unsigned int)hash;
+}
+
+int args_index_build(grm_args_t *args, unsigned int capacity)
+{
+  args_node_t **index, *current_node;
+
+  index = calloc(capacity, sizeof(args_node_t *));
+  if (index == NULL)
+    {
+      debug_print_malloc_error();
+      return 0;
+    }
+  free(args->index);
+  args->index = index;
+  args->index_capacity = capacity;
+  for (current_node = args->kwargs_head; current_node != NULL; current_node = current_node->next)
+    {
+      args_index_insert(args, current_node);
+    }
+
+  return 1;
+}
+
+void args_index_insert(grm_args_t *args, args_node_t *args_node)
+{
+  unsigned int mask, i;
+
+  mask = args->index_capacity - 1;
+  for (i = args_hash_key(args_node->arg->key) & mask; args->index[i] != NULL; i = (i + 1) & mask)
+    ;
+  args->index[i] = args_node;
+}
+
+void args_index_clear(grm_args_t *args)
+{
+  free(args->index);
+  args->index = NULL;
+  args->index_capacity = 0;
+}
+
 args_iterator_t *args_iter(const grm_args_t *args)
 {
   return args_iterator_new(args->kwargs_head, NULL);
 }
 
+void args_mark_modified(grm_args_t *args)
+{
+  args->generation = ++args_generation_counter;
+}
+
+unsigned long args_generation(const grm_args_t *args)
+{
+  /* Return the latest generation of `args` and all nested containers. Every modification assigns a container a new
+   * generation, so the result changes whenever anything in the hierarchy was modified (or replaced by a new
+   * container) since it was queried the last time. */
+  args_node_t *current_node;
+  args_value_iterator_t *value_it;
+  unsigned long generation = args->generation, nested_generation;
+  grm_args_t **nested_args;
+  size_t i;
+
+  for (current_node = args->kwargs_head; current_node != NULL; current_node = current_node->next)
+    {
+      if (strchr(current_node->arg->value_format, 'a') == NULL && strchr(current_node->arg->value_format, 'A') == NULL)
+        {
+          continue;
+        }
+      value_it = arg_value_iter(current_node->arg);
+      if (value_it == NULL)
+        {
+          continue;
+        }
+      while (value_it->next(value_it) != NULL)
+        {
+          if (value_it->format != 'a')
+            {
+              continue;
+            }
+          nested_args = value_it->is_array ? *(grm_args_t ***)value_it->value_ptr : (grm_args_t **)value_it->value_ptr;
+          for (i = 0; i < (value_it->is_array ? value_it->array_length : 1); i++)
+            {
+              if (nested_args[i] == NULL)
+                {
+                  continue;
+                }
+              nested_generation = args_generation(nested_args[i]);
+              generation = grm_max(generation, nested_generation);
+            }
+        }
+      args_value_iterator_delete(value_it);
+    }
+
+  return generation;
+}
+
+int args_has_caller_owned_arrays(const grm_args_t *args)
+{
+  /* Return `1` if `args` or a nested container holds an array pushed with `grm_args_push_ref`. Such arrays can be
+   * modified in place by the caller, which is not reflected by `args_generation`. */
+  args_node_t *current_node;
+  args_value_iterator_t *value_it;
+  grm_args_t **nested_args;
+  int found = 0;
+  size_t i;
+
+  for (current_node = args->kwargs_head; current_node != NULL && !found; current_node = current_node->next)
+    {
+      if (arg_is_caller_owned(current_node->arg))
+        {
+          return 1;
+        }
+      if (strchr(current_node->arg->value_format, 'a') == NULL && strchr(current_node->arg->value_format, 'A') == NULL)
+        {
+          continue;
+        }
+      value_it = arg_value_iter(current_node->arg);
+      if (value_it == NULL)
+        {
+          continue;
+        }
+      while (!found && value_it->next(value_it) != NULL)
+        {
+          if (value_it->format != 'a')
+            {
+              continue;
+            }
+          nested_args = value_it->is_array ? *(grm_args_t ***)value_it->value_ptr : (grm_args_t **)value_it->value_ptr;
+          for (i = 0; i < (value_it->is_array ? value_it->array_length : 1) && !found; i++)
+            {
+              found = nested_args[i] != NULL && args_has_caller_owned_arrays(nested_args[i]);
+            }
+        }
+      args_value_iterator_delete(value_it);
+    }
+
+  return found;
+}
+
+void args_memory_usage(const grm_args_t *args, args_memory_usage_t *usage)
+{
+  /* Add the memory used by array values of `args` and all nested containers to `usage`. Arrays which are referenced
+   * more than once (by other arguments or containers) are counted as shared; they are counted each time they are
+   * reached. */
+  args_node_t *current_node;
+  args_value_iterator_t *value_it;
+  arg_t *arg;
+  size_t i, bytes;
+
+  ++(usage->container_count);
+  for (current_node = args->kwargs_head; current_node != NULL; current_node = current_node->next)
+    {
+      arg = current_node->arg;
+      value_it = arg_value_iter(arg);
+      if (value_it == NULL)
+        {
+          continue;
+        }
+      while (value_it->next(value_it) != NULL)
+        {
+          if (value_it->format == 'a')
+            {
+              if (value_it->is_array)
+                {
+                  for (i = 0; i < value_it->array_length; i++)
+                    {
+                      args_memory_usage((*(grm_args_t ***)value_it->value_ptr)[i], usage);
+                    }
+                }
+              else
+                {
+                  args_memory_usage(*(grm_args_t **)value_it->value_ptr, usage);
+                }
+              continue;
+            }
+          if (!value_it->is_array)
+            {
+              continue;
+            }
+          bytes = value_it->array_length * argparse_format_to_size[(unsigned char)value_it->format];
+          if (value_it->format == 's')
+            {
+              for (i = 0; i < value_it->array_length; i++)
+                {
+                  bytes += strlen((*(char ***)value_it->value_ptr)[i]) + 1;
+                }
+            }
+          ++(usage->array_count);
+          usage->array_bytes += bytes;
+          if (arg->priv->reference_count > 1 || (arg->priv->buffer != NULL && arg->priv->buffer->reference_count > 1))
+            {
+              usage->shared_bytes += bytes;
+            }
+          if (arg_is_caller_owned(arg))
+            {
+              usage->caller_owned_bytes += bytes;
+            }
+        }
+      args_value_iterator_delete(value_it);
+    }
+}
+
 
 /* ------------------------- argument iterator ---------------------------------------------------------------------- */
 
@@ -2098,6 +2489,37 @@ int grm_args_push_buf(grm_args_t *args, const char *key, const char *value_forma
   return error == ERROR_NONE;
 }
 
+int grm_args_push_ref(grm_args_t *args, const char *key, const char *value_format, unsigned int array_length,
+                      const void *data, grm_args_release_callback_t release, void *context)
+{
+  /* Push a single array (`nI` or `nD`) without copying it. The memory stays owned by the caller until `release` is
+   * called (once no argument container references the data any more); if `release` is `NULL` the caller must keep the
+   * data alive until all containers holding it (including the containers merged by `grm_plot`) are deleted. The data
+   * may be modified in place; `grm_plot` does not reuse the previous output of subplots holding such arrays. */
+  args_buffer_t *buffer;
+  char format;
+  err_t error;
+
+  format = (value_format[0] == 'n') ? value_format[1] : value_format[0];
+  if ((format != 'I' && format != 'D') || value_format[(value_format[0] == 'n') ? 2 : 1] != '\0')
+    {
+      debug_print_error(("The format \"%s\" is not supported by `grm_args_push_ref`.\n", value_format));
+      return 0;
+    }
+
+  argparse_init_static_variables();
+  buffer = args_buffer_new((void *)data, array_length * argparse_format_to_size[tolower(format)],
+                           (release != NULL) ? release : args_buffer_keep_data, context);
+  if (buffer == NULL)
+    {
+      return 0;
+    }
+  error = args_push_array_ref(args, key, format, array_length, (void *)data, buffer);
+  args_buffer_release(buffer);
+
+  return error == ERROR_NONE;
+}
+
 int grm_args_contains(const grm_args_t *args, const char *keyword)
 {
   return args_at(args, keyword) != NULL;
@@ -2114,6 +2536,8 @@ void grm_args_remove(grm_args_t *args, const char *key)
 
   if (args_find_previous_node(args, key, &previous_node_by_keyword))
     {
+      args_index_clear(args);
+      args_mark_modified(args);
       if (previous_node_by_keyword == NULL)
         {
           tmp_node = args->kwargs_head->next;
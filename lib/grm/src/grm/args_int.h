@@ -12,6 +12,7 @@ extern "C" {
 #include <sys/types.h>
 
 #include <grm/args.h>
+#include "array_stats_int.h"
 #include "error_int.h"
 #include "util_int.h"
 
@@ -22,13 +23,40 @@ typedef SSIZE_T ssize_t;
 
 /* ######################### internal interface ##################################################################### */
 
+/* ========================= macros ================================================================================= */
+
+/* ------------------------- argument container --------------------------------------------------------------------- */
+
+/* Containers with at least this many nodes get a hash index for keyword lookups; smaller ones are scanned linearly */
+#define ARGS_INDEX_MIN_COUNT 8
+
+
 /* ========================= datatypes ============================================================================== */
 
 /* ------------------------- argument ------------------------------------------------------------------------------- */
 
+/* Reference counted memory block which holds the data of array values without copying it. Array values are never
+ * modified while they are shared, code which needs to write to an array calls `arg_unshare_array` first
+ * (copy-on-write). Blocks without a `release` callback were allocated by GRM and are freed with `free`. */
+struct _args_buffer_t
+{
+  unsigned int reference_count;
+  void *data;
+  size_t size;
+  grm_args_release_callback_t release;
+  void *context;
+};
+typedef struct _args_buffer_t args_buffer_t;
+
 struct _arg_private_t
 {
   unsigned int reference_count;
+  /* If set, the argument holds a single array whose data is owned by this block instead of the argument */
+  args_buffer_t *buffer;
+  /* Statistics of an `nD` array; they are computed on first use by `arg_array_stats` and reset by all functions which
+   * modify the array */
+  int has_stats;
+  array_stats_t stats;
 };
 
 
@@ -54,6 +82,18 @@ typedef void *(*copy_value_t)(void *);
 typedef void (*delete_value_t)(void *);
 
 
+/* ------------------------- memory usage --------------------------------------------------------------------------- */
+
+typedef struct
+{
+  size_t container_count;
+  size_t array_count;
+  size_t array_bytes;
+  size_t shared_bytes;
+  size_t caller_owned_bytes;
+} args_memory_usage_t;
+
+
 /* ------------------------- argument container --------------------------------------------------------------------- */
 
 struct _args_node_t
@@ -67,6 +107,12 @@ struct _grm_args_t
   args_node_t *kwargs_head;
   args_node_t *kwargs_tail;
   unsigned int count;
+  /* Open addressing hash table (linear probing) of the nodes in the list above; it is built lazily by
+   * `args_find_node` and dropped whenever nodes are removed. `index_capacity` is zero or a power of two. */
+  args_node_t **index;
+  unsigned int index_capacity;
+  /* Set by `args_mark_modified` whenever nodes are added, replaced or removed */
+  unsigned long generation;
 };
 
 /* ------------------------- argument iterator ---------------------------------------------------------------------- */
@@ -109,12 +155,14 @@ char *argparse_convert_to_array(argparse_state_t *state);
 /* ------------------------- argument container --------------------------------------------------------------------- */
 
 arg_t *args_create_args(const char *key, const char *value_format, const void *buffer, va_list *vl, int apply_padding);
+arg_t *args_create_array_ref(const char *key, char format, size_t length, void *data, args_buffer_t *buffer);
 int args_validate_format_string(const char *format);
 const char *args_skip_option(const char *format);
 void args_copy_format_string_for_arg(char *dst, const char *format);
 void args_copy_format_string_for_parsing(char *dst, const char *format);
 int args_check_format_compatibility(const arg_t *arg, const char *compatible_format);
 void args_decrease_arg_reference_count(args_node_t *args_node);
+void arg_decrease_reference_count(arg_t *arg);
 
 
 /* ------------------------- value copy ----------------------------------------------------------------------------- */
@@ -122,6 +170,13 @@ void args_decrease_arg_reference_count(args_node_t *args_node);
 void *copy_value(char format, void *value_ptr);
 
 
+/* ------------------------- shared array buffer -------------------------------------------------------------------- */
+
+args_buffer_t *args_buffer_new(void *data, size_t size, grm_args_release_callback_t release, void *context);
+void args_buffer_keep_data(void *data, void *context);
+void args_buffer_release(args_buffer_t *buffer);
+
+
 /* ========================= methods ================================================================================ */
 
 /* ------------------------- argument ------------------------------------------------------------------------------- */
@@ -129,6 +184,9 @@ void *copy_value(char format, void *value_ptr);
 args_value_iterator_t *arg_value_iter(const arg_t *arg);
 
 err_t arg_increase_array(arg_t *arg, size_t increment);
+err_t arg_unshare_array(arg_t *arg);
+int arg_is_caller_owned(const arg_t *arg);
+const array_stats_t *arg_array_stats(const arg_t *arg);
 
 int arg_first_value(const arg_t *arg, const char *first_value_format, void *first_value, unsigned int *array_length);
 #define arg_first_value(arg, first_value_format, first_value, array_length) \
@@ -149,6 +207,8 @@ err_t args_push_common(grm_args_t *args, const char *key, const char *value_form
                        int apply_padding);
 err_t args_push_vl(grm_args_t *args, const char *key, const char *value_format, va_list *vl);
 err_t args_push_arg(grm_args_t *args, arg_t *arg);
+err_t args_push_array_ref(grm_args_t *args, const char *key, char format, size_t length, void *data,
+                          args_buffer_t *buffer);
 err_t args_update_many(grm_args_t *args, const grm_args_t *update_args) UNUSED;
 err_t args_merge(grm_args_t *args, const grm_args_t *merge_args, const char *const *merge_keys);
 err_t args_setdefault_common(grm_args_t *args, const char *key, const char *value_format, const void *buffer,
@@ -158,19 +218,31 @@ err_t args_setdefault_buf(grm_args_t *args, const char *key, const char *value_f
                           int apply_padding) UNUSED;
 err_t args_setdefault_vl(grm_args_t *args, const char *key, const char *value_format, va_list *vl);
 
+void args_append_node(grm_args_t *args, args_node_t *args_node);
 void args_clear(grm_args_t *args, const char **exclude_keys);
 
 err_t args_increase_array(grm_args_t *args, const char *key, size_t increment) UNUSED;
 
-unsigned int args_count(const grm_args_t *args) UNUSED;
+unsigned int args_count(const grm_args_t *args);
 
 arg_t *args_at(const grm_args_t *args, const char *keyword);
 
 args_node_t *args_find_node(const grm_args_t *args, const char *keyword);
 int args_find_previous_node(const grm_args_t *args, const char *keyword, args_node_t **previous_node);
 
+unsigned int args_hash_key(const char *key);
+int args_index_build(grm_args_t *args, unsigned int capacity);
+void args_index_insert(grm_args_t *args, args_node_t *args_node);
+void args_index_clear(grm_args_t *args);
+
 args_iterator_t *args_iter(const grm_args_t *args);
 
+void args_mark_modified(grm_args_t *args);
+unsigned long args_generation(const grm_args_t *args);
+int args_has_caller_owned_arrays(const grm_args_t *args);
+
+void args_memory_usage(const grm_args_t *args, args_memory_usage_t *usage);
+
 
 /* ------------------------- argument iterator ---------------------------------------------------------------------- */
 
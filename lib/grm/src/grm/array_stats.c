@@ -0,0 +1,128 @@
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+/* ######################### includes ############################################################################### */
+
+#include <float.h>
+#include <stdlib.h>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define HAVE_SSE2
+#endif
+
+#include "array_stats_int.h"
+#include "util_int.h"
+#include "worker_pool_int.h"
+
+
+/* ######################### internal implementation ################################################################ */
+
+/* ========================= datatypes ============================================================================== */
+
+/* ------------------------- array statistics ----------------------------------------------------------------------- */
+
+typedef struct
+{
+  const double *values;
+  size_t first;
+  size_t last;
+  array_stats_t stats;
+} array_stats_chunk_t;
+
+
+/* ========================= functions ============================================================================== */
+
+/* ------------------------- array statistics ----------------------------------------------------------------------- */
+
+static void array_stats_scan(array_stats_chunk_t *chunk)
+{
+  /* Scan the values `[first, last)`; the order is checked for all pairs of neighbours within the chunk */
+  const double *values = chunk->values;
+  size_t i = chunk->first, last = chunk->last, finite_count = 0;
+  double min = DBL_MAX, max = -DBL_MAX;
+  int unordered = 0;
+#ifdef HAVE_SSE2
+  __m128d vmin = _mm_set1_pd(DBL_MAX), vmax = _mm_set1_pd(-DBL_MAX), vzero = _mm_setzero_pd(), v, vnext;
+  double lanes[2];
+  int finite_mask;
+
+  for (; i + 2 < last; i += 2)
+    {
+      v = _mm_loadu_pd(values + i);
+      vnext = _mm_loadu_pd(values + i + 1);
+      /* `min` and `max` return their second operand if one of them is NaN, so NaN values are skipped */
+      vmin = _mm_min_pd(v, vmin);
+      vmax = _mm_max_pd(v, vmax);
+      /* `v - v` is `0` for finite values and NaN for infinite values and NaN */
+      finite_mask = _mm_movemask_pd(_mm_cmpeq_pd(_mm_sub_pd(v, v), vzero));
+      finite_count += (finite_mask & 1) + (finite_mask >> 1);
+      unordered |= _mm_movemask_pd(_mm_cmpnle_pd(v, vnext));
+    }
+  _mm_storeu_pd(lanes, vmin);
+  min = grm_min(lanes[0], lanes[1]);
+  _mm_storeu_pd(lanes, vmax);
+  max = grm_max(lanes[0], lanes[1]);
+#endif
+  for (; i < last; ++i)
+    {
+      if (values[i] == values[i])
+        {
+          min = grm_min(values[i], min);
+          max = grm_max(values[i], max);
+          finite_count += (values[i] - values[i] == 0.0);
+        }
+      if (i + 1 < last && !(values[i] <= values[i + 1]))
+        {
+          unordered = 1;
+        }
+    }
+
+  chunk->stats.min = min;
+  chunk->stats.max = max;
+  chunk->stats.finite_count = finite_count;
+  /* every value of a chunk with two or more values is part of a checked pair, so NaN values are detected */
+  chunk->stats.sorted = !unordered && (last - chunk->first != 1 || values[chunk->first] == values[chunk->first]);
+}
+
+static void array_stats_scan_task(void *task)
+{
+  array_stats_scan((array_stats_chunk_t *)task);
+}
+
+void array_stats_compute(const double *values, size_t length, array_stats_t *stats)
+{
+  /* Compute the statistics of `values`; large arrays are split into one chunk per thread of the worker pool */
+  array_stats_chunk_t chunks[WORKER_POOL_MAX_THREADS];
+  unsigned int chunk_count = 1, i;
+
+  if (length >= ARRAY_STATS_PARALLEL_MIN)
+    {
+      chunk_count = worker_pool_thread_count();
+    }
+
+  for (i = 0; i < chunk_count; ++i)
+    {
+      chunks[i].values = values;
+      chunks[i].first = length / chunk_count * i;
+      chunks[i].last = (i + 1 < chunk_count) ? length / chunk_count * (i + 1) : length;
+    }
+  worker_pool_run(array_stats_scan_task, chunks, chunk_count, sizeof(array_stats_chunk_t));
+
+  *stats = chunks[0].stats;
+  for (i = 1; i < chunk_count; ++i)
+    {
+      array_stats_merge(stats, &chunks[i].stats, values[chunks[i].first - 1] <= values[chunks[i].first]);
+    }
+}
+
+void array_stats_merge(array_stats_t *stats, const array_stats_t *next_stats, int ordered)
+{
+  /* Combine the statistics of two consecutive arrays. `ordered` tells if the last value of the first array is not
+   * greater than the first value of the second one (it must be set if one of the arrays is empty). */
+  stats->min = grm_min(stats->min, next_stats->min);
+  stats->max = grm_max(stats->max, next_stats->max);
+  stats->finite_count += next_stats->finite_count;
+  stats->sorted = stats->sorted && next_stats->sorted && ordered;
+}
@@ -0,0 +1,53 @@
+#ifndef GRM_ARRAY_STATS_INT_H_INCLUDED
+#define GRM_ARRAY_STATS_INT_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ######################### includes ############################################################################### */
+
+#include <stddef.h>
+
+
+/* ######################### internal interface ##################################################################### */
+
+/* ========================= macros ================================================================================= */
+
+/* ------------------------- array statistics ----------------------------------------------------------------------- */
+
+/* Arrays with at least this many values are scanned by the threads of the worker pool */
+#define ARRAY_STATS_PARALLEL_MIN (1 << 20)
+
+
+/* ========================= datatypes ============================================================================== */
+
+/* ------------------------- array statistics ----------------------------------------------------------------------- */
+
+/*
+ * Summary of a double array which is needed to compute plot ranges and to find the visible part of a series. NaN
+ * values are ignored by `min` and `max` (like in the range computations of `plot.cxx`); if there are no other values,
+ * `min` is `DBL_MAX` and `max` is `-DBL_MAX`. `sorted` is only set if the values are in ascending order and contain
+ * no NaN values.
+ */
+typedef struct
+{
+  double min;
+  double max;
+  size_t finite_count;
+  int sorted;
+} array_stats_t;
+
+
+/* ========================= methods ================================================================================ */
+
+/* ------------------------- array statistics ----------------------------------------------------------------------- */
+
+void array_stats_compute(const double *values, size_t length, array_stats_t *stats);
+void array_stats_merge(array_stats_t *stats, const array_stats_t *next_stats, int ordered);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* ifndef GRM_ARRAY_STATS_INT_H_INCLUDED */
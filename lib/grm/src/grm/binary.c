@@ -0,0 +1,733 @@
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+/* ######################### includes ############################################################################### */
+
+#include <ctype.h>
+#include <limits.h>
+#include <stddef.h>
+#include <stdint.h>
+#include <string.h>
+#ifdef HAVE_ZLIB
+#include <zlib.h>
+#endif
+
+#include "args_int.h"
+#include "binary_int.h"
+#include "json_int.h"
+
+
+/* ######################### private interface ###################################################################### */
+
+/* ========================= datatypes ============================================================================== */
+
+/* ------------------------- binary deserializer -------------------------------------------------------------------- */
+
+typedef struct
+{
+  const char *payload;
+  const char *ptr;
+  const char *end;
+  args_buffer_t *buffer;
+} frombinary_state_t;
+
+
+/* ========================= methods ================================================================================ */
+
+/* ------------------------- binary format -------------------------------------------------------------------------- */
+
+static void binary_put_size(char *dst, size_t value, int n_bytes);
+static int binary_get_size(const char *src, int n_bytes, size_t *value);
+
+
+/* ------------------------- binary serializer ---------------------------------------------------------------------- */
+
+static err_t tobinary_write_count(memwriter_t *memwriter, size_t count);
+static err_t tobinary_write_string(memwriter_t *memwriter, const char *s);
+static err_t tobinary_write_array(memwriter_t *memwriter, size_t payload_start, const void *data, size_t length,
+                                  size_t element_size);
+static err_t tobinary_write_value(memwriter_t *memwriter, size_t payload_start, const args_value_iterator_t *value_it);
+static err_t tobinary_write_object(memwriter_t *memwriter, size_t payload_start, const grm_args_t *args);
+
+
+/* ------------------------- binary deserializer -------------------------------------------------------------------- */
+
+static err_t frombinary_read_count(frombinary_state_t *state, size_t *count);
+static err_t frombinary_read_string(frombinary_state_t *state, const char **s);
+static err_t frombinary_read_array(frombinary_state_t *state, size_t element_size, size_t *length, const char **data);
+static err_t frombinary_read_member(frombinary_state_t *state, grm_args_t *args);
+static err_t frombinary_read_object(frombinary_state_t *state, grm_args_t *args);
+
+
+/* ######################### private implementation ################################################################# */
+
+/* ========================= methods ================================================================================ */
+
+/* ------------------------- binary format -------------------------------------------------------------------------- */
+
+void binary_put_size(char *dst, size_t value, int n_bytes)
+{
+  int i;
+
+  for (i = 0; i < n_bytes; i++)
+    {
+      dst[i] = (char)(value & 0xff);
+      /* shift in two steps to avoid undefined behavior if `size_t` has only 32 bits */
+      value = (value >> 4) >> 4;
+    }
+}
+
+int binary_get_size(const char *src, int n_bytes, size_t *value)
+{
+  size_t result = 0;
+  int i;
+
+  for (i = n_bytes - 1; i >= 0; i--)
+    {
+      if (result > ((size_t)-1 >> 8))
+        {
+          /* the value cannot be represented on this host */
+          return 0;
+        }
+      result = (result << 8) | (unsigned char)src[i];
+    }
+  *value = result;
+
+  return 1;
+}
+
+
+/* ------------------------- binary serializer ---------------------------------------------------------------------- */
+
+err_t tobinary_write_count(memwriter_t *memwriter, size_t count)
+{
+  char buf[4];
+
+  if (count > 0xffffffffUL)
+    {
+      return ERROR_UNSUPPORTED_DATATYPE;
+    }
+  binary_put_size(buf, count, 4);
+
+  return memwriter_write(memwriter, buf, 4);
+}
+
+err_t tobinary_write_string(memwriter_t *memwriter, const char *s)
+{
+  size_t length = strlen(s);
+  err_t error = ERROR_NONE;
+
+  if ((error = tobinary_write_count(memwriter, length)) != ERROR_NONE)
+    {
+      return error;
+    }
+  /* include the terminating '\0' so the receiver can use strings in place */
+  return memwriter_write(memwriter, s, length + 1);
+}
+
+err_t tobinary_write_array(memwriter_t *memwriter, size_t payload_start, const void *data, size_t length,
+                           size_t element_size)
+{
+  static const char zeros[BINARY_ALIGNMENT] = {0};
+  size_t padding;
+  err_t error = ERROR_NONE;
+
+  if ((error = tobinary_write_count(memwriter, length)) != ERROR_NONE)
+    {
+      return error;
+    }
+  padding = (BINARY_ALIGNMENT - (memwriter_size(memwriter) - payload_start) % BINARY_ALIGNMENT) % BINARY_ALIGNMENT;
+  if ((error = memwriter_write(memwriter, zeros, padding)) != ERROR_NONE)
+    {
+      return error;
+    }
+  if (length == 0)
+    {
+      return ERROR_NONE;
+    }
+
+  return memwriter_write(memwriter, data, length * element_size);
+}
+
+err_t tobinary_write_value(memwriter_t *memwriter, size_t payload_start, const args_value_iterator_t *value_it)
+{
+  size_t i;
+  err_t error = ERROR_NONE;
+
+  if (value_it->is_array)
+    {
+      switch (value_it->format)
+        {
+        case 'i':
+          return tobinary_write_array(memwriter, payload_start, *(int **)value_it->value_ptr, value_it->array_length,
+                                      sizeof(int));
+        case 'd':
+          return tobinary_write_array(memwriter, payload_start, *(double **)value_it->value_ptr,
+                                      value_it->array_length, sizeof(double));
+        case 'c':
+          return tobinary_write_array(memwriter, payload_start, *(char **)value_it->value_ptr, value_it->array_length,
+                                      sizeof(char));
+        case 's':
+          if ((error = tobinary_write_count(memwriter, value_it->array_length)) != ERROR_NONE)
+            {
+              return error;
+            }
+          for (i = 0; i < value_it->array_length && error == ERROR_NONE; i++)
+            {
+              error = tobinary_write_string(memwriter, (*(char ***)value_it->value_ptr)[i]);
+            }
+          return error;
+        case 'a':
+          if ((error = tobinary_write_count(memwriter, value_it->array_length)) != ERROR_NONE)
+            {
+              return error;
+            }
+          for (i = 0; i < value_it->array_length && error == ERROR_NONE; i++)
+            {
+              error = tobinary_write_object(memwriter, payload_start, (*(grm_args_t ***)value_it->value_ptr)[i]);
+            }
+          return error;
+        default:
+          return ERROR_UNSUPPORTED_DATATYPE;
+        }
+    }
+
+  switch (value_it->format)
+    {
+    case 'i':
+      return memwriter_write(memwriter, value_it->value_ptr, sizeof(int));
+    case 'd':
+      return memwriter_write(memwriter, value_it->value_ptr, sizeof(double));
+    case 'c':
+      return memwriter_write(memwriter, value_it->value_ptr, sizeof(char));
+    case 's':
+      return tobinary_write_string(memwriter, *(char **)value_it->value_ptr);
+    case 'a':
+      return tobinary_write_object(memwriter, payload_start, *(grm_args_t **)value_it->value_ptr);
+    default:
+      return ERROR_UNSUPPORTED_DATATYPE;
+    }
+}
+
+err_t tobinary_write_object(memwriter_t *memwriter, size_t payload_start, const grm_args_t *args)
+{
+  args_iterator_t *it;
+  args_value_iterator_t *value_it = NULL;
+  arg_t *arg;
+  char format;
+  err_t error = ERROR_NONE;
+
+  if ((error = tobinary_write_count(memwriter, args_count(args))) != ERROR_NONE)
+    {
+      return error;
+    }
+  it = args_iter(args);
+  if (it == NULL)
+    {
+      return ERROR_MALLOC;
+    }
+  while (error == ERROR_NONE && (arg = it->next(it)) != NULL)
+    {
+      value_it = arg_value_iter(arg);
+      if (value_it == NULL)
+        {
+          error = ERROR_MALLOC;
+          break;
+        }
+      if (value_it->next(value_it) == NULL)
+        {
+          error = ERROR_UNSUPPORTED_DATATYPE;
+          break;
+        }
+      format = value_it->is_array ? (char)toupper(value_it->format) : value_it->format;
+      if ((error = tobinary_write_string(memwriter, arg->key)) != ERROR_NONE ||
+          (error = memwriter_write(memwriter, &format, 1)) != ERROR_NONE ||
+          (error = tobinary_write_value(memwriter, payload_start, value_it)) != ERROR_NONE)
+        {
+          break;
+        }
+      /* multiple values per key have no representation in the binary format -> let the caller fall back to JSON */
+      if (value_it->next(value_it) != NULL)
+        {
+          error = ERROR_UNSUPPORTED_DATATYPE;
+          break;
+        }
+      args_value_iterator_delete(value_it);
+      value_it = NULL;
+    }
+  if (value_it != NULL)
+    {
+      args_value_iterator_delete(value_it);
+    }
+  args_iterator_delete(it);
+
+  return error;
+}
+
+
+/* ------------------------- binary deserializer -------------------------------------------------------------------- */
+
+err_t frombinary_read_count(frombinary_state_t *state, size_t *count)
+{
+  if (state->end - state->ptr < 4)
+    {
+      return ERROR_PARSE_OBJECT;
+    }
+  binary_get_size(state->ptr, 4, count);
+  state->ptr += 4;
+
+  return ERROR_NONE;
+}
+
+err_t frombinary_read_string(frombinary_state_t *state, const char **s)
+{
+  size_t length;
+  err_t error = ERROR_NONE;
+
+  if ((error = frombinary_read_count(state, &length)) != ERROR_NONE)
+    {
+      return error;
+    }
+  if ((size_t)(state->end - state->ptr) <= length || state->ptr[length] != '\0')
+    {
+      return ERROR_PARSE_STRING;
+    }
+  *s = state->ptr;
+  state->ptr += length + 1;
+
+  return error;
+}
+
+err_t frombinary_read_array(frombinary_state_t *state, size_t element_size, size_t *length, const char **data)
+{
+  size_t padding;
+  err_t error = ERROR_NONE;
+
+  if ((error = frombinary_read_count(state, length)) != ERROR_NONE)
+    {
+      return error;
+    }
+  if (*length > INT_MAX)
+    {
+      /* array lengths are passed as `int` to `grm_args_push` */
+      return ERROR_UNSUPPORTED_DATATYPE;
+    }
+  padding = (BINARY_ALIGNMENT - (state->ptr - state->payload) % BINARY_ALIGNMENT) % BINARY_ALIGNMENT;
+  if ((size_t)(state->end - state->ptr) < padding ||
+      (size_t)(state->end - state->ptr - padding) / element_size < *length)
+    {
+      return ERROR_PARSE_ARRAY;
+    }
+  *data = state->ptr + padding;
+  state->ptr += padding + *length * element_size;
+
+  return error;
+}
+
+err_t frombinary_read_member(frombinary_state_t *state, grm_args_t *args)
+{
+  const char *key, *data, *s;
+  char format, *chars;
+  int int_value;
+  double double_value;
+  size_t length, i;
+  const char **strings;
+  grm_args_t *nested_args, **nested_args_array;
+  err_t error = ERROR_NONE;
+
+  if ((error = frombinary_read_string(state, &key)) != ERROR_NONE)
+    {
+      return error;
+    }
+  if (state->ptr >= state->end)
+    {
+      return ERROR_PARSE_OBJECT;
+    }
+  format = *state->ptr++;
+
+  switch (format)
+    {
+    case 'i':
+      if (state->end - state->ptr < (ptrdiff_t)sizeof(int))
+        {
+          return ERROR_PARSE_INT;
+        }
+      memcpy(&int_value, state->ptr, sizeof(int));
+      state->ptr += sizeof(int);
+      return grm_args_push(args, key, "i", int_value) ? ERROR_NONE : ERROR_MALLOC;
+    case 'd':
+      if (state->end - state->ptr < (ptrdiff_t)sizeof(double))
+        {
+          return ERROR_PARSE_DOUBLE;
+        }
+      memcpy(&double_value, state->ptr, sizeof(double));
+      state->ptr += sizeof(double);
+      return grm_args_push(args, key, "d", double_value) ? ERROR_NONE : ERROR_MALLOC;
+    case 'c':
+      if (state->ptr >= state->end)
+        {
+          return ERROR_PARSE_STRING;
+        }
+      return grm_args_push(args, key, "c", *state->ptr++) ? ERROR_NONE : ERROR_MALLOC;
+    case 's':
+      if ((error = frombinary_read_string(state, &s)) != ERROR_NONE)
+        {
+          return error;
+        }
+      return grm_args_push(args, key, "s", s) ? ERROR_NONE : ERROR_MALLOC;
+    case 'a':
+      nested_args = grm_args_new();
+      if (nested_args == NULL)
+        {
+          return ERROR_MALLOC;
+        }
+      if ((error = frombinary_read_object(state, nested_args)) != ERROR_NONE ||
+          !grm_args_push(args, key, "a", nested_args))
+        {
+          grm_args_delete(nested_args);
+          return (error != ERROR_NONE) ? error : ERROR_MALLOC;
+        }
+      return error;
+    case 'I':
+      if ((error = frombinary_read_array(state, sizeof(int), &length, &data)) != ERROR_NONE)
+        {
+          return error;
+        }
+      if (state->buffer != NULL)
+        {
+          return args_push_array_ref(args, key, 'I', length, (void *)data, state->buffer);
+        }
+      return grm_args_push(args, key, "nI", (int)length, data) ? ERROR_NONE : ERROR_MALLOC;
+    case 'D':
+      if ((error = frombinary_read_array(state, sizeof(double), &length, &data)) != ERROR_NONE)
+        {
+          return error;
+        }
+      if (state->buffer != NULL)
+        {
+          return args_push_array_ref(args, key, 'D', length, (void *)data, state->buffer);
+        }
+      return grm_args_push(args, key, "nD", (int)length, data) ? ERROR_NONE : ERROR_MALLOC;
+    case 'C':
+      if ((error = frombinary_read_array(state, sizeof(char), &length, &data)) != ERROR_NONE)
+        {
+          return error;
+        }
+      /* the argument container stores char arrays as strings (so they are never written), push a terminated copy */
+      chars = malloc(length + 1);
+      if (chars == NULL)
+        {
+          debug_print_malloc_error();
+          return ERROR_MALLOC;
+        }
+      memcpy(chars, data, length);
+      chars[length] = '\0';
+      if (!grm_args_push(args, key, "s", chars))
+        {
+          error = ERROR_MALLOC;
+        }
+      free(chars);
+      return error;
+    case 'S':
+      if ((error = frombinary_read_count(state, &length)) != ERROR_NONE)
+        {
+          return error;
+        }
+      if (length > INT_MAX || length > (size_t)(state->end - state->ptr) / 5)
+        {
+          /* every string needs at least 5 bytes (length and terminator) */
+          return ERROR_PARSE_ARRAY;
+        }
+      strings = malloc((length + 1) * sizeof(const char *));
+      if (strings == NULL)
+        {
+          debug_print_malloc_error();
+          return ERROR_MALLOC;
+        }
+      for (i = 0; i < length && error == ERROR_NONE; i++)
+        {
+          error = frombinary_read_string(state, &strings[i]);
+        }
+      if (error == ERROR_NONE && !grm_args_push(args, key, "nS", (int)length, strings))
+        {
+          error = ERROR_MALLOC;
+        }
+      free(strings);
+      return error;
+    case 'A':
+      if ((error = frombinary_read_count(state, &length)) != ERROR_NONE)
+        {
+          return error;
+        }
+      if (length > INT_MAX || length > (size_t)(state->end - state->ptr) / 4)
+        {
+          /* every object needs at least 4 bytes (member count) */
+          return ERROR_PARSE_ARRAY;
+        }
+      nested_args_array = calloc(length + 1, sizeof(grm_args_t *));
+      if (nested_args_array == NULL)
+        {
+          debug_print_malloc_error();
+          return ERROR_MALLOC;
+        }
+      for (i = 0; i < length && error == ERROR_NONE; i++)
+        {
+          nested_args_array[i] = grm_args_new();
+          if (nested_args_array[i] == NULL)
+            {
+              error = ERROR_MALLOC;
+              break;
+            }
+          error = frombinary_read_object(state, nested_args_array[i]);
+        }
+      /* the argument container takes ownership of the nested containers on success */
+      if (error == ERROR_NONE && !grm_args_push(args, key, "nA", (int)length, nested_args_array))
+        {
+          error = ERROR_MALLOC;
+        }
+      if (error != ERROR_NONE)
+        {
+          for (i = 0; i < length && nested_args_array[i] != NULL; i++)
+            {
+              grm_args_delete(nested_args_array[i]);
+            }
+        }
+      free(nested_args_array);
+      return error;
+    default:
+      return ERROR_PARSE_UNKNOWN_DATATYPE;
+    }
+}
+
+err_t frombinary_read_object(frombinary_state_t *state, grm_args_t *args)
+{
+  size_t count, i;
+  err_t error = ERROR_NONE;
+
+  if ((error = frombinary_read_count(state, &count)) != ERROR_NONE)
+    {
+      return error;
+    }
+  for (i = 0; i < count && error == ERROR_NONE; i++)
+    {
+      error = frombinary_read_member(state, args);
+    }
+
+  return error;
+}
+
+
+/* ######################### internal implementation ################################################################ */
+
+/* ========================= methods ================================================================================ */
+
+/* ------------------------- binary format -------------------------------------------------------------------------- */
+
+int binary_is_supported(void)
+{
+  static const int one = 1;
+
+  return sizeof(int) == 4 && sizeof(double) == 8 && *(const char *)&one == 1;
+}
+
+int binary_capabilities(void)
+{
+#ifdef HAVE_ZLIB
+  return BINARY_FLAG_COMPRESSED;
+#else
+  return 0;
+#endif
+}
+
+void binary_write_announcement(char *buf)
+{
+  memcpy(buf, BINARY_MAGIC, BINARY_MAGIC_SIZE);
+  buf[BINARY_MAGIC_SIZE] = BINARY_VERSION;
+  buf[BINARY_MAGIC_SIZE + 1] = (char)binary_capabilities();
+}
+
+int binary_read_announcement(const char *buf, int *capabilities)
+{
+  if (memcmp(buf, BINARY_MAGIC, BINARY_MAGIC_SIZE) != 0 || buf[BINARY_MAGIC_SIZE] != BINARY_VERSION)
+    {
+      return 0;
+    }
+  *capabilities = (unsigned char)buf[BINARY_MAGIC_SIZE + 1];
+
+  return 1;
+}
+
+
+/* ------------------------- binary serializer ---------------------------------------------------------------------- */
+
+err_t tobinary_write_args(memwriter_t *memwriter, const grm_args_t *args, int compression_level)
+{
+  char header[BINARY_HEADER_SIZE];
+  size_t message_start, payload_start, payload_size, uncompressed_size;
+  err_t error = ERROR_NONE;
+
+  memset(header, 0, BINARY_HEADER_SIZE);
+  memcpy(header, BINARY_MAGIC, BINARY_MAGIC_SIZE);
+  header[BINARY_MAGIC_SIZE] = BINARY_VERSION;
+
+  message_start = memwriter_size(memwriter);
+  if ((error = memwriter_write(memwriter, header, BINARY_HEADER_SIZE)) != ERROR_NONE)
+    {
+      return error;
+    }
+  payload_start = memwriter_size(memwriter);
+  if ((error = tobinary_write_object(memwriter, payload_start, args)) != ERROR_NONE)
+    {
+      memwriter_erase(memwriter, message_start, memwriter_size(memwriter) - message_start);
+      return error;
+    }
+  payload_size = uncompressed_size = memwriter_size(memwriter) - payload_start;
+
+#ifdef HAVE_ZLIB
+  if (compression_level > 0 && payload_size == (uLong)payload_size)
+    {
+      uLongf compressed_size = compressBound(payload_size);
+      Bytef *compressed = malloc(compressed_size);
+
+      if (compressed != NULL &&
+          compress2(compressed, &compressed_size, (Bytef *)memwriter_buf(memwriter) + payload_start, payload_size,
+                    compression_level > Z_BEST_COMPRESSION ? Z_BEST_COMPRESSION : compression_level) == Z_OK &&
+          compressed_size < payload_size)
+        {
+          memcpy(memwriter_buf(memwriter) + payload_start, compressed, compressed_size);
+          memwriter_erase(memwriter, payload_start + compressed_size, payload_size - compressed_size);
+          payload_size = compressed_size;
+          memwriter_buf(memwriter)[message_start + BINARY_MAGIC_SIZE + 1] = BINARY_FLAG_COMPRESSED;
+        }
+      free(compressed);
+    }
+#else
+  (void)compression_level;
+#endif
+
+  binary_put_size(memwriter_buf(memwriter) + message_start + 8, payload_size, 8);
+  binary_put_size(memwriter_buf(memwriter) + message_start + 16, uncompressed_size, 8);
+
+  return error;
+}
+
+void tobinary_write_json_header(char *header, size_t payload_size)
+{
+  memset(header, 0, BINARY_HEADER_SIZE);
+  memcpy(header, BINARY_MAGIC, BINARY_MAGIC_SIZE);
+  header[BINARY_MAGIC_SIZE] = BINARY_VERSION;
+  header[BINARY_MAGIC_SIZE + 1] = BINARY_FLAG_JSON;
+  binary_put_size(header + 8, payload_size, 8);
+  binary_put_size(header + 16, payload_size, 8);
+}
+
+
+/* ------------------------- binary deserializer -------------------------------------------------------------------- */
+
+int frombinary_is_message(const char *buf, size_t size)
+{
+  return size > 0 && *buf == BINARY_MAGIC[0];
+}
+
+int frombinary_message_size(const char *buf, size_t size, size_t *message_size)
+{
+  size_t payload_size;
+
+  if (size < BINARY_HEADER_SIZE || !binary_get_size(buf + 8, 8, &payload_size) ||
+      payload_size > (size_t)-1 - BINARY_HEADER_SIZE)
+    {
+      return 0;
+    }
+  *message_size = BINARY_HEADER_SIZE + payload_size;
+
+  return 1;
+}
+
+int frombinary_is_in_place_message(const char *buf, size_t size)
+{
+  /* Arrays of uncompressed binary messages can be read in place (see `frombinary_read`) */
+  return size >= BINARY_HEADER_SIZE &&
+         ((unsigned char)buf[BINARY_MAGIC_SIZE + 1] & (BINARY_FLAG_COMPRESSED | BINARY_FLAG_JSON)) == 0;
+}
+
+err_t frombinary_read(grm_args_t *args, char *buf, size_t size, args_buffer_t *buffer)
+{
+  /* If `buffer` is given (it must contain `buf`), `int` and `double` arrays reference the message instead of being
+   * copied. Decompressed payloads are always shared this way since they are not needed otherwise. */
+  frombinary_state_t state;
+  size_t payload_size, uncompressed_size;
+  int flags;
+  err_t error = ERROR_NONE;
+
+  if (size < BINARY_HEADER_SIZE || memcmp(buf, BINARY_MAGIC, BINARY_MAGIC_SIZE) != 0 ||
+      buf[BINARY_MAGIC_SIZE] != BINARY_VERSION || !binary_get_size(buf + 8, 8, &payload_size) ||
+      !binary_get_size(buf + 16, 8, &uncompressed_size) || payload_size > size - BINARY_HEADER_SIZE)
+    {
+      return ERROR_PARSE_OBJECT;
+    }
+  flags = (unsigned char)buf[BINARY_MAGIC_SIZE + 1];
+  state.payload = buf + BINARY_HEADER_SIZE;
+  state.buffer = NULL;
+
+  if (flags & BINARY_FLAG_JSON)
+    {
+      if (payload_size == 0 || buf[BINARY_HEADER_SIZE + payload_size - 1] != '\0')
+        {
+          return ERROR_PARSE_INCOMPLETE_STRING;
+        }
+      return fromjson_read_in_place(args, buf + BINARY_HEADER_SIZE);
+    }
+
+  if (flags & BINARY_FLAG_COMPRESSED)
+    {
+#ifdef HAVE_ZLIB
+      uLongf inflated_size = uncompressed_size;
+      char *uncompressed;
+
+      if (uncompressed_size != (uLong)uncompressed_size)
+        {
+          return ERROR_UNSUPPORTED_OPERATION;
+        }
+      uncompressed = malloc(uncompressed_size > 0 ? uncompressed_size : 1);
+      if (uncompressed == NULL)
+        {
+          debug_print_malloc_error();
+          return ERROR_MALLOC;
+        }
+      if (uncompress((Bytef *)uncompressed, &inflated_size, (const Bytef *)state.payload, payload_size) != Z_OK ||
+          inflated_size != uncompressed_size)
+        {
+          free(uncompressed);
+          return ERROR_PARSE_OBJECT;
+        }
+      state.payload = uncompressed;
+      payload_size = uncompressed_size;
+      state.buffer = args_buffer_new(uncompressed, uncompressed_size, NULL, NULL);
+      if (state.buffer == NULL)
+        {
+          free(uncompressed);
+          return ERROR_MALLOC;
+        }
+#else
+      return ERROR_UNSUPPORTED_OPERATION;
+#endif
+    }
+  else if (buffer != NULL && (uintptr_t)state.payload % BINARY_ALIGNMENT == 0)
+    {
+      /* array data is aligned relative to the payload start, so the payload itself must be aligned to be shared */
+      state.buffer = buffer;
+      ++(buffer->reference_count);
+    }
+  state.ptr = state.payload;
+  state.end = state.payload + payload_size;
+
+  error = frombinary_read_object(&state, args);
+  if (state.buffer != NULL)
+    {
+      /* also frees `uncompressed` if no array references it */
+      args_buffer_release(state.buffer);
+    }
+
+  return error;
+}
@@ -0,0 +1,88 @@
+#ifndef GRM_BINARY_INT_H_INCLUDED
+#define GRM_BINARY_INT_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ######################### includes ############################################################################### */
+
+#include <stdlib.h>
+
+#include <grm/args.h>
+#include "args_int.h"
+#include "error_int.h"
+#include "memwriter_int.h"
+
+
+/* ######################### internal interface ##################################################################### */
+
+/* ========================= macros ================================================================================= */
+
+/* ------------------------- binary format -------------------------------------------------------------------------- */
+
+/*
+ * A binary message consists of a fixed size header followed by the (optionally compressed) payload:
+ *
+ *   offset  size  content
+ *        0     4  `BINARY_MAGIC` (the first byte can never start a JSON message)
+ *        4     1  `BINARY_VERSION`
+ *        5     1  flags (`BINARY_FLAG_COMPRESSED`, `BINARY_FLAG_JSON`)
+ *        6     2  reserved
+ *        8     8  payload size in bytes (little endian)
+ *       16     8  uncompressed payload size in bytes (little endian)
+ *
+ * The payload encodes an argument container as a member count followed by the members. Each member is a
+ * length-prefixed key, a format character (`i`, `d`, `c`, `s`, `a` or the uppercase array variants) and the value.
+ * Array data is stored in native byte order and aligned to 8 bytes relative to the payload start, so it can be
+ * copied with a single `memcpy`. The binary format is only used on little endian hosts which agree on the sizes of
+ * `int` and `double`; this is checked by `binary_is_supported`.
+ *
+ * With `BINARY_FLAG_JSON` set, the payload is a '\0' terminated JSON message instead. This is used for messages
+ * which are written incrementally (`grm_send`, `grm_send_ref`), so the receiver never needs to scan for a terminator
+ * and can parse the message in place.
+ *
+ * The same magic is sent by a receiver once after accepting a connection, followed by the version and the receiver
+ * capabilities (`BINARY_FLAG_COMPRESSED` if it can inflate messages). Senders only switch to the binary format after
+ * they read this announcement, so old peers keep talking JSON.
+ */
+
+#define BINARY_MAGIC "\001GRB"
+#define BINARY_MAGIC_SIZE 4
+#define BINARY_VERSION 1
+#define BINARY_HEADER_SIZE 24
+#define BINARY_ANNOUNCEMENT_SIZE (BINARY_MAGIC_SIZE + 2)
+#define BINARY_ALIGNMENT 8
+
+#define BINARY_FLAG_COMPRESSED 0x01
+#define BINARY_FLAG_JSON 0x02
+
+
+/* ========================= methods ================================================================================ */
+
+/* ------------------------- binary format -------------------------------------------------------------------------- */
+
+int binary_is_supported(void);
+int binary_capabilities(void);
+void binary_write_announcement(char *buf);
+int binary_read_announcement(const char *buf, int *capabilities);
+
+
+/* ------------------------- binary serializer ---------------------------------------------------------------------- */
+
+err_t tobinary_write_args(memwriter_t *memwriter, const grm_args_t *args, int compression_level);
+void tobinary_write_json_header(char *header, size_t payload_size);
+
+
+/* ------------------------- binary deserializer -------------------------------------------------------------------- */
+
+int frombinary_is_message(const char *buf, size_t size);
+int frombinary_message_size(const char *buf, size_t size, size_t *message_size);
+int frombinary_is_in_place_message(const char *buf, size_t size);
+err_t frombinary_read(grm_args_t *args, char *buf, size_t size, args_buffer_t *buffer);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* ifndef GRM_BINARY_INT_H_INCLUDED */
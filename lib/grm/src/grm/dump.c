@@ -269,6 +269,18 @@ void grm_dump(const grm_args_t *args, FILE *f)
     }
   args_iterator_delete(it);
 
+  if (recursion_level == 0)
+    {
+      /* Summarize the memory held by array values, so duplicated or shared data can be spotted */
+      args_memory_usage_t usage;
+
+      memset(&usage, 0, sizeof(usage));
+      args_memory_usage(args, &usage);
+      fprintf(f, "(memory: %lu arrays in %lu containers, %lu bytes, %lu bytes shared, %lu bytes caller-owned)\n",
+              (unsigned long)usage.array_count, (unsigned long)usage.container_count, (unsigned long)usage.array_bytes,
+              (unsigned long)usage.shared_bytes, (unsigned long)usage.caller_owned_bytes);
+    }
+
   --recursion_level;
 
 #undef BUFFER_LEN
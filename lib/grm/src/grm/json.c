@@ -30,18 +30,9 @@
 
 /* ------------------------- json deserializer ---------------------------------------------------------------------- */
 
-const char *FROMJSON_VALID_DELIMITERS = ",]}";
 const char FROMJSON_STRING_DELIMITER = '"';
 const char FROMJSON_ESCAPE_CHARACTER = '\\';
 
-static err_t (*fromjson_datatype_to_func[])(fromjson_state_t *) = {NULL,
-                                                                   fromjson_parse_null,
-                                                                   fromjson_parse_bool,
-                                                                   fromjson_parse_number,
-                                                                   fromjson_parse_string,
-                                                                   fromjson_parse_array,
-                                                                   fromjson_parse_object};
-
 static const char *const fromjson_datatype_to_string[] = {"unknown", "null",  "bool",  "number",
                                                           "string",  "array", "object"};
 
@@ -64,664 +55,656 @@ int grm_read(grm_args_t *args, const char *json_string)
 
 err_t fromjson_read(grm_args_t *args, const char *json_string)
 {
-  return fromjson_parse(args, json_string, NULL);
-}
+  char *json_copy;
+  err_t error;
 
-int grm_load_from_str(const char *json_string)
-{
-  return (fromjson_read(active_plot_args, json_string) == ERROR_NONE);
+  /* the parser modifies the buffer (strings are terminated and unescaped in place), so parse a copy */
+  json_copy = gks_strdup(json_string);
+  if (json_copy == NULL)
+    {
+      debug_print_malloc_error();
+      return ERROR_MALLOC;
+    }
+  error = fromjson_read_in_place(args, json_copy);
+  free(json_copy);
+
+  return error;
 }
 
-err_t fromjson_parse(grm_args_t *args, const char *json_string, fromjson_shared_state_t *shared_state)
+err_t fromjson_read_in_place(grm_args_t *args, char *json_string)
 {
-  char *filtered_json_string = NULL;
   fromjson_state_t state;
-  int allocated_shared_state_mem = 0;
-  err_t error = ERROR_NONE;
+  err_t error;
   char *saved_locale;
 
-  state.datatype = JSON_DATATYPE_UNKNOWN;
-  state.value_buffer = NULL;
-  state.value_buffer_pointer_level = 0;
-  state.next_value_memory = NULL;
-  state.next_value_type = malloc(NEXT_VALUE_TYPE_SIZE);
-  if (state.next_value_type == NULL)
+  /* The message is parsed in a single pass: whitespace is skipped where it is allowed and array values are written to
+   * the memory which is handed over to `args` without counting the array elements first. */
+  state.json_ptr = json_string;
+  while (fromjson_is_whitespace(*state.json_ptr))
     {
-      debug_print_malloc_error();
-      return ERROR_MALLOC;
+      ++state.json_ptr;
     }
-  state.args = args;
-  if (shared_state == NULL)
+  if (*state.json_ptr == '\0')
     {
-      shared_state = malloc(sizeof(fromjson_shared_state_t));
-      if (shared_state == NULL)
-        {
-          free(state.next_value_type);
-          debug_print_malloc_error();
-          return ERROR_MALLOC;
-        }
-      if ((error = fromjson_copy_and_filter_json_string(&filtered_json_string, json_string)) != ERROR_NONE)
-        {
-          free(state.next_value_type);
-          free(shared_state);
-          return error;
-        }
-      shared_state->json_ptr = filtered_json_string;
-      shared_state->parsed_any_value_before = 0;
-      allocated_shared_state_mem = 1;
+      return ERROR_NONE;
     }
-  state.shared_state = shared_state;
-  state.parsing_object = (*state.shared_state->json_ptr == '{');
-  if (state.parsing_object)
+  if (*state.json_ptr != '{')
     {
-      ++state.shared_state->json_ptr;
+      /* parsing values without an outer object (-> missing key) is not supported by the argument container */
+      return ERROR_PARSE_MISSING_OBJECT_CONTAINER;
     }
 
+  /* `strtod` is only used as a fallback but it must not depend on the locale of the application */
   saved_locale = setlocale(LC_NUMERIC, NULL);
   setlocale(LC_NUMERIC, "C");
 
-  while (strchr("}", *state.shared_state->json_ptr) == NULL)
+  error = fromjson_parse_object(&state, args);
+
+  if (saved_locale)
     {
-      const char *current_key = NULL;
+      setlocale(LC_NUMERIC, saved_locale);
+    }
 
-      if (state.parsing_object)
+  return error;
+}
+
+int grm_load_from_str(const char *json_string)
+{
+  return (fromjson_read(active_plot_args, json_string) == ERROR_NONE);
+}
+
+#define SKIP_WHITESPACE()                                 \
+  do                                                      \
+    {                                                     \
+      while (fromjson_is_whitespace(*state->json_ptr))    \
+        {                                                 \
+          ++state->json_ptr;                              \
+        }                                                 \
+    }                                                     \
+  while (0)
+
+err_t fromjson_parse_object(fromjson_state_t *state, grm_args_t *args)
+{
+  char *key;
+  err_t error;
+
+  /* skip the opening brace */
+  ++state->json_ptr;
+  SKIP_WHITESPACE();
+  if (*state->json_ptr == '}')
+    {
+      ++state->json_ptr;
+      return ERROR_NONE;
+    }
+  while (1)
+    {
+      if (*state->json_ptr != FROMJSON_STRING_DELIMITER)
         {
-          fromjson_parse_string(&state);
-          current_key = *(const char **)state.value_buffer;
-          free(state.value_buffer);
-          state.value_buffer = NULL;
-          ++(state.shared_state->json_ptr);
+          return fromjson_delimiter_error(state);
         }
-      state.datatype = fromjson_check_type(&state);
-      if (state.datatype)
+      if ((error = fromjson_parse_string(state, &key)) != ERROR_NONE)
         {
-          if ((error = fromjson_datatype_to_func[state.datatype](&state)) != ERROR_NONE)
-            {
-              break;
-            }
-          if (state.parsing_object)
-            {
-              grm_args_push_buf(args, current_key, state.next_value_type, state.value_buffer, 0);
-            }
-          else
-            {
-              /* parsing values without an outer object (-> missing key) is not supported by the argument container */
-              error = ERROR_PARSE_MISSING_OBJECT_CONTAINER;
-              break;
-            }
-          if (strchr(FROMJSON_VALID_DELIMITERS, *state.shared_state->json_ptr) != NULL)
-            {
-              if (*state.shared_state->json_ptr == ',')
-                {
-                  ++state.shared_state->json_ptr;
-                }
-            }
-          else
-            {
-              error = ERROR_PARSE_INVALID_DELIMITER;
-              break;
-            }
+          return error;
         }
-      else
+      SKIP_WHITESPACE();
+      if (*state->json_ptr != ':')
         {
-          error = ERROR_PARSE_UNKNOWN_DATATYPE;
-          break;
+          return fromjson_delimiter_error(state);
         }
-      if (state.value_buffer_pointer_level > 1)
+      ++state->json_ptr;
+      SKIP_WHITESPACE();
+      if ((error = fromjson_parse_value(state, args, key)) != ERROR_NONE)
         {
-          int i, outer_array_length = uppercase_count(state.next_value_type);
-          for (i = 0; i < outer_array_length; ++i)
-            {
-              free(((char **)state.value_buffer)[i]);
-            }
+          return error;
+        }
+      SKIP_WHITESPACE();
+      if (*state->json_ptr == ',')
+        {
+          ++state->json_ptr;
+          SKIP_WHITESPACE();
+        }
+      else if (*state->json_ptr == '}')
+        {
+          ++state->json_ptr;
+          return ERROR_NONE;
+        }
+      else
+        {
+          return fromjson_delimiter_error(state);
         }
-      free(state.value_buffer);
-      state.value_buffer = NULL;
-      state.value_buffer_pointer_level = 0;
-    }
-  if (state.parsing_object && *state.shared_state->json_ptr == '\0')
-    {
-      error = ERROR_PARSE_INCOMPLETE_STRING;
-    }
-  if (*state.shared_state->json_ptr)
-    {
-      ++state.shared_state->json_ptr;
     }
+}
 
-  free(state.value_buffer);
-  free(filtered_json_string);
-  free(state.next_value_type);
-
-  if (allocated_shared_state_mem)
-    {
-      free(shared_state);
-    }
+err_t fromjson_parse_value(fromjson_state_t *state, grm_args_t *args, const char *key)
+{
+  fromjson_number_t number;
+  grm_args_t *object_args;
+  char *string_value;
+  int bool_value;
+  err_t error = ERROR_NONE;
 
-  if (saved_locale)
+  switch (fromjson_check_type(state))
     {
-      setlocale(LC_NUMERIC, saved_locale);
+    case JSON_DATATYPE_NULL:
+      if ((error = fromjson_parse_null(state)) == ERROR_NONE && !grm_args_push_buf(args, key, "", NULL, 0))
+        {
+          error = ERROR_MALLOC;
+        }
+      break;
+    case JSON_DATATYPE_BOOL:
+      if ((error = fromjson_parse_bool(state, &bool_value)) == ERROR_NONE && !grm_args_push(args, key, "i", bool_value))
+        {
+          error = ERROR_MALLOC;
+        }
+      break;
+    case JSON_DATATYPE_NUMBER:
+      if ((error = fromjson_parse_number(state, &number)) == ERROR_NONE &&
+          !(number.is_int ? grm_args_push(args, key, "i", number.int_value)
+                          : grm_args_push(args, key, "d", number.double_value)))
+        {
+          error = ERROR_MALLOC;
+        }
+      break;
+    case JSON_DATATYPE_STRING:
+      if ((error = fromjson_parse_string(state, &string_value)) == ERROR_NONE &&
+          !grm_args_push(args, key, "s", string_value))
+        {
+          error = ERROR_MALLOC;
+        }
+      break;
+    case JSON_DATATYPE_ARRAY:
+      error = fromjson_parse_array(state, args, key);
+      break;
+    case JSON_DATATYPE_OBJECT:
+      if ((object_args = grm_args_new()) == NULL)
+        {
+          debug_print_malloc_error();
+          return ERROR_MALLOC;
+        }
+      if ((error = fromjson_parse_object(state, object_args)) != ERROR_NONE ||
+          !grm_args_push(args, key, "a", object_args))
+        {
+          grm_args_delete(object_args);
+          error = (error != ERROR_NONE) ? error : ERROR_MALLOC;
+        }
+      break;
+    default:
+      error = ERROR_PARSE_UNKNOWN_DATATYPE;
+      break;
     }
 
   return error;
 }
 
-#define CHECK_AND_ALLOCATE_MEMORY(type, length)                \
-  do                                                           \
-    {                                                          \
-      if (state->value_buffer == NULL)                         \
-        {                                                      \
-          state->value_buffer = malloc(length * sizeof(type)); \
-          if (state->value_buffer == NULL)                     \
-            {                                                  \
-              debug_print_malloc_error();                      \
-              return 0;                                        \
-            }                                                  \
-          state->value_buffer_pointer_level = 1;               \
-          state->next_value_memory = state->value_buffer;      \
-        }                                                      \
-    }                                                          \
-  while (0)
-
 err_t fromjson_parse_null(fromjson_state_t *state)
 {
-  if (strncmp(state->shared_state->json_ptr, "null", 4) != 0)
+  if (strncmp(state->json_ptr, "null", 4) != 0 || !fromjson_is_value_end(state->json_ptr[4]))
     {
       return ERROR_PARSE_NULL;
     }
-  strcpy(state->next_value_type, "");
-  state->shared_state->json_ptr += 4;
+  state->json_ptr += 4;
   return ERROR_NONE;
 }
 
-err_t fromjson_parse_bool(fromjson_state_t *state)
+err_t fromjson_parse_bool(fromjson_state_t *state, int *bool_value)
 {
-  int bool_value;
+  size_t length;
 
-  if (strncmp(state->shared_state->json_ptr, "true", 4) == 0)
+  if (strncmp(state->json_ptr, "true", 4) == 0)
     {
-      bool_value = 1;
+      *bool_value = 1;
+      length = 4;
     }
-  else if (strncmp(state->shared_state->json_ptr, "false", 5) == 0)
+  else if (strncmp(state->json_ptr, "false", 5) == 0)
     {
-      bool_value = 0;
+      *bool_value = 0;
+      length = 5;
     }
   else
     {
       return ERROR_PARSE_BOOL;
     }
-  CHECK_AND_ALLOCATE_MEMORY(int, 1);
-  *((int *)state->next_value_memory) = bool_value;
-  strcpy(state->next_value_type, "i");
-  state->shared_state->json_ptr += bool_value ? 4 : 5;
+  if (!fromjson_is_value_end(state->json_ptr[length]))
+    {
+      return ERROR_PARSE_BOOL;
+    }
+  state->json_ptr += length;
   return ERROR_NONE;
 }
 
-err_t fromjson_parse_number(fromjson_state_t *state)
+err_t fromjson_parse_number(fromjson_state_t *state, fromjson_number_t *number)
 {
-  err_t error;
+  const char *number_start, *digits_start, *current_ptr;
+  unsigned long magnitude = 0, limit;
+  int negative, was_successful;
+  char current_char;
 
-  if (is_int_number(state->shared_state->json_ptr))
+  number_start = current_ptr = state->json_ptr;
+  negative = (*current_ptr == '-');
+  if (negative || *current_ptr == '+')
     {
-      error = fromjson_parse_int(state);
+      ++current_ptr;
     }
-  else
+  /* Integers are converted while scanning them, as long as the value fits into an `int` */
+  limit = (unsigned long)INT_MAX + (negative ? 1 : 0);
+  digits_start = current_ptr;
+  while (*current_ptr >= '0' && *current_ptr <= '9' && magnitude <= (limit - (*current_ptr - '0')) / 10)
     {
-      error = fromjson_parse_double(state);
+      magnitude = 10 * magnitude + (*current_ptr - '0');
+      ++current_ptr;
     }
-  return error;
-}
-
-err_t fromjson_parse_int(fromjson_state_t *state)
-{
-  int was_successful;
-  int int_value;
-
-  int_value = fromjson_str_to_int((const char **)&state->shared_state->json_ptr, &was_successful);
-  if (!was_successful)
+  if (current_ptr != digits_start && fromjson_is_value_end(*current_ptr))
     {
-      return ERROR_PARSE_INT;
+      number->is_int = 1;
+      number->int_value = negative ? -(int)(magnitude - 1) - 1 : (int)magnitude;
+      state->json_ptr = (char *)current_ptr;
+      return ERROR_NONE;
     }
-  CHECK_AND_ALLOCATE_MEMORY(int, 1);
-  *((int *)state->next_value_memory) = int_value;
-  strcpy(state->next_value_type, "i");
-  return ERROR_NONE;
-}
 
-err_t fromjson_parse_double(fromjson_state_t *state)
-{
-  int was_successful;
-  double double_value;
-
-  double_value = fromjson_str_to_double((const char **)&state->shared_state->json_ptr, &was_successful);
-  if (!was_successful)
+  /* Everything else (fractions, exponents, `NAN`, `INF` and integers which are too large for `int`) is a double */
+  current_char = *current_ptr;
+  while (!fromjson_is_value_end(current_char))
     {
-      return ERROR_PARSE_DOUBLE;
+      current_char = *++current_ptr;
     }
-  CHECK_AND_ALLOCATE_MEMORY(double, 1);
-  *((double *)state->next_value_memory) = double_value;
-  strcpy(state->next_value_type, "d");
+  number->is_int = 0;
+  if (!str_to_double(number_start, current_ptr, &number->double_value))
+    {
+      number->double_value = fromjson_str_to_double(number_start, current_ptr, &was_successful);
+      if (!was_successful)
+        {
+          return ERROR_PARSE_DOUBLE;
+        }
+    }
+  state->json_ptr = (char *)current_ptr;
   return ERROR_NONE;
 }
 
-err_t fromjson_parse_string(fromjson_state_t *state)
+err_t fromjson_parse_string(fromjson_state_t *state, char **string_value)
 {
-  char *string_value;
-  char *json_ptr;
-  const char *src_ptr;
-  char *dest_ptr;
-  int string_is_complete;
-  int skipped_char;
+  char *src_ptr, *dest_ptr;
+  size_t chunk_length;
 
-  CHECK_AND_ALLOCATE_MEMORY(char *, 1);
-  json_ptr = state->shared_state->json_ptr;
-  string_value = ++json_ptr;
-  while (*json_ptr && !is_string_delimiter(json_ptr, string_value))
+  /* Unescape the string in place (`\` escapes the next character); characters between the special characters are
+   * skipped with `strcspn` which is vectorized by common C libraries */
+  src_ptr = dest_ptr = ++state->json_ptr;
+  *string_value = dest_ptr;
+  while (1)
     {
-      ++json_ptr;
-    }
-  string_is_complete = (*json_ptr != '\0');
-  *json_ptr = '\0';
-  /* Unescape '"' and '\' (since '\' is the escape character) */
-  src_ptr = dest_ptr = string_value;
-  skipped_char = 0;
-  while (*src_ptr)
-    {
-      if (*src_ptr == '\\' && !skipped_char)
+      chunk_length = strcspn(src_ptr, "\"\\");
+      if (dest_ptr != src_ptr)
         {
-          ++src_ptr;
-          skipped_char = 1;
+          memmove(dest_ptr, src_ptr, chunk_length);
         }
-      else
+      src_ptr += chunk_length;
+      dest_ptr += chunk_length;
+      if (*src_ptr == FROMJSON_STRING_DELIMITER)
+        {
+          break;
+        }
+      if (*src_ptr == '\0' || *(src_ptr + 1) == '\0')
         {
-          *dest_ptr = *src_ptr;
-          ++src_ptr;
-          ++dest_ptr;
-          skipped_char = 0;
+          state->json_ptr = src_ptr + (*src_ptr != '\0');
+          *dest_ptr = '\0';
+          return ERROR_PARSE_STRING;
         }
+      *dest_ptr++ = *++src_ptr;
+      ++src_ptr;
     }
   *dest_ptr = '\0';
+  state->json_ptr = src_ptr + 1;
 
-  *((const char **)state->next_value_memory) = string_value;
-  strcpy(state->next_value_type, "s");
-  ++json_ptr;
-  state->shared_state->json_ptr = json_ptr;
-
-  return string_is_complete ? ERROR_NONE : ERROR_PARSE_STRING;
+  return ERROR_NONE;
 }
 
-err_t fromjson_parse_array(fromjson_state_t *state)
+err_t fromjson_parse_array(fromjson_state_t *state, grm_args_t *args, const char *key)
 {
-  fromjson_datatype_t json_datatype;
-  const char *next_delim_ptr;
-
-#define PARSE_VALUES(parse_suffix, c_type)                                                                         \
-  do                                                                                                               \
-    {                                                                                                              \
-      c_type *values;                                                                                              \
-      c_type *current_value_ptr;                                                                                   \
-      CHECK_AND_ALLOCATE_MEMORY(c_type *, 1);                                                                      \
-      values = malloc(array_length * sizeof(c_type));                                                              \
-      if (values == NULL)                                                                                          \
-        {                                                                                                          \
-          debug_print_malloc_error();                                                                              \
-          return ERROR_MALLOC;                                                                                     \
-        }                                                                                                          \
-      current_value_ptr = values;                                                                                  \
-      *(c_type **)state->next_value_memory = values;                                                               \
-      state->value_buffer_pointer_level = 2;                                                                       \
-      state->next_value_memory = values;                                                                           \
-      --state->shared_state->json_ptr;                                                                             \
-      while (!error && strchr("]", *state->shared_state->json_ptr) == NULL)                                        \
-        {                                                                                                          \
-          ++state->shared_state->json_ptr;                                                                         \
-          error = fromjson_parse_##parse_suffix(state);                                                            \
-          ++current_value_ptr;                                                                                     \
-          state->next_value_memory = current_value_ptr;                                                            \
-        }                                                                                                          \
-      snprintf(array_type + strlen(array_type), NEXT_VALUE_TYPE_SIZE, "%c(%zu)", toupper(*state->next_value_type), \
-               array_length);                                                                                      \
-    }                                                                                                              \
-  while (0)
+  fromjson_array_t array, *nested_arrays = NULL, *new_nested_arrays;
+  size_t nested_count = 0, nested_capacity = 0, i;
+  char *array_start;
+  args_buffer_t *buffer;
+  void *data;
+  err_t error = ERROR_NONE;
 
-  if (strchr("]", *(state->shared_state->json_ptr + 1)) == NULL)
+  array_start = state->json_ptr++;
+  SKIP_WHITESPACE();
+  if (*state->json_ptr != '[')
     {
-      char array_type[NEXT_VALUE_TYPE_SIZE];
-      size_t outer_array_length = 0;
-      int is_nested_array = (*(state->shared_state->json_ptr + 1) == '[');
-      unsigned int current_outer_array_index = 0;
-      if (is_nested_array)
+      state->json_ptr = array_start;
+      if ((error = fromjson_parse_flat_array(state, &array)) != ERROR_NONE)
         {
-          outer_array_length = fromjson_get_outer_array_length(state->shared_state->json_ptr);
-          /* `char *` is only used as a generic type since all pointers to values have the same storage size */
-          CHECK_AND_ALLOCATE_MEMORY(char *, outer_array_length);
+          return error;
         }
-      array_type[0] = '\0';
-      do
+      switch (array.type)
         {
-          err_t error = ERROR_NONE;
-          size_t array_length = 0;
-          state->shared_state->json_ptr += is_nested_array ? 2 : 1;
-          next_delim_ptr = state->shared_state->json_ptr;
-          while (*next_delim_ptr != ']' &&
-                 fromjson_find_next_delimiter(&next_delim_ptr, next_delim_ptr, array_length == 0, 1))
+        case 'i':
+        case 'd':
+          if (array.length == 0)
             {
-              ++array_length;
+              if (!grm_args_push_buf(args, key, "I(0)", NULL, 0))
+                {
+                  error = ERROR_MALLOC;
+                }
+              break;
             }
-          if (*next_delim_ptr != ']')
+          /* hand the parsed values over to the argument container instead of copying them */
+          if (array.capacity > array.length &&
+              (data = realloc(array.data, array.length * fromjson_array_element_size(array.type))) != NULL)
             {
-              state->shared_state->json_ptr -= is_nested_array ? 2 : 1;
-              return ERROR_PARSE_INCOMPLETE_STRING;
+              array.data = data;
             }
-          assert(array_length > 0);
-          json_datatype = fromjson_check_type(state);
-          switch (json_datatype)
+          if ((buffer = args_buffer_new(array.data, array.length * fromjson_array_element_size(array.type), NULL,
+                                        NULL)) == NULL)
             {
-            case JSON_DATATYPE_NUMBER:
-              if (is_int_number(state->shared_state->json_ptr))
-                {
-                  PARSE_VALUES(int, int);
-                }
-              else
-                {
-                  PARSE_VALUES(double, double);
-                }
-              break;
-            case JSON_DATATYPE_STRING:
-              PARSE_VALUES(string, char *);
-              break;
-            case JSON_DATATYPE_OBJECT:
-              PARSE_VALUES(object, grm_args_t *);
-              break;
-            case JSON_DATATYPE_ARRAY:
-              debug_print_error(("Arrays only support one level of nesting!\n"));
-              state->shared_state->json_ptr -= is_nested_array ? 2 : 1;
-              return ERROR_PARSE_ARRAY;
-              break;
-            default:
-              debug_print_error(("The datatype \"%s\" is currently not supported in arrays!\n",
-                                 fromjson_datatype_to_string[json_datatype]));
-              state->shared_state->json_ptr -= is_nested_array ? 2 : 1;
-              return ERROR_PARSE_ARRAY;
+              error = ERROR_MALLOC;
               break;
             }
-          ++(state->shared_state->json_ptr);
-          if (is_nested_array)
+          array.data = NULL;
+          error = args_push_array_ref(args, key, array.type, array.length, buffer->data, buffer);
+          args_buffer_release(buffer);
+          break;
+        case 's':
+          if (!grm_args_push(args, key, "nS", (int)array.length, array.data))
+            {
+              error = ERROR_MALLOC;
+            }
+          break;
+        case 'a':
+          /* the containers are owned by `args` from now on, they are only deleted with the array on errors */
+          if (grm_args_push(args, key, "nA", (int)array.length, array.data))
             {
-              ++current_outer_array_index;
-              /* `char **` is only used as a generic type since all pointers to values have the same storage size */
-              state->next_value_memory = ((char **)state->value_buffer) + current_outer_array_index;
+              array.type = 'i';
             }
+          else
+            {
+              error = ERROR_MALLOC;
+            }
+          break;
+        default:
+          break;
         }
-      while (is_nested_array && current_outer_array_index < outer_array_length &&
-             strchr("]", *state->shared_state->json_ptr) == NULL);
-      if (is_nested_array && *state->shared_state->json_ptr == ']')
-        {
-          ++state->shared_state->json_ptr;
-        }
-      strcpy(state->next_value_type, array_type);
-    }
-  else
-    {
-      strcpy(state->next_value_type, "I(0)");
+      fromjson_array_finalize(&array);
+      return error;
     }
 
-  return ERROR_NONE;
-
-#undef PARSE_VALUES
-}
-
-err_t fromjson_parse_object(fromjson_state_t *state)
-{
-  grm_args_t *args;
-  err_t error;
-
-  CHECK_AND_ALLOCATE_MEMORY(grm_args_t *, 1);
-  args = grm_args_new();
-  error = fromjson_parse(args, state->shared_state->json_ptr, state->shared_state);
-  *((grm_args_t **)state->next_value_memory) = args;
-  strcpy(state->next_value_type, "a");
-  return error;
-}
-
-#undef CHECK_AND_ALLOCATE_MEMORY
-
-fromjson_datatype_t fromjson_check_type(const fromjson_state_t *state)
-{
-  fromjson_datatype_t datatype;
-
-  datatype = JSON_DATATYPE_UNKNOWN;
-  switch (*state->shared_state->json_ptr)
-    {
-    case '"':
-      datatype = JSON_DATATYPE_STRING;
-      break;
-    case '[':
-      datatype = JSON_DATATYPE_ARRAY;
-      break;
-    case '{':
-      datatype = JSON_DATATYPE_OBJECT;
-      break;
-    default:
-      break;
-    }
-  if (datatype == JSON_DATATYPE_UNKNOWN)
+  /* Arrays of arrays are stored as one argument with multiple array values, e.g. `D(3)D(2)` */
+  while (1)
     {
-      if (*state->shared_state->json_ptr == 'n')
+      if (*state->json_ptr != '[')
         {
-          datatype = JSON_DATATYPE_NULL;
+          debug_print_error(("Nested arrays must only contain arrays!\n"));
+          error = ERROR_PARSE_ARRAY;
+          break;
         }
-      else if (strchr("ft", *state->shared_state->json_ptr) != NULL)
+      if (nested_count == nested_capacity)
         {
-          datatype = JSON_DATATYPE_BOOL;
+          nested_capacity = (nested_capacity > 0) ? 2 * nested_capacity : FROMJSON_ARRAY_INITIAL_CAPACITY;
+          new_nested_arrays = realloc(nested_arrays, nested_capacity * sizeof(fromjson_array_t));
+          if (new_nested_arrays == NULL)
+            {
+              debug_print_malloc_error();
+              error = ERROR_MALLOC;
+              break;
+            }
+          nested_arrays = new_nested_arrays;
         }
-      else
+      if ((error = fromjson_parse_flat_array(state, &nested_arrays[nested_count])) != ERROR_NONE)
         {
-          datatype = JSON_DATATYPE_NUMBER;
+          break;
         }
-    }
-  return datatype;
-}
-
-err_t fromjson_copy_and_filter_json_string(char **dest, const char *src)
-{
-  const char *src_ptr;
-  char *dest_buffer, *dest_ptr;
-  int in_string;
-
-  src_ptr = src;
-  dest_buffer = malloc(strlen(src) + 1);
-  if (dest_buffer == NULL)
-    {
-      debug_print_malloc_error();
-      return ERROR_MALLOC;
-    }
-  dest_ptr = dest_buffer;
-
-  in_string = 0;
-  while (*src_ptr)
-    {
-      if (is_string_delimiter(src_ptr, src))
+      ++nested_count;
+      SKIP_WHITESPACE();
+      if (*state->json_ptr == ',')
         {
-          in_string = !in_string;
+          ++state->json_ptr;
+          SKIP_WHITESPACE();
         }
-      if (in_string || !isspace(*src_ptr))
+      else if (*state->json_ptr == ']')
         {
-          *dest_ptr = *src_ptr;
-          ++dest_ptr;
+          ++state->json_ptr;
+          break;
+        }
+      else
+        {
+          error = fromjson_delimiter_error(state);
+          break;
         }
-      ++src_ptr;
     }
-  *dest_ptr = '\0';
-
-  *dest = dest_buffer;
-
-  return ERROR_NONE;
-}
-
-int fromjson_is_escaped_delimiter(const char *delim_ptr, const char *str)
-{
-  const char *first_non_escape_char_ptr;
-
-  first_non_escape_char_ptr = delim_ptr - 1;
-  while (first_non_escape_char_ptr != str - 1 && *first_non_escape_char_ptr == FROMJSON_ESCAPE_CHARACTER)
+  if (error == ERROR_NONE)
     {
-      --first_non_escape_char_ptr;
+      error = fromjson_push_nested_arrays(args, key, nested_arrays, nested_count);
     }
-  return (delim_ptr - first_non_escape_char_ptr) % 2 == 0;
+  for (i = 0; i < nested_count; ++i)
+    {
+      fromjson_array_finalize(&nested_arrays[i]);
+    }
+  free(nested_arrays);
+
+  return error;
 }
 
-int fromjson_find_next_delimiter(const char **delim_ptr, const char *src, int include_start,
-                                 int exclude_nested_structures)
+err_t fromjson_parse_flat_array(fromjson_state_t *state, fromjson_array_t *array)
 {
-  int is_in_string = 0;
+  fromjson_datatype_t datatype, element_datatype;
+  fromjson_number_t number;
+  char *string_value;
+  grm_args_t *object_args;
+  size_t new_capacity;
+  err_t error = ERROR_NONE;
 
-  if (*src == '\0')
+  fromjson_array_init(array);
+  ++state->json_ptr;
+  SKIP_WHITESPACE();
+  if (*state->json_ptr == ']')
     {
-      return 0;
+      ++state->json_ptr;
+      return ERROR_NONE;
     }
-  if (!include_start)
+  datatype = fromjson_check_type(state);
+  switch (datatype)
     {
-      ++src;
+    case JSON_DATATYPE_NUMBER:
+      array->type = 'i';
+      break;
+    case JSON_DATATYPE_STRING:
+      array->type = 's';
+      break;
+    case JSON_DATATYPE_OBJECT:
+      array->type = 'a';
+      break;
+    case JSON_DATATYPE_ARRAY:
+      debug_print_error(("Arrays only support one level of nesting!\n"));
+      return ERROR_PARSE_ARRAY;
+    default:
+      debug_print_error(
+          ("The datatype \"%s\" is currently not supported in arrays!\n", fromjson_datatype_to_string[datatype]));
+      return ERROR_PARSE_ARRAY;
     }
-  if (exclude_nested_structures)
-    {
-      const char *src_ptr = src;
-      int nested_level = 0;
 
-      while (*src_ptr != '\0')
+  while (1)
+    {
+      element_datatype = fromjson_check_type(state);
+      if (element_datatype != datatype)
         {
-          if (*src_ptr == FROMJSON_STRING_DELIMITER && !fromjson_is_escaped_delimiter(src_ptr, src))
+          debug_print_error(("Arrays with elements of different datatypes (\"%s\" and \"%s\") are not supported!\n",
+                             fromjson_datatype_to_string[datatype], fromjson_datatype_to_string[element_datatype]));
+          error = ERROR_PARSE_ARRAY;
+          break;
+        }
+      if (array->length == array->capacity)
+        {
+          new_capacity = (array->capacity > 0) ? 2 * array->capacity : FROMJSON_ARRAY_INITIAL_CAPACITY;
+          if ((error = fromjson_array_reserve(array, new_capacity)) != ERROR_NONE)
             {
-              is_in_string = !is_in_string;
+              break;
             }
-          if (!is_in_string)
+        }
+      switch (datatype)
+        {
+        case JSON_DATATYPE_NUMBER:
+          if ((error = fromjson_parse_number(state, &number)) != ERROR_NONE)
             {
-              if (strchr("[{", *src_ptr))
-                {
-                  ++nested_level;
-                }
-              else if (strchr("]}", *src_ptr))
+              break;
+            }
+          if (array->type == 'i')
+            {
+              if (number.is_int)
                 {
-                  if (nested_level > 0)
-                    {
-                      --nested_level;
-                    }
-                  else
-                    {
-                      break;
-                    }
+                  ((int *)array->data)[array->length++] = number.int_value;
+                  break;
                 }
-              else if (*src_ptr == ',' && nested_level == 0)
+              /* the first non-integer value turns the whole array into a double array */
+              if ((error = fromjson_array_promote_to_double(array)) != ERROR_NONE)
                 {
                   break;
                 }
             }
-          ++src_ptr;
+          ((double *)array->data)[array->length++] = number.is_int ? number.int_value : number.double_value;
+          break;
+        case JSON_DATATYPE_STRING:
+          if ((error = fromjson_parse_string(state, &string_value)) == ERROR_NONE)
+            {
+              ((char **)array->data)[array->length++] = string_value;
+            }
+          break;
+        default:
+          if ((object_args = grm_args_new()) == NULL)
+            {
+              debug_print_malloc_error();
+              error = ERROR_MALLOC;
+              break;
+            }
+          /* store the container before parsing it, so it is deleted with the array on errors */
+          ((grm_args_t **)array->data)[array->length++] = object_args;
+          error = fromjson_parse_object(state, object_args);
+          break;
         }
-      if (*src_ptr != '\0')
+      if (error != ERROR_NONE)
         {
-          *delim_ptr = src_ptr;
-          return 1;
+          break;
         }
-    }
-  else
-    {
-      const char *src_ptr = src;
-      while (*src_ptr != '\0' && (is_in_string || strchr(FROMJSON_VALID_DELIMITERS, *src_ptr) == NULL))
+      SKIP_WHITESPACE();
+      if (*state->json_ptr == ',')
         {
-          if (*src_ptr == FROMJSON_STRING_DELIMITER && !fromjson_is_escaped_delimiter(src_ptr, src))
-            {
-              is_in_string = !is_in_string;
-            }
-          ++src_ptr;
+          ++state->json_ptr;
+          SKIP_WHITESPACE();
         }
-      if (*src_ptr != '\0')
+      else if (*state->json_ptr == ']')
         {
-          *delim_ptr = src_ptr;
-          return 1;
+          ++state->json_ptr;
+          break;
+        }
+      else
+        {
+          error = fromjson_delimiter_error(state);
+          break;
         }
     }
-  return 0;
+  if (error != ERROR_NONE)
+    {
+      fromjson_array_finalize(array);
+    }
+
+  return error;
 }
 
-size_t fromjson_get_outer_array_length(const char *str)
+err_t fromjson_push_nested_arrays(grm_args_t *args, const char *key, fromjson_array_t *arrays, size_t count)
 {
-  size_t outer_array_length = 0;
-  int current_array_level = 1;
+  char *format, *format_ptr;
+  void **values;
+  size_t i;
 
-  if (*str != '[')
+  format = malloc(count * (4 + 3 * sizeof(unsigned long)) + 1);
+  values = malloc(count * sizeof(void *));
+  if (format == NULL || values == NULL)
+    {
+      debug_print_malloc_error();
+      free(format);
+      free(values);
+      return ERROR_MALLOC;
+    }
+  format_ptr = format;
+  for (i = 0; i < count; ++i)
     {
-      return outer_array_length;
+      values[i] = arrays[i].data;
+      format_ptr += sprintf(format_ptr, "%c(%lu)", toupper(arrays[i].type), (unsigned long)arrays[i].length);
     }
-  ++str;
-  while (current_array_level > 0 && *str)
+  if (!grm_args_push_buf(args, key, format, values, 0))
     {
-      switch (*str)
+      /* the containers are deleted with the arrays */
+      free(format);
+      free(values);
+      return ERROR_MALLOC;
+    }
+  for (i = 0; i < count; ++i)
+    {
+      if (arrays[i].type == 'a')
         {
-        case '[':
-          ++current_array_level;
-          break;
-        case ']':
-          --current_array_level;
-          break;
-        case ',':
-          if (current_array_level == 1)
-            {
-              ++outer_array_length;
-            }
-          break;
-        default:
-          break;
+          /* the containers are owned by `args` from now on, only the pointer array is freed */
+          arrays[i].type = 'i';
         }
-      ++str;
     }
-  ++outer_array_length;
-  return outer_array_length;
+  free(format);
+  free(values);
+
+  return ERROR_NONE;
+}
+
+#undef SKIP_WHITESPACE
+
+fromjson_datatype_t fromjson_check_type(const fromjson_state_t *state)
+{
+  switch (*state->json_ptr)
+    {
+    case '"':
+      return JSON_DATATYPE_STRING;
+    case '[':
+      return JSON_DATATYPE_ARRAY;
+    case '{':
+      return JSON_DATATYPE_OBJECT;
+    case 'n':
+      return JSON_DATATYPE_NULL;
+    case 'f':
+    case 't':
+      return JSON_DATATYPE_BOOL;
+    default:
+      return JSON_DATATYPE_NUMBER;
+    }
 }
 
-double fromjson_str_to_double(const char **str, int *was_successful)
+err_t fromjson_delimiter_error(const fromjson_state_t *state)
+{
+  return (*state->json_ptr == '\0') ? ERROR_PARSE_INCOMPLETE_STRING : ERROR_PARSE_INVALID_DELIMITER;
+}
+
+double fromjson_str_to_double(const char *str, const char *end, int *was_successful)
 {
   char *conversion_end = NULL;
   double conversion_result;
   int success = 0;
-  const char *next_delim_ptr = NULL;
 
   errno = 0;
-  if (*str != NULL)
-    {
-      conversion_result = strtod(*str, &conversion_end);
-    }
-  else
-    {
-      conversion_result = 0.0;
-    }
-  if (conversion_end == NULL)
-    {
-      debug_print_error(("No number conversion was executed (the string is NULL)!\n"));
-    }
-  else if (*str == conversion_end || strchr(FROMJSON_VALID_DELIMITERS, *conversion_end) == NULL)
+  conversion_result = strtod(str, &conversion_end);
+  if (str == conversion_end || conversion_end != end)
     {
-      fromjson_find_next_delimiter(&next_delim_ptr, *str, 1, 0);
-      debug_print_error(("The parameter \"%.*s\" is not a valid number!\n", next_delim_ptr - *str, *str));
+      debug_print_error(("The parameter \"%.*s\" is not a valid number!\n", (int)(end - str), str));
     }
   else if (errno == ERANGE)
     {
-      fromjson_find_next_delimiter(&next_delim_ptr, *str, 1, 0);
       if (conversion_result == HUGE_VAL || conversion_result == -HUGE_VAL)
         {
           debug_print_error(("The parameter \"%.*s\" caused an overflow, the number has been clamped to \"%lf\"\n",
-                             next_delim_ptr - *str, *str, conversion_result));
+                             (int)(end - str), str, conversion_result));
         }
       else
         {
           debug_print_error(("The parameter \"%.*s\" caused an underflow, the number has been clamped to \"%lf\"\n",
-                             next_delim_ptr - *str, *str, conversion_result));
+                             (int)(end - str), str, conversion_result));
         }
     }
   else
     {
       success = 1;
-      *str = conversion_end;
     }
   if (was_successful != NULL)
     {
@@ -731,58 +714,83 @@ double fromjson_str_to_double(const char **str, int *was_successful)
   return conversion_result;
 }
 
-int fromjson_str_to_int(const char **str, int *was_successful)
+void fromjson_array_init(fromjson_array_t *array)
 {
-  char *conversion_end = NULL;
-  long conversion_result;
-  int success = 0;
-  const char *next_delim_ptr = NULL;
+  array->type = 'i';
+  array->length = 0;
+  array->capacity = 0;
+  array->data = NULL;
+}
 
-  errno = 0;
-  if (*str != NULL)
-    {
-      conversion_result = strtol(*str, &conversion_end, 10);
-    }
-  else
+void fromjson_array_finalize(fromjson_array_t *array)
+{
+  size_t i;
+
+  if (array->type == 'a')
     {
-      conversion_result = 0;
+      for (i = 0; i < array->length; ++i)
+        {
+          grm_args_delete(((grm_args_t **)array->data)[i]);
+        }
     }
-  if (conversion_end == NULL)
-    {
-      debug_print_error(("No number conversion was executed (the string is NULL)!\n"));
+  free(array->data);
+  fromjson_array_init(array);
+}
+
+size_t fromjson_array_element_size(char type)
+{
+  switch (type)
+    {
+    case 'i':
+      return sizeof(int);
+    case 'd':
+      return sizeof(double);
+    case 's':
+      return sizeof(char *);
+    default:
+      return sizeof(grm_args_t *);
     }
-  else if (*str == conversion_end || strchr(FROMJSON_VALID_DELIMITERS, *conversion_end) == NULL)
+}
+
+err_t fromjson_array_reserve(fromjson_array_t *array, size_t capacity)
+{
+  void *data;
+
+  data = realloc(array->data, capacity * fromjson_array_element_size(array->type));
+  if (data == NULL)
     {
-      fromjson_find_next_delimiter(&next_delim_ptr, *str, 1, 0);
-      debug_print_error(("The parameter \"%.*s\" is not a valid number!\n", next_delim_ptr - *str, *str));
+      debug_print_malloc_error();
+      return ERROR_MALLOC;
     }
-  else if (errno == ERANGE || conversion_result > INT_MAX || conversion_result < INT_MIN)
+  array->data = data;
+  array->capacity = capacity;
+
+  return ERROR_NONE;
+}
+
+err_t fromjson_array_promote_to_double(fromjson_array_t *array)
+{
+  double *data;
+  size_t i;
+
+  if (array->capacity > 0)
     {
-      fromjson_find_next_delimiter(&next_delim_ptr, *str, 1, 0);
-      if (conversion_result > INT_MAX)
+      data = malloc(array->capacity * sizeof(double));
+      if (data == NULL)
         {
-          debug_print_error(("The parameter \"%.*s\" is too big, the number has been clamped to \"%d\"\n",
-                             next_delim_ptr - *str, *str, INT_MAX));
-          conversion_result = INT_MAX;
+          debug_print_malloc_error();
+          return ERROR_MALLOC;
         }
-      else
+      for (i = 0; i < array->length; ++i)
         {
-          debug_print_error(("The parameter \"%.*s\" is too small, the number has been clamped to \"%d\"\n",
-                             next_delim_ptr - *str, *str, INT_MIN));
-          conversion_result = INT_MIN;
+          data[i] = ((int *)array->data)[i];
         }
+      free(array->data);
+      array->data = data;
     }
-  else
-    {
-      success = 1;
-      *str = conversion_end;
-    }
-  if (was_successful != NULL)
-    {
-      *was_successful = success;
-    }
+  array->type = 'd';
 
-  return (int)conversion_result;
+  return ERROR_NONE;
 }
 
 
@@ -919,11 +927,68 @@ int fromjson_str_to_int(const char **str, int *was_successful)
     return error;                                                                                         \
   }
 
+/* Arrays of numbers are written in one go: memory for the longest possible output is reserved once and the values are
+ * formatted directly into the memwriter buffer. */
+#define DEFINE_STRINGIFY_NUMBER_ARRAY(name, type, max_length)                                              \
+  err_t tojson_stringify_##name##_array(tojson_state_t *state)                                             \
+  {                                                                                                        \
+    type *values;                                                                                          \
+    unsigned int length, i;                                                                                \
+    char *buffer, *buffer_start;                                                                           \
+    err_t error = ERROR_NONE;                                                                              \
+    INIT_MULTI_VALUE(values, type);                                                                        \
+    if (state->additional_type_info != NULL)                                                               \
+      {                                                                                                    \
+        if (!str_to_uint(state->additional_type_info, &length))                                            \
+          {                                                                                                \
+            debug_print_error(                                                                             \
+                ("The given array length \"%s\" is no valid number; the array contents will be ignored.",  \
+                 state->additional_type_info));                                                            \
+            length = 0;                                                                                    \
+          }                                                                                                \
+      }                                                                                                    \
+    else                                                                                                   \
+      {                                                                                                    \
+        length = state->shared->array_length;                                                              \
+      }                                                                                                    \
+    if ((error = memwriter_ensure_buf(state->memwriter, (size_t)length * (max_length) + 2)) != ERROR_NONE) \
+      {                                                                                                    \
+        return error;                                                                                      \
+      }                                                                                                    \
+    buffer = buffer_start = memwriter_buf(state->memwriter) + memwriter_size(state->memwriter);            \
+    *buffer++ = '[';                                                                                       \
+    for (i = 0; i < length; ++i)                                                                           \
+      {                                                                                                    \
+        if (i > 0)                                                                                         \
+          {                                                                                                \
+            *buffer++ = ',';                                                                               \
+          }                                                                                                \
+        buffer += tojson_format_##name(buffer, values[i]);                                                 \
+      }                                                                                                    \
+    *buffer++ = ']';                                                                                       \
+    memwriter_commit(state->memwriter, buffer - buffer_start);                                             \
+    FIN_MULTI_VALUE(type);                                                                                 \
+    state->shared->wrote_output = 1;                                                                       \
+    return error;                                                                                          \
+  }                                                                                                        \
+                                                                                                           \
+  err_t tojson_stringify_##name##_value(memwriter_t *memwriter, type value)                                \
+  {                                                                                                        \
+    char *buffer;                                                                                          \
+    err_t error;                                                                                           \
+    if ((error = memwriter_ensure_buf(memwriter, (max_length))) != ERROR_NONE)                             \
+      {                                                                                                    \
+        return error;                                                                                      \
+      }                                                                                                    \
+    buffer = memwriter_buf(memwriter) + memwriter_size(memwriter);                                         \
+    memwriter_commit(memwriter, tojson_format_##name(buffer, value));                                      \
+    return ERROR_NONE;                                                                                     \
+  }
+
 DEFINE_STRINGIFY_SINGLE(int, int, int)
-DEFINE_STRINGIFY_MULTI(int, int)
-DEFINE_STRINGIFY_VALUE(int, int, "%d")
+DEFINE_STRINGIFY_NUMBER_ARRAY(int, int, TOJSON_INT_MAX_LENGTH)
 DEFINE_STRINGIFY_SINGLE(double, double, double)
-DEFINE_STRINGIFY_MULTI(double, double)
+DEFINE_STRINGIFY_NUMBER_ARRAY(double, double, TOJSON_DOUBLE_MAX_LENGTH)
 DEFINE_STRINGIFY_SINGLE(char, char, int)
 DEFINE_STRINGIFY_VALUE(char, char, "%c")
 DEFINE_STRINGIFY_SINGLE(string, char *, char *)
@@ -935,35 +1000,59 @@ DEFINE_STRINGIFY_MULTI(args, grm_args_t *)
 
 #undef DEFINE_STRINGIFY_SINGLE
 #undef DEFINE_STRINGIFY_MULTI
+#undef DEFINE_STRINGIFY_NUMBER_ARRAY
 #undef DEFINE_STRINGIFY_VALUE
 
 #define STR(x) #x
 #define XSTR(x) STR(x)
 
-err_t tojson_stringify_double_value(memwriter_t *memwriter, double value)
+size_t tojson_format_int(char *buffer, int value)
 {
-  err_t error;
-  size_t string_start_index;
-  const char *unprocessed_string;
+  char digits[TOJSON_INT_MAX_LENGTH];
+  unsigned int magnitude;
+  size_t digit_count = 0, length = 0;
 
-  string_start_index = memwriter_size(memwriter);
-  /*
-     The %G format specifier is important here, as it returns "NAN" for missing values -
-     %g would return "nan" and be handled as JSON_DATATYPE_NULL in fromjson_check_type()
-   */
-  if ((error = memwriter_printf(memwriter, "%." XSTR(DBL_DECIMAL_DIG) "G", value)) != ERROR_NONE)
+  magnitude = (value < 0) ? 0u - (unsigned int)value : (unsigned int)value;
+  do
     {
-      return error;
+      digits[digit_count++] = (char)('0' + magnitude % 10);
+      magnitude /= 10;
     }
-  unprocessed_string = memwriter_buf(memwriter) + string_start_index;
-  if (strspn(unprocessed_string, "0123456789-") == memwriter_size(memwriter) - string_start_index)
+  while (magnitude > 0);
+  if (value < 0)
     {
-      if ((error = memwriter_putc(memwriter, '.')) != ERROR_NONE)
-        {
-          return error;
-        }
+      buffer[length++] = '-';
     }
-  return ERROR_NONE;
+  while (digit_count > 0)
+    {
+      buffer[length++] = digits[--digit_count];
+    }
+  buffer[length] = '\0';
+  return length;
+}
+
+size_t tojson_format_double(char *buffer, double value)
+{
+  size_t length = 0;
+
+  /* Finite values are written in the shortest form which is read back as the same value. NaN and infinity are
+   * written with `%G` since the parser expects "NAN" and "INF" ("nan" would be handled as JSON_DATATYPE_NULL). */
+  if (value - value == 0.0)
+    {
+      length = double_to_str(value, buffer, TOJSON_DOUBLE_MAX_LENGTH - 2);
+    }
+  if (length == 0)
+    {
+      length = sprintf(buffer, "%." XSTR(DBL_DECIMAL_DIG) "G", value);
+    }
+  buffer[length] = '\0';
+  /* integral values need a '.', otherwise they are read back as integers */
+  if (strspn(buffer, "0123456789-") == length)
+    {
+      buffer[length++] = '.';
+      buffer[length] = '\0';
+    }
+  return length;
 }
 
 #undef XSTR
@@ -16,18 +16,24 @@ extern "C" {
 
 /* ######################### internal interface ##################################################################### */
 
-/* ========================= global varibales ======================================================================= */
+/* ========================= macros ================================================================================= */
 
 /* ------------------------- json deserializer ---------------------------------------------------------------------- */
 
-extern const char *FROMJSON_VALID_DELIMITERS;
+#define FROMJSON_ARRAY_INITIAL_CAPACITY 16
 
+#define fromjson_is_whitespace(c) \
+  ((c) == ' ' || (c) == '\n' || (c) == '\r' || (c) == '\t' || (c) == '\f' || (c) == '\v')
+/* characters which terminate a number or literal token */
+#define fromjson_is_value_end(c) \
+  ((c) == ',' || (c) == ']' || (c) == '}' || (c) == '\0' || fromjson_is_whitespace(c))
 
-/* ========================= macros ================================================================================= */
 
-/* ------------------------- json deserializer ---------------------------------------------------------------------- */
+/* ------------------------- json serializer ------------------------------------------------------------------------ */
 
-#define NEXT_VALUE_TYPE_SIZE 80
+/* Upper bounds of the characters written for numbers, including a sign, a trailing '.' and the terminating '\0' */
+#define TOJSON_INT_MAX_LENGTH (3 * sizeof(int) + 2)
+#define TOJSON_DOUBLE_MAX_LENGTH 32
 
 
 /* ========================= datatypes ============================================================================== */
@@ -47,21 +53,25 @@ typedef enum
 
 typedef struct
 {
+  /* Current parse position; strings are terminated and unescaped in place, so the parsed buffer is modified */
   char *json_ptr;
-  int parsed_any_value_before;
-} fromjson_shared_state_t;
+} fromjson_state_t;
 
 typedef struct
 {
-  fromjson_datatype_t datatype;
-  int parsing_object;
-  void *value_buffer;
-  int value_buffer_pointer_level;
-  void *next_value_memory;
-  char *next_value_type;
-  grm_args_t *args;
-  fromjson_shared_state_t *shared_state;
-} fromjson_state_t;
+  int is_int;
+  int int_value;
+  double double_value;
+} fromjson_number_t;
+
+/* Growable array of parsed values; `type` is one of the argument format characters `i`, `d`, `s` and `a` */
+typedef struct
+{
+  char type;
+  size_t length;
+  size_t capacity;
+  void *data;
+} fromjson_array_t;
 
 
 /* ------------------------- json serializer ------------------------------------------------------------------------ */
@@ -119,25 +129,27 @@ typedef struct
 
 int grm_read(grm_args_t *args, const char *json_string);
 err_t fromjson_read(grm_args_t *args, const char *json_string);
+err_t fromjson_read_in_place(grm_args_t *args, char *json_string);
 
-err_t fromjson_parse(grm_args_t *args, const char *json_string, fromjson_shared_state_t *shared_state);
+err_t fromjson_parse_object(fromjson_state_t *state, grm_args_t *args);
+err_t fromjson_parse_value(fromjson_state_t *state, grm_args_t *args, const char *key);
 err_t fromjson_parse_null(fromjson_state_t *state);
-err_t fromjson_parse_bool(fromjson_state_t *state);
-err_t fromjson_parse_number(fromjson_state_t *state);
-err_t fromjson_parse_int(fromjson_state_t *state);
-err_t fromjson_parse_double(fromjson_state_t *state);
-err_t fromjson_parse_string(fromjson_state_t *state);
-err_t fromjson_parse_array(fromjson_state_t *state);
-err_t fromjson_parse_object(fromjson_state_t *state);
+err_t fromjson_parse_bool(fromjson_state_t *state, int *bool_value);
+err_t fromjson_parse_number(fromjson_state_t *state, fromjson_number_t *number);
+err_t fromjson_parse_string(fromjson_state_t *state, char **string_value);
+err_t fromjson_parse_array(fromjson_state_t *state, grm_args_t *args, const char *key);
+err_t fromjson_parse_flat_array(fromjson_state_t *state, fromjson_array_t *array);
+err_t fromjson_push_nested_arrays(grm_args_t *args, const char *key, fromjson_array_t *arrays, size_t count);
 
 fromjson_datatype_t fromjson_check_type(const fromjson_state_t *state);
-err_t fromjson_copy_and_filter_json_string(char **dest, const char *src);
-int fromjson_is_escaped_delimiter(const char *delim_ptr, const char *str);
-int fromjson_find_next_delimiter(const char **delim_ptr, const char *src, int include_start,
-                                 int exclude_nested_structures);
-size_t fromjson_get_outer_array_length(const char *str);
-double fromjson_str_to_double(const char **str, int *was_successful);
-int fromjson_str_to_int(const char **str, int *was_successful);
+err_t fromjson_delimiter_error(const fromjson_state_t *state);
+double fromjson_str_to_double(const char *str, const char *end, int *was_successful);
+
+void fromjson_array_init(fromjson_array_t *array);
+void fromjson_array_finalize(fromjson_array_t *array);
+size_t fromjson_array_element_size(char type);
+err_t fromjson_array_reserve(fromjson_array_t *array, size_t capacity);
+err_t fromjson_array_promote_to_double(fromjson_array_t *array);
 
 
 /* ------------------------- json serializer ------------------------------------------------------------------------ */
@@ -148,6 +160,8 @@ int fromjson_str_to_int(const char **str, int *was_successful);
   err_t tojson_stringify_##name##_value(memwriter_t *memwriter, type value);
 
 err_t tojson_read_array_length(tojson_state_t *state);
+size_t tojson_format_int(char *buffer, int value);
+size_t tojson_format_double(char *buffer, double value);
 err_t tojson_skip_bytes(tojson_state_t *state);
 DECLARE_STRINGIFY(int, int)
 DECLARE_STRINGIFY(double, double)
@@ -168,14 +168,69 @@ err_t memwriter_printf(memwriter_t *memwriter, const char *format, ...)
   return error;
 }
 
+err_t memwriter_write(memwriter_t *memwriter, const void *data, size_t size)
+{
+  err_t error = ERROR_NONE;
+
+  if ((error = memwriter_ensure_buf(memwriter, size + 1)) != ERROR_NONE)
+    {
+      return error;
+    }
+  memcpy(memwriter->buf + memwriter->size, data, size);
+  memwriter->size += size;
+  memwriter->buf[memwriter->size] = '\0';
+
+  return error;
+}
+
 err_t memwriter_puts(memwriter_t *memwriter, const char *s)
 {
-  return memwriter_printf(memwriter, "%s", s);
+  return memwriter_write(memwriter, s, strlen(s));
 }
 
 err_t memwriter_putc(memwriter_t *memwriter, char c)
 {
-  return memwriter_printf(memwriter, "%c", c);
+  err_t error;
+
+  if ((error = memwriter_ensure_buf(memwriter, 2)) != ERROR_NONE)
+    {
+      return error;
+    }
+  memwriter->buf[memwriter->size++] = c;
+  memwriter->buf[memwriter->size] = '\0';
+
+  return ERROR_NONE;
+}
+
+void memwriter_commit(memwriter_t *memwriter, size_t size)
+{
+  /* `size` bytes were written directly into the spare capacity (e.g. by `recv`) */
+  memwriter->size += size;
+  if (memwriter->size < memwriter->capacity)
+    {
+      memwriter->buf[memwriter->size] = '\0';
+    }
+}
+
+char *memwriter_detach(memwriter_t *memwriter)
+{
+  /* Hand the buffer over to the caller and continue with a new, empty one. On allocation failure, `NULL` is returned
+   * and the memwriter is left unchanged. */
+  char *buf, *new_buf;
+
+  new_buf = malloc(MEMWRITER_INITIAL_SIZE);
+  if (new_buf == NULL)
+    {
+      debug_print_malloc_error();
+      return NULL;
+    }
+  buf = memwriter->buf;
+  memwriter->buf = new_buf;
+  memwriter->size = 0;
+  memwriter->capacity = MEMWRITER_INITIAL_SIZE;
+  *memwriter->buf = '\0';
+
+  return buf;
 }
 
 char *memwriter_buf(const memwriter_t *memwriter)
@@ -187,3 +242,8 @@ size_t memwriter_size(const memwriter_t *memwriter)
 {
   return memwriter->size;
 }
+
+size_t memwriter_capacity(const memwriter_t *memwriter)
+{
+  return memwriter->capacity;
+}
@@ -50,10 +50,14 @@ err_t memwriter_insert(memwriter_t *memwriter, int index, const char *str) UNUSE
 err_t memwriter_enlarge_buf(memwriter_t *memwriter, size_t size_increment);
 err_t memwriter_ensure_buf(memwriter_t *memwriter, size_t needed_additional_size);
 err_t memwriter_printf(memwriter_t *memwriter, const char *format, ...);
+err_t memwriter_write(memwriter_t *memwriter, const void *data, size_t size);
 err_t memwriter_puts(memwriter_t *memwriter, const char *s);
 err_t memwriter_putc(memwriter_t *memwriter, char c);
+void memwriter_commit(memwriter_t *memwriter, size_t size);
+char *memwriter_detach(memwriter_t *memwriter);
 char *memwriter_buf(const memwriter_t *memwriter);
 size_t memwriter_size(const memwriter_t *memwriter);
+size_t memwriter_capacity(const memwriter_t *memwriter);
 
 
 #ifdef __cplusplus
@@ -16,15 +16,18 @@
 #include <netdb.h>
 #include <netinet/in.h>
 #include <time.h>
+#include <sys/select.h>
 #include <sys/socket.h>
 #include <unistd.h>
 #include <sys/ioctl.h>
 #endif
 
 #include "args_int.h"
+#include "binary_int.h"
 #include "dynamic_args_array_int.h"
 #include "json_int.h"
 #include "net_int.h"
+#include "util_int.h"
 #include "datatype/string_list_int.h"
 #include "datatype/template/list_int.h"
 
@@ -113,6 +116,16 @@ err_t dynamic_args_array_list_entry_delete(dynamic_args_array_list_entry_t entry
 
 /* ========================= methods ================================================================================ */
 
+/* ------------------------- receiver / sender ---------------------------------------------------------------------- */
+
+int net_binary_is_enabled(void)
+{
+  return binary_is_supported() &&
+         !(getenv(NET_BINARY_ENV_KEY) != NULL &&
+           str_equals_any(getenv(NET_BINARY_ENV_KEY), 7, "0", "off", "OFF", "false", "FALSE", "no", "NO"));
+}
+
+
 /* ------------------------- receiver ------------------------------------------------------------------------------- */
 
 err_t receiver_init_for_custom(net_handle_t *handle, const char *name, unsigned int id,
@@ -122,6 +135,7 @@ err_t receiver_init_for_custom(net_handle_t *handle, const char *name, unsigned
   handle->sender_receiver.receiver.comm.custom.name = name;
   handle->sender_receiver.receiver.comm.custom.id = id;
   handle->sender_receiver.receiver.message_size = 0;
+  handle->sender_receiver.receiver.message_is_binary = 0;
   handle->sender_receiver.receiver.recv = receiver_recv_for_custom;
   handle->finalize = receiver_finalize_for_custom;
   handle->sender_receiver.receiver.memwriter = memwriter_new();
@@ -153,6 +167,7 @@ err_t receiver_init_for_socket(net_handle_t *handle, const char *hostname, unsig
   handle->sender_receiver.receiver.memwriter = NULL;
   handle->sender_receiver.receiver.comm.socket.server_socket = -1;
   handle->sender_receiver.receiver.comm.socket.client_socket = -1;
+  handle->sender_receiver.receiver.message_is_binary = 0;
   handle->sender_receiver.receiver.recv = receiver_recv_for_socket;
   handle->finalize = receiver_finalize_for_socket;
 
@@ -242,6 +257,16 @@ err_t receiver_init_for_socket(net_handle_t *handle, const char *hostname, unsig
       return ERROR_NETWORK_CONNECTION_ACCEPT;
     }
 
+  /* Announce the binary format; senders which do not know it never read from the socket, so a failing send is not
+   * treated as an error */
+  if (net_binary_is_enabled())
+    {
+      char announcement[BINARY_ANNOUNCEMENT_SIZE];
+      binary_write_announcement(announcement);
+      send(handle->sender_receiver.receiver.comm.socket.client_socket, announcement, BINARY_ANNOUNCEMENT_SIZE,
+           NET_SEND_FLAGS);
+    }
+
   handle->sender_receiver.receiver.memwriter = memwriter_new();
   if (handle->sender_receiver.receiver.memwriter == NULL)
     {
@@ -309,18 +334,54 @@ err_t receiver_finalize_for_socket(net_handle_t *handle)
 
 err_t receiver_recv_for_socket(net_handle_t *handle)
 {
-  int search_start_index = 0;
+  memwriter_t *memwriter = handle->sender_receiver.receiver.memwriter;
+  size_t search_start_index = 0, message_size, recv_size;
   char *end_ptr;
-  static char recv_buf[SOCKET_RECV_BUF_SIZE];
   err_t error = ERROR_NONE;
 
-  while ((end_ptr = memchr(memwriter_buf(handle->sender_receiver.receiver.memwriter) + search_start_index, ETB,
-                           memwriter_size(handle->sender_receiver.receiver.memwriter) - search_start_index)) == NULL)
+  handle->sender_receiver.receiver.message_is_binary = 0;
+  while (1)
     {
       int bytes_received;
-      search_start_index = memwriter_size(handle->sender_receiver.receiver.memwriter);
-      bytes_received =
-          recv(handle->sender_receiver.receiver.comm.socket.client_socket, recv_buf, SOCKET_RECV_BUF_SIZE, 0);
+      if (frombinary_is_message(memwriter_buf(memwriter), memwriter_size(memwriter)))
+        {
+          /* binary messages are length-prefixed, so reserve the whole message as soon as the header is complete */
+          if (frombinary_message_size(memwriter_buf(memwriter), memwriter_size(memwriter), &message_size))
+            {
+              if (memwriter_size(memwriter) >= message_size)
+                {
+                  handle->sender_receiver.receiver.message_is_binary = 1;
+                  break;
+                }
+              if ((error = memwriter_ensure_buf(memwriter, message_size - memwriter_size(memwriter))) != ERROR_NONE)
+                {
+                  return error;
+                }
+            }
+        }
+      else if ((end_ptr = memchr(memwriter_buf(memwriter) + search_start_index, ETB,
+                                 memwriter_size(memwriter) - search_start_index)) != NULL)
+        {
+          *end_ptr = '\0';
+          message_size = end_ptr - memwriter_buf(memwriter);
+          break;
+        }
+      else
+        {
+          search_start_index = memwriter_size(memwriter);
+        }
+      /* receive directly into the spare capacity of the memwriter, keeping one byte for the terminating '\0' */
+      if ((error = memwriter_ensure_buf(memwriter, SOCKET_RECV_BUF_SIZE + 1)) != ERROR_NONE)
+        {
+          return error;
+        }
+      recv_size = memwriter_capacity(memwriter) - memwriter_size(memwriter) - 1;
+      if (recv_size > INT_MAX)
+        {
+          recv_size = INT_MAX;
+        }
+      bytes_received = recv(handle->sender_receiver.receiver.comm.socket.client_socket,
+                            memwriter_buf(memwriter) + memwriter_size(memwriter), (int)recv_size, 0);
       if (bytes_received < 0)
         {
           psocketerror("error while receiving data");
@@ -330,14 +391,46 @@ err_t receiver_recv_for_socket(net_handle_t *handle)
         {
           return ERROR_NETWORK_RECV_CONNECTION_SHUTDOWN;
         }
-      if ((error = memwriter_printf(handle->sender_receiver.receiver.memwriter, "%.*s", bytes_received, recv_buf)) !=
-          ERROR_NONE)
-        {
-          return error;
-        }
+      memwriter_commit(memwriter, bytes_received);
+    }
+  handle->sender_receiver.receiver.message_size = message_size;
+
+  return error;
+}
+
+err_t receiver_read_binary_in_place(net_handle_t *handle, grm_args_t *args)
+{
+  /* Take the receive buffer out of the memwriter and let the arrays of the message reference it, so large datasets
+   * are not held twice (once in the receive buffer and once in `args`). */
+  memwriter_t *memwriter = handle->sender_receiver.receiver.memwriter;
+  size_t message_size = handle->sender_receiver.receiver.message_size;
+  size_t remaining_size = memwriter_size(memwriter) - message_size;
+  args_buffer_t *buffer;
+  char *buf, *shrunk_buf;
+  err_t error;
+
+  if ((buf = memwriter_detach(memwriter)) == NULL)
+    {
+      return ERROR_MALLOC;
+    }
+  /* keep the beginning of the next message which may have been received with this one */
+  if ((error = memwriter_write(memwriter, buf + message_size, remaining_size)) != ERROR_NONE)
+    {
+      free(buf);
+      return error;
     }
-  *end_ptr = '\0';
-  handle->sender_receiver.receiver.message_size = end_ptr - memwriter_buf(handle->sender_receiver.receiver.memwriter);
+  /* return the spare capacity to the system (shrinking large blocks does not copy them) */
+  if ((shrunk_buf = realloc(buf, message_size)) != NULL)
+    {
+      buf = shrunk_buf;
+    }
+  if ((buffer = args_buffer_new(buf, message_size, NULL, NULL)) == NULL)
+    {
+      free(buf);
+      return ERROR_MALLOC;
+    }
+  error = frombinary_read(args, buf, message_size, buffer);
+  args_buffer_release(buffer);
 
   return error;
 }
@@ -373,6 +466,9 @@ err_t sender_init_for_custom(net_handle_t *handle, const char *name, unsigned in
   handle->sender_receiver.sender.comm.custom.send = custom_send;
   handle->sender_receiver.sender.comm.custom.name = name;
   handle->sender_receiver.sender.comm.custom.id = id;
+  handle->sender_receiver.sender.message_is_binary = 0;
+  handle->sender_receiver.sender.message_is_framed = 0;
+  handle->sender_receiver.sender.binary_state = NET_BINARY_UNAVAILABLE;
   handle->sender_receiver.sender.send = sender_send_for_custom;
   handle->finalize = sender_finalize_for_custom;
   handle->sender_receiver.sender.memwriter = memwriter_new();
@@ -410,6 +506,21 @@ err_t sender_init_for_socket(net_handle_t *handle, const char *hostname, unsigne
 
   handle->sender_receiver.sender.memwriter = NULL;
   handle->sender_receiver.sender.comm.socket.client_socket = -1;
+  handle->sender_receiver.sender.comm.socket.announcement_size = 0;
+  handle->sender_receiver.sender.comm.socket.waited_for_announcement = 0;
+  handle->sender_receiver.sender.message_is_binary = 0;
+  handle->sender_receiver.sender.message_is_framed = 0;
+  handle->sender_receiver.sender.binary_state = net_binary_is_enabled() ? NET_BINARY_UNKNOWN : NET_BINARY_UNAVAILABLE;
+  handle->sender_receiver.sender.peer_capabilities = 0;
+  handle->sender_receiver.sender.compression_level = 0;
+  if (getenv(NET_COMPRESSION_ENV_KEY) != NULL)
+    {
+      unsigned int compression_level;
+      if (str_to_uint(getenv(NET_COMPRESSION_ENV_KEY), &compression_level))
+        {
+          handle->sender_receiver.sender.compression_level = (int)compression_level;
+        }
+    }
   handle->sender_receiver.sender.send = sender_send_for_socket;
   handle->finalize = sender_finalize_for_socket;
 
@@ -585,10 +696,23 @@ err_t sender_send_for_socket(net_handle_t *handle)
   int bytes_left;
   err_t error = ERROR_NONE;
 
-  if ((error = memwriter_putc(handle->sender_receiver.sender.memwriter, ETB)) != ERROR_NONE)
+  /* binary messages carry their size in the header and need no terminator */
+  if (handle->sender_receiver.sender.message_is_framed)
+    {
+      if ((error = memwriter_write(handle->sender_receiver.sender.memwriter, "", 1)) != ERROR_NONE)
+        {
+          return error;
+        }
+      tobinary_write_json_header(memwriter_buf(handle->sender_receiver.sender.memwriter),
+                                 memwriter_size(handle->sender_receiver.sender.memwriter) - BINARY_HEADER_SIZE);
+    }
+  else if (!handle->sender_receiver.sender.message_is_binary &&
+           (error = memwriter_putc(handle->sender_receiver.sender.memwriter, ETB)) != ERROR_NONE)
     {
       return error;
     }
+  handle->sender_receiver.sender.message_is_binary = 0;
+  handle->sender_receiver.sender.message_is_framed = 0;
 
   buf = memwriter_buf(handle->sender_receiver.sender.memwriter);
   buf_size = memwriter_size(handle->sender_receiver.sender.memwriter);
@@ -610,6 +734,75 @@ err_t sender_send_for_socket(net_handle_t *handle)
   return error;
 }
 
+void sender_negotiate_binary_for_socket(net_handle_t *handle)
+{
+  int client_socket = handle->sender_receiver.sender.comm.socket.client_socket;
+  char *announcement = handle->sender_receiver.sender.comm.socket.announcement;
+  int *announcement_size = &handle->sender_receiver.sender.comm.socket.announcement_size;
+  int bytes_received, capabilities, timeout_ms;
+
+  if (handle->sender_receiver.sender.binary_state != NET_BINARY_UNKNOWN)
+    {
+      return;
+    }
+  /* wait for the receiver announcement only once, later messages just check if it arrived in the meantime */
+  timeout_ms = handle->sender_receiver.sender.comm.socket.waited_for_announcement ? 0 : BINARY_ANNOUNCEMENT_TIMEOUT_MS;
+  handle->sender_receiver.sender.comm.socket.waited_for_announcement = 1;
+  while (*announcement_size < BINARY_ANNOUNCEMENT_SIZE)
+    {
+      fd_set read_fds;
+      struct timeval timeout;
+
+      FD_ZERO(&read_fds);
+      FD_SET(client_socket, &read_fds);
+      timeout.tv_sec = timeout_ms / 1000;
+      timeout.tv_usec = (timeout_ms % 1000) * 1000;
+      if (select(client_socket + 1, &read_fds, NULL, NULL, &timeout) <= 0)
+        {
+          /* nothing announced (yet), try again on the next message */
+          return;
+        }
+      bytes_received = recv(client_socket, announcement + *announcement_size,
+                            BINARY_ANNOUNCEMENT_SIZE - *announcement_size, 0);
+      if (bytes_received <= 0)
+        {
+          handle->sender_receiver.sender.binary_state = NET_BINARY_UNAVAILABLE;
+          return;
+        }
+      *announcement_size += bytes_received;
+    }
+  if (binary_read_announcement(announcement, &capabilities))
+    {
+      handle->sender_receiver.sender.binary_state = NET_BINARY_AVAILABLE;
+      handle->sender_receiver.sender.peer_capabilities = capabilities;
+    }
+  else
+    {
+      handle->sender_receiver.sender.binary_state = NET_BINARY_UNAVAILABLE;
+    }
+}
+
+err_t sender_begin_json_message(net_handle_t *handle)
+{
+  char header[BINARY_HEADER_SIZE];
+
+  if (memwriter_size(handle->sender_receiver.sender.memwriter) > 0)
+    {
+      /* continue the pending message */
+      return ERROR_NONE;
+    }
+  sender_negotiate_binary_for_socket(handle);
+  if (handle->sender_receiver.sender.binary_state != NET_BINARY_AVAILABLE)
+    {
+      return ERROR_NONE;
+    }
+  /* reserve space for the frame header, it is filled in by `sender_send_for_socket` when the message is complete */
+  handle->sender_receiver.sender.message_is_framed = 1;
+  memset(header, 0, BINARY_HEADER_SIZE);
+
+  return memwriter_write(handle->sender_receiver.sender.memwriter, header, BINARY_HEADER_SIZE);
+}
+
 err_t sender_send_for_custom(net_handle_t *handle)
 {
   const char *buf;
@@ -714,15 +907,40 @@ grm_args_t *grm_recv(const void *p, grm_args_t *args)
     {
       goto error_cleanup;
     }
-  if (fromjson_read(args, memwriter_buf(handle->sender_receiver.receiver.memwriter)) != ERROR_NONE)
+  if (handle->sender_receiver.receiver.message_is_binary &&
+      handle->sender_receiver.receiver.message_size >= RECV_IN_PLACE_MIN_SIZE &&
+      frombinary_is_in_place_message(memwriter_buf(handle->sender_receiver.receiver.memwriter),
+                                     handle->sender_receiver.receiver.message_size))
     {
-      goto error_cleanup;
+      if (receiver_read_binary_in_place(handle, args) != ERROR_NONE)
+        {
+          goto error_cleanup;
+        }
     }
-
-  if (memwriter_erase(handle->sender_receiver.receiver.memwriter, 0,
-                      handle->sender_receiver.receiver.message_size + 1) != ERROR_NONE)
+  else if (handle->sender_receiver.receiver.message_is_binary)
     {
-      goto error_cleanup;
+      if (frombinary_read(args, memwriter_buf(handle->sender_receiver.receiver.memwriter),
+                          handle->sender_receiver.receiver.message_size, NULL) != ERROR_NONE)
+        {
+          goto error_cleanup;
+        }
+      if (memwriter_erase(handle->sender_receiver.receiver.memwriter, 0,
+                          handle->sender_receiver.receiver.message_size) != ERROR_NONE)
+        {
+          goto error_cleanup;
+        }
+    }
+  else
+    {
+      if (fromjson_read_in_place(args, memwriter_buf(handle->sender_receiver.receiver.memwriter)) != ERROR_NONE)
+        {
+          goto error_cleanup;
+        }
+      if (memwriter_erase(handle->sender_receiver.receiver.memwriter, 0,
+                          handle->sender_receiver.receiver.message_size + 1) != ERROR_NONE)
+        {
+          goto error_cleanup;
+        }
     }
 
   return args;
@@ -745,6 +963,10 @@ int grm_send(const void *p, const char *data_desc, ...)
   va_list vl;
   err_t error;
 
+  if ((error = sender_begin_json_message(handle)) != ERROR_NONE)
+    {
+      return 0;
+    }
   va_start(vl, data_desc);
   error = tojson_write_vl(handle->sender_receiver.sender.memwriter, data_desc, &vl);
   if (error == ERROR_NONE && tojson_is_complete() && handle->sender_receiver.sender.send != NULL)
@@ -761,6 +983,10 @@ int grm_send_buf(const void *p, const char *data_desc, const void *buffer, int a
   net_handle_t *handle = (net_handle_t *)p;
   err_t error;
 
+  if ((error = sender_begin_json_message(handle)) != ERROR_NONE)
+    {
+      return 0;
+    }
   error = tojson_write_buf(handle->sender_receiver.sender.memwriter, data_desc, buffer, apply_padding);
   if (error == ERROR_NONE && tojson_is_complete() && handle->sender_receiver.sender.send != NULL)
     {
@@ -1031,9 +1257,37 @@ int grm_send_ref(const void *p, const char *key, char format, const void *ref, i
 int grm_send_args(const void *p, const grm_args_t *args)
 {
   net_handle_t *handle = (net_handle_t *)p;
+  memwriter_t *memwriter = handle->sender_receiver.sender.memwriter;
   err_t error;
 
-  error = tojson_write_args(handle->sender_receiver.sender.memwriter, args);
+  /* The binary format can only be used if no partially written JSON message is pending */
+  if (memwriter_size(memwriter) == 0)
+    {
+      sender_negotiate_binary_for_socket(handle);
+    }
+  if (handle->sender_receiver.sender.binary_state == NET_BINARY_AVAILABLE && memwriter_size(memwriter) == 0)
+    {
+      error = tobinary_write_args(memwriter, args,
+                                  (handle->sender_receiver.sender.peer_capabilities & BINARY_FLAG_COMPRESSED)
+                                      ? handle->sender_receiver.sender.compression_level
+                                      : 0);
+      if (error == ERROR_NONE)
+        {
+          handle->sender_receiver.sender.message_is_binary = 1;
+          error = handle->sender_receiver.sender.send(handle);
+          return error == ERROR_NONE;
+        }
+      else if (error != ERROR_UNSUPPORTED_DATATYPE)
+        {
+          return 0;
+        }
+      /* arguments with multiple values per key are only supported by JSON */
+    }
+  if ((error = sender_begin_json_message(handle)) != ERROR_NONE)
+    {
+      return 0;
+    }
+  error = tojson_write_args(memwriter, args);
   if (error == ERROR_NONE && tojson_is_complete() && handle->sender_receiver.sender.send != NULL)
     {
       error = handle->sender_receiver.sender.send(handle);
@@ -7,6 +7,7 @@ extern "C" {
 
 /* ######################### includes ############################################################################### */
 
+#include "binary_int.h"
 #include "error_int.h"
 #include "memwriter_int.h"
 #include <grm/net.h>
@@ -19,12 +20,24 @@ extern "C" {
 /* ------------------------- receiver / sender----------------------------------------------------------------------- */
 
 #define SOCKET_RECV_BUF_SIZE (MEMWRITER_INITIAL_SIZE - 1)
+/* Binary messages of at least this size are read in place: their arrays reference the receive buffer */
+#define RECV_IN_PLACE_MIN_SIZE 1048576
+
+#define NET_BINARY_ENV_KEY "GRM_NET_BINARY"
+
+#ifdef MSG_NOSIGNAL
+#define NET_SEND_FLAGS MSG_NOSIGNAL
+#else
+#define NET_SEND_FLAGS 0
+#endif
 
 
 /* ------------------------- sender --------------------------------------------------------------------------------- */
 
 #define SEND_REF_FORMAT_MAX_LENGTH 100
 #define PORT_MAX_STRING_LENGTH 80
+#define NET_COMPRESSION_ENV_KEY "GRM_NET_COMPRESSION"
+#define BINARY_ANNOUNCEMENT_TIMEOUT_MS 100
 
 
 /* ========================= datatypes ============================================================================== */
@@ -34,6 +47,13 @@ extern "C" {
 struct _net_handle_t;
 typedef struct _net_handle_t net_handle_t;
 
+typedef enum
+{
+  NET_BINARY_UNKNOWN,
+  NET_BINARY_UNAVAILABLE,
+  NET_BINARY_AVAILABLE
+} net_binary_state_t;
+
 typedef err_t (*recv_callback_t)(net_handle_t *);
 typedef err_t (*send_callback_t)(net_handle_t *);
 typedef const char *(*custom_recv_callback_t)(const char *, unsigned int);
@@ -49,6 +69,7 @@ struct _net_handle_t
     {
       memwriter_t *memwriter;
       size_t message_size;
+      int message_is_binary;
       recv_callback_t recv;
       union
       {
@@ -68,6 +89,11 @@ struct _net_handle_t
     struct
     {
       memwriter_t *memwriter;
+      int message_is_binary;
+      int message_is_framed;
+      net_binary_state_t binary_state;
+      int peer_capabilities;
+      int compression_level;
       send_callback_t send;
       union
       {
@@ -81,6 +107,9 @@ struct _net_handle_t
         {
           int client_socket;
           struct sockaddr_in server_address;
+          char announcement[BINARY_ANNOUNCEMENT_SIZE];
+          int announcement_size;
+          int waited_for_announcement;
         } socket;
       } comm;
     } sender;
@@ -90,6 +119,11 @@ struct _net_handle_t
 
 /* ========================= methods ================================================================================ */
 
+/* ------------------------- receiver / sender ---------------------------------------------------------------------- */
+
+static int net_binary_is_enabled(void);
+
+
 /* ------------------------- receiver ------------------------------------------------------------------------------- */
 
 static err_t receiver_init_for_socket(net_handle_t *handle, const char *hostname, unsigned int port);
@@ -99,6 +133,7 @@ static err_t receiver_finalize_for_socket(net_handle_t *handle);
 static err_t receiver_finalize_for_custom(net_handle_t *handle);
 static err_t receiver_recv_for_socket(net_handle_t *handle);
 static err_t receiver_recv_for_custom(net_handle_t *handle);
+static err_t receiver_read_binary_in_place(net_handle_t *handle, grm_args_t *args);
 
 
 /* ------------------------- sender --------------------------------------------------------------------------------- */
@@ -110,6 +145,8 @@ static err_t sender_finalize_for_socket(net_handle_t *handle);
 static err_t sender_finalize_for_custom(net_handle_t *handle);
 static err_t sender_send_for_socket(net_handle_t *handle);
 static err_t sender_send_for_custom(net_handle_t *handle);
+static void sender_negotiate_binary_for_socket(net_handle_t *handle);
+static err_t sender_begin_json_message(net_handle_t *handle);
 
 
 #ifdef __cplusplus
@@ -1,5 +1,6 @@
 /* ######################### includes ############################################################################### */
 
+#include <algorithm>
 #include <string>
 
 extern "C" {
@@ -20,7 +21,9 @@ extern "C" {
 #include "interaction_int.h"
 #include "logging_int.h"
 #include "plot_int.h"
+#include "ringbuffer_int.h"
 #include "util_int.h"
+#include "worker_pool_int.h"
 
 #include "datatype/double_map_int.h"
 #include "datatype/string_map_int.h"
@@ -48,6 +51,39 @@ DECLARE_MAP_TYPE(plot_func, plot_func_t)
 DECLARE_MAP_TYPE(args_set, args_set_t *)
 
 
+/* ------------------------- polar histogram ------------------------------------------------------------------------ */
+
+/* Input of the colormap image of a polar histogram; the image is computed in stripes of rows by the worker pool */
+typedef struct
+{
+  int *lineardata;
+  int image_size;
+  int center;
+  int phiflip;
+  unsigned int num_bins;
+  const double *angles;
+  const int *bin_counts;
+  unsigned int num_bin_edges;
+  const double *bin_widths;
+  int is_pdf;
+  int is_countdensity;
+  int total;
+  double norm_factor;
+  double max;
+  double r_min;
+  double r_max;
+  const int *colormap;
+  int colormap_size;
+} polar_histogram_image_t;
+
+typedef struct
+{
+  const polar_histogram_image_t *image;
+  int first_row;
+  int last_row;
+} polar_histogram_image_rows_t;
+
+
 #undef DECLARE_SET_TYPE
 #undef DECLARE_MAP_TYPE
 
@@ -110,6 +146,11 @@ DECLARE_MAP_METHODS(plot_func)
 DECLARE_MAP_METHODS(args_set)
 
 
+/* ------------------------- data preparation ----------------------------------------------------------------------- */
+
+static const double *plot_prepared_bins(const plot_prepared_t *request);
+
+
 #undef DECLARE_SET_METHODS
 #undef DECLARE_MAP_METHODS
 
@@ -229,6 +270,25 @@ static const double_map_entry_t symbol_to_meters_per_unit[] = {
 static int pre_plot_text_encoding = -1;
 
 
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~ subplot cache ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static subplot_cache_entry_t *subplot_cache = nullptr;
+static unsigned int subplot_cache_length = 0;
+static unsigned int subplot_cache_capacity = 0;
+static int subplot_cache_wiss_opened = 0;
+static int subplot_cache_active = 0;
+static int subplot_cache_open_segment = 0;
+static int subplot_cache_next_segment = 1;
+static double subplot_cache_layout[10];
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~ data preparation ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+static plot_prepared_t *plot_prepared = nullptr;
+static unsigned int plot_prepared_length = 0;
+static unsigned int plot_prepared_capacity = 0;
+
+
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~ valid keys ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
 /* IMPORTANT: Every key should only be part of ONE array -> keys can be assigned to the right object, if a user sends a
@@ -295,12 +355,12 @@ const char *valid_subplot_keys[] = {"accelerate",
                                     "zlog",
                                     nullptr};
 const char *valid_series_keys[] = {
-    "a",          "algorithm",    "bin_width",  "bin_edges",  "bin_counts", "c",      "c_dims",     "crange",
-    "draw_edges", "dmin",         "dmax",       "edge_color", "edge_width", "error",  "face_color", "foreground_color",
-    "indices",    "inner_series", "isovalue",   "markertype", "nbins",      "philim", "rgb",        "rlim",
-    "s",          "spec",         "step_where", "stairs",     "u",          "v",      "weights",    "x",
-    "xcolormap",  "xrange",       "y",          "ycolormap",  "ylabels",    "yrange", "z",          "z_dims",
-    "zrange",     nullptr};
+    "a",          "algorithm",    "bin_width", "bin_edges",  "bin_counts", "c",       "c_dims",     "crange",
+    "draw_edges", "dmin",         "dmax",      "edge_color", "edge_width", "error",   "face_color", "foreground_color",
+    "indices",    "inner_series", "isovalue",  "markertype", "nbins",      "philim",  "rgb",        "ring_capacity",
+    "rlim",       "s",            "spec",      "step_where", "stairs",     "u",       "v",          "weights",
+    "x",          "xcolormap",    "xrange",    "y",          "ycolormap",  "ylabels", "yrange",     "z",
+    "z_dims",     "zrange",       nullptr};
 
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~ valid types ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
@@ -348,6 +408,7 @@ static string_map_entry_t key_to_formats[] = {{"a", "A"},
                                               {"raw", "s"},
                                               {"resample_method", "s|i"},
                                               {"reset_ranges", "i"},
+                                              {"ring_capacity", "i"},
                                               {"rotation", "d"},
                                               {"size", "D|I|A"},
                                               {"spec", "s"},
@@ -757,6 +818,100 @@ cleanup:
   return error;
 }
 
+err_t plot_append_args(const grm_args_t *append_args)
+{
+  /* Append the data arrays of `append_args` to an existing series (selected by the id keys like `plot_merge_args`
+   * does) instead of replacing them. The series arrays are turned into ring buffers which keep the last
+   * `ring_capacity` values (or grow if no capacity is set), so a stream only needs to send the new points. For kinds
+   * whose ranges are the plain minima and maxima of the data, the series ranges are updated from the ring buffers, so
+   * `plot_store_coordinate_ranges` does not rescan the data on every frame. */
+  const char *data_component_names[] = {"x", "y", "z", "c", nullptr};
+  const char *range_keys[] = {"xrange", "yrange", "zrange", "crange", nullptr};
+  double *component_values[array_size(data_component_names)];
+  unsigned int component_length, length = 0;
+  int plot_id, subplot_id, series_id;
+  grm_args_t **plots, **subplots, **series;
+  unsigned int plot_count, subplot_count, series_count;
+  grm_args_t *subplot_args, *series_args;
+  const char *kind = nullptr, *style = "";
+  int ring_capacity = 0, update_ranges, has_data = 0;
+  double min_component, max_component;
+  ringbuffer_t *ring;
+  unsigned int i;
+  err_t error;
+
+  get_id_from_args(append_args, &plot_id, &subplot_id, &series_id);
+  if (plot_id <= 0)
+    {
+      plot_id = (active_plot_index > 0) ? active_plot_index : 1;
+    }
+  subplot_id = grm_max(subplot_id, 1);
+  series_id = grm_max(series_id, 1);
+  return_error_if(!grm_args_first_value(global_root_args, "plots", "A", &plots, &plot_count) ||
+                      (unsigned int)plot_id > plot_count,
+                  ERROR_PLOT_INVALID_ID);
+  return_error_if(!grm_args_first_value(plots[plot_id - 1], "subplots", "A", &subplots, &subplot_count) ||
+                      (unsigned int)subplot_id > subplot_count,
+                  ERROR_PLOT_INVALID_ID);
+  subplot_args = subplots[subplot_id - 1];
+  return_error_if(!grm_args_first_value(subplot_args, "series", "A", &series, &series_count) ||
+                      (unsigned int)series_id > series_count,
+                  ERROR_PLOT_INVALID_ID);
+  series_args = series[series_id - 1];
+
+  for (i = 0; data_component_names[i] != nullptr; ++i)
+    {
+      component_values[i] = nullptr;
+      if (!grm_args_contains(append_args, data_component_names[i]))
+        {
+          continue;
+        }
+      return_error_if(!grm_args_first_value(append_args, data_component_names[i], "D", &component_values[i],
+                                            &component_length),
+                      ERROR_PLOT_INCOMPATIBLE_ARGUMENTS);
+      return_error_if(has_data && component_length != length, ERROR_PLOT_COMPONENT_LENGTH_MISMATCH);
+      length = component_length;
+      has_data = 1;
+    }
+  return_error_if(!has_data, ERROR_PLOT_MISSING_DATA);
+
+  if (grm_args_values(append_args, "ring_capacity", "i", &ring_capacity))
+    {
+      grm_args_push(series_args, "ring_capacity", "i", ring_capacity);
+    }
+  else
+    {
+      grm_args_values(series_args, "ring_capacity", "i", &ring_capacity);
+    }
+  ring_capacity = grm_max(ring_capacity, 0);
+
+  grm_args_values(subplot_args, "kind", "s", &kind);
+  grm_args_values(subplot_args, "style", "s", &style);
+  update_ranges = kind != nullptr && str_equals_any(kind, 6, "line", "scatter", "step", "stem", "plot3", "scatter3") &&
+                  strcmp(style, "stacked") != 0;
+  for (i = 0; data_component_names[i] != nullptr; ++i)
+    {
+      if (component_values[i] != nullptr)
+        {
+          error = ringbuffer_append(series_args, data_component_names[i], ring_capacity, component_values[i], length);
+          return_if_error;
+        }
+      /* Ranges of other components (e.g. `x` of a line plot which is given by the length of `y`) are stale now */
+      ring = update_ranges ? ringbuffer_of_arg(args_at(series_args, data_component_names[i])) : nullptr;
+      if (ring != nullptr)
+        {
+          ringbuffer_range(ring, &min_component, &max_component);
+          grm_args_push(series_args, range_keys[i], "dd", min_component, max_component);
+        }
+      else
+        {
+          grm_args_remove(series_args, range_keys[i]);
+        }
+    }
+
+  return ERROR_NONE;
+}
+
 err_t plot_init_arg_structure(arg_t *arg, const char **hierarchy_name_ptr, unsigned int next_hierarchy_level_max_id)
 {
   grm_args_t **args_array = nullptr;
@@ -1729,17 +1884,30 @@ err_t plot_store_coordinate_ranges(grm_args_t *subplot_args)
                             }
                           else
                             {
+                              const array_stats_t *stats =
+                                  arg_array_stats(args_at(*current_series, *current_component_name));
                               if (strcmp(kind, "barplot") == 0)
                                 {
                                   current_min_component = 0.0;
                                   current_max_component = 0.0;
                                 }
-                              for (i = 0; i < current_point_count; i++)
+                              if (stats != nullptr)
+                                {
+                                  /* cached until the array is modified, so unchanged data is not scanned again */
+                                  current_min_component = grm_min(stats->min, current_min_component);
+                                  current_max_component = grm_max(stats->max, current_max_component);
+                                }
+                              else
                                 {
-                                  if (!is_nan(current_component[i]))
+                                  for (i = 0; i < current_point_count; i++)
                                     {
-                                      current_min_component = grm_min(current_component[i], current_min_component);
-                                      current_max_component = grm_max(current_component[i], current_max_component);
+                                      if (!is_nan(current_component[i]))
+                                        {
+                                          current_min_component =
+                                              grm_min(current_component[i], current_min_component);
+                                          current_max_component =
+                                              grm_max(current_component[i], current_max_component);
+                                        }
                                     }
                                 }
                             }
@@ -2013,6 +2181,7 @@ err_t plot_store_coordinate_ranges(grm_args_t *subplot_args)
               double current_y_min = DBL_MAX, current_y_max = -DBL_MAX;
               {
                 double *x = nullptr, *weights = nullptr;
+                const double *current_bins;
                 unsigned int num_bins = 0, num_weights;
                 cleanup_and_set_error_if(!grm_args_first_value(*current_series, "x", "D", &x, &current_point_count),
                                          ERROR_PLOT_MISSING_DATA);
@@ -2026,15 +2195,22 @@ err_t plot_store_coordinate_ranges(grm_args_t *subplot_args)
                   {
                     num_bins = (int)(3.3 * log10(current_point_count) + 0.5) + 1;
                   }
-                bins = static_cast<double *>(malloc(num_bins * sizeof(double)));
-                cleanup_and_set_error_if(bins == nullptr, ERROR_MALLOC);
-                bin_data(current_point_count, x, num_bins, bins, weights);
+                plot_prepared_t request = {*current_series, PLOT_PREPARED_HIST_BINS, x, current_point_count, weights,
+                                           0, 0, num_bins, nullptr};
+                current_bins = plot_prepared_bins(&request);
+                if (current_bins == nullptr)
+                  {
+                    bins = static_cast<double *>(malloc(num_bins * sizeof(double)));
+                    cleanup_and_set_error_if(bins == nullptr, ERROR_MALLOC);
+                    bin_data(current_point_count, x, num_bins, bins, weights);
+                    current_bins = bins;
+                  }
                 for (i = 0; i < num_bins; i++)
                   {
-                    current_y_min = grm_min(current_y_min, bins[i]);
-                    current_y_max = grm_max(current_y_max, bins[i]);
+                    current_y_min = grm_min(current_y_min, current_bins[i]);
+                    current_y_max = grm_max(current_y_max, current_bins[i]);
                   }
-                grm_args_push(*current_series, "bins", "nD", num_bins, bins);
+                grm_args_push(*current_series, "bins", "nD", num_bins, current_bins);
                 free(bins);
                 bins = nullptr;
               }
@@ -2240,8 +2416,474 @@ err_t plot_get_args_in_hierarchy(grm_args_t *args, const char **hierarchy_name_s
 }
 
 
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~ subplot cache ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* The output of every subplot which did not change between two `grm_plot` calls is recorded as a GKS segment in a
+ * workstation independent segment storage (WISS). As long as the subplot arguments are not modified (which is
+ * detected with `args_generation`), the segment is copied to the output workstations instead of rendering the subplot
+ * again. Subplots which change on every call are not recorded at all, neither are subplots holding arrays of the
+ * caller (`grm_args_push_ref`) which can be modified in place without a new generation. */
+
+static subplot_cache_entry_t *plot_subplot_cache_entry(const grm_args_t *subplot_args)
+{
+  subplot_cache_entry_t *entry;
+  unsigned int i;
+
+  for (i = 0; i < subplot_cache_length; ++i)
+    {
+      if (subplot_cache[i].subplot_args == subplot_args)
+        {
+          return &subplot_cache[i];
+        }
+    }
+  if (subplot_cache_length == subplot_cache_capacity)
+    {
+      unsigned int new_capacity = (subplot_cache_capacity > 0) ? 2 * subplot_cache_capacity : 16;
+      subplot_cache_entry_t *new_subplot_cache =
+          (subplot_cache_entry_t *)realloc(subplot_cache, new_capacity * sizeof(subplot_cache_entry_t));
+      if (new_subplot_cache == nullptr)
+        {
+          debug_print_malloc_error();
+          return nullptr;
+        }
+      subplot_cache = new_subplot_cache;
+      subplot_cache_capacity = new_capacity;
+    }
+  entry = &subplot_cache[subplot_cache_length++];
+  entry->subplot_args = subplot_args;
+  entry->generation = 0;
+  entry->segment = 0;
+  entry->visited = 0;
+
+  return entry;
+}
+
+static void plot_subplot_cache_delete_segment(subplot_cache_entry_t *entry)
+{
+  if (entry->segment != 0)
+    {
+      gks_delete_seg(entry->segment);
+      entry->segment = 0;
+    }
+}
+
+int plot_subplot_cache_begin(const grm_args_t *plot_args)
+{
+  /* Activate the segment storage for the subplots of `plot_args`; returns `0` if the cache cannot be used */
+  double layout[10];
+  int pixel_width, pixel_height, state, errind, conid, wtype;
+  unsigned int i;
+
+  subplot_cache_active = 0;
+  /* GR streams (`GR_DISPLAY`, `GR_DEBUG`) are written by GR directly, so they would miss copied segments */
+  if (getenv("GR_DISPLAY") != nullptr || getenv("GR_DEBUG") != nullptr)
+    {
+      return 0;
+    }
+  if (!grm_args_values(plot_args, "wswindow", "dddd", &layout[0], &layout[1], &layout[2], &layout[3]) ||
+      !grm_args_values(plot_args, "wsviewport", "dddd", &layout[4], &layout[5], &layout[6], &layout[7]) ||
+      !grm_args_values(plot_args, "previous_pixel_size", "ii", &pixel_width, &pixel_height))
+    {
+      return 0;
+    }
+  layout[8] = pixel_width;
+  layout[9] = pixel_height;
+
+  gks_inq_operating_state(&state);
+  if (state != GKS_K_WSAC)
+    {
+      return 0;
+    }
+  gks_inq_ws_conntype(PLOT_SUBPLOT_CACHE_WKID, &errind, &conid, &wtype);
+  if (errind != GKS_K_NO_ERROR)
+    {
+      /* The segment storage was not opened yet or it was closed together with GKS, so no segment exists */
+      for (i = 0; i < subplot_cache_length; ++i)
+        {
+          subplot_cache[i].segment = 0;
+        }
+      gks_open_ws(PLOT_SUBPLOT_CACHE_WKID, nullptr, GKS_K_WSTYPE_WISS);
+      gks_inq_ws_conntype(PLOT_SUBPLOT_CACHE_WKID, &errind, &conid, &wtype);
+      subplot_cache_wiss_opened = (errind == GKS_K_NO_ERROR);
+    }
+  if (!subplot_cache_wiss_opened || wtype != GKS_K_WSTYPE_WISS)
+    {
+      return 0;
+    }
+
+  if (memcmp(layout, subplot_cache_layout, sizeof(layout)) != 0)
+    {
+      /* The segments are stored in normalized device coordinates and are only valid for the same workstation setup */
+      for (i = 0; i < subplot_cache_length; ++i)
+        {
+          plot_subplot_cache_delete_segment(&subplot_cache[i]);
+        }
+      memcpy(subplot_cache_layout, layout, sizeof(layout));
+    }
+  for (i = 0; i < subplot_cache_length; ++i)
+    {
+      subplot_cache[i].visited = 0;
+    }
+  gks_activate_ws(PLOT_SUBPLOT_CACHE_WKID);
+  subplot_cache_active = 1;
+
+  return 1;
+}
+
+int plot_subplot_cache_is_valid(const grm_args_t *subplot_args)
+{
+  /* Return `1` if `plot_subplot_cache_replay` will copy the recorded output of `subplot_args` (without side effects) */
+  unsigned int i;
+
+  if (!subplot_cache_active)
+    {
+      return 0;
+    }
+  for (i = 0; i < subplot_cache_length; ++i)
+    {
+      if (subplot_cache[i].subplot_args == subplot_args)
+        {
+          return subplot_cache[i].segment != 0 && subplot_cache[i].generation == args_generation(subplot_args);
+        }
+    }
+
+  return 0;
+}
+
+int plot_subplot_cache_replay(const grm_args_t *subplot_args)
+{
+  /* Copy the recorded output of `subplot_args` to the output workstations and return `1` if it is still valid;
+   * otherwise return `0` (the subplot must be rendered) and start a recording if the subplot did not change since the
+   * previous call. */
+  subplot_cache_entry_t *entry;
+  unsigned long generation;
+
+  if (!subplot_cache_active)
+    {
+      return 0;
+    }
+  entry = plot_subplot_cache_entry(subplot_args);
+  if (entry == nullptr)
+    {
+      return 0;
+    }
+  entry->visited = 1;
+  if (args_has_caller_owned_arrays(subplot_args))
+    {
+      plot_subplot_cache_delete_segment(entry);
+      return 0;
+    }
+  generation = args_generation(subplot_args);
+  if (generation == entry->generation && entry->segment != 0)
+    {
+      logger((stderr, "Copy segment %d of subplot %p\n", entry->segment, (void *)subplot_args));
+      gr_copysegws(entry->segment);
+      return 1;
+    }
+  plot_subplot_cache_delete_segment(entry);
+  if (generation == entry->generation)
+    {
+      entry->segment = subplot_cache_next_segment;
+      subplot_cache_next_segment = (subplot_cache_next_segment < INT_MAX) ? subplot_cache_next_segment + 1 : 1;
+      subplot_cache_open_segment = entry->segment;
+      logger((stderr, "Record segment %d of subplot %p\n", entry->segment, (void *)subplot_args));
+      gr_createseg(entry->segment);
+    }
+
+  return 0;
+}
+
+void plot_subplot_cache_store(const grm_args_t *subplot_args)
+{
+  /* Finish the rendering of `subplot_args`; the arguments pushed while rendering are part of the stored state */
+  subplot_cache_entry_t *entry;
+
+  if (!subplot_cache_active)
+    {
+      return;
+    }
+  if (subplot_cache_open_segment != 0)
+    {
+      gr_closeseg();
+      subplot_cache_open_segment = 0;
+    }
+  entry = plot_subplot_cache_entry(subplot_args);
+  if (entry != nullptr)
+    {
+      entry->generation = args_generation(subplot_args);
+    }
+}
+
+void plot_subplot_cache_end(void)
+{
+  /* Deactivate the segment storage and delete the segments of subplots which were not drawn (anymore) */
+  unsigned int i, j;
+
+  if (!subplot_cache_active)
+    {
+      return;
+    }
+  if (subplot_cache_open_segment != 0)
+    {
+      /* a subplot failed while it was recorded, so the segment is incomplete */
+      gr_closeseg();
+      for (i = 0; i < subplot_cache_length; ++i)
+        {
+          if (subplot_cache[i].segment == subplot_cache_open_segment)
+            {
+              plot_subplot_cache_delete_segment(&subplot_cache[i]);
+            }
+        }
+      subplot_cache_open_segment = 0;
+    }
+  for (i = 0, j = 0; i < subplot_cache_length; ++i)
+    {
+      if (subplot_cache[i].visited)
+        {
+          subplot_cache[j++] = subplot_cache[i];
+        }
+      else
+        {
+          plot_subplot_cache_delete_segment(&subplot_cache[i]);
+        }
+    }
+  subplot_cache_length = j;
+  gks_deactivate_ws(PLOT_SUBPLOT_CACHE_WKID);
+  subplot_cache_active = 0;
+}
+
+void plot_subplot_cache_finalize(void)
+{
+  int state, errind, conid, wtype;
+
+  gks_inq_operating_state(&state);
+  if (subplot_cache_wiss_opened && state >= GKS_K_WSOP)
+    {
+      gks_inq_ws_conntype(PLOT_SUBPLOT_CACHE_WKID, &errind, &conid, &wtype);
+      if (errind == GKS_K_NO_ERROR)
+        {
+          gks_close_ws(PLOT_SUBPLOT_CACHE_WKID);
+        }
+    }
+  subplot_cache_wiss_opened = 0;
+  free(subplot_cache);
+  subplot_cache = nullptr;
+  subplot_cache_length = 0;
+  subplot_cache_capacity = 0;
+  memset(subplot_cache_layout, 0, sizeof(subplot_cache_layout));
+}
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~ data preparation ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* Before the subplots are rendered one after another, the bins of all histograms and marginal heatmaps are computed
+ * concurrently by the worker pool. The rendering code looks them up with `plot_prepared_bins` and computes the bins
+ * itself if they are missing, so GR calls and modifications of args containers stay on the calling thread. */
+
+static void plot_marginal_bins(const double *z, unsigned int rows, unsigned int columns, int reduce_rows, int use_max,
+                               double *bins)
+{
+  /* Sum up (or take the maximum of) the rows or the columns of `z`; NaN values count as `0` */
+  unsigned int i, j, bin;
+  double value;
+
+  for (i = 0; i < (reduce_rows ? rows : columns); i++)
+    {
+      bins[i] = 0;
+    }
+  for (i = 0; i < rows; i++)
+    {
+      for (j = 0; j < columns; j++)
+        {
+          value = (grm_isnan(z[i * columns + j])) ? 0 : z[i * columns + j];
+          bin = reduce_rows ? i : j;
+          bins[bin] = use_max ? grm_max(bins[bin], value) : bins[bin] + value;
+        }
+    }
+}
+
+static void plot_prepare_task(void *task)
+{
+  plot_prepared_t *prepared = static_cast<plot_prepared_t *>(task);
+
+  if (prepared->kind == PLOT_PREPARED_HIST_BINS)
+    {
+      bin_data(prepared->length, const_cast<double *>(prepared->values), prepared->num_bins, prepared->bins,
+               const_cast<double *>(prepared->weights));
+    }
+  else
+    {
+      plot_marginal_bins(prepared->values, prepared->length / prepared->columns, prepared->columns,
+                         prepared->kind == PLOT_PREPARED_ROW_REDUCTION, prepared->use_max, prepared->bins);
+    }
+}
+
+static void plot_prepare_add(const plot_prepared_t *request)
+{
+  /* Queue the computation of `request`; without memory the bins are computed while rendering */
+  double *bins;
+
+  if (plot_prepared_length == plot_prepared_capacity)
+    {
+      unsigned int new_capacity = (plot_prepared_capacity > 0) ? 2 * plot_prepared_capacity : 16;
+      plot_prepared_t *new_plot_prepared =
+          static_cast<plot_prepared_t *>(realloc(plot_prepared, new_capacity * sizeof(plot_prepared_t)));
+      if (new_plot_prepared == nullptr)
+        {
+          debug_print_malloc_error();
+          return;
+        }
+      plot_prepared = new_plot_prepared;
+      plot_prepared_capacity = new_capacity;
+    }
+  bins = static_cast<double *>(malloc(request->num_bins * sizeof(double)));
+  if (bins == nullptr)
+    {
+      debug_print_malloc_error();
+      return;
+    }
+  plot_prepared[plot_prepared_length] = *request;
+  plot_prepared[plot_prepared_length++].bins = bins;
+}
+
+static const double *plot_prepared_bins(const plot_prepared_t *request)
+{
+  /* Return the prepared bins for the input of `request` or `nullptr` if they were not computed in advance */
+  const plot_prepared_t *prepared;
+  unsigned int i;
+
+  for (i = 0; i < plot_prepared_length; ++i)
+    {
+      prepared = &plot_prepared[i];
+      if (prepared->series_args == request->series_args && prepared->kind == request->kind &&
+          prepared->values == request->values && prepared->length == request->length &&
+          prepared->weights == request->weights && prepared->columns == request->columns &&
+          prepared->use_max == request->use_max && prepared->num_bins == request->num_bins)
+        {
+          return prepared->bins;
+        }
+    }
+
+  return nullptr;
+}
+
+void plot_prepare_subplots(grm_args_t *plot_args)
+{
+  /* Compute the bins of the subplots which are rendered by this `grm_plot` call (and not copied from the subplot
+   * cache); this mirrors the input handling of `plot_store_coordinate_ranges` and `plot_marginalheatmap` */
+  grm_args_t **current_subplot_args, **current_series;
+  const char *kind, *marginalheatmap_kind, *algorithm;
+  double *x, *y, *z, *weights, y_min, y_max;
+  unsigned int x_length, y_length, z_length, num_weights, num_bins;
+
+  plot_prepared_clear();
+  if (worker_pool_thread_count() < 2)
+    {
+      return;
+    }
+  grm_args_values(plot_args, "subplots", "A", &current_subplot_args);
+  for (; *current_subplot_args != nullptr; ++current_subplot_args)
+    {
+      if (plot_subplot_cache_is_valid(*current_subplot_args) ||
+          !grm_args_values(*current_subplot_args, "kind", "s", &kind) ||
+          !grm_args_values(*current_subplot_args, "series", "A", &current_series))
+        {
+          continue;
+        }
+      if (strcmp(kind, "hist") == 0 && !grm_args_values(*current_subplot_args, "ylim", "dd", &y_min, &y_max))
+        {
+          for (; *current_series != nullptr; ++current_series)
+            {
+              weights = nullptr;
+              num_bins = 0;
+              if (!grm_args_first_value(*current_series, "x", "D", &x, &x_length))
+                {
+                  continue;
+                }
+              grm_args_values(*current_series, "nbins", "i", &num_bins);
+              grm_args_first_value(*current_series, "weights", "D", &weights, &num_weights);
+              if (weights != nullptr && num_weights != x_length)
+                {
+                  continue;
+                }
+              if (num_bins <= 1)
+                {
+                  num_bins = (int)(3.3 * log10(x_length) + 0.5) + 1;
+                }
+              plot_prepared_t request = {*current_series, PLOT_PREPARED_HIST_BINS, x, x_length, weights, 0, 0,
+                                         num_bins, nullptr};
+              plot_prepare_add(&request);
+            }
+        }
+      else if (strcmp(kind, "marginalheatmap") == 0 &&
+               grm_args_values(*current_subplot_args, "marginalheatmap_kind", "s", &marginalheatmap_kind) &&
+               strcmp(marginalheatmap_kind, "all") == 0 && *current_series != nullptr &&
+               grm_args_values(*current_series, "algorithm", "s", &algorithm) &&
+               str_equals_any(algorithm, 2, "sum", "max") &&
+               grm_args_first_value(*current_series, "x", "D", &x, &x_length) &&
+               grm_args_first_value(*current_series, "y", "D", &y, &y_length) &&
+               grm_args_first_value(*current_series, "z", "D", &z, &z_length) && x_length > 0 &&
+               z_length == x_length * y_length)
+        {
+          int use_max = strcmp(algorithm, "max") == 0;
+          plot_prepared_t rows_request = {*current_series, PLOT_PREPARED_ROW_REDUCTION, z, z_length, nullptr,
+                                          x_length, use_max, y_length, nullptr};
+          plot_prepared_t columns_request = {*current_series, PLOT_PREPARED_COLUMN_REDUCTION, z, z_length, nullptr,
+                                             x_length, use_max, x_length, nullptr};
+          plot_prepare_add(&rows_request);
+          plot_prepare_add(&columns_request);
+        }
+    }
+  worker_pool_run(plot_prepare_task, plot_prepared, plot_prepared_length, sizeof(plot_prepared_t));
+}
+
+void plot_prepared_clear(void)
+{
+  unsigned int i;
+
+  for (i = 0; i < plot_prepared_length; ++i)
+    {
+      free(plot_prepared[i].bins);
+    }
+  free(plot_prepared);
+  plot_prepared = nullptr;
+  plot_prepared_length = 0;
+  plot_prepared_capacity = 0;
+}
+
+
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~ plotting ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
+static void plot_visible_polyline_part(grm_args_t *subplot_args, const double *x, unsigned int x_length, int x_sorted,
+                                       int vertical, unsigned int *first, unsigned int *length)
+{
+  /* Find the part of a polyline with ascending `x` values which can be visible in the current window: the points
+   * inside the window (enlarged by 10% like in GR to keep line joins near the edges intact) and one neighbour on each
+   * side. All other segments lie beyond the same clipping edge and would be dropped by GR anyway, but only after
+   * transforming and copying all points. This keeps redraws of zoomed in plots proportional to the visible data.
+   * Like in GR, only solid lines are shortened since dropped segments would shift the pattern of other line types. */
+  double window[4], clip_rect[4], lower, upper;
+  int log_scale = 0, errind, clip_switch, linetype;
+  const double *begin, *end;
+
+  *first = 0;
+  *length = x_length;
+  grm_args_values(subplot_args, vertical ? "ylog" : "xlog", "i", &log_scale);
+  gks_inq_clip(&errind, &clip_switch, clip_rect);
+  gks_inq_pline_linetype(&errind, &linetype);
+  if (!x_sorted || log_scale || clip_switch != GKS_K_CLIP || linetype != GKS_K_LINETYPE_SOLID ||
+      !grm_args_values(subplot_args, "window", "dddd", &window[0], &window[1], &window[2], &window[3]))
+    {
+      return;
+    }
+  lower = vertical ? window[2] : window[0];
+  upper = vertical ? window[3] : window[1];
+  begin = std::lower_bound(x, x + x_length, lower - 0.1 * (upper - lower));
+  end = std::upper_bound(begin, x + x_length, upper + 0.1 * (upper - lower));
+  *first = (begin > x) ? begin - x - 1 : 0;
+  *length = ((end < x + x_length) ? end - x + 1 : x_length) - *first;
+}
+
 err_t plot_line(grm_args_t *subplot_args)
 {
   grm_args_t **current_series;
@@ -2256,7 +2898,8 @@ err_t plot_line(grm_args_t *subplot_args)
     {
       double *x = NULL, *y = NULL;
       int allocated_x = 0, markertype;
-      unsigned int x_length = 0, y_length = 0;
+      unsigned int x_length = 0, y_length = 0, visible_first, visible_length;
+      const array_stats_t *x_stats;
       char *spec;
       int mask;
       cleanup_and_set_error_if(!grm_args_first_value(*current_series, "y", "D", &y, &y_length),
@@ -2278,13 +2921,17 @@ err_t plot_line(grm_args_t *subplot_args)
       mask = gr_uselinespec(spec);
       if (int_equals_any(mask, 5, 0, 1, 3, 4, 5))
         {
+          /* generated `x` values are ascending, given ones are checked with the cached array statistics */
+          x_stats = allocated_x ? nullptr : arg_array_stats(args_at(*current_series, "x"));
+          plot_visible_polyline_part(subplot_args, x, x_length, allocated_x || (x_stats != nullptr && x_stats->sorted),
+                                     strcmp(orientation, "horizontal") != 0, &visible_first, &visible_length);
           if (strcmp(orientation, "horizontal") == 0)
             {
-              gr_polyline(x_length, x, y);
+              gr_polyline(visible_length, x + visible_first, y + visible_first);
             }
           else
             {
-              gr_polyline(x_length, y, x);
+              gr_polyline(visible_length, y + visible_first, x + visible_first);
             }
         }
       if (mask & 2)
@@ -4260,7 +4907,7 @@ err_t plot_marginalheatmap(grm_args_t *subplot_args)
   const double *viewport;
   double c_min, c_max;
   int flip, options, xind, yind;
-  unsigned int i, j, k;
+  unsigned int i, k;
   grm_args_t **current_series;
   char *algorithm, *marginalheatmap_kind;
   double *bins = nullptr;
@@ -4276,7 +4923,7 @@ err_t plot_marginalheatmap(grm_args_t *subplot_args)
 
   for (k = 0; k < 2; k++)
     {
-      double x_min, x_max, y_min, y_max, value, bin_max = 0;
+      double x_min, x_max, y_min, y_max, bin_max = 0;
 
       gr_savestate();
 
@@ -4296,48 +4943,49 @@ err_t plot_marginalheatmap(grm_args_t *subplot_args)
 
       if (strcmp(marginalheatmap_kind, "all") == 0)
         {
-          unsigned int x_len = num_bins_x, y_len = num_bins_y;
+          unsigned int bins_length = (k == 0) ? num_bins_y : num_bins_x;
+          int use_max = strcmp(algorithm, "max") == 0;
+          const double *prepared_bins;
 
-          bins = static_cast<double *>(malloc(((k == 0) ? num_bins_y : num_bins_x) * sizeof(double)));
+          bins = static_cast<double *>(malloc(bins_length * sizeof(double)));
           cleanup_and_set_error_if(bins == nullptr, ERROR_MALLOC);
           grm_args_push(subplot_args, "kind", "s", "hist");
 
-          for (i = 0; i < ((k == 0) ? num_bins_y : num_bins_x); i++)
+          plot_prepared_t request = {*current_series,
+                                     (k == 0) ? PLOT_PREPARED_ROW_REDUCTION : PLOT_PREPARED_COLUMN_REDUCTION,
+                                     plot,
+                                     n,
+                                     nullptr,
+                                     num_bins_x,
+                                     use_max,
+                                     bins_length,
+                                     nullptr};
+          prepared_bins = plot_prepared_bins(&request);
+          if (prepared_bins != nullptr)
             {
-              bins[i] = 0;
+              memcpy(bins, prepared_bins, bins_length * sizeof(double));
             }
-          for (i = 0; i < y_len; i++)
+          else if (use_max || strcmp(algorithm, "sum") == 0)
             {
-              for (j = 0; j < x_len; j++)
-                {
-                  value = (grm_isnan(plot[i * num_bins_x + j])) ? 0 : plot[i * num_bins_x + j];
-                  if (strcmp(algorithm, "sum") == 0)
-                    {
-                      bins[(k == 0) ? i : j] += value;
-                    }
-                  else if (strcmp(algorithm, "max") == 0)
-                    {
-                      bins[(k == 0) ? i : j] = grm_max(bins[(k == 0) ? i : j], value);
-                    }
-                }
-              if (k == 0)
-                {
-                  bin_max = grm_max(bin_max, bins[i]);
-                }
+              plot_marginal_bins(plot, num_bins_y, num_bins_x, k == 0, use_max, bins);
             }
-          if (k == 1)
+          else
             {
-              for (i = 0; i < x_len; i++)
+              for (i = 0; i < bins_length; i++)
                 {
-                  bin_max = grm_max(bin_max, bins[i]);
+                  bins[i] = 0;
                 }
             }
-          for (i = 0; i < ((k == 0) ? y_len : x_len); i++)
+          for (i = 0; i < bins_length; i++)
+            {
+              bin_max = grm_max(bin_max, bins[i]);
+            }
+          for (i = 0; i < bins_length; i++)
             {
               bins[i] = (bin_max == 0) ? 0 : bins[i] / bin_max * (c_max / 15);
             }
 
-          grm_args_push(*current_series, "bins", "nD", ((k == 0) ? num_bins_y : num_bins_x), bins);
+          grm_args_push(*current_series, "bins", "nD", bins_length, bins);
 
           free(bins);
           bins = nullptr;
@@ -5012,6 +5660,55 @@ err_t plot_polar(grm_args_t *subplot_args)
 }
 
 
+static void plot_polar_histogram_image_rows(void *task)
+{
+  /* Fill the rows `[first_row, last_row)` of the colormap image of a polar histogram */
+  const polar_histogram_image_rows_t *rows = static_cast<const polar_histogram_image_rows_t *>(task);
+  const polar_histogram_image_t *image = rows->image;
+  int center = image->center, colormap_size = image->colormap_size;
+  double radius, angle, norm_factor = image->norm_factor;
+  int x, y, count;
+  unsigned int q;
+
+  for (y = rows->first_row; y < rows->last_row; y++)
+    {
+      for (x = 0; x < image->image_size; x++)
+        {
+          radius = sqrt(pow(x - center, 2) + pow(y - center, 2));
+          angle = atan2(y - center, x - center);
+
+          if (angle < 0) angle += M_PI * 2;
+          if (image->phiflip == 0) angle = 2 * M_PI - angle;
+
+          for (q = 0; q < image->num_bins; ++q)
+            {
+              if (angle > image->angles[q] && angle <= image->angles[q + 1])
+                {
+                  count = image->bin_counts[q];
+                  if (image->is_pdf && image->num_bin_edges > 0)
+                    {
+                      norm_factor = image->total * image->bin_widths[q];
+                    }
+                  else if (image->is_countdensity && image->num_bin_edges > 0)
+                    {
+                      norm_factor = image->bin_widths[q];
+                    }
+
+                  if ((grm_round(radius * 100) / 100) <=
+                          (grm_round((count * 1.0 / norm_factor / image->max * center) * 100) / 100) &&
+                      radius <= image->r_max && radius > image->r_min)
+                    {
+                      image->lineardata[y * image->image_size + x] =
+                          image->colormap[(int)(radius / (center * pow(2, 0.5)) * (colormap_size - 1)) * colormap_size +
+                                          grm_max(grm_min((int)(angle / (2 * M_PI) * colormap_size), colormap_size - 1),
+                                                  0)];
+                    }
+                }
+            }
+        }
+    }
+}
+
 /*!
  * Plot a polar histogram.
  *
@@ -5122,6 +5819,7 @@ err_t plot_polar_histogram(grm_args_t *subplot_args)
   grm_args_t **series;
   unsigned int resample = 0;
   int *lineardata = nullptr;
+  polar_histogram_image_rows_t *image_rows = nullptr;
   int *bin_counts = nullptr;
   double *f1 = nullptr;
   double *f2 = nullptr;
@@ -5275,19 +5973,24 @@ err_t plot_polar_histogram(grm_args_t *subplot_args)
         {
           int colormap_size = 500;
           int image_size = 2000;
-          int y, center, center_x, center_y;
-          double radius, angle;
+          int image_task_count = (image_size + PLOT_POLAR_HISTOGRAM_IMAGE_ROWS_PER_TASK - 1) /
+                                 PLOT_POLAR_HISTOGRAM_IMAGE_ROWS_PER_TASK;
+          int center;
           int temp1, temp2;
           int temp = 0;
           int total = 0;
           double norm_factor = 1;
-          int count = 0;
           double max_radius;
+          polar_histogram_image_t image;
 
 
           lineardata = static_cast<int *>(calloc(image_size * image_size, sizeof(int)));
           cleanup_and_set_error_if(lineardata == nullptr, ERROR_MALLOC);
 
+          image_rows = static_cast<polar_histogram_image_rows_t *>(
+              malloc(image_task_count * sizeof(polar_histogram_image_rows_t)));
+          cleanup_and_set_error_if(image_rows == nullptr, ERROR_MALLOC);
+
           bin_counts = static_cast<int *>(malloc(num_bins * sizeof(int)));
           cleanup_and_set_error_if(bin_counts == nullptr, ERROR_MALLOC);
 
@@ -5308,8 +6011,6 @@ err_t plot_polar_histogram(grm_args_t *subplot_args)
 
           outer = classes;
 
-          center_x = image_size / 2;
-          center_y = image_size / 2;
           center = image_size / 2;
 
           max_radius = center;
@@ -5354,44 +6055,34 @@ err_t plot_polar_histogram(grm_args_t *subplot_args)
               r_max = max_radius;
             }
 
-          for (y = 0; y < image_size; y++)
-            {
-              for (x = 0; x < image_size; x++)
-                {
-                  int q;
-                  radius = sqrt(pow(x - center_x, 2) + pow(y - center_y, 2));
-                  angle = atan2(y - center_y, x - center_x);
-
-                  if (angle < 0) angle += M_PI * 2;
-                  if (phiflip == 0) angle = 2 * M_PI - angle;
-
-                  for (q = 0; q < num_bins; ++q)
-                    {
-                      if (angle > angles[q] && angle <= angles[q + 1])
-                        {
-                          count = bin_counts[q];
-                          if (strcmp(norm, "pdf") == 0 && num_bin_edges > 0)
-                            {
-                              norm_factor = total * bin_widths[q];
-                            }
-                          else if (strcmp(norm, "countdensity") == 0 && num_bin_edges > 0)
-                            {
-                              norm_factor = bin_widths[q];
-                            }
-
-                          if ((grm_round(radius * 100) / 100) <=
-                                  (grm_round((count * 1.0 / norm_factor / max * center) * 100) / 100) &&
-                              radius <= r_max && radius > r_min)
-                            {
-                              lineardata[y * image_size + x] = colormap
-                                  [(int)(radius / (center * pow(2, 0.5)) * (colormap_size - 1)) * colormap_size +
-                                   grm_max(grm_min((int)(angle / (2 * M_PI) * colormap_size), colormap_size - 1), 0)];
-                            }
-
-                        } /* end angle check */
-                    }     /* end for q loop: bin check*/
-                }         /* end x loop*/
-            }             /* end y loop */
+          /* The pixels are independent, so stripes of rows are computed concurrently */
+          image.lineardata = lineardata;
+          image.image_size = image_size;
+          image.center = center;
+          image.phiflip = phiflip;
+          image.num_bins = num_bins;
+          image.angles = angles;
+          image.bin_counts = bin_counts;
+          image.num_bin_edges = num_bin_edges;
+          image.bin_widths = bin_widths;
+          image.is_pdf = strcmp(norm, "pdf") == 0;
+          image.is_countdensity = strcmp(norm, "countdensity") == 0;
+          image.total = total;
+          image.norm_factor = norm_factor;
+          image.max = max;
+          image.r_min = r_min;
+          image.r_max = r_max;
+          image.colormap = colormap;
+          image.colormap_size = colormap_size;
+          for (temp1 = 0; temp1 < image_task_count; temp1++)
+            {
+              image_rows[temp1].image = &image;
+              image_rows[temp1].first_row = temp1 * PLOT_POLAR_HISTOGRAM_IMAGE_ROWS_PER_TASK;
+              image_rows[temp1].last_row =
+                  grm_min((temp1 + 1) * PLOT_POLAR_HISTOGRAM_IMAGE_ROWS_PER_TASK, image_size);
+            }
+          worker_pool_run(plot_polar_histogram_image_rows, image_rows, image_task_count,
+                          sizeof(polar_histogram_image_rows_t));
           if (rlim != nullptr)
             {
               r_min = rlim[0];
@@ -5399,8 +6090,10 @@ err_t plot_polar_histogram(grm_args_t *subplot_args)
             }
           gr_drawimage(-1.0, 1.0, -1.0, 1.0, image_size, image_size, lineardata, 0);
           free(lineardata);
+          free(image_rows);
           free(bin_counts);
           lineardata = nullptr;
+          image_rows = nullptr;
           bin_counts = nullptr;
         } /* end colormap calculation*/
 
@@ -6033,6 +6726,7 @@ cleanup:
   free(mlist);
   free(rectlist);
   free(lineardata);
+  free(image_rows);
   free(bin_counts);
   if (freeable_bin_widths == 1)
     {
@@ -8580,6 +9274,8 @@ void grm_finalize(void)
 {
   if (plot_static_variables_initialized)
     {
+      plot_subplot_cache_finalize();
+      worker_pool_finalize();
       grm_args_delete(global_root_args);
       global_root_args = nullptr;
       active_plot_args = nullptr;
@@ -8647,7 +9343,15 @@ int grm_merge_extended(const grm_args_t *args, int hold, const char *identificat
           process_events();
           return 1;
         }
-      if (plot_merge_args(global_root_args, args, nullptr, nullptr, hold) != ERROR_NONE)
+      int append = 0;
+      if (grm_args_values(args, "append", "i", &append) && append)
+        {
+          if (plot_append_args(args) != ERROR_NONE)
+            {
+              return 0;
+            }
+        }
+      else if (plot_merge_args(global_root_args, args, nullptr, nullptr, hold) != ERROR_NONE)
         {
           return 0;
         }
@@ -8660,6 +9364,15 @@ int grm_merge_extended(const grm_args_t *args, int hold, const char *identificat
   return 1;
 }
 
+int grm_append(const grm_args_t *args)
+{
+  if (plot_init_static_variables() != ERROR_NONE)
+    {
+      return 0;
+    }
+  return plot_append_args(args) == ERROR_NONE;
+}
+
 int grm_merge_hold(const grm_args_t *args)
 {
   return grm_merge_extended(args, 1, nullptr);
@@ -8688,26 +9401,42 @@ int grm_plot(const grm_args_t *args)
     {
       plot_set_attribute_defaults(active_plot_args);
       plot_pre_plot(active_plot_args);
+      plot_subplot_cache_begin(active_plot_args);
+      plot_prepare_subplots(active_plot_args);
       grm_args_values(active_plot_args, "subplots", "A", &current_subplot_args);
       while (*current_subplot_args != nullptr)
         {
+          if (plot_subplot_cache_replay(*current_subplot_args))
+            {
+              ++current_subplot_args;
+              continue;
+            }
           if (plot_pre_subplot(*current_subplot_args) != ERROR_NONE)
             {
+              plot_subplot_cache_end();
+              plot_prepared_clear();
               return 0;
             }
           grm_args_values(*current_subplot_args, "kind", "s", &kind);
           logger((stderr, "Got keyword \"kind\" with value \"%s\"\n", kind));
           if (!plot_func_map_at(plot_func_map, kind, &plot_func))
             {
+              plot_subplot_cache_end();
+              plot_prepared_clear();
               return 0;
             }
           if (plot_func(*current_subplot_args) != ERROR_NONE)
             {
+              plot_subplot_cache_end();
+              plot_prepared_clear();
               return 0;
             };
           plot_post_subplot(*current_subplot_args);
+          plot_subplot_cache_store(*current_subplot_args);
           ++current_subplot_args;
         }
+      plot_subplot_cache_end();
+      plot_prepared_clear();
       plot_post_plot(active_plot_args);
     }
 
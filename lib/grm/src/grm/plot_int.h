@@ -86,6 +86,13 @@ extern const char *plot_clear_exclude_keys[];
 #define PLOT_CONTOUR_GRIDIT_N 200
 #define PLOT_WIREFRAME_GRIDIT_N 50
 #define PLOT_SURFACE_GRIDIT_N 200
+#define PLOT_POLAR_HISTOGRAM_IMAGE_ROWS_PER_TASK 50
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~ subplot cache ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+/* workstation id of the segment storage (GR uses `1` for output and `6` for printing) */
+#define PLOT_SUBPLOT_CACHE_WKID 9
 
 
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~ util ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
@@ -102,6 +109,42 @@ extern const char *plot_clear_exclude_keys[];
 typedef err_t (*plot_func_t)(grm_args_t *args);
 
 
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~ subplot cache ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+typedef struct
+{
+  const grm_args_t *subplot_args;
+  unsigned long generation; /* `args_generation` of `subplot_args` after it was rendered the last time */
+  int segment;              /* GKS segment with the output of the last rendering or `0` if none is recorded */
+  int visited;
+} subplot_cache_entry_t;
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~ data preparation ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+typedef enum
+{
+  PLOT_PREPARED_HIST_BINS,
+  PLOT_PREPARED_ROW_REDUCTION,
+  PLOT_PREPARED_COLUMN_REDUCTION
+} plot_prepared_kind_t;
+
+/* Bins of a series which are computed by the worker pool before the subplots are rendered. The input fields are
+ * compared with the series arguments when the bins are used, so outdated results are never taken. */
+typedef struct
+{
+  const grm_args_t *series_args;
+  plot_prepared_kind_t kind;
+  const double *values;  /* `x` of histograms or `z` of marginal heatmaps */
+  unsigned int length;
+  const double *weights; /* histograms only */
+  unsigned int columns;  /* reductions only: the row length of `values` */
+  int use_max;           /* reductions only: "max" instead of "sum" */
+  unsigned int num_bins;
+  double *bins;
+} plot_prepared_t;
+
+
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~ options ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
 typedef enum
@@ -148,6 +191,7 @@ err_t plot_init_static_variables(void);
 
 err_t plot_merge_args(grm_args_t *args, const grm_args_t *merge_args, const char **hierarchy_name_ptr,
                       uint_map_t *hierarchy_to_id, int hold_always);
+err_t plot_append_args(const grm_args_t *append_args);
 err_t plot_init_arg_structure(arg_t *arg, const char **hierarchy_name_ptr, unsigned int next_hierarchy_level_max_id);
 err_t plot_init_args_structure(grm_args_t *args, const char **hierarchy_name_ptr,
                                unsigned int next_hierarchy_level_max_id);
@@ -171,6 +215,22 @@ err_t plot_get_args_in_hierarchy(grm_args_t *args, const char **hierarchy_name_s
                                  const char ***found_hierarchy_ptr);
 
 
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~ subplot cache ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+int plot_subplot_cache_begin(const grm_args_t *plot_args);
+int plot_subplot_cache_is_valid(const grm_args_t *subplot_args);
+int plot_subplot_cache_replay(const grm_args_t *subplot_args);
+void plot_subplot_cache_store(const grm_args_t *subplot_args);
+void plot_subplot_cache_end(void);
+void plot_subplot_cache_finalize(void);
+
+
+/* ~~~~~~~~~~~~~~~~~~~~~~~~~ data preparation ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
+
+void plot_prepare_subplots(grm_args_t *plot_args);
+void plot_prepared_clear(void);
+
+
 /* ~~~~~~~~~~~~~~~~~~~~~~~~~ plotting ~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~~ */
 
 err_t plot_line(grm_args_t *subplot_args);
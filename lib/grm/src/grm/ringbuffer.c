@@ -0,0 +1,290 @@
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+/* ######################### includes ############################################################################### */
+
+#include <float.h>
+#include <stdlib.h>
+#include <string.h>
+
+#include "ringbuffer_int.h"
+
+
+/* ######################### internal implementation ################################################################ */
+
+/* ========================= macros ================================================================================= */
+
+/* ------------------------- ring buffer ---------------------------------------------------------------------------- */
+
+/* The values follow the header, so its size is rounded up to keep them aligned */
+#define RINGBUFFER_HEADER_SIZE (((sizeof(ringbuffer_t) + sizeof(double) - 1) / sizeof(double)) * sizeof(double))
+
+
+/* ========================= static variables ======================================================================= */
+
+/* ------------------------- ring buffer ---------------------------------------------------------------------------- */
+
+/* Ring buffers are stored in `args_buffer_t` objects without a release callback (they are freed with `free`); the
+ * address of this variable is used as their context to tell them apart from other shared arrays. */
+static char ringbuffer_buffer_tag;
+
+
+/* ========================= methods ================================================================================ */
+
+/* ------------------------- ring buffer ---------------------------------------------------------------------------- */
+
+ringbuffer_t *ringbuffer_new(size_t capacity)
+{
+  ringbuffer_t *ring;
+  size_t memory_size;
+
+  memory_size = ringbuffer_memory_size(capacity);
+  if (memory_size == 0)
+    {
+      return NULL;
+    }
+  ring = malloc(memory_size);
+  if (ring == NULL)
+    {
+      debug_print_malloc_error();
+      return NULL;
+    }
+  ring->capacity = capacity;
+  ring->start = 0;
+  ring->length = 0;
+  ring->min_head = 0;
+  ring->min_count = 0;
+  ring->max_head = 0;
+  ring->max_count = 0;
+
+  return ring;
+}
+
+void ringbuffer_delete(ringbuffer_t *ring)
+{
+  free(ring);
+}
+
+size_t ringbuffer_memory_size(size_t capacity)
+{
+  /* header, two copies of the values and two deques of positions; returns `0` if the size is not representable */
+  size_t bytes_per_value = 2 * (sizeof(double) + sizeof(size_t));
+
+  if (capacity == 0 || capacity > ((size_t)-1 - RINGBUFFER_HEADER_SIZE) / bytes_per_value)
+    {
+      return 0;
+    }
+  return RINGBUFFER_HEADER_SIZE + capacity * bytes_per_value;
+}
+
+double *ringbuffer_values(const ringbuffer_t *ring)
+{
+  return (double *)((char *)ring + RINGBUFFER_HEADER_SIZE);
+}
+
+static size_t *ringbuffer_min_deque(const ringbuffer_t *ring)
+{
+  return (size_t *)(ringbuffer_values(ring) + 2 * ring->capacity);
+}
+
+static size_t *ringbuffer_max_deque(const ringbuffer_t *ring)
+{
+  return ringbuffer_min_deque(ring) + ring->capacity;
+}
+
+static void ringbuffer_push_value(ringbuffer_t *ring, double value)
+{
+  double *values = ringbuffer_values(ring);
+  size_t *min_deque = ringbuffer_min_deque(ring), *max_deque = ringbuffer_max_deque(ring);
+  size_t capacity = ring->capacity, position;
+
+  if (ring->length == capacity)
+    {
+      /* Drop the oldest value; the deques are ordered by age, so it can only be referenced by their fronts */
+      if (ring->min_count > 0 && min_deque[ring->min_head] == ring->start)
+        {
+          ring->min_head = (ring->min_head + 1) % capacity;
+          --ring->min_count;
+        }
+      if (ring->max_count > 0 && max_deque[ring->max_head] == ring->start)
+        {
+          ring->max_head = (ring->max_head + 1) % capacity;
+          --ring->max_count;
+        }
+      ring->start = (ring->start + 1) % capacity;
+      --ring->length;
+    }
+  position = (ring->start + ring->length) % capacity;
+  values[position] = value;
+  values[position + capacity] = value;
+  ++ring->length;
+
+  if (value != value)
+    {
+      return;
+    }
+  /* Values which are not smaller (greater) than a newer value can never become the minimum (maximum) again */
+  while (ring->min_count > 0 && values[min_deque[(ring->min_head + ring->min_count - 1) % capacity]] >= value)
+    {
+      --ring->min_count;
+    }
+  min_deque[(ring->min_head + ring->min_count) % capacity] = position;
+  ++ring->min_count;
+  while (ring->max_count > 0 && values[max_deque[(ring->max_head + ring->max_count - 1) % capacity]] <= value)
+    {
+      --ring->max_count;
+    }
+  max_deque[(ring->max_head + ring->max_count) % capacity] = position;
+  ++ring->max_count;
+}
+
+void ringbuffer_push(ringbuffer_t *ring, const double *values, size_t count)
+{
+  size_t i;
+
+  if (count >= ring->capacity)
+    {
+      /* only the last `capacity` values remain */
+      values += count - ring->capacity;
+      count = ring->capacity;
+      ring->start = 0;
+      ring->length = 0;
+      ring->min_count = 0;
+      ring->max_count = 0;
+    }
+  for (i = 0; i < count; ++i)
+    {
+      ringbuffer_push_value(ring, values[i]);
+    }
+}
+
+void ringbuffer_range(const ringbuffer_t *ring, double *min, double *max)
+{
+  /* `DBL_MAX` and `-DBL_MAX` are returned for windows without any (non-NaN) values */
+  const double *values = ringbuffer_values(ring);
+
+  *min = (ring->min_count > 0) ? values[ringbuffer_min_deque(ring)[ring->min_head]] : DBL_MAX;
+  *max = (ring->max_count > 0) ? values[ringbuffer_max_deque(ring)[ring->max_head]] : -DBL_MAX;
+}
+
+static void ringbuffer_update_stats(const ringbuffer_t *ring, array_stats_t *stats, const double *values,
+                                    size_t count)
+{
+  /* Update the statistics of the window of `ring` for appending `values`; this must be called before the values are
+   * pushed. Only the dropped and the new values are scanned; the range may shrink, so the caller takes it from the
+   * deques after the push. */
+  const double *window = ringbuffer_values(ring) + ring->start;
+  size_t dropped, i;
+  array_stats_t new_stats;
+
+  if (count >= ring->capacity)
+    {
+      array_stats_compute(values + count - ring->capacity, ring->capacity, stats);
+      return;
+    }
+  dropped = (ring->length + count > ring->capacity) ? ring->length + count - ring->capacity : 0;
+  for (i = 0; i < dropped; ++i)
+    {
+      stats->finite_count -= (window[i] - window[i] == 0.0);
+    }
+  array_stats_compute(values, count, &new_stats);
+  /* dropping values from the front keeps a sorted window sorted */
+  array_stats_merge(stats, &new_stats, ring->length == dropped || count == 0 || window[ring->length - 1] <= values[0]);
+}
+
+ringbuffer_t *ringbuffer_of_arg(const arg_t *arg)
+{
+  /* Return the ring buffer which `arg` references or `NULL` if `arg` is an ordinary value */
+  ringbuffer_t *ring;
+  const size_t *size_t_typed_buffer;
+
+  if (arg == NULL || arg->priv->buffer == NULL || arg->priv->buffer->context != &ringbuffer_buffer_tag ||
+      strcmp(arg->value_format, "nD") != 0)
+    {
+      return NULL;
+    }
+  ring = arg->priv->buffer->data;
+  size_t_typed_buffer = arg->value_ptr;
+  if (*size_t_typed_buffer != ring->length ||
+      *(double **)(size_t_typed_buffer + 1) != ringbuffer_values(ring) + ring->start)
+    {
+      return NULL;
+    }
+
+  return ring;
+}
+
+err_t ringbuffer_append(grm_args_t *args, const char *key, size_t capacity, const double *values, size_t count)
+{
+  /* Append `count` values to the array `key` of `args`. The array is converted to a ring buffer which keeps the last
+   * `capacity` values; a `capacity` of `0` lets the buffer grow instead. A ring buffer which is not shared with other
+   * arguments or containers is updated in place, otherwise a new one is created (copy-on-write). */
+  arg_t *arg;
+  ringbuffer_t *ring = NULL, *new_ring;
+  args_buffer_t *buffer;
+  double *old_values = NULL;
+  unsigned int old_length = 0;
+  size_t *size_t_typed_buffer;
+  err_t error;
+
+  arg = args_at(args, key);
+  if (arg != NULL)
+    {
+      ring = ringbuffer_of_arg(arg);
+      if (ring != NULL)
+        {
+          old_values = ringbuffer_values(ring) + ring->start;
+          old_length = ring->length;
+        }
+      else if (!arg_first_value(arg, "D", &old_values, &old_length))
+        {
+          return ERROR_ARGS_INCREASING_NON_ARRAY_VALUE;
+        }
+    }
+  if (capacity == 0)
+    {
+      capacity = (ring != NULL) ? ring->capacity : 0;
+      if (old_length + count > capacity)
+        {
+          capacity = grm_max(grm_max(2 * capacity, old_length + count), RINGBUFFER_INITIAL_CAPACITY);
+        }
+    }
+
+  if (ring != NULL && ring->capacity == capacity && arg->priv->reference_count == 1 &&
+      arg->priv->buffer->reference_count == 1)
+    {
+      if (arg->priv->has_stats)
+        {
+          ringbuffer_update_stats(ring, &arg->priv->stats, values, count);
+        }
+      ringbuffer_push(ring, values, count);
+      size_t_typed_buffer = arg->value_ptr;
+      *size_t_typed_buffer = ring->length;
+      *(double **)(size_t_typed_buffer + 1) = ringbuffer_values(ring) + ring->start;
+      if (arg->priv->has_stats)
+        {
+          ringbuffer_range(ring, &arg->priv->stats.min, &arg->priv->stats.max);
+        }
+      args_mark_modified(args);
+      return ERROR_NONE;
+    }
+
+  new_ring = ringbuffer_new(capacity);
+  if (new_ring == NULL)
+    {
+      return ERROR_MALLOC;
+    }
+  ringbuffer_push(new_ring, old_values, old_length);
+  ringbuffer_push(new_ring, values, count);
+  buffer = args_buffer_new(new_ring, ringbuffer_memory_size(capacity), NULL, &ringbuffer_buffer_tag);
+  if (buffer == NULL)
+    {
+      ringbuffer_delete(new_ring);
+      return ERROR_MALLOC;
+    }
+  error = args_push_array_ref(args, key, 'D', new_ring->length, ringbuffer_values(new_ring) + new_ring->start, buffer);
+  args_buffer_release(buffer);
+
+  return error;
+}
@@ -0,0 +1,70 @@
+#ifndef GRM_RINGBUFFER_INT_H_INCLUDED
+#define GRM_RINGBUFFER_INT_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ######################### includes ############################################################################### */
+
+#include <stddef.h>
+
+#include <grm/args.h>
+#include "args_int.h"
+#include "error_int.h"
+
+
+/* ######################### internal interface ##################################################################### */
+
+/* ========================= macros ================================================================================= */
+
+/* ------------------------- ring buffer ---------------------------------------------------------------------------- */
+
+/* Initial capacity of ring buffers without a fixed capacity; they double their capacity when they are full */
+#define RINGBUFFER_INITIAL_CAPACITY 1024
+
+
+/* ========================= datatypes ============================================================================== */
+
+/* ------------------------- ring buffer ---------------------------------------------------------------------------- */
+
+/*
+ * A ring buffer holds the last `capacity` values of a streamed series array. Every value is stored twice (at
+ * position `i` and `i + capacity`), so the current window `[start, start + length)` is always contiguous and can be
+ * referenced by an `nD` argument without copying it. The minimum and maximum of the window are maintained
+ * incrementally with two monotonic deques of positions (NaN values are ignored).
+ *
+ * The header is followed by the `2 * capacity` values and the two deques in a single memory block which is owned by
+ * an `args_buffer_t`.
+ */
+typedef struct
+{
+  size_t capacity;
+  size_t start;
+  size_t length;
+  size_t min_head;
+  size_t min_count;
+  size_t max_head;
+  size_t max_count;
+} ringbuffer_t;
+
+
+/* ========================= methods ================================================================================ */
+
+/* ------------------------- ring buffer ---------------------------------------------------------------------------- */
+
+ringbuffer_t *ringbuffer_new(size_t capacity);
+void ringbuffer_delete(ringbuffer_t *ring);
+size_t ringbuffer_memory_size(size_t capacity);
+double *ringbuffer_values(const ringbuffer_t *ring);
+void ringbuffer_push(ringbuffer_t *ring, const double *values, size_t count);
+void ringbuffer_range(const ringbuffer_t *ring, double *min, double *max);
+
+ringbuffer_t *ringbuffer_of_arg(const arg_t *arg);
+err_t ringbuffer_append(grm_args_t *args, const char *key, size_t capacity, const double *values, size_t count);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* ifndef GRM_RINGBUFFER_INT_H_INCLUDED */
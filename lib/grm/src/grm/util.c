@@ -88,11 +88,6 @@ int is_equidistant_array(unsigned int length, const double *x)
   return 1;
 }
 
-int is_int_number(const char *str)
-{
-  return strchr(FROMJSON_VALID_DELIMITERS, str[strspn(str, "0123456789-+")]) != NULL;
-}
-
 int str_to_uint(const char *str, unsigned int *value_ptr)
 {
   char *conversion_end = NULL;
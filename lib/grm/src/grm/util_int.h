@@ -121,8 +121,9 @@ void bin_data(unsigned int num_points, double *points, unsigned int num_bins, do
 void linspace(double start, double end, unsigned int n, double *x);
 size_t djb2_hash(const char *str);
 int is_equidistant_array(unsigned int length, const double *x);
-int is_int_number(const char *str);
 int str_to_uint(const char *str, unsigned int *value_ptr);
+int str_to_double(const char *first, const char *last, double *value_ptr);
+size_t double_to_str(double value, char *buffer, size_t size);
 int int_equals_any(int number, unsigned int n, ...);
 int str_equals_any(const char *str, unsigned int n, ...);
 int str_equals_any_in_array(const char *str, const char **str_array);
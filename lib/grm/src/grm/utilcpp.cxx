@@ -1,7 +1,11 @@
 #include "utilcpp_int.hxx"
+#include "util_int.h"
 #include <cmath>
 #include <list>
 #include <algorithm>
+#if __has_include(<charconv>)
+#include <charconv>
+#endif
 
 #ifdef _WIN64
 #include <stdlib.h>
@@ -45,3 +49,49 @@ bool ends_with(const std::string &str, const std::string &suffix)
 {
   return str.size() >= suffix.size() && 0 == str.compare(str.size() - suffix.size(), suffix.size(), suffix);
 }
+
+int str_to_double(const char *first, const char *last, double *value_ptr)
+{
+  /* `std::from_chars` is locale independent and, unlike `strtod`, does not need to scan for the end of the number
+   * (recent standard libraries implement it with the Eisel-Lemire algorithm). Callers fall back to `strtod` if it is
+   * not available or the conversion fails, e.g. for out of range values which need an error message. libc++ is
+   * excluded since it marks floating point `from_chars` as unavailable for older macOS deployment targets. */
+#if defined(__cpp_lib_to_chars) && !defined(_LIBCPP_VERSION)
+  double value;
+  std::from_chars_result result = std::from_chars(first, last, value);
+
+  if (result.ec != std::errc() || result.ptr != last)
+    {
+      return 0;
+    }
+  *value_ptr = value;
+  return 1;
+#else
+  (void)first;
+  (void)last;
+  (void)value_ptr;
+  return 0;
+#endif
+}
+
+size_t double_to_str(double value, char *buffer, size_t size)
+{
+  /* Writes the shortest representation which `str_to_double` and `strtod` parse back to `value` (without a
+   * terminating '\0'), recent standard libraries use the Ryu algorithm for this. Returns the number of written
+   * characters or 0 if `std::to_chars` is not available or the buffer is too small, so callers can fall back to
+   * `printf("%.17G")`. */
+#if defined(__cpp_lib_to_chars) && !defined(_LIBCPP_VERSION)
+  std::to_chars_result result = std::to_chars(buffer, buffer + size, value);
+
+  if (result.ec != std::errc())
+    {
+      return 0;
+    }
+  return result.ptr - buffer;
+#else
+  (void)value;
+  (void)buffer;
+  (void)size;
+  return 0;
+#endif
+}
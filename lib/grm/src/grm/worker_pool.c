@@ -0,0 +1,188 @@
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+/* ######################### includes ############################################################################### */
+
+#include <stdlib.h>
+
+#if !defined(_WIN32) && !defined(NO_THREADS)
+#include <pthread.h>
+#include <unistd.h>
+#define HAVE_THREADS
+#endif
+
+#include "util_int.h"
+#include "worker_pool_int.h"
+
+
+/* ######################### internal implementation ################################################################ */
+
+/* ========================= static variables ======================================================================= */
+
+/* ------------------------- worker pool ---------------------------------------------------------------------------- */
+
+static int worker_pool_started = 0;
+static unsigned int worker_pool_threads = 1;
+
+#ifdef HAVE_THREADS
+/* All following variables are protected by `worker_pool_mutex`. A batch is running while `worker_pool_busy` is set;
+ * pool threads wait for `worker_pool_next_task < worker_pool_task_count` and the calling thread waits for
+ * `worker_pool_unfinished_count == 0`. */
+static pthread_mutex_t worker_pool_mutex = PTHREAD_MUTEX_INITIALIZER;
+static pthread_cond_t worker_pool_work_cond = PTHREAD_COND_INITIALIZER;
+static pthread_cond_t worker_pool_done_cond = PTHREAD_COND_INITIALIZER;
+static pthread_t worker_pool_thread_ids[WORKER_POOL_MAX_THREADS];
+static unsigned int worker_pool_thread_id_count = 0;
+static int worker_pool_shutdown = 0;
+static int worker_pool_busy = 0;
+static worker_pool_task_func_t worker_pool_task_func = NULL;
+static char *worker_pool_tasks = NULL;
+static size_t worker_pool_task_size = 0;
+static size_t worker_pool_task_count = 0;
+static size_t worker_pool_next_task = 0;
+static size_t worker_pool_unfinished_count = 0;
+#endif
+
+
+/* ========================= functions ============================================================================== */
+
+/* ------------------------- worker pool ---------------------------------------------------------------------------- */
+
+#ifdef HAVE_THREADS
+
+static void worker_pool_process_next_task(void)
+{
+  /* Take the next task of the running batch; `worker_pool_mutex` must be locked and is locked again on return */
+  worker_pool_task_func_t task_func = worker_pool_task_func;
+  void *task = worker_pool_tasks + worker_pool_next_task * worker_pool_task_size;
+
+  ++worker_pool_next_task;
+  pthread_mutex_unlock(&worker_pool_mutex);
+  task_func(task);
+  pthread_mutex_lock(&worker_pool_mutex);
+  if (--worker_pool_unfinished_count == 0)
+    {
+      pthread_cond_signal(&worker_pool_done_cond);
+    }
+}
+
+static void *worker_pool_worker(void *arg)
+{
+  (void)arg;
+
+  pthread_mutex_lock(&worker_pool_mutex);
+  for (;;)
+    {
+      while (!worker_pool_shutdown && worker_pool_next_task >= worker_pool_task_count)
+        {
+          pthread_cond_wait(&worker_pool_work_cond, &worker_pool_mutex);
+        }
+      if (worker_pool_shutdown)
+        {
+          break;
+        }
+      worker_pool_process_next_task();
+    }
+  pthread_mutex_unlock(&worker_pool_mutex);
+
+  return NULL;
+}
+
+#endif
+
+unsigned int worker_pool_thread_count(void)
+{
+  /* Number of threads (including the calling one) which run the tasks of a batch */
+  if (!worker_pool_started)
+    {
+      unsigned int thread_count = 1;
+#ifdef HAVE_THREADS
+      long processor_count;
+
+      if (getenv(WORKER_POOL_THREADS_ENV_KEY) == NULL ||
+          !str_to_uint(getenv(WORKER_POOL_THREADS_ENV_KEY), &thread_count))
+        {
+          processor_count = sysconf(_SC_NPROCESSORS_ONLN);
+          thread_count = (processor_count > 0) ? (unsigned int)processor_count : 1;
+        }
+      thread_count = grm_max(1, grm_min(thread_count, WORKER_POOL_MAX_THREADS));
+      /* if a thread cannot be created, its share of the work is done by the other ones */
+      pthread_mutex_lock(&worker_pool_mutex);
+      while (worker_pool_thread_id_count + 1 < thread_count &&
+             pthread_create(worker_pool_thread_ids + worker_pool_thread_id_count, NULL, worker_pool_worker, NULL) ==
+                 0)
+        {
+          ++worker_pool_thread_id_count;
+        }
+      pthread_mutex_unlock(&worker_pool_mutex);
+      thread_count = worker_pool_thread_id_count + 1;
+#endif
+      worker_pool_threads = thread_count;
+      worker_pool_started = 1;
+    }
+
+  return worker_pool_threads;
+}
+
+void worker_pool_run(worker_pool_task_func_t task_func, void *tasks, size_t task_count, size_t task_size)
+{
+  size_t i;
+
+#ifdef HAVE_THREADS
+  if (task_count > 1 && worker_pool_thread_count() > 1)
+    {
+      pthread_mutex_lock(&worker_pool_mutex);
+      if (!worker_pool_busy)
+        {
+          worker_pool_busy = 1;
+          worker_pool_task_func = task_func;
+          worker_pool_tasks = (char *)tasks;
+          worker_pool_task_size = task_size;
+          worker_pool_task_count = task_count;
+          worker_pool_next_task = 0;
+          worker_pool_unfinished_count = task_count;
+          pthread_cond_broadcast(&worker_pool_work_cond);
+          while (worker_pool_next_task < worker_pool_task_count)
+            {
+              worker_pool_process_next_task();
+            }
+          while (worker_pool_unfinished_count > 0)
+            {
+              pthread_cond_wait(&worker_pool_done_cond, &worker_pool_mutex);
+            }
+          worker_pool_task_count = 0;
+          worker_pool_next_task = 0;
+          worker_pool_busy = 0;
+          pthread_mutex_unlock(&worker_pool_mutex);
+          return;
+        }
+      /* a task started a batch itself, so all threads are already in use */
+      pthread_mutex_unlock(&worker_pool_mutex);
+    }
+#endif
+  for (i = 0; i < task_count; ++i)
+    {
+      task_func((char *)tasks + i * task_size);
+    }
+}
+
+void worker_pool_finalize(void)
+{
+#ifdef HAVE_THREADS
+  unsigned int i;
+
+  pthread_mutex_lock(&worker_pool_mutex);
+  worker_pool_shutdown = 1;
+  pthread_cond_broadcast(&worker_pool_work_cond);
+  pthread_mutex_unlock(&worker_pool_mutex);
+  for (i = 0; i < worker_pool_thread_id_count; ++i)
+    {
+      pthread_join(worker_pool_thread_ids[i], NULL);
+    }
+  worker_pool_thread_id_count = 0;
+  worker_pool_shutdown = 0;
+#endif
+  worker_pool_threads = 1;
+  worker_pool_started = 0;
+}
@@ -0,0 +1,50 @@
+#ifndef GRM_WORKER_POOL_INT_H_INCLUDED
+#define GRM_WORKER_POOL_INT_H_INCLUDED
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* ######################### includes ############################################################################### */
+
+#include <stddef.h>
+
+
+/* ######################### internal interface ##################################################################### */
+
+/* ========================= macros ================================================================================= */
+
+/* ------------------------- worker pool ---------------------------------------------------------------------------- */
+
+/* The calling thread and at most `WORKER_POOL_MAX_THREADS - 1` pool threads work on a batch of tasks */
+#define WORKER_POOL_MAX_THREADS 8
+/* Number of threads (including the calling one); the default is the number of online processors */
+#define WORKER_POOL_THREADS_ENV_KEY "GRM_THREADS"
+
+
+/* ========================= datatypes ============================================================================== */
+
+/* ------------------------- worker pool ---------------------------------------------------------------------------- */
+
+typedef void (*worker_pool_task_func_t)(void *task);
+
+
+/* ========================= methods ================================================================================ */
+
+/* ------------------------- worker pool ---------------------------------------------------------------------------- */
+
+/*
+ * Run `task_func` on each of the `task_count` tasks in the array `tasks` (with elements of `task_size` bytes) and
+ * return when all of them are finished. Tasks are run concurrently and in no particular order, so they must not touch
+ * shared state like args containers or GR. The pool threads are started by the first call; calls from within a task
+ * run the nested tasks on the current thread.
+ */
+void worker_pool_run(worker_pool_task_func_t task_func, void *tasks, size_t task_count, size_t task_size);
+unsigned int worker_pool_thread_count(void);
+void worker_pool_finalize(void);
+
+
+#ifdef __cplusplus
+}
+#endif
+#endif /* ifndef GRM_WORKER_POOL_INT_H_INCLUDED */
@@ -0,0 +1,100 @@
+/*
+ * Keyword lookup benchmark for the GRM argument container.
+ *
+ * A figure with a grid of line plot subplots is plotted repeatedly on the dummy workstation, so the measured time is
+ * dominated by argument handling (merging defaults into the plot hierarchy and looking up keywords) instead of
+ * rendering. Afterwards, lookups of existing and missing keys are timed on a container holding the keys of a subplot
+ * after `grm_plot` merged in its defaults.
+ *
+ *   args_lookup [grid_size [frames [lookups]]]
+ */
+
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "grm.h"
+
+#define POINTS 100
+
+#define ARRAY_SIZE(a) (sizeof(a) / sizeof((a)[0]))
+
+static const char *subplot_keys[] = {
+    "kind",     "subplot",  "xlog",     "ylog",     "zlog",        "xflip",       "yflip",       "zflip",
+    "xgrid",    "ygrid",    "zgrid",    "colormap", "adjust_xlim", "adjust_ylim", "adjust_zlim", "resample_method",
+    "font",     "rotation", "tilt",     "series",   "xlim",        "ylim",        "window",      "font_precision",
+    "viewport", "vp",       "panzoom",  "location", "grplot",      "backgroundcolor"};
+static const char *lookup_keys[] = {"kind",  "series", "xlim",   "ylim", "xlog",     "ylog",     "window",
+                                    "title", "xlabel", "ylabel", "zlim", "colormap", "viewport", "grid_element"};
+
+int main(int argc, char *argv[])
+{
+  int grid_size = 4, frames = 200, lookups = 1000000, subplot_count, i, j, found = 0, value;
+  grm_args_t *args, *subplot, **subplots;
+  double x[POINTS], y[POINTS], seconds;
+  clock_t start;
+
+  if (argc > 1) grid_size = atoi(argv[1]);
+  if (argc > 2) frames = atoi(argv[2]);
+  if (argc > 3) lookups = atoi(argv[3]);
+
+  setenv("GKS_WSTYPE", "100", 1);
+
+  for (i = 0; i < POINTS; i++)
+    {
+      x[i] = (double)i / POINTS;
+      y[i] = sin(i * 0.1);
+    }
+
+  subplot_count = grid_size * grid_size;
+  subplots = (grm_args_t **)malloc(subplot_count * sizeof(grm_args_t *));
+  for (i = 0; i < subplot_count; i++)
+    {
+      subplots[i] = grm_args_new();
+      grm_args_push(subplots[i], "x", "nD", POINTS, x);
+      grm_args_push(subplots[i], "y", "nD", POINTS, y);
+      grm_args_push(subplots[i], "subplot", "dddd", (double)(i % grid_size) / grid_size,
+                    (double)(i % grid_size + 1) / grid_size, (double)(i / grid_size) / grid_size,
+                    (double)(i / grid_size + 1) / grid_size);
+    }
+  args = grm_args_new();
+  grm_args_push(args, "subplots", "nA", subplot_count, subplots);
+  free(subplots);
+
+  start = clock();
+  for (i = 0; i < frames; i++)
+    {
+      grm_plot(args);
+    }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("grm_plot %d subplots: %d frames in %.3f s, %.3f ms/frame\n", subplot_count, frames, seconds,
+         seconds / frames * 1e3);
+
+  subplot = grm_args_new();
+  for (i = 0; i < (int)ARRAY_SIZE(subplot_keys); i++)
+    {
+      grm_args_push(subplot, subplot_keys[i], "i", i);
+    }
+  start = clock();
+  for (i = 0; i < lookups; i++)
+    {
+      for (j = 0; j < (int)ARRAY_SIZE(lookup_keys); j++)
+        {
+          found += grm_args_values(subplot, lookup_keys[j], "i", &value);
+        }
+    }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("lookups in %d keys: %d in %.3f s, %.1f ns/lookup (%d hits)\n", (int)ARRAY_SIZE(subplot_keys),
+         lookups * (int)ARRAY_SIZE(lookup_keys), seconds, seconds / lookups / ARRAY_SIZE(lookup_keys) * 1e9, found);
+  grm_args_delete(subplot);
+
+  grm_args_delete(args);
+  grm_finalize();
+
+  return 0;
+}
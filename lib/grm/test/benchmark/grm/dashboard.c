@@ -0,0 +1,110 @@
+/*
+ * Partial re-render benchmark for dashboards.
+ *
+ * A figure with `rows` x `columns` line plot subplots is plotted on the dummy workstation. The first run merges new
+ * data into every subplot (selected with `subplot_id`) on each frame, so everything has to be rendered again. The
+ * second one updates a single subplot per frame; the output of the unchanged subplots is replayed from GKS segments.
+ *
+ *   dashboard [rows [columns [frames [points]]]]
+ */
+
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "grm.h"
+
+static void fill(double *y, int points, int phase)
+{
+  int i;
+
+  for (i = 0; i < points; i++)
+    {
+      y[i] = sin(i * 0.01 + phase * 0.1);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+  int rows = 3, columns = 4, frames = 200, points = 1000, subplot_count, i, j;
+  grm_args_t *args, *update_args, **subplots;
+  double *x, *y, seconds;
+  clock_t start;
+
+  if (argc > 1) rows = atoi(argv[1]);
+  if (argc > 2) columns = atoi(argv[2]);
+  if (argc > 3) frames = atoi(argv[3]);
+  if (argc > 4) points = atoi(argv[4]);
+
+  setenv("GKS_WSTYPE", "100", 1);
+
+  x = (double *)malloc(points * sizeof(double));
+  y = (double *)malloc(points * sizeof(double));
+  for (i = 0; i < points; i++)
+    {
+      x[i] = (double)i / points;
+    }
+  fill(y, points, 0);
+
+  subplot_count = rows * columns;
+  subplots = (grm_args_t **)malloc(subplot_count * sizeof(grm_args_t *));
+  for (i = 0; i < subplot_count; i++)
+    {
+      subplots[i] = grm_args_new();
+      grm_args_push(subplots[i], "x", "nD", points, x);
+      grm_args_push(subplots[i], "y", "nD", points, y);
+      grm_args_push(subplots[i], "title", "s", "subplot");
+      grm_args_push(subplots[i], "subplot", "dddd", (double)(i % columns) / columns, (double)(i % columns + 1) / columns,
+                    (double)(i / columns) / rows, (double)(i / columns + 1) / rows);
+    }
+  args = grm_args_new();
+  grm_args_push(args, "subplots", "nA", subplot_count, subplots);
+  free(subplots);
+
+  grm_plot(args);
+  update_args = grm_args_new();
+
+  /* every subplot changes */
+  start = clock();
+  for (i = 0; i < frames; i++)
+    {
+      fill(y, points, i);
+      for (j = 0; j < subplot_count; j++)
+        {
+          grm_args_push(update_args, "subplot_id", "i", j + 1);
+          grm_args_push(update_args, "y", "nD", points, y);
+          grm_merge_hold(update_args);
+        }
+      grm_plot(NULL);
+    }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("update %d of %d subplots: %d frames in %.3f s, %.3f ms/frame\n", subplot_count, subplot_count, frames,
+         seconds, seconds / frames * 1e3);
+
+  /* one subplot changes */
+  start = clock();
+  for (i = 0; i < frames; i++)
+    {
+      fill(y, points, i);
+      grm_args_push(update_args, "subplot_id", "i", i % subplot_count + 1);
+      grm_args_push(update_args, "y", "nD", points, y);
+      grm_merge_hold(update_args);
+      grm_plot(NULL);
+    }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("update 1 of %d subplots: %d frames in %.3f s, %.3f ms/frame\n", subplot_count, frames, seconds,
+         seconds / frames * 1e3);
+  grm_args_delete(update_args);
+
+  grm_args_delete(args);
+  free(x);
+  free(y);
+  grm_finalize();
+
+  return 0;
+}
@@ -0,0 +1,148 @@
+/*
+ * Latency and throughput benchmark for the GRM network transport.
+ *
+ * A receiver process is forked which is connected to the benchmark process in both directions over the loopback
+ * interface. The latency is measured with small messages which are echoed by the receiver (half of the round trip
+ * time is reported). The throughput is measured with messages containing two double arrays; the receiver only
+ * acknowledges the last one. Both measurements are done with the binary format and with JSON only
+ * (`GRM_NET_BINARY=0`).
+ *
+ *   net_loopback [points [messages [round_trips]]]
+ */
+
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+
+#include <sys/time.h>
+#include <sys/wait.h>
+#include <unistd.h>
+
+#include "grm.h"
+
+#define PORT 8420
+
+static double now(void)
+{
+  struct timeval tv;
+
+  gettimeofday(&tv, NULL);
+  return tv.tv_sec + tv.tv_usec * 1e-6;
+}
+
+static void echo(unsigned int port, int round_trips, int messages)
+{
+  void *receiver, *sender;
+  grm_args_t *args;
+  int i;
+
+  receiver = grm_open(GRM_RECEIVER, "localhost", port, NULL, NULL);
+  sender = grm_open(GRM_SENDER, "localhost", port + 1, NULL, NULL);
+  if (receiver == NULL || sender == NULL)
+    {
+      exit(1);
+    }
+  for (i = 0; i < round_trips + messages; i++)
+    {
+      if ((args = grm_recv(receiver, NULL)) == NULL)
+        {
+          exit(1);
+        }
+      if (i < round_trips || i == round_trips + messages - 1)
+        {
+          grm_send_args(sender, args);
+        }
+      grm_args_delete(args);
+    }
+  grm_close(sender);
+  grm_close(receiver);
+}
+
+static void run(const char *format, unsigned int port, int n, int messages, int round_trips, double *x, double *y)
+{
+  void *receiver, *sender;
+  grm_args_t *args, *reply;
+  double start, latency, throughput;
+  int i;
+  pid_t pid;
+
+  fflush(stdout);
+  if ((pid = fork()) == 0)
+    {
+      echo(port, round_trips, messages);
+      exit(0);
+    }
+  sender = grm_open(GRM_SENDER, "localhost", port, NULL, NULL);
+  receiver = grm_open(GRM_RECEIVER, "localhost", port + 1, NULL, NULL);
+  if (receiver == NULL || sender == NULL)
+    {
+      fprintf(stderr, "could not connect to the receiver process\n");
+      exit(1);
+    }
+
+  args = grm_args_new();
+  grm_args_push(args, "kind", "s", "line");
+  start = now();
+  for (i = 0; i < round_trips; i++)
+    {
+      grm_args_push(args, "id", "i", i);
+      grm_send_args(sender, args);
+      reply = grm_recv(receiver, NULL);
+      grm_args_delete(reply);
+    }
+  latency = (now() - start) / round_trips / 2;
+  grm_args_delete(args);
+
+  args = grm_args_new();
+  grm_args_push(args, "kind", "s", "line");
+  grm_args_push(args, "x", "nD", n, x);
+  grm_args_push(args, "y", "nD", n, y);
+  start = now();
+  for (i = 0; i < messages; i++)
+    {
+      grm_send_args(sender, args);
+    }
+  reply = grm_recv(receiver, NULL);
+  throughput = now() - start;
+  grm_args_delete(reply);
+  grm_args_delete(args);
+
+  grm_close(sender);
+  grm_close(receiver);
+  waitpid(pid, NULL, 0);
+
+  printf("%-6s latency %.1f us/message, %d messages of 2 x %d doubles: %.3f s, %.1f messages/s, %.1f MiB/s\n", format,
+         latency * 1e6, messages, n, throughput, messages / throughput,
+         2.0 * n * sizeof(double) * messages / throughput / (1024 * 1024));
+}
+
+int main(int argc, char *argv[])
+{
+  int n = 1000000, messages = 10, round_trips = 2000, i;
+  double *x, *y;
+
+  if (argc > 1) n = atoi(argv[1]);
+  if (argc > 2) messages = atoi(argv[2]);
+  if (argc > 3) round_trips = atoi(argv[3]);
+
+  x = (double *)malloc(n * sizeof(double));
+  y = (double *)malloc(n * sizeof(double));
+  for (i = 0; i < n; i++)
+    {
+      x[i] = (double)i / n;
+      y[i] = sin(i * 0.001);
+    }
+
+  run("binary", PORT, n, messages, round_trips, x, y);
+  setenv("GRM_NET_BINARY", "0", 1);
+  run("json", PORT + 2, n, messages, round_trips, x, y);
+
+  free(x);
+  free(y);
+
+  return 0;
+}
@@ -0,0 +1,83 @@
+/*
+ * Pan/zoom benchmark for large line plots.
+ *
+ * A line plot with `points` sorted points is plotted on the dummy workstation. The first run zooms in step by step
+ * with `grm_input` until `1 / zoom` of the range is visible, the second one pans this view by a few pixels on every
+ * frame, like an interactive viewer does.
+ *
+ *   panzoom [points [frames [zoom]]]
+ */
+
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "grm.h"
+
+int main(int argc, char *argv[])
+{
+  int points = 1000000, frames = 100, zoom = 100, i;
+  grm_args_t *args, *input_args;
+  double *x, *y, seconds;
+  clock_t start;
+
+  if (argc > 1) points = atoi(argv[1]);
+  if (argc > 2) frames = atoi(argv[2]);
+  if (argc > 3) zoom = atoi(argv[3]);
+
+  setenv("GKS_WSTYPE", "100", 1);
+
+  x = (double *)malloc(points * sizeof(double));
+  y = (double *)malloc(points * sizeof(double));
+  for (i = 0; i < points; i++)
+    {
+      x[i] = i * 1e-3;
+      y[i] = sin(i * 1e-3) + 0.1 * sin(i * 0.37);
+    }
+
+  args = grm_args_new();
+  grm_args_push(args, "x", "nD", points, x);
+  grm_args_push(args, "y", "nD", points, y);
+  grm_args_push(args, "size", "dd", 600.0, 450.0);
+  grm_plot(args);
+
+  input_args = grm_args_new();
+  grm_args_push(input_args, "x", "i", 300);
+  grm_args_push(input_args, "y", "i", 225);
+  grm_args_push(input_args, "factor", "d", pow(1.0 / zoom, 1.0 / frames));
+  start = clock();
+  for (i = 0; i < frames; i++)
+    {
+      grm_input(input_args);
+      grm_plot(NULL);
+    }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("zoom in to 1/%d of %d points: %d frames in %.3f s, %.3f ms/frame\n", zoom, points, frames, seconds,
+         seconds / frames * 1e3);
+
+  grm_args_remove(input_args, "factor");
+  start = clock();
+  for (i = 0; i < frames; i++)
+    {
+      grm_args_push(input_args, "xshift", "i", (i % 20 < 10) ? 5 : -5);
+      grm_args_push(input_args, "yshift", "i", 0);
+      grm_input(input_args);
+      grm_plot(NULL);
+    }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("pan 1/%d of %d points: %d frames in %.3f s, %.3f ms/frame\n", zoom, points, frames, seconds,
+         seconds / frames * 1e3);
+
+  grm_args_delete(input_args);
+  grm_args_delete(args);
+  free(x);
+  free(y);
+  grm_finalize();
+
+  return 0;
+}
@@ -0,0 +1,140 @@
+/*
+ * Benchmark for figures with many subplots which need a lot of data preparation.
+ *
+ * A 4x4 grid of histograms (two series with `points` values each), marginal heatmaps (`points` values) and polar
+ * histograms with a colormap (`points / 100` angles, most of the time is spent on the colormap image) is plotted on
+ * the dummy workstation. Before every frame, all subplots are modified, so none of them can be copied from the
+ * subplot cache. The wall time is measured because the preparation runs on several threads; compare with
+ * `GRM_THREADS=1` to get the serial time.
+ *
+ *   parallel_prepare [points [frames]]
+ */
+
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "grm.h"
+
+#ifndef M_PI
+#define M_PI 3.14159265358979323846
+#endif
+
+#define ROWS 4
+#define COLUMNS 4
+
+
+static double wall_time(void)
+{
+  struct timespec now;
+
+  clock_gettime(CLOCK_MONOTONIC, &now);
+  return now.tv_sec + now.tv_nsec * 1e-9;
+}
+
+int main(int argc, char *argv[])
+{
+  int points = 1000000, frames = 10, grid, i, j;
+  grm_args_t *args, *subplots[ROWS * COLUMNS], *series[2], *update_args;
+  double *x1, *x2, *theta, *grid_x, *grid_y, *z, seconds;
+  const char *threads;
+
+  if (argc > 1) points = atoi(argv[1]);
+  if (argc > 2) frames = atoi(argv[2]);
+
+  setenv("GKS_WSTYPE", "100", 1);
+
+  grid = (int)sqrt(points);
+  x1 = (double *)malloc(points * sizeof(double));
+  x2 = (double *)malloc(points * sizeof(double));
+  theta = (double *)malloc(points * sizeof(double));
+  grid_x = (double *)malloc(grid * sizeof(double));
+  grid_y = (double *)malloc(grid * sizeof(double));
+  z = (double *)malloc(grid * grid * sizeof(double));
+  srand(42);
+  for (i = 0; i < points; i++)
+    {
+      x1[i] = sin(i * 1e-3) + (double)rand() / RAND_MAX;
+      x2[i] = cos(i * 1e-3) * (double)rand() / RAND_MAX;
+      theta[i] = 2 * M_PI * (double)rand() / RAND_MAX * (double)rand() / RAND_MAX;
+    }
+  for (i = 0; i < grid; i++)
+    {
+      grid_x[i] = grid_y[i] = (double)i / grid;
+      for (j = 0; j < grid; j++)
+        {
+          z[i * grid + j] = sin(i * 0.01) * cos(j * 0.02);
+        }
+    }
+
+  for (i = 0; i < ROWS * COLUMNS; i++)
+    {
+      subplots[i] = grm_args_new();
+      grm_args_push(subplots[i], "subplot", "dddd", (double)(i % COLUMNS) / COLUMNS,
+                    (double)(i % COLUMNS + 1) / COLUMNS, (double)(i / COLUMNS) / ROWS,
+                    (double)(i / COLUMNS + 1) / ROWS);
+      if (i < 2 * COLUMNS)
+        {
+          grm_args_push(subplots[i], "kind", "s", "hist");
+          series[0] = grm_args_new();
+          grm_args_push(series[0], "x", "nD", points, x1);
+          series[1] = grm_args_new();
+          grm_args_push(series[1], "x", "nD", points, x2);
+          grm_args_push(subplots[i], "series", "nA", 2, series);
+        }
+      else if (i < 3 * COLUMNS)
+        {
+          grm_args_push(subplots[i], "kind", "s", "marginalheatmap");
+          grm_args_push(subplots[i], "marginalheatmap_kind", "s", "all");
+          grm_args_push(subplots[i], "algorithm", "s", (i % 2 == 0) ? "sum" : "max");
+          grm_args_push(subplots[i], "x", "nD", grid, grid_x);
+          grm_args_push(subplots[i], "y", "nD", grid, grid_y);
+          grm_args_push(subplots[i], "z", "nD", grid * grid, z);
+        }
+      else
+        {
+          grm_args_push(subplots[i], "kind", "s", "polar_histogram");
+          grm_args_push(subplots[i], "x", "nD", points / 100, theta);
+          grm_args_push(subplots[i], "xcolormap", "i", 44);
+          grm_args_push(subplots[i], "ycolormap", "i", 44);
+        }
+    }
+  args = grm_args_new();
+  grm_args_push(args, "subplots", "nA", ROWS * COLUMNS, subplots);
+  grm_args_push(args, "size", "dd", 1200.0, 1200.0);
+  grm_plot(args);
+
+  update_args = grm_args_new();
+  seconds = wall_time();
+  for (i = 0; i < frames; i++)
+    {
+      for (j = 0; j < ROWS * COLUMNS; j++)
+        {
+          grm_args_push(update_args, "subplot_id", "i", j + 1);
+          grm_args_push(update_args, "title", "s", (i % 2 == 0) ? "even frame" : "odd frame");
+          grm_merge_hold(update_args);
+        }
+      grm_plot(NULL);
+    }
+  seconds = wall_time() - seconds;
+  threads = getenv("GRM_THREADS");
+  printf("%d subplots with %d points, GRM_THREADS=%s: %d frames in %.3f s, %.3f ms/frame\n", ROWS * COLUMNS, points,
+         (threads != NULL) ? threads : "(all processors)", frames, seconds, seconds / frames * 1e3);
+
+  grm_args_delete(update_args);
+  grm_args_delete(args);
+  free(x1);
+  free(x2);
+  free(theta);
+  free(grid_x);
+  free(grid_y);
+  free(z);
+  grm_finalize();
+
+  return 0;
+}
@@ -0,0 +1,102 @@
+/*
+ * Streaming benchmark for ring buffer series.
+ *
+ * A line plot with a window of `capacity` points is updated with `chunk` new points per frame on the dummy
+ * workstation. The first run resends the whole window with `grm_plot` on every frame (the way live plots were
+ * updated before), the second one appends the new points with `grm_append` to a ring buffer series and redraws with
+ * `grm_plot(NULL)`. Finally, the cost of `grm_append` alone is measured.
+ *
+ *   stream_append [capacity [frames [chunk]]]
+ */
+
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <time.h>
+
+#include "grm.h"
+
+static void fill(double *x, double *y, int first, int count)
+{
+  int i;
+
+  for (i = 0; i < count; i++)
+    {
+      x[i] = (first + i) * 1e-3;
+      y[i] = sin((first + i) * 1e-2);
+    }
+}
+
+int main(int argc, char *argv[])
+{
+  int capacity = 10000, frames = 1000, chunk = 1, i, appends;
+  double *x, *y, seconds;
+  grm_args_t *args;
+  clock_t start;
+
+  if (argc > 1) capacity = atoi(argv[1]);
+  if (argc > 2) frames = atoi(argv[2]);
+  if (argc > 3) chunk = atoi(argv[3]);
+
+  setenv("GKS_WSTYPE", "100", 1);
+
+  x = (double *)malloc((capacity + frames * chunk) * sizeof(double));
+  y = (double *)malloc((capacity + frames * chunk) * sizeof(double));
+  fill(x, y, 0, capacity + frames * chunk);
+
+  /* resend the whole window */
+  args = grm_args_new();
+  start = clock();
+  for (i = 0; i < frames; i++)
+    {
+      grm_args_push(args, "x", "nD", capacity, x + i * chunk);
+      grm_args_push(args, "y", "nD", capacity, y + i * chunk);
+      grm_plot(args);
+    }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("resend %d points: %d frames in %.3f s, %.3f ms/frame\n", capacity, frames, seconds, seconds / frames * 1e3);
+  grm_args_delete(args);
+
+  /* append to a ring buffer */
+  args = grm_args_new();
+  grm_args_push(args, "x", "nD", capacity, x);
+  grm_args_push(args, "y", "nD", capacity, y);
+  grm_args_push(args, "ring_capacity", "i", capacity);
+  grm_plot(args);
+  grm_args_delete(args);
+  args = grm_args_new();
+  grm_args_push(args, "append", "i", 1);
+  start = clock();
+  for (i = 0; i < frames; i++)
+    {
+      grm_args_push(args, "x", "nD", chunk, x + capacity + i * chunk);
+      grm_args_push(args, "y", "nD", chunk, y + capacity + i * chunk);
+      grm_append(args);
+      grm_plot(NULL);
+    }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("append %d of %d points: %d frames in %.3f s, %.3f ms/frame\n", chunk, capacity, frames, seconds,
+         seconds / frames * 1e3);
+
+  appends = frames * 100;
+  start = clock();
+  for (i = 0; i < appends; i++)
+    {
+      grm_args_push(args, "x", "nD", chunk, x + i % frames * chunk);
+      grm_args_push(args, "y", "nD", chunk, y + i % frames * chunk);
+      grm_append(args);
+    }
+  seconds = (double)(clock() - start) / CLOCKS_PER_SEC;
+  printf("grm_append %d points: %d calls in %.3f s, %.3f us/call\n", chunk, appends, seconds, seconds / appends * 1e6);
+  grm_args_delete(args);
+
+  free(x);
+  free(y);
+  grm_finalize();
+
+  return 0;
+}
@@ -0,0 +1,98 @@
+#ifdef __unix__
+#define _POSIX_C_SOURCE 1
+#endif
+
+#include <string.h>
+
+#include "test.h"
+
+#include <grm/args_int.h>
+
+
+static int release_count = 0;
+
+static void release(void *data, void *context)
+{
+  assert(context == &release_count);
+  ++release_count;
+  free(data);
+}
+
+void test(void)
+{
+  const int length = 4;
+  double *data, *double_ptr;
+  grm_args_t *args, *args_copy_, *parent_args, *nested_args;
+  arg_t *arg;
+  unsigned int array_length;
+  args_memory_usage_t usage;
+  int i;
+
+  data = malloc(length * sizeof(double));
+  for (i = 0; i < length; ++i)
+    {
+      data[i] = i;
+    }
+
+  args = grm_args_new();
+  assert(grm_args_push_ref(args, "x", "nD", length, data, release, &release_count));
+  assert(!grm_args_push_ref(args, "s", "nS", length, data, release, &release_count));
+
+  /* the data is referenced, not copied */
+  assert(grm_args_first_value(args, "x", "D", &double_ptr, &array_length));
+  assert(double_ptr == data);
+  assert(array_length == (unsigned int)length);
+
+  /* copies share the data */
+  args_copy_ = args_copy(args);
+  assert(grm_args_first_value(args_copy_, "x", "D", &double_ptr, NULL));
+  assert(double_ptr == data);
+
+  memset(&usage, 0, sizeof(usage));
+  args_memory_usage(args, &usage);
+  assert(usage.container_count == 1);
+  assert(usage.array_count == 1);
+  assert(usage.array_bytes == length * sizeof(double));
+  assert(usage.shared_bytes == length * sizeof(double));
+  assert(usage.caller_owned_bytes == length * sizeof(double));
+
+  /* statistics of caller-owned arrays are not cached, the caller may modify the data in place */
+  assert(arg_array_stats(args_at(args, "x"))->max == length - 1);
+  assert(!args_at(args, "x")->priv->has_stats);
+  data[0] = length;
+  assert(arg_array_stats(args_at(args, "x"))->max == length);
+  data[0] = 0;
+
+  /* containers holding caller-owned arrays (also in nested containers) are not cached by `grm_plot` */
+  assert(args_has_caller_owned_arrays(args));
+  parent_args = grm_args_new();
+  nested_args = grm_args_new();
+  grm_args_push(parent_args, "series", "a", nested_args);
+  assert(!args_has_caller_owned_arrays(parent_args));
+  assert(grm_args_push_ref(nested_args, "y", "nD", length, data, NULL, NULL));
+  assert(args_has_caller_owned_arrays(parent_args));
+  grm_args_delete(parent_args);
+
+  /* the caller-owned memory is released when the last container referencing it is deleted */
+  grm_args_delete(args);
+  assert(release_count == 0);
+
+  /* copy-on-write: growing the array needs a private copy, which releases the shared buffer */
+  arg = args_at(args_copy_, "x");
+  assert(arg != NULL && arg->priv->buffer != NULL);
+  assert(arg_increase_array(arg, 2) == ERROR_NONE);
+  assert(arg->priv->buffer == NULL);
+  assert(release_count == 1);
+  assert(!args_has_caller_owned_arrays(args_copy_));
+  assert(grm_args_first_value(args_copy_, "x", "D", &double_ptr, &array_length));
+  assert(array_length == (unsigned int)length + 2);
+  for (i = 0; i < length; ++i)
+    {
+      assert(double_ptr[i] == i);
+    }
+
+  grm_args_delete(args_copy_);
+  assert(release_count == 1);
+}
+
+DEFINE_TEST_MAIN
@@ -0,0 +1,165 @@
+#ifdef __unix__
+#define _POSIX_C_SOURCE 1
+#endif
+
+#include <float.h>
+#include <stdlib.h>
+
+#include "test.h"
+
+#include <grm/args_int.h>
+#include <grm/array_stats_int.h>
+#include <grm/ringbuffer_int.h>
+#include <grm/worker_pool_int.h>
+
+
+#define CAPACITY 16
+#define CHUNK 5
+
+
+static void expected_stats(const double *values, size_t length, array_stats_t *stats)
+{
+  size_t i;
+
+  stats->min = DBL_MAX;
+  stats->max = -DBL_MAX;
+  stats->finite_count = 0;
+  stats->sorted = 1;
+  for (i = 0; i < length; ++i)
+    {
+      if (values[i] == values[i])
+        {
+          stats->min = (values[i] < stats->min) ? values[i] : stats->min;
+          stats->max = (values[i] > stats->max) ? values[i] : stats->max;
+          stats->finite_count += (values[i] - values[i] == 0.0);
+        }
+      else
+        {
+          stats->sorted = 0;
+        }
+      if (i > 0 && values[i - 1] > values[i])
+        {
+          stats->sorted = 0;
+        }
+    }
+}
+
+static void assert_stats(const array_stats_t *stats, const double *values, size_t length)
+{
+  array_stats_t expected;
+
+  expected_stats(values, length, &expected);
+  assert(stats->min == expected.min && stats->max == expected.max);
+  assert(stats->finite_count == expected.finite_count);
+  assert(!stats->sorted == !expected.sorted);
+}
+
+static void assert_computed_stats(const double *values, size_t length)
+{
+  array_stats_t stats;
+
+  array_stats_compute(values, length, &stats);
+  assert_stats(&stats, values, length);
+}
+
+void test(void)
+{
+  double values[64], stream[40 * CHUNK], zero = 0.0, nan_value, inf_value, *large, *window;
+  size_t large_length = ARRAY_STATS_PARALLEL_MIN + 3, length, i;
+  const array_stats_t *stats;
+  unsigned int window_length;
+  grm_args_t *args;
+  int parts;
+
+  nan_value = zero / zero;
+  inf_value = 1.0 / zero;
+
+  /* small arrays of all lengths (to cover the vectorized loop and the remainder) */
+  srand(42);
+  for (i = 0; i < 64; ++i)
+    {
+      values[i] = (double)(rand() % 100) - 50.0;
+    }
+  for (length = 0; length <= 64; ++length)
+    {
+      assert_computed_stats(values, length);
+    }
+  for (i = 0; i < 64; ++i)
+    {
+      values[i] = (double)i;
+    }
+  for (length = 0; length <= 64; ++length)
+    {
+      assert_computed_stats(values, length);
+    }
+  values[63] = inf_value;
+  assert_computed_stats(values, 64);
+  values[0] = -inf_value;
+  assert_computed_stats(values, 64);
+  for (i = 0; i < 4; ++i)
+    {
+      values[i * 20 + 1] = nan_value;
+      assert_computed_stats(values, 64);
+    }
+  values[0] = nan_value;
+  assert_computed_stats(values, 1);
+  assert_computed_stats(values, 2);
+
+  /* large arrays are split into one chunk per pool thread; a descent or NaN at any chunk border must be detected */
+  large = malloc(large_length * sizeof(double));
+  assert(large != NULL);
+  for (i = 0; i < large_length; ++i)
+    {
+      large[i] = (double)i;
+    }
+  assert_computed_stats(large, large_length);
+  for (parts = 2; parts <= WORKER_POOL_MAX_THREADS; ++parts)
+    {
+      i = large_length / parts;
+      large[i] = -1.0;
+      assert_computed_stats(large, large_length);
+      large[i] = nan_value;
+      assert_computed_stats(large, large_length);
+      large[i] = (double)i;
+      large[i - 1] = (double)i + 1.0;
+      assert_computed_stats(large, large_length);
+      large[i - 1] = (double)(i - 1);
+    }
+  free(large);
+
+  /* statistics are cached per argument and reset by modifications */
+  args = grm_args_new();
+  grm_args_push(args, "x", "nD", 64, values);
+  stats = arg_array_stats(args_at(args, "x"));
+  assert(stats != NULL && args_at(args, "x")->priv->has_stats);
+  assert_stats(stats, values, 64);
+  assert(arg_array_stats(args_at(args, "x")) == stats);
+  assert(arg_increase_array(args_at(args, "x"), 1) == ERROR_NONE);
+  assert(!args_at(args, "x")->priv->has_stats);
+  grm_args_push(args, "x", "nD", 10, values + 2);
+  assert_stats(arg_array_stats(args_at(args, "x")), values + 2, 10);
+  grm_args_push(args, "n", "i", 1);
+  assert(arg_array_stats(args_at(args, "n")) == NULL);
+
+  /* ring buffers update cached statistics incrementally (the window is sorted first and unsorted later) */
+  for (i = 0; i < 40 * CHUNK; ++i)
+    {
+      stream[i] = (i < 20 * CHUNK) ? (double)i : (i % 23 == 0) ? nan_value : (double)(rand() % 100);
+    }
+  assert(ringbuffer_append(args, "y", CAPACITY, stream, CHUNK) == ERROR_NONE);
+  arg_array_stats(args_at(args, "y"));
+  for (i = 1; i < 40; ++i)
+    {
+      assert(ringbuffer_append(args, "y", CAPACITY, stream + i * CHUNK, CHUNK) == ERROR_NONE);
+      assert(args_at(args, "y")->priv->has_stats);
+      assert(grm_args_first_value(args, "y", "D", &window, &window_length));
+      assert_stats(&args_at(args, "y")->priv->stats, window, window_length);
+    }
+  assert(ringbuffer_append(args, "y", CAPACITY, stream, 2 * CAPACITY + 1) == ERROR_NONE);
+  assert(grm_args_first_value(args, "y", "D", &window, &window_length));
+  assert_stats(arg_array_stats(args_at(args, "y")), window, window_length);
+
+  grm_args_delete(args);
+}
+
+DEFINE_TEST_MAIN
@@ -0,0 +1,224 @@
+#ifdef __unix__
+#define _POSIX_C_SOURCE 1
+#endif
+
+#include <stdlib.h>
+#include <string.h>
+
+#include "test.h"
+
+#include <grm/args_int.h>
+#include <grm/binary_int.h>
+#include <grm/json_int.h>
+#include <grm/memwriter_int.h>
+
+
+#define LARGE_ARRAY_LENGTH 10000
+
+
+static grm_args_t *new_test_args(void)
+{
+  static const int int_values[] = {1, -2, 2147483647};
+  static const double double_values[] = {0.5, -1e300, 3.0};
+  static const char *string_values[] = {"a", "", "with \"quotes\" and \\"};
+  double *large_values;
+  grm_args_t *args, *nested_args, *deep_args, *array_args[2];
+  int i;
+
+  /* `nested_args` -> `deep_args` and an array of containers whose members have array values themselves */
+  deep_args = grm_args_new();
+  grm_args_push(deep_args, "ints", "nI", array_size(int_values), int_values);
+  nested_args = grm_args_new();
+  grm_args_push(nested_args, "name", "s", "nested");
+  grm_args_push(nested_args, "deep", "a", deep_args);
+  for (i = 0; i < 2; ++i)
+    {
+      array_args[i] = grm_args_new();
+      grm_args_push(array_args[i], "index", "i", i);
+      grm_args_push(array_args[i], "strings", "nS", i + 1, string_values);
+    }
+
+  /* the long array is compressible */
+  large_values = malloc(LARGE_ARRAY_LENGTH * sizeof(double));
+  assert(large_values != NULL);
+  for (i = 0; i < LARGE_ARRAY_LENGTH; ++i)
+    {
+      large_values[i] = i % 10;
+    }
+
+  args = grm_args_new();
+  grm_args_push(args, "int", "i", -42);
+  grm_args_push(args, "double", "d", 0.1);
+  grm_args_push(args, "char", "c", 'x');
+  grm_args_push(args, "string", "s", "Hello, World!");
+  grm_args_push(args, "object", "a", nested_args);
+  grm_args_push(args, "int_array", "nI", array_size(int_values), int_values);
+  grm_args_push(args, "double_array", "nD", array_size(double_values), double_values);
+  grm_args_push(args, "string_array", "nS", array_size(string_values), string_values);
+  grm_args_push(args, "object_array", "nA", 2, array_args);
+  grm_args_push(args, "large_array", "nD", LARGE_ARRAY_LENGTH, large_values);
+  free(large_values);
+
+  return args;
+}
+
+static void assert_equal_args(const grm_args_t *args, const grm_args_t *expected_args)
+{
+  /* the JSON representation contains all values (doubles in their shortest exact form), the explicit terminator is
+   * needed for empty containers which do not write anything into the new memwriters */
+  memwriter_t *memwriter, *expected_memwriter;
+
+  memwriter = memwriter_new();
+  expected_memwriter = memwriter_new();
+  assert(tojson_write_args(memwriter, args) == ERROR_NONE && memwriter_putc(memwriter, '\0') == ERROR_NONE);
+  assert(tojson_write_args(expected_memwriter, expected_args) == ERROR_NONE &&
+         memwriter_putc(expected_memwriter, '\0') == ERROR_NONE);
+  assert(strcmp(memwriter_buf(memwriter), memwriter_buf(expected_memwriter)) == 0);
+  memwriter_delete(expected_memwriter);
+  memwriter_delete(memwriter);
+}
+
+static char *write_message(const grm_args_t *args, int compression_level, size_t *size)
+{
+  memwriter_t *memwriter;
+  char *message;
+  size_t message_size;
+
+  memwriter = memwriter_new();
+  assert(tobinary_write_args(memwriter, args, compression_level) == ERROR_NONE);
+  message_size = memwriter_size(memwriter);
+  assert(frombinary_is_message(memwriter_buf(memwriter), message_size));
+  assert(frombinary_message_size(memwriter_buf(memwriter), message_size, size) && *size == message_size);
+  message = malloc(message_size);
+  assert(message != NULL);
+  memcpy(message, memwriter_buf(memwriter), message_size);
+  memwriter_delete(memwriter);
+
+  return message;
+}
+
+static void test_round_trip(const grm_args_t *args, int compression_level, int compressible)
+{
+  grm_args_t *read_args;
+  args_buffer_t *buffer;
+  char *message;
+  size_t size;
+  int compressed;
+
+  message = write_message(args, compression_level, &size);
+  compressed = (message[BINARY_MAGIC_SIZE + 1] & BINARY_FLAG_COMPRESSED) != 0;
+  /* payloads are only sent compressed if that makes them smaller */
+  assert(compressed == (compression_level > 0 && compressible && (binary_capabilities() & BINARY_FLAG_COMPRESSED)));
+  assert(frombinary_is_in_place_message(message, size) == !compressed);
+
+  /* values are copied out of the message... */
+  read_args = grm_args_new();
+  assert(frombinary_read(read_args, message, size, NULL) == ERROR_NONE);
+  assert_equal_args(read_args, args);
+  grm_args_delete(read_args);
+
+  /* ...or reference it, which keeps it alive after the reader released it */
+  buffer = args_buffer_new(message, size, NULL, NULL);
+  assert(buffer != NULL);
+  read_args = grm_args_new();
+  assert(frombinary_read(read_args, message, size, buffer) == ERROR_NONE);
+  args_buffer_release(buffer);
+  assert_equal_args(read_args, args);
+  grm_args_delete(read_args);
+}
+
+static void test_char_array(void)
+{
+  /* Char arrays are stored as strings by the argument container and thus never written, but they can be read. The
+   * message is: 1 member, key "chars", format 'C', 3 elements, padding to 8 bytes, "abc" */
+  static const char payload[] = "\001\000\000\000\005\000\000\000chars\000C\003\000\000\000\000\000\000\000\000abc";
+  char message[BINARY_HEADER_SIZE + sizeof(payload) - 1];
+  grm_args_t *args;
+  const char *string_value;
+
+  memset(message, 0, BINARY_HEADER_SIZE);
+  memcpy(message, BINARY_MAGIC, BINARY_MAGIC_SIZE);
+  message[BINARY_MAGIC_SIZE] = BINARY_VERSION;
+  message[8] = message[16] = (char)(sizeof(payload) - 1);
+  memcpy(message + BINARY_HEADER_SIZE, payload, sizeof(payload) - 1);
+
+  args = grm_args_new();
+  assert(frombinary_read(args, message, sizeof(message), NULL) == ERROR_NONE);
+  assert(grm_args_values(args, "chars", "s", &string_value) && strcmp(string_value, "abc") == 0);
+  grm_args_delete(args);
+}
+
+static void test_invalid_messages(const grm_args_t *args)
+{
+  static const int int_values[] = {1, 2};
+  grm_args_t *read_args;
+  memwriter_t *memwriter;
+  char *message, *truncated_message;
+  size_t size, truncated_size, payload_size;
+  int i;
+
+  /* messages which end too early are rejected, also if the header is adjusted to the truncated payload */
+  message = write_message(args, 0, &size);
+  for (truncated_size = 0; truncated_size < size; truncated_size += (truncated_size < 4096) ? 1 : 4096)
+    {
+      truncated_message = malloc(truncated_size > 0 ? truncated_size : 1);
+      assert(truncated_message != NULL);
+      memcpy(truncated_message, message, truncated_size);
+      read_args = grm_args_new();
+      assert(frombinary_read(read_args, truncated_message, truncated_size, NULL) != ERROR_NONE);
+      grm_args_delete(read_args);
+      if (truncated_size >= BINARY_HEADER_SIZE)
+        {
+          payload_size = truncated_size - BINARY_HEADER_SIZE;
+          for (i = 0; i < 4; ++i)
+            {
+              truncated_message[8 + i] = truncated_message[16 + i] = (char)((payload_size >> (8 * i)) & 0xff);
+            }
+        }
+      read_args = grm_args_new();
+      assert(frombinary_read(read_args, truncated_message, truncated_size, NULL) != ERROR_NONE);
+      grm_args_delete(read_args);
+      free(truncated_message);
+    }
+  message[0] = '{';
+  read_args = grm_args_new();
+  assert(!frombinary_is_message(message, size));
+  assert(frombinary_read(read_args, message, size, NULL) != ERROR_NONE);
+  grm_args_delete(read_args);
+  free(message);
+
+  /* multiple values per key cannot be written, the partial message is removed */
+  read_args = grm_args_new();
+  grm_args_push(read_args, "values", "nInI", 2, int_values, 1, int_values);
+  memwriter = memwriter_new();
+  memwriter_printf(memwriter, "prefix");
+  assert(tobinary_write_args(memwriter, read_args, 0) == ERROR_UNSUPPORTED_DATATYPE);
+  assert(memwriter_size(memwriter) == 6);
+  memwriter_delete(memwriter);
+  grm_args_delete(read_args);
+}
+
+void test(void)
+{
+  grm_args_t *args;
+
+  if (!binary_is_supported())
+    {
+      return;
+    }
+
+  args = new_test_args();
+  test_round_trip(args, 0, 1);
+  test_round_trip(args, 6, 1);
+  test_char_array();
+  test_invalid_messages(args);
+  grm_args_delete(args);
+
+  /* empty containers */
+  args = grm_args_new();
+  test_round_trip(args, 0, 0);
+  test_round_trip(args, 6, 0);
+  grm_args_delete(args);
+}
+
+DEFINE_TEST_MAIN
@@ -0,0 +1,195 @@
+#ifdef __unix__
+#define _POSIX_C_SOURCE 1
+#endif
+
+#include <limits.h>
+#include <string.h>
+
+#include "test.h"
+
+#include <grm/args_int.h>
+#include <grm/json_int.h>
+
+
+typedef struct
+{
+  const char *json_string;
+  err_t error;
+} error_case_t;
+
+
+static unsigned int count_args(grm_args_t *args)
+{
+  args_iterator_t *it;
+  unsigned int count = 0;
+
+  it = args_iter(args);
+  while (it->next(it) != NULL)
+    {
+      ++count;
+    }
+  args_iterator_delete(it);
+
+  return count;
+}
+
+static void test_mixed_arrays(void)
+{
+  grm_args_t *args;
+  int *int_values;
+  double *double_values;
+  unsigned int length;
+
+  args = grm_args_new();
+  assert(fromjson_read(args, "{\"ints\": [1, -2, 3], \"int_first\": [1, 2.5, -3], \"double_first\": [0.5, 1], "
+                             "\"exponent\": [2, 1e2]}") == ERROR_NONE);
+  assert(grm_args_first_value(args, "ints", "I", &int_values, &length));
+  assert(length == 3 && int_values[0] == 1 && int_values[1] == -2 && int_values[2] == 3);
+  /* arrays which contain at least one double are converted to double arrays completely */
+  assert(grm_args_first_value(args, "int_first", "D", &double_values, &length));
+  assert(length == 3 && double_values[0] == 1.0 && double_values[1] == 2.5 && double_values[2] == -3.0);
+  assert(grm_args_first_value(args, "double_first", "D", &double_values, &length));
+  assert(length == 2 && double_values[0] == 0.5 && double_values[1] == 1.0);
+  assert(grm_args_first_value(args, "exponent", "D", &double_values, &length));
+  assert(length == 2 && double_values[0] == 2.0 && double_values[1] == 100.0);
+  grm_args_delete(args);
+}
+
+static void test_empty_values(void)
+{
+  grm_args_t *args, *nested_args;
+  int *int_values;
+  unsigned int length;
+
+  args = grm_args_new();
+  assert(fromjson_read(args, "") == ERROR_NONE);
+  assert(fromjson_read(args, " \n\t ") == ERROR_NONE);
+  assert(fromjson_read(args, "{}") == ERROR_NONE);
+  assert(fromjson_read(args, "  {  }  ") == ERROR_NONE);
+  assert(count_args(args) == 0);
+
+  assert(fromjson_read(args, "{\"object\": {}, \"array\": [], \"objects\": [{}, {\"a\": {}}]}") == ERROR_NONE);
+  assert(grm_args_values(args, "object", "a", &nested_args));
+  assert(count_args(nested_args) == 0);
+  assert(grm_args_first_value(args, "array", "I", &int_values, &length));
+  assert(length == 0);
+  assert(grm_args_values(args, "objects", "aa", &nested_args, &nested_args));
+  assert(grm_args_values(nested_args, "a", "a", &nested_args));
+  assert(count_args(nested_args) == 0);
+  grm_args_delete(args);
+}
+
+static void test_int_range(void)
+{
+  grm_args_t *args;
+  int int_value;
+  double double_value, *double_values;
+  unsigned int length;
+
+  args = grm_args_new();
+  assert(fromjson_read(args, "{\"max\": 2147483647, \"min\": -2147483648, \"above\": 2147483648, "
+                             "\"below\": -2147483649, \"huge\": 123456789012345678901234567890, "
+                             "\"array\": [1, 3000000000]}") == ERROR_NONE);
+  if (INT_MAX == 2147483647)
+    {
+      assert(grm_args_values(args, "max", "i", &int_value) && int_value == INT_MAX);
+      assert(grm_args_values(args, "min", "i", &int_value) && int_value == INT_MIN);
+      /* integers which do not fit into an `int` are parsed as doubles */
+      assert(grm_args_values(args, "above", "d", &double_value) && double_value == 2147483648.0);
+      assert(grm_args_values(args, "below", "d", &double_value) && double_value == -2147483649.0);
+    }
+  assert(grm_args_values(args, "huge", "d", &double_value) && double_value == 123456789012345678901234567890.0);
+  assert(grm_args_first_value(args, "array", "D", &double_values, &length));
+  assert(length == 2 && double_values[0] == 1.0 && double_values[1] == 3000000000.0);
+  grm_args_delete(args);
+}
+
+static void test_strings(void)
+{
+  grm_args_t *args;
+  const char *string_value;
+  const char **string_values;
+  unsigned int length;
+
+  args = grm_args_new();
+  assert(fromjson_read(args, "{\"backslash\": \"a\\\\\", \"quotes\": \"\\\"q\\\"\", \"empty\": \"\", "
+                             "\"array\": [\"x\\\\\", \"\", \"y z\"]}") == ERROR_NONE);
+  /* an escaped backslash right before the closing quote does not escape the quote */
+  assert(grm_args_values(args, "backslash", "s", &string_value) && strcmp(string_value, "a\\") == 0);
+  assert(grm_args_values(args, "quotes", "s", &string_value) && strcmp(string_value, "\"q\"") == 0);
+  assert(grm_args_values(args, "empty", "s", &string_value) && strcmp(string_value, "") == 0);
+  assert(grm_args_first_value(args, "array", "S", &string_values, &length));
+  assert(length == 3);
+  assert(strcmp(string_values[0], "x\\") == 0 && strcmp(string_values[1], "") == 0 &&
+         strcmp(string_values[2], "y z") == 0);
+  grm_args_delete(args);
+}
+
+static void test_in_place(void)
+{
+  const char *json_string = "{\"s\": \"x\\\"y\", \"n\": 1}";
+  char buffer[32];
+  grm_args_t *args;
+  const char *string_value;
+  int int_value;
+
+  args = grm_args_new();
+  /* `fromjson_read` parses a copy... */
+  assert(fromjson_read(args, json_string) == ERROR_NONE);
+  assert(strcmp(json_string, "{\"s\": \"x\\\"y\", \"n\": 1}") == 0);
+  grm_args_clear(args);
+
+  /* ...while `fromjson_read_in_place` unescapes strings in the given buffer, which is not needed afterwards */
+  strcpy(buffer, json_string);
+  assert(fromjson_read_in_place(args, buffer) == ERROR_NONE);
+  memset(buffer, 'X', sizeof(buffer) - 1);
+  assert(grm_args_values(args, "s", "s", &string_value) && strcmp(string_value, "x\"y") == 0);
+  assert(grm_args_values(args, "n", "i", &int_value) && int_value == 1);
+  grm_args_delete(args);
+}
+
+static void test_errors(void)
+{
+  static const error_case_t error_cases[] = {
+      {"[1, 2]", ERROR_PARSE_MISSING_OBJECT_CONTAINER},
+      {"{\"a\": 1", ERROR_PARSE_INCOMPLETE_STRING},
+      {"{\"a\": 1,}", ERROR_PARSE_INVALID_DELIMITER},
+      {"{\"a\": 1 \"b\": 2}", ERROR_PARSE_INVALID_DELIMITER},
+      {"{\"a\" 1}", ERROR_PARSE_INVALID_DELIMITER},
+      {"{a: 1}", ERROR_PARSE_INVALID_DELIMITER},
+      {"{\"a\": nul}", ERROR_PARSE_NULL},
+      {"{\"a\": tru}", ERROR_PARSE_BOOL},
+      {"{\"a\": 1x}", ERROR_PARSE_DOUBLE},
+      {"{\"a\": -}", ERROR_PARSE_DOUBLE},
+      {"{\"s\": \"abc", ERROR_PARSE_STRING},
+      {"{\"s\": \"abc\\", ERROR_PARSE_STRING},
+      {"{\"a\": [1, 2}", ERROR_PARSE_INVALID_DELIMITER},
+      {"{\"a\": [1, \"b\"]}", ERROR_PARSE_ARRAY},
+      {"{\"a\": [[1], 2]}", ERROR_PARSE_ARRAY},
+      /* the already parsed containers are deleted with the array */
+      {"{\"a\": [{\"b\": 1}, {\"c\": [1, \"d\"]}]}", ERROR_PARSE_ARRAY},
+      {"{\"a\": [{\"b\": 1}, 2]}", ERROR_PARSE_ARRAY},
+      {"{\"a\": [[{\"b\": 1}], [{\"c\": tru}]]}", ERROR_PARSE_BOOL},
+  };
+  grm_args_t *args;
+  unsigned int i;
+
+  for (i = 0; i < array_size(error_cases); ++i)
+    {
+      args = grm_args_new();
+      assert(fromjson_read(args, error_cases[i].json_string) == error_cases[i].error);
+      grm_args_delete(args);
+    }
+}
+
+void test(void)
+{
+  test_mixed_arrays();
+  test_empty_values();
+  test_int_range();
+  test_strings();
+  test_in_place();
+  test_errors();
+}
+
+DEFINE_TEST_MAIN
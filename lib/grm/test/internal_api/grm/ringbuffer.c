@@ -0,0 +1,115 @@
+#ifdef __unix__
+#define _POSIX_C_SOURCE 1
+#endif
+
+#include <float.h>
+#include <stdlib.h>
+
+#include "test.h"
+
+#include <grm/args_int.h>
+#include <grm/ringbuffer_int.h>
+
+
+#define CAPACITY 16
+#define CHUNK 5
+
+
+static void assert_window(const grm_args_t *args, const double *expected, unsigned int expected_length)
+{
+  double *values, min = DBL_MAX, max = -DBL_MAX, ring_min, ring_max;
+  unsigned int length, i;
+  ringbuffer_t *ring;
+
+  assert(grm_args_first_value(args, "x", "D", &values, &length));
+  assert(length == expected_length);
+  for (i = 0; i < length; ++i)
+    {
+      assert(values[i] == expected[i] || (values[i] != values[i] && expected[i] != expected[i]));
+      if (values[i] == values[i])
+        {
+          min = (values[i] < min) ? values[i] : min;
+          max = (values[i] > max) ? values[i] : max;
+        }
+    }
+  ring = ringbuffer_of_arg(args_at(args, "x"));
+  assert(ring != NULL);
+  ringbuffer_range(ring, &ring_min, &ring_max);
+  assert(ring_min == min && ring_max == max);
+}
+
+void test(void)
+{
+  double stream[40 * CHUNK], initial[3] = {7.0, -1.0, 3.0}, all_values[3 + 40 * CHUNK], zero = 0.0;
+  grm_args_t *args, *args_copy_;
+  double *values;
+  unsigned int length, total_length;
+  ringbuffer_t *ring;
+  int i;
+
+  srand(42);
+  for (i = 0; i < (int)(sizeof(stream) / sizeof(stream[0])); ++i)
+    {
+      stream[i] = (i % 17 == 0) ? zero / zero : (double)(rand() % 100);
+      all_values[3 + i] = stream[i];
+    }
+  for (i = 0; i < 3; ++i)
+    {
+      all_values[i] = initial[i];
+    }
+
+  /* existing arrays are converted and only the last `CAPACITY` values are kept; ranges follow the window */
+  args = grm_args_new();
+  grm_args_push(args, "x", "nD", 3, initial);
+  assert(ringbuffer_of_arg(args_at(args, "x")) == NULL);
+  assert(ringbuffer_append(args, "x", CAPACITY, stream, CHUNK) == ERROR_NONE);
+  assert_window(args, all_values, 3 + CHUNK);
+  for (i = 1; i < 40; ++i)
+    {
+      ring = ringbuffer_of_arg(args_at(args, "x"));
+      assert(ringbuffer_append(args, "x", CAPACITY, stream + i * CHUNK, CHUNK) == ERROR_NONE);
+      /* an unshared ring buffer is updated in place */
+      assert(ringbuffer_of_arg(args_at(args, "x")) == ring);
+      total_length = 3 + (i + 1) * CHUNK;
+      if (total_length < CAPACITY)
+        {
+          assert_window(args, all_values, total_length);
+        }
+      else
+        {
+          assert_window(args, all_values + total_length - CAPACITY, CAPACITY);
+        }
+    }
+
+  /* appending more values than the capacity keeps the last ones */
+  assert(ringbuffer_append(args, "x", CAPACITY, stream, 2 * CAPACITY + 1) == ERROR_NONE);
+  assert_window(args, stream + CAPACITY + 1, CAPACITY);
+
+  /* copy-on-write: a shared ring buffer is not modified */
+  args_copy_ = args_copy(args);
+  ring = ringbuffer_of_arg(args_at(args, "x"));
+  assert(ringbuffer_append(args, "x", CAPACITY, stream + 1, 1) == ERROR_NONE);
+  assert(ringbuffer_of_arg(args_at(args, "x")) != ring);
+  assert_window(args_copy_, stream + CAPACITY + 1, CAPACITY);
+  assert(grm_args_first_value(args, "x", "D", &values, &length));
+  assert(length == CAPACITY && values[CAPACITY - 1] == stream[1]);
+  grm_args_delete(args_copy_);
+
+  /* without a capacity the buffer grows */
+  assert(ringbuffer_append(args, "y", 0, stream + 1, 3) == ERROR_NONE);
+  for (i = 0; i < 1000; ++i)
+    {
+      assert(ringbuffer_append(args, "y", 0, stream + i % 40, 3) == ERROR_NONE);
+    }
+  assert(grm_args_first_value(args, "y", "D", &values, &length));
+  assert(length == 3003);
+  assert(values[0] == stream[1] && values[3002] == stream[999 % 40 + 2]);
+
+  /* only double arrays can be appended to */
+  grm_args_push(args, "s", "s", "text");
+  assert(ringbuffer_append(args, "s", CAPACITY, stream, 1) == ERROR_ARGS_INCREASING_NON_ARRAY_VALUE);
+
+  grm_args_delete(args);
+}
+
+DEFINE_TEST_MAIN
@@ -4,6 +4,12 @@
 #include <assert.h>
 #include <stdio.h>
 
+#ifndef _MSC_VER
+#include <unistd.h>
+#else
+#include <io.h>
+#endif
+
 #ifndef NDEBUG
 #define DEFINE_TEST_MAIN                                \
   int main(void)                                        \
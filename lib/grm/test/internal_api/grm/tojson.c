@@ -0,0 +1,161 @@
+#ifdef __unix__
+#define _POSIX_C_SOURCE 1
+#endif
+
+#include <float.h>
+#include <limits.h>
+#include <math.h>
+#include <string.h>
+
+#include "test.h"
+
+#include <grm/args_int.h>
+#include <grm/json_int.h>
+#include <grm/memwriter_int.h>
+
+
+#define RANDOM_VALUE_COUNT 10000
+
+
+typedef struct
+{
+  double value;
+  const char *json_string;
+} double_case_t;
+
+
+static int same_double(double a, double b)
+{
+  if (a != a || b != b)
+    {
+      return a != a && b != b;
+    }
+  /* also distinguishes 0.0 and -0.0 */
+  return a == b && (a != 0.0 || (1.0 / a > 0) == (1.0 / b > 0));
+}
+
+static double random_double(unsigned long *seed)
+{
+  /* doubles with random bit patterns (except NaN and infinity) cover all exponents and mantissa lengths */
+  double value;
+  unsigned char *bytes = (unsigned char *)&value;
+  size_t i;
+
+  do
+    {
+      for (i = 0; i < sizeof(double); ++i)
+        {
+          *seed = (*seed * 1103515245ul + 12345ul) & 0x7ffffffful;
+          bytes[i] = (unsigned char)(*seed >> 16);
+        }
+    }
+  while (value - value != 0.0);
+
+  return value;
+}
+
+static void test_format_int(void)
+{
+  char buffer[TOJSON_INT_MAX_LENGTH];
+
+  assert(tojson_format_int(buffer, 0) == 1 && strcmp(buffer, "0") == 0);
+  assert(tojson_format_int(buffer, -7) == 2 && strcmp(buffer, "-7") == 0);
+  assert(tojson_format_int(buffer, 1234567) == 7 && strcmp(buffer, "1234567") == 0);
+  if (INT_MAX == 2147483647)
+    {
+      assert(tojson_format_int(buffer, INT_MAX) == 10 && strcmp(buffer, "2147483647") == 0);
+      assert(tojson_format_int(buffer, INT_MIN) == 11 && strcmp(buffer, "-2147483648") == 0);
+    }
+}
+
+static void test_format_double(void)
+{
+  static const double_case_t double_cases[] = {
+      /* integral values get a trailing '.', so they are not read back as integers */
+      {0.0, "0."},
+      {1.0, "1."},
+      {-3.0, "-3."},
+      {123456789012.0, "123456789012."},
+      {0.1, "0.1"},
+      {-2.5, "-2.5"},
+      {1e22, "1e+22"},
+      {1e-7, "1e-07"},
+      {5e-324, "5e-324"},
+      {DBL_MAX, "1.7976931348623157e+308"},
+  };
+  char buffer[TOJSON_DOUBLE_MAX_LENGTH];
+  double inf = HUGE_VAL;
+  unsigned int i;
+  size_t length;
+
+  for (i = 0; i < array_size(double_cases); ++i)
+    {
+      length = tojson_format_double(buffer, double_cases[i].value);
+      assert(length == strlen(buffer));
+      assert(strcmp(buffer, double_cases[i].json_string) == 0);
+    }
+  /* NaN and infinity are written in the spelling which is understood by the parser */
+  assert(tojson_format_double(buffer, inf) == 3 && strcmp(buffer, "INF") == 0);
+  assert(tojson_format_double(buffer, -inf) == 4 && strcmp(buffer, "-INF") == 0);
+  length = tojson_format_double(buffer, inf - inf);
+  assert(strcmp(buffer + (length - 3), "NAN") == 0 && (length == 3 || (length == 4 && buffer[0] == '-')));
+}
+
+static void test_round_trip(void)
+{
+  double double_values[RANDOM_VALUE_COUNT], *read_double_values, inf = HUGE_VAL, read_double_value;
+  int int_values[] = {0, 1, -1, INT_MAX, INT_MIN}, *read_int_values;
+  grm_args_t *args, *read_args;
+  memwriter_t *memwriter;
+  unsigned int length, i;
+  unsigned long seed = 42;
+
+  double_values[0] = 0.0;
+  double_values[1] = -0.0;
+  double_values[2] = 1.0;
+  double_values[3] = -3.0;
+  double_values[4] = 1e22;
+  double_values[5] = inf;
+  double_values[6] = -inf;
+  double_values[7] = inf - inf;
+  double_values[8] = DBL_MIN;
+  double_values[9] = 4503599627370496.0; /* 2^52 */
+  for (i = 10; i < RANDOM_VALUE_COUNT; ++i)
+    {
+      double_values[i] = random_double(&seed);
+    }
+
+  args = grm_args_new();
+  grm_args_push(args, "doubles", "nD", RANDOM_VALUE_COUNT, double_values);
+  grm_args_push(args, "ints", "nI", array_size(int_values), int_values);
+  grm_args_push(args, "integral", "d", 2.0);
+  memwriter = memwriter_new();
+  assert(tojson_write_args(memwriter, args) == ERROR_NONE);
+
+  read_args = grm_args_new();
+  assert(fromjson_read(read_args, memwriter_buf(memwriter)) == ERROR_NONE);
+  assert(grm_args_first_value(read_args, "doubles", "D", &read_double_values, &length));
+  assert(length == RANDOM_VALUE_COUNT);
+  for (i = 0; i < length; ++i)
+    {
+      assert(same_double(read_double_values[i], double_values[i]));
+    }
+  assert(grm_args_first_value(read_args, "ints", "I", &read_int_values, &length));
+  assert(length == array_size(int_values));
+  assert(memcmp(read_int_values, int_values, sizeof(int_values)) == 0);
+  /* integral doubles stay doubles */
+  assert(grm_args_values(read_args, "integral", "d", &read_double_value) && read_double_value == 2.0);
+
+  grm_args_delete(read_args);
+  memwriter_delete(memwriter);
+  grm_args_delete(args);
+}
+
+void test(void)
+{
+  test_format_int();
+  test_format_double();
+  test_round_trip();
+}
+
+DEFINE_TEST_MAIN
@@ -0,0 +1,104 @@
+#ifdef __unix__
+#define _POSIX_C_SOURCE 200112L
+#endif
+
+#include <stdlib.h>
+
+#include "test.h"
+
+#include <grm/worker_pool_int.h>
+
+
+#define TASK_COUNT 1000
+#define NESTED_TASK_COUNT 4
+
+
+typedef struct
+{
+  long index;
+  long sum;
+  int run_count;
+} task_t;
+
+
+static void sum_task(void *data)
+{
+  task_t *task = (task_t *)data;
+  long i;
+
+  for (i = 0; i <= task->index; ++i)
+    {
+      task->sum += i;
+    }
+  ++task->run_count;
+}
+
+static void nested_task(void *data)
+{
+  task_t *task = (task_t *)data, nested_tasks[NESTED_TASK_COUNT];
+  int i;
+
+  for (i = 0; i < NESTED_TASK_COUNT; ++i)
+    {
+      nested_tasks[i].index = task->index;
+      nested_tasks[i].sum = 0;
+      nested_tasks[i].run_count = 0;
+    }
+  worker_pool_run(sum_task, nested_tasks, NESTED_TASK_COUNT, sizeof(task_t));
+  for (i = 0; i < NESTED_TASK_COUNT; ++i)
+    {
+      assert(nested_tasks[i].run_count == 1);
+      task->sum += nested_tasks[i].sum;
+    }
+  ++task->run_count;
+}
+
+static void run_batch(task_t *tasks, size_t task_count, void (*task_func)(void *), long factor)
+{
+  size_t i;
+
+  for (i = 0; i < task_count; ++i)
+    {
+      tasks[i].index = (long)i * 10;
+      tasks[i].sum = 0;
+      tasks[i].run_count = 0;
+    }
+  worker_pool_run(task_func, tasks, task_count, sizeof(task_t));
+  for (i = 0; i < task_count; ++i)
+    {
+      assert(tasks[i].run_count == 1);
+      assert(tasks[i].sum == factor * tasks[i].index * (tasks[i].index + 1) / 2);
+    }
+}
+
+void test(void)
+{
+  static const size_t task_counts[] = {0, 1, 2, 7, TASK_COUNT};
+  task_t tasks[TASK_COUNT];
+  int i, j;
+
+  /* use several threads even on machines with a single processor */
+  setenv(WORKER_POOL_THREADS_ENV_KEY, "4", 1);
+#ifndef _WIN32
+  assert(worker_pool_thread_count() == 4);
+#endif
+  for (i = 0; i < 100; ++i)
+    {
+      for (j = 0; j < (int)(sizeof(task_counts) / sizeof(task_counts[0])); ++j)
+        {
+          run_batch(tasks, task_counts[j], sum_task, 1);
+        }
+    }
+
+  /* tasks which start batches themselves run them on their own thread */
+  run_batch(tasks, 100, nested_task, NESTED_TASK_COUNT);
+
+  /* the pool can be restarted with another number of threads */
+  worker_pool_finalize();
+  setenv(WORKER_POOL_THREADS_ENV_KEY, "1", 1);
+  assert(worker_pool_thread_count() == 1);
+  run_batch(tasks, TASK_COUNT, sum_task, 1);
+  worker_pool_finalize();
+}
+
+DEFINE_TEST_MAIN